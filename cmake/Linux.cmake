@@ -15,6 +15,12 @@
 
 add_library(iolmaster_osal)
 
+# Data Storage backend, independent of the SPI mode
+target_sources(iolmaster_osal
+  PRIVATE
+  ${IOLINKMASTER_SOURCE_DIR}/iol_osal/linux/osal_ds_file.c
+)
+
 # TODO: ett snyggare sätt att bygga beroende på linux/linux-usb
 set(IOLMASTER_USB_SOURCES
   ${IOLINKMASTER_SOURCE_DIR}/iol_osal/linux/osal_spi_usb_helpers.c
@@ -28,10 +34,16 @@ set(IOLMASTER_COMMON_SOURCES
 )
 
 option(IOLINKMASTER_USB_MODE_ENABLE "Enable usb mode" OFF)
+option(IOLINKMASTER_USB_IRQ_EVENT_ENABLE
+  "Sample the IRQ pin with each SPI batch and wait on it in the MPSSE engine" OFF)
 
 if(IOLINKMASTER_USB_MODE_ENABLE)
   add_definitions(-DIOLINKMASTER_USB_MODE_ENABLE)
 
+  if(IOLINKMASTER_USB_IRQ_EVENT_ENABLE)
+    add_definitions(-DIOLINKMASTER_USB_IRQ_EVENT_ENABLE)
+  endif()
+
   if(NOT IOLINKMASTER_FTDI_DRIVER_PREFIX)
   find_path(IOLINKMASTER_FTDI_DRIVER_PREFIX include/ftd2xx.h PATHS /usr/local)
   endif()
@@ -47,6 +59,7 @@ if(IOLINKMASTER_USB_MODE_ENABLE)
       $<BUILD_INTERFACE:${IOLINKMASTER_SOURCE_DIR}/iol_osal/include>
       $<INSTALL_INTERFACE:include>
     PRIVATE
+      ${IOLINKMASTER_SOURCE_DIR}/include
       ${IOLINKMASTER_SOURCE_DIR}/iol_osal/linux
       ${IOLINKMASTER_FTDI_DRIVER_PREFIX}/include
     )
@@ -68,6 +81,7 @@ else()
       $<BUILD_INTERFACE:${IOLINKMASTER_SOURCE_DIR}/iol_osal/include>
       $<INSTALL_INTERFACE:include>
     PRIVATE
+      ${IOLINKMASTER_SOURCE_DIR}/include
       ${IOLINKMASTER_SOURCE_DIR}/iol_osal/linux
       ${IOLINKMASTER_FTDI_DRIVER_PREFIX}/include
   )
@@ -44,6 +44,12 @@ extern "C" {
 #define IOLINK_REVISION_1_1 0x11
 
 #define IOLINK_PD_MAX_SIZE 32 //!< Maximum number of bytes in Process Data
+#define IOLINK_PD_FILTER_FIELDS 4 //!< Maximum number of PD filter deadbands
+#define IOLINK_DS_MAX_SIZE 2048 //!< Maximum number of bytes in a Data Storage
+
+/** Size of a Data Storage image of port_cnt ports, see iolink_ds_export() */
+#define IOLINK_DS_IMAGE_SIZE(port_cnt)                                         \
+   (16 + (port_cnt) * (16 + IOLINK_DS_MAX_SIZE))
 
 typedef struct iolink_m_cfg iolink_m_cfg_t;
 typedef struct iolink_m iolink_m_t;
@@ -435,6 +441,48 @@ typedef struct CC_PACKED arg_block_od
 } arg_block_od_t;
 CC_PACKED_END
 
+CC_PACKED_BEGIN
+typedef struct CC_PACKED port_index
+{
+   uint16_t index;
+   uint8_t subindex;
+} port_index_t;
+CC_PACKED_END
+
+CC_PACKED_BEGIN
+typedef struct CC_PACKED arg_block_portindexlist
+{
+   arg_block_t arg_block; // IOLINK_ARG_BLOCK_ID_PORT_INXDEX_LIST
+   port_index_t entries[];
+} arg_block_portindexlist_t;
+CC_PACKED_END
+
+/**
+ * Object of a DeviceParBatch ArgBlock.
+ *
+ * The objects follow each other without padding, each taking
+ * sizeof (dev_par_bat_entry_t) + len octets. errortype is the result of the
+ * ISDU transfer of the object and is set by the master.
+ */
+CC_PACKED_BEGIN
+typedef struct CC_PACKED dev_par_bat_entry
+{
+   uint16_t index;
+   uint8_t subindex;
+   iolink_smi_errortypes_t errortype;
+   uint8_t len;
+   uint8_t data[];
+} dev_par_bat_entry_t;
+CC_PACKED_END
+
+CC_PACKED_BEGIN
+typedef struct CC_PACKED arg_block_devparbat
+{
+   arg_block_t arg_block; // IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT
+   uint8_t entries[];     // dev_par_bat_entry_t objects
+} arg_block_devparbat_t;
+CC_PACKED_END
+
 CC_PACKED_BEGIN
 typedef struct CC_PACKED arg_block_ds_data
 {
@@ -560,6 +608,10 @@ static_assert (
    "");
 
 static_assert (sizeof (arg_block_od_t) == 5, "");
+static_assert (sizeof (port_index_t) == 3, "");
+static_assert (sizeof (arg_block_portindexlist_t) == 2, "");
+static_assert (sizeof (dev_par_bat_entry_t) == 6, "");
+static_assert (sizeof (arg_block_devparbat_t) == 2, "");
 static_assert (sizeof (arg_block_ds_data_t) == 2 + 12, "");
 
 static_assert (sizeof (portconfiglist_t) == 12, "");
@@ -577,6 +629,32 @@ static_assert (sizeof (arg_block_joberror_t) == 6, "");
 
 typedef struct iolink_hw_drv iolink_hw_drv_t;
 
+#define IOLINK_PI_UNMAPPED 0xFFFF //!< Offset of items not in the process image
+
+/** Placement of a port in the master process image */
+typedef struct iolink_pi_map
+{
+   /** Offset of the PQI in the input area, 1 octet */
+   uint16_t pqi_offset;
+
+   /** Offset of the port status (iolink_port_status_info_t) in the input
+    *  area, 1 octet */
+   uint16_t status_offset;
+
+   /** Offset of PD input in the input area */
+   uint16_t pdin_offset;
+
+   /** Size of the PD input slot. Longer PD input is truncated, shorter is
+    *  padded with zeros */
+   uint8_t pdin_len;
+
+   /** Offset of PD output in the output area */
+   uint16_t pdout_offset;
+
+   /** Size of the PD output slot */
+   uint8_t pdout_len;
+} iolink_pi_map_t;
+
 /** Port configuration */
 typedef struct iolink_port_cfg
 {
@@ -591,8 +669,236 @@ typedef struct iolink_port_cfg
 
    /** User argument */
    void * arg;
+
+   /** Placement in the process image, NULL if not mapped */
+   const iolink_pi_map_t * pi_map;
 } iolink_port_cfg_t;
 
+/** Longest heartbeat of a PD input filter, in ms (about 71 minutes) */
+#define IOLINK_PD_FILTER_MAX_HEARTBEAT_MS (UINT32_MAX / 1000)
+
+/** Analog field of a PD input filter */
+typedef struct iolink_pd_filter_field
+{
+   /** Offset of the field in Process Data, in octets */
+   uint8_t offset;
+
+   /** Field size in octets (1, 2 or 4), 0 if unused */
+   uint8_t len;
+
+   /** Field is a two's complement value */
+   bool is_signed;
+
+   /** Changes up to this value are not notified */
+   uint32_t deadband;
+} iolink_pd_filter_field_t;
+
+/** Change filter for PD input notifications */
+typedef struct iolink_pd_filter
+{
+   /** Bits that are notified on change, fields excluded */
+   uint8_t mask[IOLINK_PD_MAX_SIZE];
+
+   /** Analog fields (big-endian) notified when they change more than their
+    *  deadband */
+   iolink_pd_filter_field_t fields[IOLINK_PD_FILTER_FIELDS];
+
+   /** Max time (in ms) between notifications, 0 for no limit. At most
+    *  IOLINK_PD_FILTER_MAX_HEARTBEAT_MS */
+   uint32_t heartbeat_ms;
+} iolink_pd_filter_t;
+
+/** Process Data of a port, see iolink_pd_read */
+typedef struct iolink_pd
+{
+   /** PD input of the last cycle */
+   uint8_t pdin[IOLINK_PD_MAX_SIZE];
+   uint8_t pdin_len;
+
+   /** PD output sent to the device */
+   uint8_t pdout[IOLINK_PD_MAX_SIZE];
+   uint8_t pdout_len;
+
+   /** Port qualifier information */
+   iolink_port_qualifier_info_t pqi;
+
+   /** Time (in us) when the PD input was received */
+   uint32_t pdin_time_us;
+} iolink_pd_t;
+
+/** Field of a PD description */
+typedef struct iolink_pd_field_desc
+{
+   /** Offset of the least significant bit, counted from the last bit of
+    *  PD input as the IODD bitOffset */
+   uint16_t bit_offset;
+
+   /** Field size in bits, 1 to 32 */
+   uint8_t bit_len;
+
+   /** Field is a two's complement value */
+   bool is_signed;
+
+   /** Engineering value = raw value * gradient + offset. A gradient of 0
+    *  is taken as 1 */
+   float gradient;
+   float offset;
+} iolink_pd_field_desc_t;
+
+/** PD input layout of a device, see iolink_pd_desc_add */
+typedef struct iolink_pd_desc
+{
+   uint16_t vendorid;
+   uint32_t deviceid;
+
+   /** PD input length, in octets */
+   uint8_t pdin_len;
+
+   uint8_t field_cnt;
+   const iolink_pd_field_desc_t * fields;
+} iolink_pd_desc_t;
+
+/**
+ * Data Storage set of a port, see iolink_ds_storage_t
+ */
+typedef struct iolink_ds_record
+{
+   uint16_t vendorid;
+   uint32_t deviceid;
+   uint16_t functionid;
+   /** Checksum of the Data Storage set, as reported by the device */
+   uint32_t cs;
+   /** Number of octets in data, at most IOLINK_DS_MAX_SIZE */
+   uint16_t size;
+   uint8_t * data;
+} iolink_ds_record_t;
+
+/**
+ * Data Storage persistence backend
+ *
+ * Keeps the Data Storage set of each port across restarts of the master,
+ * so that a device can be checked against, or restored from, its stored
+ * set without a new upload. The sets are loaded when the master is
+ * initialised and stored when they change. The functions are called from
+ * the master thread.
+ */
+typedef struct iolink_ds_storage
+{
+   /** Opaque argument of the functions */
+   void * arg;
+
+   /** Load the set of a port into record, data has room for
+    *  IOLINK_DS_MAX_SIZE octets. Return false if there is no valid set */
+   bool (*load) (void * arg, uint8_t portnumber, iolink_ds_record_t * record);
+
+   /** Store the set of a port, replacing any previous set. Return false
+    *  if it could not be stored */
+   bool (*store) (
+      void * arg,
+      uint8_t portnumber,
+      const iolink_ds_record_t * record);
+
+   /** Remove the set of a port */
+   void (*erase) (void * arg, uint8_t portnumber);
+} iolink_ds_storage_t;
+
+/**
+ * Data Storage transfer statistics of a port, see iolink_ds_get_stats()
+ */
+typedef struct iolink_ds_stats
+{
+   /** Duration of the last completed upload, in microseconds */
+   uint32_t upload_us;
+   /** Size of the Data Storage set of the last completed upload */
+   uint16_t upload_size;
+   /** Number of parameters read in the last completed upload */
+   uint8_t upload_param_cnt;
+   /** Duration of the last completed download, in microseconds */
+   uint32_t download_us;
+   /** Size of the Data Storage set of the last completed download */
+   uint16_t download_size;
+   /** Number of parameters written in the last completed download */
+   uint16_t download_param_cnt;
+} iolink_ds_stats_t;
+
+/** Phases of the startup of a port */
+typedef enum iolink_startup_phase
+{
+   /** Waiting for the other ports, see iolink_m_cfg_t.startup_max_ports */
+   IOLINK_STARTUP_PHASE_WAIT = 0,
+   /** WURQ and COM baud rate detection */
+   IOLINK_STARTUP_PHASE_WURQ,
+   /** SM ReadComParameter, reading the direct parameters */
+   IOLINK_STARTUP_PHASE_READ_COM,
+   /** SM CheckComp, including the device restart if any */
+   IOLINK_STARTUP_PHASE_CHECK_COMP,
+   /** SM waiting for the DL to reach PREOPERATE */
+   IOLINK_STARTUP_PHASE_PREOPERATE,
+   /** SM reading the serial number */
+   IOLINK_STARTUP_PHASE_SERNUM,
+   /** CM DS_ParamManager, Data Storage */
+   IOLINK_STARTUP_PHASE_DS,
+   /** CM WaitingOnOperate */
+   IOLINK_STARTUP_PHASE_OPERATE,
+   IOLINK_STARTUP_PHASE_LAST,
+} iolink_startup_phase_t;
+
+/** Time spent by a port in a startup phase */
+typedef struct iolink_startup_phase_rec
+{
+   /** The phase was first entered, 0 if not entered */
+   uint32_t start_us;
+   /** Time spent in the phase, the current visit excluded */
+   uint32_t duration_us;
+   /** Number of times the phase was entered, e.g. on retries */
+   uint16_t cnt;
+} iolink_startup_phase_rec_t;
+
+/**
+ * Startup timeline of a port, see iolink_startup_get_timeline(). The times
+ * are in microseconds, see os_get_current_time_us(), and 0 if not
+ * reached.
+ */
+typedef struct iolink_startup_timeline
+{
+   /** The port asked to wake up its device */
+   uint32_t request_us;
+   /** The last WURQ was sent, after waiting for the other ports */
+   uint32_t wurq_us;
+   /** Communication was established */
+   uint32_t com_us;
+   /** PREOPERATE or OPERATE was reached, ending the startup */
+   uint32_t ready_us;
+   /** OPERATE was reached */
+   uint32_t operate_us;
+   /** Number of WURQs sent during the startup */
+   uint16_t wurq_cnt;
+   /** Time spent in each phase */
+   iolink_startup_phase_rec_t phase[IOLINK_STARTUP_PHASE_LAST];
+} iolink_startup_timeline_t;
+
+/** Startup times of a phase, over the ports that went through it */
+typedef struct iolink_startup_phase_stats
+{
+   /** Number of ports */
+   uint8_t port_cnt;
+   /** Shortest time of a port, in microseconds */
+   uint32_t min_us;
+   /** Longest time of a port, in microseconds */
+   uint32_t max_us;
+   /** Sum of the times of the ports, in microseconds */
+   uint32_t total_us;
+} iolink_startup_phase_stats_t;
+
+/** Startup report of all ports, see iolink_startup_get_report() */
+typedef struct iolink_startup_report
+{
+   /** Time spent in each phase */
+   iolink_startup_phase_stats_t phase[IOLINK_STARTUP_PHASE_LAST];
+   /** Time from the wake-up request to OPERATE */
+   iolink_startup_phase_stats_t operate;
+} iolink_startup_report_t;
+
 /** IO-Link master stack configuration */
 typedef struct iolink_m_cfg
 {
@@ -631,6 +937,33 @@ typedef struct iolink_m_cfg
 
    /** Stack size (in bytes) of the DL thread */
    size_t dl_thread_stack_size;
+
+   /** Max time (in ms) an on-request data request waits for a busy port,
+    *  0 for no limit. Longer times than about 35 minutes are reduced to
+    *  that */
+   uint32_t od_queue_timeout_ms;
+
+   /** Max age (in ms) of cached device status parameters (ErrorCount,
+    *  DeviceStatus), 0 to always read them from the device. Longer times
+    *  than about 35 minutes are reduced to that */
+   uint32_t od_cache_ttl_ms;
+
+   /** Size (in octets) of the process image input area, 0 for none */
+   uint16_t pi_input_size;
+
+   /** Size (in octets) of the process image output area, 0 for none */
+   uint16_t pi_output_size;
+
+   /** Data Storage persistence backend, NULL to keep the Data Storage
+    *  sets in RAM only */
+   const iolink_ds_storage_t * ds_storage;
+
+   /** Max number of ports waking up their devices at once, from the WURQ
+    *  until PREOPERATE or OPERATE, 0 for no limit */
+   uint8_t startup_max_ports;
+
+   /** Min time (in us) between the WURQs of two ports, 0 for none */
+   uint32_t startup_wurq_spacing_us;
 } iolink_m_cfg_t;
 
 /**
@@ -765,6 +1098,12 @@ iolink_error_t SMI_DeviceWrite_req (
 /**
  * Batch read parameters from device
  *
+ * The arg_block is a PortIndexList with the objects to read. The objects are
+ * read back-to-back, the result is confirmed as one DeviceParBatch holding
+ * the data or ErrorType of each object. The result must fit in
+ * IOLINK_ODE_BATCH_SIZE octets, objects whose data does not fit are
+ * returned with ErrorType VAL_LENOVRRUN.
+ *
  * @param portnumber          Port number
  * @param exp_arg_block_id    Block ID
  * @param arg_block_len       Block length
@@ -778,7 +1117,12 @@ iolink_error_t SMI_ParamReadBatch_req (
    arg_block_t * arg_block);
 
 /**
- * Batch write parameters from device
+ * Batch write parameters to device
+ *
+ * The arg_block is a DeviceParBatch with the objects to write. All objects
+ * are written back-to-back, the ErrorType of each object is stored in
+ * arg_block. A VoidBlock is confirmed if all objects were written, otherwise
+ * a JobError with the ErrorType of the first failed object.
  *
  * @param portnumber          Port number
  * @param exp_arg_block_id    Block ID
@@ -792,6 +1136,22 @@ iolink_error_t SMI_ParamWriteBatch_req (
    uint16_t arg_block_len,
    arg_block_t * arg_block);
 
+/**
+ * Cancel queued on-request data requests
+ *
+ * SMI_DeviceRead_req, SMI_DeviceWrite_req, SMI_ParamReadBatch_req and
+ * SMI_ParamWriteBatch_req made while the port is busy with another request
+ * are queued, up to IOLINK_ODE_QUEUE_LEN per port. This removes the queued
+ * requests that use arg_block and confirms them with a JobError
+ * SERVICE_TEMP_UNAVAILABLE. A request that has already started is not
+ * affected.
+ *
+ * @param portnumber          Port number
+ * @param arg_block           Block of the request to cancel
+ * @return                    Error type
+ */
+iolink_error_t SMI_ODCancel_req (uint8_t portnumber, arg_block_t * arg_block);
+
 /**
  * Read cyclic data from the device
  *
@@ -837,6 +1197,257 @@ iolink_error_t SMI_PDInOut_req (
    uint16_t arg_block_len,
    arg_block_t * arg_block);
 
+/**
+ * Set the change filter for PD input of a port
+ *
+ * By default cb_pd is called for every PD cycle. With a filter, cb_pd is
+ * only called when PD input changes as described by the filter, the length
+ * changes, or heartbeat_ms has elapsed since the last call. Changes are
+ * compared with the PD input of the last call. The filter is evaluated in
+ * the DL thread, unchanged PD input is not posted to the master thread.
+ *
+ * Fields are 1, 2 or 4 octets and must lie within IOLINK_PD_MAX_SIZE.
+ * Fields beyond the PD input length of the device are not checked.
+ *
+ * @param portnumber          Port number
+ * @param filter              Filter, copied. NULL to notify every cycle
+ * @return                    Error type, IOLINK_ERROR_PARAMETER_CONFLICT
+ *                            if a field or heartbeat_ms is invalid
+ */
+iolink_error_t iolink_pd_filter_set (
+   uint8_t portnumber,
+   const iolink_pd_filter_t * filter);
+
+/**
+ * Read the diagnosis entries of a port
+ *
+ * The stack keeps the events of the device connected to the port, up to
+ * IOLINK_NUM_DIAG_ENTRIES. An appearing event is kept until the matching
+ * disappearing event, a single shot event until it is the oldest entry
+ * when a new entry does not fit. The entries are cleared when the port
+ * is restarted or deactivated. They are also reported in
+ * SMI_PortStatus_req. The copy is made without taking a lock.
+ *
+ * @param portnumber          Port number
+ * @param entries             Destination, oldest entry first
+ * @param cnt                 In: size of entries. Out: number of entries
+ * @return                    Error type
+ */
+iolink_error_t iolink_diag_read (
+   uint8_t portnumber,
+   diag_entry_t * entries,
+   uint8_t * cnt);
+
+/**
+ * Read the events of a port
+ *
+ * Events from the device are queued, up to IOLINK_EVENT_RING_SIZE per
+ * port, and confirmed to the device without waiting for the application.
+ * The oldest events are dropped when the queue is full. Events read are
+ * removed from the queue. A DS_UPLOAD_REQ event also starts the Data
+ * Storage upload.
+ *
+ * @param portnumber          Port number
+ * @param entries             Destination, oldest event first
+ * @param cnt                 In: size of entries. Out: number of events
+ * @param dropped             Number of events dropped since the last read,
+ *                            may be NULL
+ * @return                    Error type
+ */
+iolink_error_t iolink_event_read (
+   uint8_t portnumber,
+   diag_entry_t * entries,
+   uint8_t * cnt,
+   uint32_t * dropped);
+
+/**
+ * Read the Process Data of a port
+ *
+ * Copies PD input, PD output, PQI and the PD input timestamp directly into
+ * pd, without building an ArgBlock or calling cb_smi. PD input is copied
+ * without taking a lock and never blocks the DL thread, so this may be
+ * called from any thread at a high rate.
+ *
+ * @param portnumber          Port number
+ * @param pd                  Destination
+ * @return                    Error type
+ */
+iolink_error_t iolink_pd_read (uint8_t portnumber, iolink_pd_t * pd);
+
+/**
+ * Add a PD input description
+ *
+ * The description is compiled into an extraction program used by
+ * iolink_pd_decode for ports with a device of the same vendor and device
+ * ID. A previous description of the device is replaced. Descriptions
+ * should be added at configuration time, before iolink_pd_decode is
+ * called.
+ *
+ * @param desc                Description, copied
+ * @return                    Error type
+ */
+iolink_error_t iolink_pd_desc_add (const iolink_pd_desc_t * desc);
+
+/**
+ * Decode the PD input of a port into engineering values
+ *
+ * The fields are decoded as described by the description of the device
+ * connected to the port.
+ *
+ * @param portnumber          Port number
+ * @param values              Destination, one value per field of the
+ *                            description
+ * @param cnt                 In: size of values. Out: number of values
+ * @return                    Error type. IOLINK_ERROR_STATE_INVALID if
+ *                            there is no description of the device,
+ *                            IOLINK_ERROR_PDINLENGTH if the PD input
+ *                            length does not match it
+ */
+iolink_error_t iolink_pd_decode (
+   uint8_t portnumber,
+   float * values,
+   uint8_t * cnt);
+
+/**
+ * Copy the input area of the process image
+ *
+ * The input area holds the PD input, PQI and port status of the ports
+ * mapped by iolink_port_cfg_t::pi_map, updated by the stack as they
+ * change. The copy is consistent: it does not mix data from before and
+ * after an update. A changed generation means the image has been updated
+ * since the previous copy.
+ *
+ * @param data                Destination
+ * @param len                 Number of octets to copy, from the start of
+ *                            the input area
+ * @param generation          Generation of the copy, or NULL
+ * @return                    Error type
+ */
+iolink_error_t iolink_pi_read_input (
+   void * data,
+   uint16_t len,
+   uint32_t * generation);
+
+/**
+ * Write the output area of the process image
+ *
+ * The PD output of each mapped port in operate is sent to its device by
+ * the master thread. Writes made before it gets to run are merged, only the
+ * latest output is sent. A port that enters operate gets the latest output.
+ *
+ * @param data                Source
+ * @param len                 Number of octets to write, from the start of
+ *                            the output area
+ * @return                    Error type
+ */
+iolink_error_t iolink_pi_write_output (const void * data, uint16_t len);
+
+/**
+ * Export the Data Storage of all ports
+ *
+ * The image holds the Data Storage set of each port with its identity and
+ * checksum, followed by a CRC-32 of the image. The format does not depend
+ * on the byte order of the host, so an image can be imported by another
+ * master, e.g. to commission several masters alike without a
+ * SMI_DSToParServ_req per port. An image is at most
+ * IOLINK_DS_IMAGE_SIZE(port_cnt) octets.
+ *
+ * @param image               Destination
+ * @param size                Size of image
+ * @param len                 Length of the exported image
+ * @return                    Error type. IOLINK_ERROR_PARAMETER_CONFLICT if
+ *                            the image does not fit
+ */
+iolink_error_t iolink_ds_export (
+   uint8_t * image,
+   uint32_t size,
+   uint32_t * len);
+
+/**
+ * Import the Data Storage of all ports
+ *
+ * Each port of the image gets the Data Storage set of the image, or has
+ * its set deleted if there was none when the image was exported. The sets
+ * are persisted if there is a backend, see iolink_m_cfg_t.ds_storage.
+ * Nothing is changed if the image is not valid. The image may hold fewer
+ * ports than the master, other ports are not changed.
+ *
+ * Nothing is changed either if a port of the image has a Data Storage
+ * upload or download in progress, or if the sets do not fit in the Data
+ * Storage arena.
+ *
+ * @param image               Image made by iolink_ds_export()
+ * @param len                 Length of image
+ * @return                    Error type. IOLINK_ERROR_PARAMETER_CONFLICT if
+ *                            the image is not valid or holds more ports
+ *                            than the master. IOLINK_ERROR_STATE_CONFLICT
+ *                            if a port is busy with Data Storage.
+ *                            IOLINK_ERROR_OUT_OF_MEMORY if the sets do not
+ *                            fit in the Data Storage arena, see
+ *                            IOLINK_DS_ARENA_SIZE
+ */
+iolink_error_t iolink_ds_import (const uint8_t * image, uint32_t len);
+
+/**
+ * Give a Data Storage set to all ports of a device
+ *
+ * Each port configured for the device of record by
+ * SMI_PortConfiguration_req, or already holding a set of it, gets the set
+ * of record, e.g. a template set of a device type used on several ports. A
+ * port downloads the set to its device at the next startup of the port,
+ * if Data Storage is enabled and the checksum of the device differs. The
+ * ports share one copy of the set in the Data Storage arena, and the sets
+ * are persisted if there is a backend, see iolink_m_cfg_t.ds_storage.
+ * Ports with an upload or download in progress are not changed.
+ *
+ * @param record              Set. The vendor ID must not be 0
+ * @param port_cnt            Number of ports given the set, or NULL
+ * @return                    Error type. IOLINK_ERROR_OUT_OF_MEMORY if
+ *                            the set does not fit in the Data Storage
+ *                            arena, see IOLINK_DS_ARENA_SIZE
+ */
+iolink_error_t iolink_ds_push_template (
+   const iolink_ds_record_t * record,
+   uint8_t * port_cnt);
+
+/**
+ * Get the Data Storage transfer statistics of a port
+ *
+ * @param portnumber          Port number
+ * @param stats               Destination
+ * @return                    Error type
+ */
+iolink_error_t iolink_ds_get_stats (
+   uint8_t portnumber,
+   iolink_ds_stats_t * stats);
+
+/**
+ * Get the startup timeline of a port
+ *
+ * The timeline shows when the port asked to wake up its device, how long
+ * it waited for the other ports, see iolink_m_cfg_t.startup_max_ports,
+ * and when it reached each step of the startup. It is reset when the
+ * port starts up again.
+ *
+ * @param portnumber          Port number
+ * @param timeline            Destination
+ * @return                    Error type
+ */
+iolink_error_t iolink_startup_get_timeline (
+   uint8_t portnumber,
+   iolink_startup_timeline_t * timeline);
+
+/**
+ * Get the startup report of all ports
+ *
+ * The report aggregates the last startup timeline of each port, so that
+ * the slowest phases of the startup of the master can be found.
+ *
+ * @param report              Destination
+ * @return                    Error type
+ */
+iolink_error_t iolink_startup_get_report (iolink_startup_report_t * report);
+
 #ifdef __cplusplus
 }
 #endif
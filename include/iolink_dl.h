@@ -51,6 +51,9 @@ typedef struct iolink_dl iolink_dl_t;
 #define IOLINK_DL_EVENT_MDH BIT (14)
 #define IOLINK_DL_EVENT_MH  BIT (15)
 
+/** Number of octets of the direct parameter page 1 */
+#define IOLINK_DL_PAGE1_LEN 16
+
 typedef enum
 {
    IOL_DL_TIMER_NONE,
@@ -61,6 +64,7 @@ typedef enum
    IOL_DL_TIMER_TDSIO,
    IOL_DL_TIMER_TDWU,
    IOL_DL_TIMER_TSD,
+   IOL_DL_TIMER_WAKEUP, /* Waiting for the startup coordinator */
 } dl_timer_t;
 
 /*
@@ -198,6 +202,7 @@ typedef enum
    IOL_MHRW_NONE,
    IOL_MHRW_WRITE,
    IOL_MHRW_READ,
+   IOL_MHRW_READPAGE,
    IOL_MHRW_WRITEPARAM,
    IOL_MHRW_READPARAM,
    IOL_MHRW_ISDUTRANSPORT,
@@ -327,6 +332,15 @@ typedef struct iolink_dl
    bool rxerror;
    bool rxtimeout;
 
+   /* DL_ReadPage_req() in progress */
+   struct
+   {
+      uint8_t addr;
+      uint8_t len;
+      uint8_t pos; /* Octets read */
+      uint8_t data[IOLINK_DL_PAGE1_LEN];
+   } page_read;
+
 #if IOLINK_HW == IOLINK_HW_MAX14819
    bool first_read_min_cycl;
    uint8_t devdly;
@@ -334,6 +348,11 @@ typedef struct iolink_dl
    uint8_t txbuffer[IOLINK_RXTX_BUFFER_SIZE];
    uint8_t rxbuffer[IOLINK_RXTX_BUFFER_SIZE];
    uint8_t tinitcyc;
+#ifdef IOLINK_MAX14819_HW_CYCLIC
+   /* Copy of the master message currently kept in the TX FIFO */
+   uint8_t tx_stored[IOLINK_RXTX_BUFFER_SIZE];
+   uint8_t tx_stored_len;
+#endif
 #endif
 } iolink_dl_t;
 
@@ -342,6 +361,12 @@ typedef struct iolink_dl
  */
 iolink_error_t DL_Read_req (iolink_port_t * port, uint8_t address);
 iolink_error_t DL_Write_req (iolink_port_t * port, uint8_t address, uint8_t value);
+/* Not in spec. Reads len octets of page 1 from address, one after the
+ * other, and confirms them all at once with DL_ReadPage_cnf() */
+iolink_error_t DL_ReadPage_req (
+   iolink_port_t * port,
+   uint8_t address,
+   uint8_t len);
 iolink_error_t DL_SetMode_req (
    iolink_port_t * port,
    iolink_dl_mode_t mode,
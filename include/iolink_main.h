@@ -28,6 +28,7 @@ extern "C" {
 
 #include "iolink_types.h"
 #include "iolink.h"
+#include "osal.h"
 
 #include <stdint.h>
 
@@ -69,6 +70,7 @@ typedef enum iolink_job_type
    IOLINK_JOB_SM_SET_PORT_CFG_REQ,
    IOLINK_JOB_DL_MODE_IND,
    IOLINK_JOB_DL_READ_CNF,
+   IOLINK_JOB_DL_READPAGE_CNF,
    IOLINK_JOB_DL_WRITE_CNF,
    IOLINK_JOB_DL_WRITE_DEVMODE_CNF,
    IOLINK_JOB_DL_READPARAM_CNF,
@@ -85,6 +87,7 @@ typedef enum iolink_job_type
    IOLINK_JOB_DS_READY,
    IOLINK_JOB_DS_CHANGE,
    IOLINK_JOB_DS_FAULT,
+   IOLINK_JOB_DS_RELEASE,
    IOLINK_JOB_OD_START,
    IOLINK_JOB_OD_STOP,
    IOLINK_JOB_AL_CONTROL_CNF,
@@ -104,6 +107,8 @@ typedef enum iolink_job_type
    IOLINK_JOB_SMI_DEVICE_READ,
    IOLINK_JOB_SMI_PARAM_READ,
    IOLINK_JOB_SMI_PARAM_WRITE,
+   IOLINK_JOB_SMI_OD_CANCEL,
+   IOLINK_JOB_PI_OUTPUT,
 
    IOLINK_JOB_PERIODIC,
 
@@ -136,6 +141,13 @@ typedef struct iolink_job
          iservice_t qualifier;
       } dl_rw_cnf;
       struct
+      {
+         uint8_t addr;
+         uint8_t len;
+         const uint8_t * data;
+         iolink_status_t stat;
+      } dl_readpage_cnf;
+      struct
       {
          const uint8_t * data;
          uint8_t data_len;
@@ -209,6 +221,10 @@ typedef struct iolink_ode_port iolink_ode_port_t;
 typedef struct iolink_pde_port iolink_pde_port_t;
 typedef struct iolink_pl_port iolink_pl_port_t;
 typedef struct iolink_sm_port iolink_sm_port_t;
+typedef struct iolink_pi iolink_pi_t;
+typedef struct iolink_pdx iolink_pdx_t;
+typedef struct iolink_arena iolink_arena_t;
+typedef struct iolink_startup iolink_startup_t;
 typedef struct iolink_dl iolink_dl_t;
 
 typedef struct iolink_port_info
@@ -270,6 +286,8 @@ uint8_t iolink_get_portnumber (iolink_port_t * port);
 
 uint8_t iolink_get_port_cnt (iolink_port_t * port);
 
+iolink_m_t * iolink_get_master (iolink_port_t * port);
+
 iolink_port_info_t * iolink_get_port_info (iolink_port_t * port);
 
 const iolink_smp_parameterlist_t * iolink_get_paramlist (iolink_port_t * port);
@@ -292,6 +310,11 @@ iolink_ode_port_t * iolink_get_ode_ctx (iolink_port_t * port);
 iolink_pde_port_t * iolink_get_pde_ctx (iolink_port_t * port);
 iolink_pl_port_t * iolink_get_pl_ctx (iolink_port_t * port);
 iolink_sm_port_t * iolink_get_sm_ctx (iolink_port_t * port);
+iolink_pi_t * iolink_get_pi (iolink_port_t * port);
+iolink_pdx_t * iolink_get_pdx (iolink_port_t * port);
+iolink_arena_t * iolink_get_ds_arena (iolink_port_t * port);
+os_mutex_t * iolink_get_ds_mtx (iolink_port_t * port);
+iolink_startup_t * iolink_get_startup (iolink_port_t * port);
 
 #ifdef __cplusplus
 }
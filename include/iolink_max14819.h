@@ -64,7 +64,61 @@ extern "C" {
 #define MAX14819_LPCNFG_LPRT(x)      (((x) & 0x03) << 6)
 #define MAX14819_LPCNFG_LPRT_MASK    MAX14819_LPCNFG_BLA (0x03)
 
+/** Max number of MAX14819 chips on one SPI bus, selected by chip_address */
+#define IOLINK_14819_BUS_MAX_CHIPS 4
+
 typedef struct iolink_14819_drv iolink_14819_drv_t;
+typedef struct iolink_14819_bus iolink_14819_bus_t;
+
+/**
+ * SPI bus statistics
+ */
+typedef struct iolink_14819_bus_stats
+{
+   /** Time covered by the statistics, in microseconds */
+   uint32_t elapsed_us;
+
+   /** Time spent in SPI transfers, in microseconds */
+   uint32_t busy_us;
+
+   /** Bus utilization (busy_us / elapsed_us), in per mille */
+   uint16_t utilization_permille;
+
+   /** Number of register and burst operations */
+   uint32_t operations;
+
+   /** Number of vectored transfers the operations were issued in */
+   uint32_t vectors;
+
+   /** Number of operations completed after their deadline */
+   uint32_t deadline_misses;
+
+   /**
+    * Worst-case time from request to completion of an operation, per chip
+    * address and channel, in microseconds
+    */
+   uint32_t max_latency_us[IOLINK_14819_BUS_MAX_CHIPS][2];
+} iolink_14819_bus_stats_t;
+
+/**
+ * SPI timing profile
+ */
+typedef struct iolink_14819_spi_timing
+{
+   /** SPI clock frequency in Hz, 0 to keep the default of the SPI backend */
+   uint32_t clk_hz;
+
+   /** Delay after each SPI transfer in microseconds, used if clk_hz is set */
+   uint32_t delay_us;
+
+   /**
+    * Characterize the SPI link at startup. The clock is stepped down from
+    * clk_hz (or the max SPI clock of the chip if 0) and the delay stepped up
+    * until reads of the RevID register and TX FIFO write echoes are
+    * reliable. The fastest reliable setting is used.
+    */
+   bool characterize;
+} iolink_14819_spi_timing_t;
 
 /**
  * IO-Link MAX14819 driver configuration
@@ -77,6 +131,18 @@ typedef struct iolink_14819_cfg
    /** Identification of the SPI slave */
    const char * spi_slave_name;
 
+   /**
+    * Optional SPI bus shared with other chips, see iolink_14819_bus_init().
+    * spi_slave_name is not used when set.
+    */
+   iolink_14819_bus_t * bus;
+
+   /**
+    * SPI timing profile. Chips on a shared bus use the same timing, the
+    * slowest timing found by the chips is kept.
+    */
+   iolink_14819_spi_timing_t spi_timing;
+
    /** Initial value of the InterruptEn register */
    uint8_t IntE;
 
@@ -129,6 +195,40 @@ typedef struct iolink_14819_cfg
  */
 iolink_hw_drv_t * iolink_14819_init (const iolink_14819_cfg_t * cfg);
 
+/**
+ * Opens an SPI bus to be shared by several MAX14819 chips.
+ *
+ * The chips on the bus are told apart by their chip_address. Register and
+ * burst operations from all chips and channels on the bus are queued and
+ * issued in order of deadline, back-to-back in vectored transfers.
+ *
+ * @param spi_slave_name  Identification of the SPI slave
+ * @return                Bus handle or NULL on failure.
+ */
+iolink_14819_bus_t * iolink_14819_bus_init (const char * spi_slave_name);
+
+/**
+ * Gets the statistics of an SPI bus.
+ *
+ * @param bus     Bus handle
+ * @param stats   Statistics
+ * @param reset   Restart the statistics after reading them
+ */
+void iolink_14819_bus_get_stats (
+   iolink_14819_bus_t * bus,
+   iolink_14819_bus_stats_t * stats,
+   bool reset);
+
+/**
+ * Gets the SPI timing in use by a driver instance.
+ *
+ * @param drv     Driver handle
+ * @param timing  SPI timing. clk_hz is 0 if the backend default is used.
+ */
+void iolink_14819_get_spi_timing (
+   iolink_hw_drv_t * drv,
+   iolink_14819_spi_timing_t * timing);
+
 /**
  * Interrupt service routine for the iolink_max14819 driver instance.
  *
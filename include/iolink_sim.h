@@ -0,0 +1,233 @@
+/*********************************************************************
+ *        _       _         _
+ *  _ __ | |_  _ | |  __ _ | |__   ___
+ * | '__|| __|(_)| | / _` || '_ \ / __|
+ * | |   | |_  _ | || (_| || |_) |\__ \
+ * |_|    \__|(_)|_| \__,_||_.__/ |___/
+ *
+ * www.rt-labs.com
+ * Copyright 2024 rt-labs AB, Sweden.
+ *
+ * This software is dual-licensed under GPLv3 and a commercial
+ * license. See the file LICENSE.md distributed with this software for
+ * full license information.
+ ********************************************************************/
+
+#ifndef IOLINK_SIM_H
+#define IOLINK_SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "iolink.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief Simulated IO-Link devices
+ *
+ * The simulator is a PL driver that answers the master messages of the
+ * stack with the replies of one virtual IO-Link device per channel, without
+ * any transceiver hardware. It is used in place of the MAX14819 driver, with
+ * the channel number as the port argument:
+ *
+ * @code
+ * iolink_hw_drv_t * drv = iolink_sim_init (&sim_cfg);
+ * port_cfgs[0].drv = drv;
+ * port_cfgs[0].arg = (void *)0;
+ * @endcode
+ *
+ * Each virtual device has a direct parameter page 1, a table of ISDU
+ * indices, a process data input generator and an event memory. Communication
+ * errors and response latency can be injected.
+ *
+ * The simulator uses the same message interface as the MAX14819, so the
+ * stack is built with IOLINK_HW set to IOLINK_HW_MAX14819. Interleaved
+ * M-sequence types (TYPE_1_1) are not supported.
+ */
+
+/** Maximum number of events held by a virtual device */
+#define IOLINK_SIM_MAX_EVENTS 6
+
+/** One ISDU index/subindex served by a virtual device */
+typedef struct iolink_sim_isdu_entry
+{
+   uint16_t index;
+   uint8_t subindex;
+
+   /** Reject ISDU writes with IDX_NOT_ACCESSIBLE */
+   bool read_only;
+
+   /** Current length of the value */
+   uint8_t len;
+
+   /** Capacity of data, longer writes are rejected with VAL_LENOVRRUN */
+   uint8_t size;
+
+   /** Value storage, owned by the application */
+   uint8_t * data;
+} iolink_sim_isdu_entry_t;
+
+/** Error and latency injection */
+typedef struct iolink_sim_faults
+{
+   /** Time from end of master message to reply, in microseconds */
+   uint32_t response_delay_us;
+
+   /** Probability (per mille) that a master message is not answered */
+   uint16_t no_response_permille;
+
+   /** Probability (per mille) that a reply has a checksum error */
+   uint16_t checksum_error_permille;
+
+   /** Number of ISDU polls answered with busy before the response */
+   uint8_t isdu_busy_cycles;
+} iolink_sim_faults_t;
+
+/** Virtual IO-Link device configuration */
+typedef struct iolink_sim_device_cfg
+{
+   /** Device connected to the channel */
+   bool present;
+
+   /** Transmission rate reported after a successful wake-up */
+   iolink_baudrate_t baudrate;
+
+   /**
+    * Direct parameter page 1, indexed by address. MinCycleTime,
+    * M-SequenceCapability, RevisionID, ProcessDataIn, ProcessDataOut,
+    * VendorID, DeviceID and FunctionID are read by the master during
+    * startup.
+    */
+   uint8_t page[16];
+
+   /** ISDU indices, index 0 (direct parameter page 1) is implicit */
+   iolink_sim_isdu_entry_t * isdu;
+   uint16_t isdu_cnt;
+
+   /**
+    * Optional process data input generator, called once per operate cycle.
+    * Without it the value set by iolink_sim_set_pdin() is sent.
+    *
+    * @param arg           User argument
+    * @param pdin          Process data input to fill in
+    * @param len           Process data input length
+    * @return true if the process data is valid, false otherwise
+    */
+   bool (*pdin_gen) (void * arg, uint8_t * pdin, uint8_t len);
+   void * pdin_gen_arg;
+
+   /** Initial error and latency injection */
+   iolink_sim_faults_t faults;
+} iolink_sim_device_cfg_t;
+
+/** Simulator configuration */
+typedef struct iolink_sim_cfg
+{
+   /** Number of channels (virtual devices) */
+   uint8_t channel_cnt;
+
+   /** Device configuration, one per channel */
+   const iolink_sim_device_cfg_t * devices;
+
+   /** Seed for the fault injection random number generator */
+   uint32_t seed;
+} iolink_sim_cfg_t;
+
+/**
+ * Initialise a simulator driver instance.
+ *
+ * @param cfg           Simulator configuration
+ * @return              Driver handle or NULL on failure.
+ */
+iolink_hw_drv_t * iolink_sim_init (const iolink_sim_cfg_t * cfg);
+
+/**
+ * Release a simulator driver instance.
+ *
+ * The ports using the driver must be stopped, i.e. the master must have
+ * been de-initialised, before the driver is released.
+ *
+ * @param drv           Driver handle, set to NULL
+ */
+void iolink_sim_deinit (iolink_hw_drv_t ** drv);
+
+/**
+ * Connect or disconnect the virtual device on a channel.
+ *
+ * A disconnected device stops answering, which the master sees as lost
+ * communication.
+ *
+ * @param drv           Driver handle
+ * @param ch            Channel
+ * @param present       true to connect the device, false to disconnect it
+ */
+void iolink_sim_set_present (iolink_hw_drv_t * drv, uint8_t ch, bool present);
+
+/**
+ * Set the process data input of a virtual device.
+ *
+ * Not used when the device has a pdin_gen function.
+ *
+ * @param drv           Driver handle
+ * @param ch            Channel
+ * @param pdin          Process data input
+ * @param len           Length of pdin
+ * @param valid         Process data input valid
+ */
+void iolink_sim_set_pdin (
+   iolink_hw_drv_t * drv,
+   uint8_t ch,
+   const uint8_t * pdin,
+   uint8_t len,
+   bool valid);
+
+/**
+ * Get the process data output last received by a virtual device.
+ *
+ * @param drv           Driver handle
+ * @param ch            Channel
+ * @param pdout         Buffer of at least IOLINK_PD_MAX_SIZE bytes
+ * @return              Length of the process data output
+ */
+uint8_t iolink_sim_get_pdout (iolink_hw_drv_t * drv, uint8_t ch, uint8_t * pdout);
+
+/**
+ * Add an event to the event memory of a virtual device.
+ *
+ * The event flag is set in the following replies until the master has read
+ * and confirmed the event memory.
+ *
+ * @param drv           Driver handle
+ * @param ch            Channel
+ * @param qualifier     Event qualifier
+ * @param code          Event code
+ * @return IOLINK_ERROR_NONE on success, IOLINK_ERROR_STATE_INVALID if the
+ *         event memory is full
+ */
+iolink_error_t iolink_sim_event_inject (
+   iolink_hw_drv_t * drv,
+   uint8_t ch,
+   uint8_t qualifier,
+   uint16_t code);
+
+/**
+ * Change the error and latency injection of a virtual device.
+ *
+ * @param drv           Driver handle
+ * @param ch            Channel
+ * @param faults        New fault settings
+ */
+void iolink_sim_set_faults (
+   iolink_hw_drv_t * drv,
+   uint8_t ch,
+   const iolink_sim_faults_t * faults);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IOLINK_SIM_H */
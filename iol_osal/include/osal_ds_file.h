@@ -0,0 +1,59 @@
+/*********************************************************************
+ *        _       _         _
+ *  _ __ | |_  _ | |  __ _ | |__   ___
+ * | '__|| __|(_)| | / _` || '_ \ / __|
+ * | |   | |_  _ | || (_| || |_) |\__ \
+ * |_|    \__|(_)|_| \__,_||_.__/ |___/
+ *
+ * www.rt-labs.com
+ * Copyright 2024 rt-labs AB, Sweden.
+ *
+ * This software is dual-licensed under GPLv3 and a commercial
+ * license. See the file LICENSE.md distributed with this software for
+ * full license information.
+ ********************************************************************/
+
+#ifndef OSAL_DS_FILE_H
+#define OSAL_DS_FILE_H
+
+#include <stddef.h> /* size_t */
+#include "iolink.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Open a Data Storage backend keeping the set of each port in a
+ * memory-mapped file, dir/ds_port<portnumber>.bin. Only available on
+ * Linux.
+ *
+ * Each file holds two slots. A set is written to the slot not holding
+ * the latest set and synced to the file before it is used, and each slot
+ * has a CRC-32 over its header and data. A write interrupted by a power
+ * loss leaves the previous set in place.
+ *
+ * Missing files are created. The result is passed to iolink_m_init() in
+ * iolink_m_cfg_t.ds_storage.
+ *
+ * @param dir              Directory of the files
+ * @param port_cnt         Number of ports
+ * @return                 Backend, or NULL on failure
+ */
+const iolink_ds_storage_t * iolink_ds_file_init (
+   const char * dir,
+   uint8_t port_cnt);
+
+/**
+ * Close a backend opened with iolink_ds_file_init(). Call after
+ * iolink_m_deinit().
+ *
+ * @param storage          Backend
+ */
+void iolink_ds_file_deinit (const iolink_ds_storage_t * storage);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSAL_DS_FILE_H */
@@ -30,6 +30,10 @@ typedef void (*isr_func_t) (void *);
  * handler is setup to poll a pre defined pin on the FT2232H chip.
  * @note In USB mode, state of the GPIO pin is polled and isr_func is called
  * when GPIO pin is detected as low.
+ * @note In USB mode with IOLINKMASTER_USB_IRQ_EVENT_ENABLE, the pin is instead
+ * sampled at the end of every SPI transfer, and the FT2232H waits on the IRQ
+ * line in hardware while the bus is idle. The IRQ line must then also be
+ * connected to ADBUS5 (GPIOL1), which is the pin WAIT_ON_IO_LOW monitors.
  *
  * @param gpio_pin  In: The GPIO pin that is connected to the IRQ pin
  * @param isr_func  In: The function that will be called when the interrupt gets
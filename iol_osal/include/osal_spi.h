@@ -18,11 +18,23 @@
 
 #include <sys/types.h> /* size_t */
 #include <inttypes.h>  /* uint32_t */
+#include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * One SPI transfer in a vectored transfer, see
+ * _iolink_pl_hw_spi_transfer_vec().
+ */
+typedef struct iolink_spi_xfer
+{
+   void * data_read;
+   const void * data_written;
+   size_t n_bytes_to_transfer;
+} iolink_spi_xfer_t;
+
 /**
  * Function that opens an SPI channel, initiates it for SPI communication,
  * and returns a file descriptor/handle.
@@ -62,6 +74,26 @@ void * _iolink_pl_hw_spi_init (const char * spi_slave_name);
  */
 void _iolink_pl_hw_spi_close (void * fd);
 
+/**
+ * Sets the SPI clock frequency and the delay after each transfer.
+ *
+ * Until called, the default timing of the backend is used.
+ *
+ * @note On Linux without USB, the default is 4 MHz and 100 us. Frequencies
+ * above the max speed of the spidev device are rejected.
+ * @note In USB mode, the default is 2.5 MHz and no delay. The clock is derived
+ * from 30 MHz, so the actual frequency is the closest one that does not
+ * exceed the requested frequency.
+ * @note Not supported on rt-kernel, where the SPI driver configuration is
+ * used.
+ *
+ * @param fd                  In: File descriptor/handle for the SPI channel
+ * @param clk_hz              In: SPI clock frequency in Hz
+ * @param delay_us            In: Delay after each transfer in microseconds
+ * @return true if the timing was applied, false otherwise
+ */
+bool _iolink_pl_hw_spi_set_timing (void * fd, uint32_t clk_hz, uint32_t delay_us);
+
 /**
  * Reads and writes data from/to an SPI slave device.
  *
@@ -88,6 +120,27 @@ void _iolink_pl_hw_spi_transfer (
    const void * data_written,
    size_t n_bytes_to_transfer);
 
+/**
+ * Performs several SPI transfers back-to-back.
+ *
+ * Each transfer is framed by its own chip select, exactly as if
+ * _iolink_pl_hw_spi_transfer() had been called once per transfer, but the
+ * transfers are handed to the SPI driver in one operation where the
+ * underlying operating system supports it.
+ *
+ * @note On Linux without USB, all transfers are issued in a single
+ * SPI_IOC_MESSAGE ioctl.
+ * @note In USB mode, ftdi_io_mutex is held for the whole vector.
+ *
+ * @param fd                  In: File descriptor/handle for the SPI channel
+ * @param xfers               In/Out: Transfers to perform
+ * @param n_xfers             In: Number of transfers
+ */
+void _iolink_pl_hw_spi_transfer_vec (
+   void * fd,
+   const iolink_spi_xfer_t * xfers,
+   size_t n_xfers);
+
 /* Functions exposed for unit testing */
 uint32_t _iolink_calc_current_transfer_size (
    uint32_t n_bytes_to_transfer,
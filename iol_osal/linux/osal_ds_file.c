@@ -0,0 +1,285 @@
+/*********************************************************************
+ *        _       _         _
+ *  _ __ | |_  _ | |  __ _ | |__   ___
+ * | '__|| __|(_)| | / _` || '_ \ / __|
+ * | |   | |_  _ | || (_| || |_) |\__ \
+ * |_|    \__|(_)|_| \__,_||_.__/ |___/
+ *
+ * www.rt-labs.com
+ * Copyright 2024 rt-labs AB, Sweden.
+ *
+ * This software is dual-licensed under GPLv3 and a commercial
+ * license. See the file LICENSE.md distributed with this software for
+ * full license information.
+ ********************************************************************/
+
+#include "osal_ds_file.h"
+#include "osal_log.h"
+#include "options.h"
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define DS_FILE_MAGIC 0x53444F49 /* "IODS" */
+
+/* One slot of a port file. Host byte order, the file is not meant to be
+ * moved between machines */
+typedef struct ds_file_slot
+{
+   uint32_t magic;
+   uint32_t crc; /* From seq to the end of the header, then size octets */
+   uint32_t seq; /* Incremented for each set stored */
+   uint32_t deviceid;
+   uint32_t cs;
+   uint16_t vendorid;
+   uint16_t functionid;
+   uint16_t size;
+   uint16_t reserved;
+   uint8_t data[IOLINK_DS_MAX_SIZE];
+} ds_file_slot_t;
+
+#define DS_FILE_LEN (2 * sizeof (ds_file_slot_t))
+
+typedef struct ds_file
+{
+   iolink_ds_storage_t storage;
+   uint8_t port_cnt;
+   ds_file_slot_t * slots[IOLINK_NUM_PORTS]; /* Two per port */
+} ds_file_t;
+
+static uint32_t ds_file_crc32 (uint32_t crc, const uint8_t * p, size_t len)
+{
+   uint8_t bit;
+
+   crc = ~crc;
+   while (len--)
+   {
+      crc ^= *p++;
+      for (bit = 0; bit < 8; bit++)
+      {
+         crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+      }
+   }
+
+   return ~crc;
+}
+
+static uint32_t ds_file_slot_crc (const ds_file_slot_t * slot)
+{
+   const uint8_t * hdr = (const uint8_t *)&slot->seq;
+   size_t hdr_len      = offsetof (ds_file_slot_t, data) -
+                         offsetof (ds_file_slot_t, seq);
+   uint32_t crc        = ds_file_crc32 (0, hdr, hdr_len);
+
+   return ds_file_crc32 (crc, slot->data, slot->size);
+}
+
+static bool ds_file_slot_valid (const ds_file_slot_t * slot)
+{
+   return (slot->magic == DS_FILE_MAGIC) &&
+          (slot->size <= IOLINK_DS_MAX_SIZE) &&
+          (slot->crc == ds_file_slot_crc (slot));
+}
+
+/* Slot holding the latest valid set, -1 if none */
+static int ds_file_latest (const ds_file_slot_t * slots)
+{
+   int latest = -1;
+   int i;
+
+   for (i = 0; i < 2; i++)
+   {
+      if (
+         ds_file_slot_valid (&slots[i]) &&
+         ((latest < 0) || ((int32_t)(slots[i].seq - slots[latest].seq) > 0)))
+      {
+         latest = i;
+      }
+   }
+
+   return latest;
+}
+
+static ds_file_slot_t * ds_file_port (ds_file_t * file, uint8_t portnumber)
+{
+   if ((portnumber == 0) || (portnumber > file->port_cnt))
+   {
+      return NULL;
+   }
+
+   return file->slots[portnumber - 1];
+}
+
+static bool ds_file_load (
+   void * arg,
+   uint8_t portnumber,
+   iolink_ds_record_t * record)
+{
+   ds_file_slot_t * slots = ds_file_port (arg, portnumber);
+   const ds_file_slot_t * slot;
+   int latest;
+
+   if (slots == NULL)
+   {
+      return false;
+   }
+
+   latest = ds_file_latest (slots);
+   if (latest < 0)
+   {
+      return false;
+   }
+
+   slot               = &slots[latest];
+   record->vendorid   = slot->vendorid;
+   record->deviceid   = slot->deviceid;
+   record->functionid = slot->functionid;
+   record->cs         = slot->cs;
+   record->size       = slot->size;
+   memcpy (record->data, slot->data, slot->size);
+
+   return true;
+}
+
+static bool ds_file_store (
+   void * arg,
+   uint8_t portnumber,
+   const iolink_ds_record_t * record)
+{
+   ds_file_slot_t * slots = ds_file_port (arg, portnumber);
+   ds_file_slot_t * slot;
+   int latest;
+
+   if ((slots == NULL) || (record->size > IOLINK_DS_MAX_SIZE))
+   {
+      return false;
+   }
+
+   /* Never overwrite the latest set */
+   latest = ds_file_latest (slots);
+   slot   = &slots[(latest == 0) ? 1 : 0];
+
+   slot->magic      = 0;
+   slot->seq        = (latest < 0) ? 1 : slots[latest].seq + 1;
+   slot->deviceid   = record->deviceid;
+   slot->cs         = record->cs;
+   slot->vendorid   = record->vendorid;
+   slot->functionid = record->functionid;
+   slot->size       = record->size;
+   slot->reserved   = 0;
+   memcpy (slot->data, record->data, record->size);
+   slot->crc   = ds_file_slot_crc (slot);
+   slot->magic = DS_FILE_MAGIC;
+
+   if (msync (slots, DS_FILE_LEN, MS_SYNC) != 0)
+   {
+      LOG_ERROR (
+         IOLINK_DS_LOG,
+         "%s: port %u: sync failed\n",
+         __func__,
+         portnumber);
+      return false;
+   }
+
+   return true;
+}
+
+static void ds_file_erase (void * arg, uint8_t portnumber)
+{
+   ds_file_slot_t * slots = ds_file_port (arg, portnumber);
+
+   if (slots == NULL)
+   {
+      return;
+   }
+
+   slots[0].magic = 0;
+   slots[1].magic = 0;
+   msync (slots, DS_FILE_LEN, MS_SYNC);
+}
+
+static ds_file_slot_t * ds_file_map (const char * dir, uint8_t portnumber)
+{
+   char path[256];
+   void * map;
+   int fd;
+
+   snprintf (path, sizeof (path), "%s/ds_port%u.bin", dir, portnumber);
+
+   fd = open (path, O_RDWR | O_CREAT, 0644);
+   if (fd == -1)
+   {
+      LOG_ERROR (IOLINK_DS_LOG, "%s: failed to open %s\n", __func__, path);
+      return NULL;
+   }
+
+   /* A new file reads as zeros, no valid slot */
+   if (ftruncate (fd, DS_FILE_LEN) != 0)
+   {
+      close (fd);
+      return NULL;
+   }
+
+   map = mmap (NULL, DS_FILE_LEN, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   close (fd);
+
+   return (map == MAP_FAILED) ? NULL : map;
+}
+
+const iolink_ds_storage_t * iolink_ds_file_init (
+   const char * dir,
+   uint8_t port_cnt)
+{
+   ds_file_t * file;
+   uint8_t i;
+
+   if (port_cnt > IOLINK_NUM_PORTS)
+   {
+      return NULL;
+   }
+
+   file = calloc (1, sizeof (ds_file_t));
+   if (file == NULL)
+   {
+      return NULL;
+   }
+
+   file->storage.arg   = file;
+   file->storage.load  = ds_file_load;
+   file->storage.store = ds_file_store;
+   file->storage.erase = ds_file_erase;
+   file->port_cnt      = port_cnt;
+
+   for (i = 0; i < port_cnt; i++)
+   {
+      file->slots[i] = ds_file_map (dir, i + 1);
+      if (file->slots[i] == NULL)
+      {
+         iolink_ds_file_deinit (&file->storage);
+         return NULL;
+      }
+   }
+
+   return &file->storage;
+}
+
+void iolink_ds_file_deinit (const iolink_ds_storage_t * storage)
+{
+   ds_file_t * file = storage->arg;
+   uint8_t i;
+
+   for (i = 0; i < file->port_cnt; i++)
+   {
+      if (file->slots[i] != NULL)
+      {
+         munmap (file->slots[i], DS_FILE_LEN);
+      }
+   }
+
+   free (file);
+}
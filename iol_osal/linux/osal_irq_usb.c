@@ -11,6 +11,8 @@
 
 #define IRQ_BIT               (1 << 4)
 #define IRQ_THREAD_SLEEP_TIME 500
+#define IRQ_IDLE_TIMEOUT_MS   1
+#define IRQ_WAIT_TIMEOUT_MS   2
 #define RX_BUFFER_SIZE        1
 #define TX_BUFFER_SIZE        2
 #define THREAD_STACK_SIZE     128
@@ -28,6 +30,7 @@ typedef struct
    void * irq_arg;
 } usb_irq_thread_t;
 
+#ifndef IOLINKMASTER_USB_IRQ_EVENT_ENABLE
 /**
  * This function returns the state of the IRQ pin by sending a read command
  * to the FTDI chip which returns the state of the lowbyte pins (ADBUS0 -
@@ -110,6 +113,58 @@ static void irq_thread (void * arg)
       os_usleep (IRQ_THREAD_SLEEP_TIME);
    }
 }
+#else
+/**
+ * Event driven variant of the IRQ thread.
+ *
+ * Every SPI batch samples the IRQ pin when releasing CS, and sets
+ * FTDI_IRQ_EVENT_ASSERTED in ftdi_irq_event if it is low. The thread sleeps on
+ * that event, so an interrupt raised while the bus is busy is handled without
+ * any extra USB round trip.
+ *
+ * When the bus has been idle for IRQ_IDLE_TIMEOUT_MS, the MPSSE engine is told
+ * to wait for the IRQ line in hardware (WAIT_ON_IO_LOW) for at most
+ * IRQ_WAIT_TIMEOUT_MS, which bounds the extra latency seen by other SPI
+ * users. The thread keeps waiting in hardware for as long as the bus is idle,
+ * so an idle master costs one USB round trip per IRQ_WAIT_TIMEOUT_MS instead
+ * of one per read of the pin.
+ *
+ * @param arg  In: Pointer to the usb_irq_thread_t structure containing thread
+ * parameter
+ */
+static void irq_thread (void * arg)
+{
+   usb_irq_thread_t * irq = (usb_irq_thread_t *)arg;
+   bool irq_flag          = false;
+   uint32_t value;
+
+   while (1)
+   {
+      if (!os_event_wait (
+             ftdi_irq_event,
+             FTDI_IRQ_EVENT_ASSERTED,
+             &value,
+             IRQ_IDLE_TIMEOUT_MS))
+      {
+         /* IRQ was seen at the end of an SPI batch */
+         os_event_clr (ftdi_irq_event, FTDI_IRQ_EVENT_ASSERTED);
+         irq_flag = true;
+      }
+      else
+      {
+         os_mutex_lock (ftdi_io_mutex);
+         irq_flag =
+            _iolink_spi_usb_wait_irq_low (irq->fthandle, IRQ_WAIT_TIMEOUT_MS);
+         os_mutex_unlock (ftdi_io_mutex);
+      }
+
+      if (irq_flag)
+      {
+         irq->isr_func (irq->irq_arg);
+      }
+   }
+}
+#endif /* IOLINKMASTER_USB_IRQ_EVENT_ENABLE */
 
 int _iolink_setup_int (int gpio_pin, isr_func_t isr_func, void * irq_arg)
 {
@@ -5,21 +5,78 @@
 #include "options.h"
 #include "fcntl.h"
 #include "unistd.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Max number of transfers in one SPI_IOC_MESSAGE */
+#define IOLINK_SPI_MAX_XFERS 16
+
+/* Default timing, until changed by _iolink_pl_hw_spi_set_timing() */
+#define IOLINK_SPI_DEFAULT_SPEED_HZ (4 * 1000 * 1000)
+#define IOLINK_SPI_DEFAULT_DELAY_US 100
+
+typedef struct iolink_spidev
+{
+   int fd;
+   uint32_t max_speed_hz; /* 0 if not known */
+   uint32_t speed_hz;
+   uint16_t delay_us;
+} iolink_spidev_t;
 
 void * _iolink_pl_hw_spi_init (const char * spi_slave_name)
 {
+   iolink_spidev_t * spi;
    int fd = -1;
    fd     = open (spi_slave_name, O_RDWR);
    if (fd == -1)
    {
       return NULL;
    }
-   return (void *)fd;
+
+   spi = calloc (1, sizeof (iolink_spidev_t));
+   if (spi == NULL)
+   {
+      close (fd);
+      return NULL;
+   }
+
+   spi->fd       = fd;
+   spi->speed_hz = IOLINK_SPI_DEFAULT_SPEED_HZ;
+   spi->delay_us = IOLINK_SPI_DEFAULT_DELAY_US;
+
+   /* Faster transfers would be silently clamped by the driver */
+   if (ioctl (fd, SPI_IOC_RD_MAX_SPEED_HZ, &spi->max_speed_hz) < 0)
+   {
+      spi->max_speed_hz = 0;
+   }
+   return spi;
 }
 
 void _iolink_pl_hw_spi_close (void * fd)
 {
-   close ((int)fd);
+   iolink_spidev_t * spi = fd;
+
+   close (spi->fd);
+   free (spi);
+}
+
+bool _iolink_pl_hw_spi_set_timing (void * fd, uint32_t clk_hz, uint32_t delay_us)
+{
+   iolink_spidev_t * spi = fd;
+
+   if ((clk_hz == 0) || (delay_us > UINT16_MAX))
+   {
+      return false;
+   }
+
+   if ((spi->max_speed_hz != 0) && (clk_hz > spi->max_speed_hz))
+   {
+      return false;
+   }
+
+   spi->speed_hz = clk_hz;
+   spi->delay_us = delay_us;
+   return true;
 }
 
 void _iolink_pl_hw_spi_transfer (
@@ -28,23 +85,57 @@ void _iolink_pl_hw_spi_transfer (
    const void * data_written,
    size_t n_bytes_to_transfer)
 {
-   int spi_fd = (int)fd;
-   // TODO
-   int delay = 100;
-   int speed = 4 * 1000 * 1000;
-   int bits  = 8;
+   iolink_spidev_t * spi = fd;
+   int bits              = 8;
 
    struct spi_ioc_transfer tr = {
       .tx_buf        = (unsigned long)data_written,
       .rx_buf        = (unsigned long)data_read,
       .len           = n_bytes_to_transfer,
-      .delay_usecs   = delay,
-      .speed_hz      = speed,
+      .delay_usecs   = spi->delay_us,
+      .speed_hz      = spi->speed_hz,
       .bits_per_word = bits,
    };
 
-   if (ioctl (spi_fd, SPI_IOC_MESSAGE (1), &tr) < 1)
+   if (ioctl (spi->fd, SPI_IOC_MESSAGE (1), &tr) < 1)
    {
       LOG_ERROR (IOLINK_PL_LOG, "%s: failed to send SPI message\n", __func__);
    }
 }
+
+void _iolink_pl_hw_spi_transfer_vec (
+   void * fd,
+   const iolink_spi_xfer_t * xfers,
+   size_t n_xfers)
+{
+   iolink_spidev_t * spi = fd;
+   int bits              = 8;
+   struct spi_ioc_transfer tr[IOLINK_SPI_MAX_XFERS];
+   size_t i;
+
+   while (n_xfers > 0)
+   {
+      size_t n = (n_xfers < IOLINK_SPI_MAX_XFERS) ? n_xfers : IOLINK_SPI_MAX_XFERS;
+
+      memset (tr, 0, sizeof (tr));
+      for (i = 0; i < n; i++)
+      {
+         tr[i].tx_buf        = (unsigned long)xfers[i].data_written;
+         tr[i].rx_buf        = (unsigned long)xfers[i].data_read;
+         tr[i].len           = xfers[i].n_bytes_to_transfer;
+         tr[i].delay_usecs   = spi->delay_us;
+         tr[i].speed_hz      = spi->speed_hz;
+         tr[i].bits_per_word = bits;
+         /* Release chip select between the transfers */
+         tr[i].cs_change = (i + 1 < n) ? 1 : 0;
+      }
+
+      if (ioctl (spi->fd, SPI_IOC_MESSAGE (n), tr) < 1)
+      {
+         LOG_ERROR (IOLINK_PL_LOG, "%s: failed to send SPI message\n", __func__);
+      }
+
+      xfers += n;
+      n_xfers -= n;
+   }
+}
@@ -22,6 +22,9 @@
 #define MPSSE_CMD_SET_DATA_BITS_LOWBYTE          0x80
 #define MPSSE_CMD_DISABLE_3PHASE_CLOCKING        0x8D
 #define MPSSE_CMD_DATA_BYTES_IN_POS_OUT_NEG_EDGE 0x31
+#define MPSSE_CMD_GET_DATA_BITS_LOWBYTE          0x81
+#define MPSSE_CMD_SEND_IMMEDIATE                 0x87
+#define MPSSE_CMD_WAIT_ON_IO_LOW                 0x89
 #define ENABLE_MPSSE                             0x02
 #define MAX_CLOCK_RATE                           30000000
 #define DISABLE_ADAPTIVE_CLOCKING                0x97
@@ -32,8 +35,47 @@
 #define SET_GPIO_CMD                             0x80
 #define SET_VALS                                 0x0A
 #define SET_DIRECTION                            0x0B
+#define RESET_BIT_MODE                           0x00
+#define IRQ_BIT                                  (1 << 4)
+#define CS_HIGH_AND_SAMPLE_BUFF_SIZE             5
+#define WAIT_IRQ_BUFF_SIZE                       3
+#define MAX_FTDI_HANDLES                         2
+
+/* SPI timing of an open FTDI device, see _iolink_pl_hw_spi_set_timing() */
+typedef struct
+{
+   void * ftdi_handle;
+   uint32_t clk_freq;
+   uint32_t delay_us;
+} ftdi_timing_t;
 
 os_mutex_t * ftdi_io_mutex;
+static ftdi_timing_t ftdi_timing[MAX_FTDI_HANDLES];
+#ifdef IOLINKMASTER_USB_IRQ_EVENT_ENABLE
+os_event_t * ftdi_irq_event;
+#endif
+
+/**
+ * Get the SPI timing of an FTDI device.
+ *
+ * @param ftdi_handle   In: A handle to the FTDI device, or NULL for a free
+ *                          entry.
+ * @return The timing of the device, or NULL if not found
+ */
+static ftdi_timing_t * get_timing (void * ftdi_handle)
+{
+   int i;
+
+   for (i = 0; i < MAX_FTDI_HANDLES; i++)
+   {
+      if (ftdi_timing[i].ftdi_handle == ftdi_handle)
+      {
+         return &ftdi_timing[i];
+      }
+   }
+
+   return NULL;
+}
 
 /**
  * Set the Chip Select (CS) pin on the FT2232H chip.
@@ -73,6 +115,91 @@ static void set_cs_pin (void * ftdi_handle, bool state)
    }
 }
 
+#ifdef IOLINKMASTER_USB_IRQ_EVENT_ENABLE
+/**
+ * Raise the Chip Select (CS) pin and sample the IRQ pin in the same USB
+ * transaction.
+ *
+ * The IRQ pin (ADBUS4) is read back with GET_DATA_BITS_LOWBYTE right after CS
+ * goes high, so every SPI batch also tells whether the MAX14819 has an
+ * interrupt pending. If it has, FTDI_IRQ_EVENT_ASSERTED is set in
+ * ftdi_irq_event, which wakes up the IRQ thread without it having to poll.
+ *
+ * @param ftdi_handle   In: A handle to the FTDI device.
+ */
+static void release_cs_and_sample_irq (void * ftdi_handle)
+{
+   uint32_t status                           = 0;
+   uint8_t buf[CS_HIGH_AND_SAMPLE_BUFF_SIZE] = {};
+   uint8_t rx_buf                            = 0;
+   uint32_t n_bytes_transferred              = 0;
+
+   buf[0] = MPSSE_CMD_SET_DATA_BITS_LOWBYTE;
+   buf[1] = SET_CS_HIGH;
+   buf[2] = SET_DIRECTION;
+   buf[3] = MPSSE_CMD_GET_DATA_BITS_LOWBYTE;
+   buf[4] = MPSSE_CMD_SEND_IMMEDIATE;
+
+   status = FT_Write (
+      ftdi_handle,
+      buf,
+      CS_HIGH_AND_SAMPLE_BUFF_SIZE,
+      &n_bytes_transferred);
+   if (status != FT_OK)
+   {
+      LOG_ERROR (LOG_STATE_ON, "APP: %s: Failed to set_cs_pin\n", __func__);
+      return;
+   }
+
+   n_bytes_transferred = 0;
+   status = FT_Read (ftdi_handle, &rx_buf, 1, &n_bytes_transferred);
+   if ((status != FT_OK) || (n_bytes_transferred != 1))
+   {
+      LOG_ERROR (LOG_STATE_ON, "APP: %s: Failed to sample IRQ pin\n", __func__);
+      return;
+   }
+
+   /* IRQ pin is active low */
+   if ((rx_buf & IRQ_BIT) == 0)
+   {
+      os_event_set (ftdi_irq_event, FTDI_IRQ_EVENT_ASSERTED);
+   }
+}
+#endif /* IOLINKMASTER_USB_IRQ_EVENT_ENABLE */
+
+/**
+ * Set the MPSSE clock frequency.
+ *
+ * @param ftdi_handle   In: A handle to the FTDI device.
+ * @param clk_freq      In: The clock frequency, with a maximum value of
+ *                          30,000,000.
+ * @return 0 for success; otherwise, check the FT_STATUS enum in ftd2xx.h for
+ * state values.
+ */
+static uint32_t set_clock (void * ftdi_handle, uint32_t clk_freq)
+{
+   uint8_t tx_buf[CLOCK_SETTINGS_BUFF_SIZE] = {};
+   uint32_t status                          = 0;
+   uint32_t n_bytes_written                 = 0;
+   uint32_t val                             = 0;
+
+   /* Round the divisor up, the clock must not exceed clk_freq */
+   val       = ((MAX_CLOCK_RATE + clk_freq - 1) / clk_freq) - 1;
+   tx_buf[0] = DISABLE_CLOCK_DIVIDE;
+   tx_buf[1] = SET_CLOCK_FREQUENCY_CMD;
+   tx_buf[2] = (uint8_t)val;
+   tx_buf[3] = (uint8_t)(val >> 8);
+   /*Send command to set clock frequency*/
+   status =
+      FT_Write (ftdi_handle, tx_buf, CLOCK_SETTINGS_BUFF_SIZE, &n_bytes_written);
+   if (status != FT_OK)
+   {
+      LOG_ERROR (LOG_STATE_ON, "APP: %s: Failed to set clock frequency\n", __func__);
+   }
+
+   return status;
+}
+
 /**
  * Configures the FT2232H chip for MPSSE mode, setting timeouts, latency, flow
  * control, and clock frequency.
@@ -89,12 +216,7 @@ static void set_cs_pin (void * ftdi_handle, bool state)
  */
 static uint32_t cfg_ftdi_prt (void * ftdi_handle, uint32_t clk_freq)
 {
-   uint8_t tx_buf[CLOCK_SETTINGS_BUFF_SIZE] = {};
-   uint8_t val_L                            = 0;
-   uint8_t val_H                            = 0;
-   uint32_t status                          = 0;
-   uint32_t n_bytes_written                 = 0;
-   uint32_t val                             = 0;
+   uint32_t status = 0;
 
    status = FT_ResetDevice (ftdi_handle);
    if (status != FT_OK)
@@ -138,23 +260,7 @@ static uint32_t cfg_ftdi_prt (void * ftdi_handle, uint32_t clk_freq)
       return status;
    }
 
-   val       = (MAX_CLOCK_RATE / clk_freq) - 1;
-   val_L     = (uint8_t)val;
-   val_H     = (uint8_t)(val >> 8);
-   tx_buf[0] = DISABLE_CLOCK_DIVIDE;
-   tx_buf[1] = SET_CLOCK_FREQUENCY_CMD;
-   tx_buf[2] = val_L;
-   tx_buf[3] = val_H;
-   /*Send command to set clock frequency*/
-   status =
-      FT_Write (ftdi_handle, tx_buf, CLOCK_SETTINGS_BUFF_SIZE, &n_bytes_written);
-   if (status != FT_OK)
-   {
-      LOG_ERROR (LOG_STATE_ON, "APP: %s: Failed to set clock frequency\n", __func__);
-      return status;
-   }
-
-   return status;
+   return set_clock (ftdi_handle, clk_freq);
 }
 
 /**
@@ -205,8 +311,17 @@ void * _iolink_pl_hw_spi_init (const char * spi_slave_name)
 {
    ftdi_io_mutex = os_mutex_create();
    void * ftdi_handle;
+   ftdi_timing_t * timing;
    uint32_t status = 0;
 
+   timing = get_timing (NULL);
+   if (timing == NULL)
+   {
+      LOG_ERROR (IOLINK_APP_LOG, "APP: %s: Too many devices\n", __func__);
+      os_mutex_destroy (ftdi_io_mutex);
+      return NULL;
+   }
+
    /* TODO: This function supports opening multiple devices by setting
       deviceNumber to 0, 1, etc. However, it does not provide the capability to
       open a specific device by name. For opening named devices, consider using
@@ -236,20 +351,63 @@ void * _iolink_pl_hw_spi_init (const char * spi_slave_name)
       return NULL;
    }
 
+#ifdef IOLINKMASTER_USB_IRQ_EVENT_ENABLE
+   ftdi_irq_event = os_event_create();
+#endif
+
+   timing->ftdi_handle = ftdi_handle;
+   timing->clk_freq    = CLK_FREQUENCY;
+   timing->delay_us    = 0;
+
    return ftdi_handle;
 }
 
 void _iolink_pl_hw_spi_close (void * ftdi_handle)
 {
+   ftdi_timing_t * timing = get_timing (ftdi_handle);
+
+   if (timing != NULL)
+   {
+      timing->ftdi_handle = NULL;
+   }
+
    if (FT_Close (ftdi_handle) != FT_OK)
    {
       LOG_ERROR (LOG_STATE_ON, "APP: %s: Failed to close handle\n", __func__);
       return;
    }
 
+#ifdef IOLINKMASTER_USB_IRQ_EVENT_ENABLE
+   os_event_destroy (ftdi_irq_event);
+#endif
    os_mutex_destroy (ftdi_io_mutex);
 }
 
+bool _iolink_pl_hw_spi_set_timing (
+   void * ftdi_handle,
+   uint32_t clk_hz,
+   uint32_t delay_us)
+{
+   ftdi_timing_t * timing = get_timing (ftdi_handle);
+   uint32_t status;
+
+   if ((timing == NULL) || (clk_hz == 0) || (clk_hz > MAX_CLOCK_RATE))
+   {
+      return false;
+   }
+
+   os_mutex_lock (ftdi_io_mutex);
+   status = set_clock (ftdi_handle, clk_hz);
+   if (status == FT_OK)
+   {
+      timing->clk_freq = clk_hz;
+      timing->delay_us = delay_us;
+   }
+   os_mutex_unlock (ftdi_io_mutex);
+
+   return (status == FT_OK);
+}
+
 void _iolink_pl_hw_spi_transfer (
    void * ftdi_handle,
    void * data_read,
@@ -262,6 +420,7 @@ void _iolink_pl_hw_spi_transfer (
    uint32_t current_transfer_size = 0;
    uint32_t n_bytes_transferred   = 0;
    uint32_t n_bytes_read          = 0;
+   ftdi_timing_t * timing         = get_timing (ftdi_handle);
 
    os_mutex_lock (ftdi_io_mutex);
    set_cs_pin (ftdi_handle, TRUE);
@@ -324,7 +483,91 @@ void _iolink_pl_hw_spi_transfer (
 
       n_bytes_transferred += n_bytes_read;
    }
+#ifdef IOLINKMASTER_USB_IRQ_EVENT_ENABLE
+   release_cs_and_sample_irq (ftdi_handle);
+#else
    set_cs_pin (ftdi_handle, FALSE);
+#endif
+   if ((timing != NULL) && (timing->delay_us > 0))
+   {
+      os_usleep (timing->delay_us);
+   }
    os_mutex_unlock (ftdi_io_mutex);
    return;
 }
+
+void _iolink_pl_hw_spi_transfer_vec (
+   void * ftdi_handle,
+   const iolink_spi_xfer_t * xfers,
+   size_t n_xfers)
+{
+   size_t i;
+
+   /* ftdi_io_mutex is recursive, keep other users off the bus between
+    * the transfers */
+   os_mutex_lock (ftdi_io_mutex);
+   for (i = 0; i < n_xfers; i++)
+   {
+      _iolink_pl_hw_spi_transfer (
+         ftdi_handle,
+         xfers[i].data_read,
+         xfers[i].data_written,
+         xfers[i].n_bytes_to_transfer);
+   }
+   os_mutex_unlock (ftdi_io_mutex);
+}
+
+#ifdef IOLINKMASTER_USB_IRQ_EVENT_ENABLE
+bool _iolink_spi_usb_wait_irq_low (void * ftdi_handle, uint32_t timeout_ms)
+{
+   uint32_t status                    = 0;
+   uint8_t tx_buf[WAIT_IRQ_BUFF_SIZE] = {};
+   uint8_t rx_buf                     = 0;
+   uint32_t n_bytes_transferred       = 0;
+   ftdi_timing_t * timing             = get_timing (ftdi_handle);
+
+   tx_buf[0] = MPSSE_CMD_WAIT_ON_IO_LOW;
+   tx_buf[1] = MPSSE_CMD_GET_DATA_BITS_LOWBYTE;
+   tx_buf[2] = MPSSE_CMD_SEND_IMMEDIATE;
+
+   status = FT_SetTimeouts (ftdi_handle, timeout_ms, WRITE_TIMEOUT_MS);
+   if (status != FT_OK)
+   {
+      LOG_ERROR (
+         LOG_STATE_ON,
+         "%s: FT_SetTimeouts failed: %d\n",
+         __func__,
+         status);
+      return false;
+   }
+
+   status =
+      FT_Write (ftdi_handle, tx_buf, WAIT_IRQ_BUFF_SIZE, &n_bytes_transferred);
+   if (status == FT_OK)
+   {
+      n_bytes_transferred = 0;
+      status = FT_Read (ftdi_handle, &rx_buf, 1, &n_bytes_transferred);
+   }
+
+   if ((status != FT_OK) || (n_bytes_transferred != 1))
+   {
+      /* The MPSSE engine is still waiting on the pin, and will not execute
+         any further commands until it goes low. Restart it. */
+      FT_SetBitMode (ftdi_handle, 0x00, RESET_BIT_MODE);
+      FT_SetBitMode (ftdi_handle, 0x00, ENABLE_MPSSE);
+      FT_Purge (ftdi_handle, FT_PURGE_RX | FT_PURGE_TX);
+      /* Restore the clock set by _iolink_pl_hw_spi_set_timing() */
+      set_clock (
+         ftdi_handle,
+         (timing != NULL) ? timing->clk_freq : CLK_FREQUENCY);
+      mpsse_setup (ftdi_handle);
+      FT_SetTimeouts (ftdi_handle, READ_TIMEOUT_MS, WRITE_TIMEOUT_MS);
+      return false;
+   }
+
+   FT_SetTimeouts (ftdi_handle, READ_TIMEOUT_MS, WRITE_TIMEOUT_MS);
+
+   /* IRQ pin is active low */
+   return (rx_buf & IRQ_BIT) == 0;
+}
+#endif /* IOLINKMASTER_USB_IRQ_EVENT_ENABLE */
@@ -11,6 +11,32 @@ extern "C" {
  * the FTDI chip.*/
 extern os_mutex_t * ftdi_io_mutex;
 
+#ifdef IOLINKMASTER_USB_IRQ_EVENT_ENABLE
+/* Event flag set by _iolink_pl_hw_spi_transfer() when the IRQ pin (ADBUS4),
+ * sampled at the end of an SPI batch, is found low. */
+#define FTDI_IRQ_EVENT_ASSERTED BIT (0)
+
+extern os_event_t * ftdi_irq_event;
+
+/**
+ * Let the MPSSE engine wait for the IRQ line to go low.
+ *
+ * Issues WAIT_ON_IO_LOW followed by a read of the lowbyte pins. The MPSSE
+ * wait command only monitors GPIOL1 (ADBUS5), so the IRQ line must be routed
+ * to ADBUS5 as well as to ADBUS4 when this mode is used.
+ *
+ * If the line does not go low within timeout_ms the MPSSE engine is
+ * restarted to abandon the pending wait.
+ *
+ * Must be called with ftdi_io_mutex held.
+ *
+ * @param ftdi_handle   In: A handle to the FTDI device.
+ * @param timeout_ms    In: Maximum time to block the bus, in milliseconds.
+ * @return true if the IRQ line went low, false on timeout or error
+ */
+bool _iolink_spi_usb_wait_irq_low (void * ftdi_handle, uint32_t timeout_ms);
+#endif /* IOLINKMASTER_USB_IRQ_EVENT_ENABLE */
+
 #ifdef __cplusplus
 }
 #endif
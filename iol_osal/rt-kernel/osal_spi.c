@@ -18,6 +18,12 @@ void _iolink_pl_hw_spi_close (void * fd)
    close ((int)fd);
 }
 
+bool _iolink_pl_hw_spi_set_timing (void * fd, uint32_t clk_hz, uint32_t delay_us)
+{
+   /* Timing is given by the SPI driver configuration */
+   return false;
+}
+
 void _iolink_pl_hw_spi_transfer (
    void * fd,
    void * data_read,
@@ -28,3 +34,20 @@ void _iolink_pl_hw_spi_transfer (
    spi_bidirectionally_transfer ((int)fd, data_read, data_written, n_bytes_to_transfer);
    spi_unselect ((int)fd);
 }
+
+void _iolink_pl_hw_spi_transfer_vec (
+   void * fd,
+   const iolink_spi_xfer_t * xfers,
+   size_t n_xfers)
+{
+   size_t i;
+
+   for (i = 0; i < n_xfers; i++)
+   {
+      _iolink_pl_hw_spi_transfer (
+         fd,
+         xfers[i].data_read,
+         xfers[i].data_written,
+         xfers[i].n_bytes_to_transfer);
+   }
+}
@@ -23,6 +23,7 @@
 #define DL_PDOutputGet_req         mock_DL_PDOutputGet_req
 #define DL_PDOutputUpdate_req      mock_DL_PDOutputUpdate_req
 #define AL_Event_ind               mock_AL_Event_ind
+#define DS_Upload                  mock_DS_Upload
 #define AL_Control_ind             mock_AL_Control_ind
 #define AL_NewInput_ind            mock_AL_NewInput_ind
 #define iolink_post_job            mock_iolink_post_job
@@ -34,6 +35,7 @@
 #include "iolink_ds.h" /* DS_Upload */
 #include "iolink_dl.h" /* DL_ReadParam_req, DL_WriteParam_req, DL_ISDUTransport_req, DL_Control_req, DL_EventConf_req, DL_PDOutputUpdate_req DL_PDOutputGet_req */
 #include "iolink_pde.h"  /* AL_Control_ind, AL_NewInput_ind */
+#include "iolink_pi.h"   /* iolink_pi_update_pdin */
 #include "iolink_main.h" /* iolink_fetch_avail_job, iolink_post_job, iolink_post_job_pd_event, iolink_get_portnumber */
 
 #include "osal_log.h"
@@ -311,6 +313,26 @@ static iolink_smi_errortypes_t al_status_to_errortype (
    return errortype;
 }
 
+/* Confirm the ongoing read and the reads that joined it */
+static void al_od_read_cnf (
+   iolink_port_t * port,
+   uint8_t len,
+   const uint8_t * data,
+   iolink_smi_errortypes_t errortype)
+{
+   iolink_al_port_t * al = iolink_get_al_ctx (port);
+   uint8_t joined_cnt    = al->service.joined_cnt;
+   uint8_t i;
+
+   al->service.joined_cnt = 0;
+   al->service.al_read_cnf_cb (port, len, data, errortype);
+
+   for (i = 0; i < joined_cnt; i++)
+   {
+      al->service.al_read_joined_cb[i] (port, len, data, errortype);
+   }
+}
+
 static iolink_fsm_al_od_event_t al_od_busy (
    iolink_port_t * port,
    iolink_fsm_al_od_event_t event)
@@ -321,6 +343,18 @@ static iolink_fsm_al_od_event_t al_od_busy (
    switch (job->type)
    {
    case IOLINK_JOB_AL_READ_REQ:
+      if (
+         (al->service.direction == IOLINK_RWDIRECTION_READ) &&
+         (al->service.index == job->al_read_req.index) &&
+         (al->service.subindex == job->al_read_req.subindex) &&
+         (al->service.joined_cnt < IOLINK_AL_OD_JOIN_MAX))
+      {
+         /* Same read ongoing, share its result */
+         al->service.al_read_joined_cb[al->service.joined_cnt++] =
+            job->al_read_req.al_read_cb;
+         break;
+      }
+
       job->al_read_req.al_read_cb (
          port,
          0,
@@ -421,7 +455,7 @@ static iolink_fsm_al_od_event_t al_od_send_al_cnf (
       /* Prepare negative AL service confirmation */
       if (al->service.direction == IOLINK_RWDIRECTION_READ)
       {
-         al->service.al_read_cnf_cb (port, 0, NULL, errortype);
+         al_od_read_cnf (port, 0, NULL, errortype);
       }
       else if (al->service.direction == IOLINK_RWDIRECTION_WRITE)
       {
@@ -430,7 +464,7 @@ static iolink_fsm_al_od_event_t al_od_send_al_cnf (
       break;
    case AL_OD_EVENT_readparam_cnf: /* T13 + T16 */
       errortype = al_err_to_errortype (al, false);
-      al->service.al_read_cnf_cb (
+      al_od_read_cnf (
          port,
          al->service.data_len,
          al->service.data_read,
@@ -442,7 +476,7 @@ static iolink_fsm_al_od_event_t al_od_send_al_cnf (
 
       if (al->service.direction == IOLINK_RWDIRECTION_READ)
       {
-         al->service.al_read_cnf_cb (
+         al_od_read_cnf (
             port,
             al->service.data_len,
             al->service.data_read,
@@ -699,15 +733,61 @@ static iolink_fsm_al_event_event_t al_event_wait_read (
    return AL_EVENT_EVENT_NONE;
 }
 
+/* Queue events for the application, dropping the oldest when full */
+static void al_event_queue (
+   iolink_al_port_t * al,
+   uint8_t event_cnt,
+   const diag_entry_t * events)
+{
+   uint8_t i;
+
+   os_mutex_lock (al->event_ring.mtx);
+   for (i = 0; i < event_cnt; i++)
+   {
+      uint8_t tail = (al->event_ring.head + al->event_ring.cnt) %
+                     IOLINK_EVENT_RING_SIZE;
+
+      al->event_ring.entries[tail] = events[i];
+      if (al->event_ring.cnt < IOLINK_EVENT_RING_SIZE)
+      {
+         al->event_ring.cnt++;
+      }
+      else
+      {
+         al->event_ring.head = (al->event_ring.head + 1) %
+                               IOLINK_EVENT_RING_SIZE;
+         al->event_ring.dropped++;
+      }
+   }
+   os_mutex_unlock (al->event_ring.mtx);
+}
+
 static iolink_fsm_al_event_event_t al_event_du_handle (
    iolink_port_t * port,
    iolink_fsm_al_event_event_t event)
 {
    iolink_al_port_t * al = iolink_get_al_ctx (port);
+   bool ds_upload        = false;
+   uint8_t i;
+
+   al_event_queue (al, al->event.event_cnt, al->event.events);
+
+   for (i = 0; i < al->event.event_cnt; i++)
+   {
+      ds_upload |= (al->event.events[i].event_code ==
+                    IOLINK_EVENTCODE_DEV_DS_UPLOAD_REQ);
+   }
+
+   if (ds_upload)
+   {
+      /* Runs as a job of its own, the other events are still reported */
+      DS_Upload (port);
+   }
 
    AL_Event_ind (port, al->event.event_cnt, al->event.events);
-   /* Now wait for diagnosis unit to acknowledge, with AL_Event_rsp() */
-   return AL_EVENT_EVENT_NONE;
+
+   /* The events are queued, no need to wait for AL_Event_rsp() */
+   return AL_EVENT_EVENT_al_event_rsp;
 }
 
 static iolink_fsm_al_event_event_t al_event_idle (
@@ -749,6 +829,8 @@ static const iolink_fsm_al_event_transition_t al_event_trans_s0[] = {
     al_event_du_handle}, /* T3 + T5 */
    {AL_EVENT_EVENT_al_event_req, AL_EVENT_STATE_Event_idle, al_event_idle}, /* T7
                                                                              */
+   /* Events are already confirmed, ignore a late AL_Event_rsp() */
+   {AL_EVENT_EVENT_al_event_rsp, AL_EVENT_STATE_Event_idle, al_event_wait_read},
 };
 
 static const iolink_fsm_al_event_transition_t al_event_trans_s1[] = {
@@ -759,6 +841,9 @@ static const iolink_fsm_al_event_transition_t al_event_trans_s1[] = {
    {AL_EVENT_EVENT_dl_event_ind_done,
     AL_EVENT_STATE_DU_Event_handling,
     al_event_du_handle}, /* T5 */
+   {AL_EVENT_EVENT_al_event_rsp,
+    AL_EVENT_STATE_Read_Event_Set,
+    al_event_wait_read},
 };
 
 static const iolink_fsm_al_event_transition_t al_event_trans_s2[] = {
@@ -953,9 +1038,29 @@ void iolink_al_init (iolink_port_t * port)
    iolink_al_port_t * al = iolink_get_al_ctx (port);
 
    memset (al, 0, sizeof (iolink_al_port_t));
-   al->mtx_pdin    = os_mutex_create();
-   al->od_state    = AL_OD_STATE_OnReq_Idle;
-   al->event_state = AL_EVENT_STATE_Event_idle;
+   al->mtx_pdin       = os_mutex_create();
+   al->diag.mtx       = os_mutex_create();
+   iolink_seqlock_init (&al->pdin_seq, al->mtx_pdin);
+   iolink_seqlock_init (&al->diag.seq, al->diag.mtx);
+   al->event_ring.mtx = os_mutex_create();
+   al->od_state       = AL_OD_STATE_OnReq_Idle;
+   al->event_state    = AL_EVENT_STATE_Event_idle;
+}
+
+void iolink_al_set_pd_filter (
+   iolink_port_t * port,
+   const iolink_pd_filter_t * filter)
+{
+   iolink_al_port_t * al = iolink_get_al_ctx (port);
+
+   os_mutex_lock (al->mtx_pdin);
+   al->pdin_filter.enabled  = (filter != NULL);
+   al->pdin_filter.notified = false;
+   if (filter != NULL)
+   {
+      al->pdin_filter.filter = *filter;
+   }
+   os_mutex_unlock (al->mtx_pdin);
 }
 
 iolink_error_t AL_Read_req (
@@ -1019,14 +1124,34 @@ iolink_error_t AL_Control_req (iolink_port_t * port, iolink_controlcode_t contro
    return DL_Control_req (port, controlcode);
 }
 
+/* Copy the PD input, normally without taking mtx_pdin */
+static uint8_t al_read_pdin (
+   iolink_al_port_t * al,
+   uint8_t * data,
+   uint32_t * time_us)
+{
+   iolink_seqlock_read_t read = {0};
+   uint8_t len;
+
+   do
+   {
+      iolink_seqlock_read_begin (&al->pdin_seq, &read);
+      len = al->pdin_data_len;
+      memcpy (data, al->pdin_data, len);
+      if (time_us != NULL)
+      {
+         *time_us = al->pdin_time_us;
+      }
+   } while (iolink_seqlock_read_retry (&al->pdin_seq, &read));
+
+   return len;
+}
+
 iolink_error_t AL_GetInput_req (iolink_port_t * port, uint8_t * len, uint8_t * data)
 {
    iolink_al_port_t * al = iolink_get_al_ctx (port);
 
-   os_mutex_lock (al->mtx_pdin);
-   *len = al->pdin_data_len;
-   memcpy (data, al->pdin_data, *len);
-   os_mutex_unlock (al->mtx_pdin);
+   *len = al_read_pdin (al, data, NULL);
 
    return IOLINK_ERROR_NONE;
 }
@@ -1038,13 +1163,9 @@ iolink_error_t AL_GetInputOutput_req (
 {
    iolink_al_port_t * al = iolink_get_al_ctx (port);
 
-   os_mutex_lock (al->mtx_pdin);
-   /* PDIn data length */
-   uint8_t pdin_len = al->pdin_data_len;
+   /* PDIn data length, PDIn_data[0] */
+   uint8_t pdin_len = al_read_pdin (al, &data[1], NULL);
    data[0]          = pdin_len;
-   /* PDIn_data[0] */
-   uint8_t * pdin_data = &data[1];
-   memcpy (pdin_data, al->pdin_data, pdin_len);
    /* PDOut data length */
    uint8_t * pdout_len = &data[pdin_len + 1];
    /* PDOut_data[0] */
@@ -1056,11 +1177,152 @@ iolink_error_t AL_GetInputOutput_req (
    {
       *len = 1 + pdin_len + 1 + *pdout_len;
    }
-   os_mutex_unlock (al->mtx_pdin);
 
    return error;
 }
 
+iolink_error_t AL_GetPD_req (iolink_port_t * port, iolink_pd_t * pd)
+{
+   iolink_al_port_t * al          = iolink_get_al_ctx (port);
+   iolink_port_info_t * port_info = iolink_get_port_info (port);
+
+   pd->pdin_len = al_read_pdin (al, pd->pdin, &pd->pdin_time_us);
+   pd->pqi = (port_info->port_quality_info & IOLINK_PORT_QUALITY_INFO_INVALID)
+                ? IOLINK_PORT_QUALIFIER_INFO_PQ_INVALID
+                : IOLINK_PORT_QUALIFIER_INFO_PQ_VALID;
+
+   return DL_PDOutputGet_req (port, &pd->pdout_len, pd->pdout);
+}
+
+static void al_diag_remove (iolink_al_port_t * al, uint8_t i)
+{
+   memmove (
+      &al->diag.entries[i],
+      &al->diag.entries[i + 1],
+      (al->diag.cnt - i - 1) * sizeof (diag_entry_t));
+   al->diag.cnt--;
+}
+
+/* EventQualifier MODE and the remaining bits: TYPE, SOURCE and INSTANCE */
+#define AL_EVENT_MODE(qualifier) ((iolink_event_mode_t)((qualifier) >> 6))
+#define AL_EVENT_ID_MASK         0x3F
+
+/* Update the diagnosis entries with an event from the device */
+static void al_diag_event (
+   iolink_al_port_t * al,
+   uint16_t eventcode,
+   uint8_t event_qualifier)
+{
+   iolink_event_mode_t mode = AL_EVENT_MODE (event_qualifier);
+   bool add                 = (mode == IOLINK_EVENT_MODE_SINGLE_SHOT);
+   uint8_t i;
+
+   os_mutex_lock (al->diag.mtx);
+   iolink_seqlock_write_begin (&al->diag.seq);
+
+   if (
+      (mode == IOLINK_EVENT_MODE_APPEARS) ||
+      (mode == IOLINK_EVENT_MODE_DISAPPEARS))
+   {
+      /* Appeared entry of the same event, if any */
+      for (i = 0; i < al->diag.cnt; i++)
+      {
+         const diag_entry_t * entry = &al->diag.entries[i];
+
+         if (
+            (entry->event_code == eventcode) &&
+            (AL_EVENT_MODE (entry->event_qualifier) ==
+             IOLINK_EVENT_MODE_APPEARS) &&
+            ((entry->event_qualifier & AL_EVENT_ID_MASK) ==
+             (event_qualifier & AL_EVENT_ID_MASK)))
+         {
+            break;
+         }
+      }
+
+      if (mode == IOLINK_EVENT_MODE_APPEARS)
+      {
+         add = (i == al->diag.cnt);
+      }
+      else if (i < al->diag.cnt)
+      {
+         al_diag_remove (al, i);
+      }
+   }
+
+   if (add)
+   {
+      if (al->diag.cnt == IOLINK_NUM_DIAG_ENTRIES)
+      {
+         al_diag_remove (al, 0);
+      }
+      al->diag.entries[al->diag.cnt].event_code      = eventcode;
+      al->diag.entries[al->diag.cnt].event_qualifier = event_qualifier;
+      al->diag.cnt++;
+   }
+
+   iolink_seqlock_write_end (&al->diag.seq);
+   os_mutex_unlock (al->diag.mtx);
+}
+
+uint8_t iolink_al_diag_read (
+   iolink_port_t * port,
+   diag_entry_t * entries,
+   uint8_t max)
+{
+   iolink_al_port_t * al      = iolink_get_al_ctx (port);
+   iolink_seqlock_read_t read = {0};
+   uint8_t cnt;
+
+   do
+   {
+      iolink_seqlock_read_begin (&al->diag.seq, &read);
+      cnt = (al->diag.cnt < max) ? al->diag.cnt : max;
+      memcpy (entries, al->diag.entries, cnt * sizeof (diag_entry_t));
+   } while (iolink_seqlock_read_retry (&al->diag.seq, &read));
+
+   return cnt;
+}
+
+void iolink_al_diag_clear (iolink_port_t * port)
+{
+   iolink_al_port_t * al = iolink_get_al_ctx (port);
+
+   os_mutex_lock (al->diag.mtx);
+   iolink_seqlock_write_begin (&al->diag.seq);
+   al->diag.cnt = 0;
+   iolink_seqlock_write_end (&al->diag.seq);
+   os_mutex_unlock (al->diag.mtx);
+}
+
+uint8_t iolink_al_event_read (
+   iolink_port_t * port,
+   diag_entry_t * entries,
+   uint8_t max,
+   uint32_t * dropped)
+{
+   iolink_al_port_t * al = iolink_get_al_ctx (port);
+   uint8_t cnt;
+   uint8_t i;
+
+   os_mutex_lock (al->event_ring.mtx);
+   cnt = (al->event_ring.cnt < max) ? al->event_ring.cnt : max;
+   for (i = 0; i < cnt; i++)
+   {
+      entries[i]          = al->event_ring.entries[al->event_ring.head];
+      al->event_ring.head = (al->event_ring.head + 1) % IOLINK_EVENT_RING_SIZE;
+   }
+   al->event_ring.cnt -= cnt;
+   if (dropped != NULL)
+   {
+      *dropped = al->event_ring.dropped;
+   }
+   al->event_ring.dropped = 0;
+   os_mutex_unlock (al->event_ring.mtx);
+
+   return cnt;
+}
+
 void DL_Event_ind (
    iolink_port_t * port,
    uint16_t eventcode,
@@ -1068,6 +1330,9 @@ void DL_Event_ind (
    uint8_t eventsleft)
 {
    iolink_job_t * job                      = iolink_fetch_avail_job (port);
+
+   al_diag_event (iolink_get_al_ctx (port), eventcode, event_qualifier);
+
    job->dl_event_ind.eventsleft            = eventsleft;
    job->dl_event_ind.event.event_code      = eventcode;
    job->dl_event_ind.event.event_qualifier = event_qualifier;
@@ -1083,6 +1348,17 @@ void DL_Control_ind (iolink_port_t * port, iolink_controlcode_t controlcode)
 {
    // TODO check why this is called frequently
    iolink_job_t * job              = iolink_fetch_avail_job (port);
+
+   if (controlcode == IOLINK_CONTROLCODE_INVALID)
+   {
+      iolink_al_port_t * al = iolink_get_al_ctx (port);
+
+      /* Notify the first PD input once valid again */
+      os_mutex_lock (al->mtx_pdin);
+      al->pdin_filter.notified = false;
+      os_mutex_unlock (al->mtx_pdin);
+   }
+
    job->dl_control_ind.controlcode = controlcode;
 
    iolink_post_job_with_type_and_callback (
@@ -1184,18 +1460,129 @@ void DL_ISDUTransport_cnf (
       al_dl_isdu_transport_cnf_cb);
 }
 
+static uint32_t al_pd_field_value (
+   const iolink_pd_filter_field_t * field,
+   const uint8_t * data)
+{
+   uint32_t value = 0;
+   uint8_t i;
+
+   /* PD is transferred MSB first */
+   for (i = 0; i < field->len; i++)
+   {
+      value = (value << 8) | data[field->offset + i];
+   }
+
+   if (
+      field->is_signed && (field->len < 4) &&
+      (value & BIT (8 * field->len - 1)))
+   {
+      value |= ~0U << (8 * field->len);
+   }
+
+   return value;
+}
+
+/* Check if PD input should be notified. Called with mtx_pdin held */
+static bool al_pd_filter_match (
+   iolink_al_port_t * al,
+   const uint8_t * data,
+   uint8_t length,
+   uint32_t now)
+{
+   const iolink_pd_filter_t * filter = &al->pdin_filter.filter;
+   const uint8_t * last              = al->pdin_filter.data;
+   uint8_t i;
+
+   if (
+      !al->pdin_filter.enabled || !al->pdin_filter.notified ||
+      (length != al->pdin_filter.data_len))
+   {
+      return true;
+   }
+
+   if (
+      (filter->heartbeat_ms > 0) &&
+      ((now - al->pdin_filter.time_us) / 1000 >= filter->heartbeat_ms))
+   {
+      return true;
+   }
+
+   for (i = 0; i < length; i++)
+   {
+      if ((data[i] ^ last[i]) & filter->mask[i])
+      {
+         return true;
+      }
+   }
+
+   for (i = 0; i < IOLINK_PD_FILTER_FIELDS; i++)
+   {
+      const iolink_pd_filter_field_t * field = &filter->fields[i];
+      uint32_t value;
+      uint32_t last_value;
+      uint32_t delta;
+
+      if ((field->len == 0) || (field->offset + field->len > length))
+      {
+         continue;
+      }
+
+      value      = al_pd_field_value (field, data);
+      last_value = al_pd_field_value (field, last);
+
+      if (field->is_signed)
+      {
+         int64_t diff = (int64_t)(int32_t)value - (int32_t)last_value;
+
+         delta = (diff < 0) ? (uint32_t)-diff : (uint32_t)diff;
+      }
+      else
+      {
+         delta = (value > last_value) ? value - last_value : last_value - value;
+      }
+
+      if (delta > field->deadband)
+      {
+         return true;
+      }
+   }
+
+   return false;
+}
+
 void DL_PDInputTransport_ind (iolink_port_t * port, uint8_t * pdin_data, uint8_t length)
 {
    iolink_al_port_t * al = iolink_get_al_ctx (port);
+   uint32_t now          = os_get_current_time_us();
+   bool notify;
 
    CC_ASSERT (length <= IOLINK_PD_MAX_SIZE);
 
+   iolink_pi_update_pdin (port, pdin_data, length);
+
    os_mutex_lock (al->mtx_pdin);
+   iolink_seqlock_write_begin (&al->pdin_seq);
    memcpy (al->pdin_data, pdin_data, length);
    al->pdin_data_len = length;
-   iolink_post_job_pd_event (port, 100, length, pdin_data);
+   al->pdin_time_us  = now;
+   iolink_seqlock_write_end (&al->pdin_seq);
+
+   notify = al_pd_filter_match (al, pdin_data, length, now);
+   if (notify)
+   {
+      memcpy (al->pdin_filter.data, pdin_data, length);
+      al->pdin_filter.data_len = length;
+      al->pdin_filter.time_us  = now;
+      al->pdin_filter.notified = true;
+      iolink_post_job_pd_event (port, 100, length, pdin_data);
+   }
    os_mutex_unlock (al->mtx_pdin);
-   AL_NewInput_ind (port);
+
+   if (notify)
+   {
+      AL_NewInput_ind (port);
+   }
 }
 
 #ifndef UNIT_TEST
@@ -1206,22 +1593,9 @@ __attribute__ ((weak)) void AL_Event_ind (
    diag_entry_t events[6])
 {
    arg_block_devevent_t arg_block_devevent;
-   uint8_t i;
 
    LOG_DEBUG (IOLINK_AL_LOG, "Got eventcnt = %u\n", event_cnt);
 
-   AL_Event_rsp (port);
-
-   for (i = 0; i < 6; i++)
-   {
-      if (events[i].event_code == IOLINK_EVENTCODE_DEV_DS_UPLOAD_REQ)
-      {
-         DS_Upload (port);
-         // TODO report the remaining events
-         return;
-      }
-   }
-
    memset (&arg_block_devevent, 0, sizeof (arg_block_devevent_t));
    arg_block_devevent.arg_block.id = IOLINK_ARG_BLOCK_ID_DEV_EVENT;
    if (event_cnt > 6)
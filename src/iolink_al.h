@@ -24,6 +24,7 @@
 
 #include "iolink_main.h" /* iolink_job_t */
 #include "iolink.h"
+#include "iolink_seqlock.h"
 #include "iolink_types.h"
 #include "options.h" /* IOLINK_MAX_EVENTS */
 #include "osal.h"
@@ -32,6 +33,9 @@
 extern "C" {
 #endif
 
+/* Max number of reads joining an ongoing read of the same index */
+#define IOLINK_AL_OD_JOIN_MAX 4
+
 typedef enum iolink_al_od_state
 {
    AL_OD_STATE_OnReq_Idle = 0,
@@ -55,9 +59,24 @@ typedef struct iolink_al_port
    iolink_al_od_state_t od_state;
    iolink_al_event_state_t event_state;
 
+   /* Written with mtx_pdin held, readers copy them under pdin_seq */
    uint8_t pdin_data[IOLINK_PD_MAX_SIZE];
    uint8_t pdin_data_len;
+   uint32_t pdin_time_us;
+   iolink_seqlock_t pdin_seq;
    os_mutex_t * mtx_pdin;
+
+   /* PD input change filter, protected by mtx_pdin */
+   struct
+   {
+      bool enabled;
+      iolink_pd_filter_t filter;
+      /* PD input at the last notification */
+      bool notified;
+      uint8_t data[IOLINK_PD_MAX_SIZE];
+      uint8_t data_len;
+      uint32_t time_us;
+   } pdin_filter;
    struct
    {
       uint16_t index;
@@ -80,6 +99,14 @@ typedef struct iolink_al_port
             iolink_port_t * port,
             iolink_smi_errortypes_t errortype);
       };
+      /* Reads of the same index and subindex requested while busy, confirmed
+       * with the result of the ongoing read */
+      uint8_t joined_cnt;
+      void (*al_read_joined_cb[IOLINK_AL_OD_JOIN_MAX]) (
+         iolink_port_t * port,
+         uint8_t len,
+         const uint8_t * data,
+         iolink_smi_errortypes_t errortype);
    } service;
 
    struct
@@ -87,6 +114,26 @@ typedef struct iolink_al_port
       uint8_t event_cnt;
       diag_entry_t events[IOLINK_MAX_EVENTS];
    } event;
+
+   /* Events not yet read by the application, protected by mtx */
+   struct
+   {
+      diag_entry_t entries[IOLINK_EVENT_RING_SIZE];
+      uint8_t head; /* Oldest event */
+      uint8_t cnt;
+      uint32_t dropped;
+      os_mutex_t * mtx;
+   } event_ring;
+
+   /* Diagnosis entries, oldest first. Written with mtx held, readers copy
+    * them under seq */
+   struct
+   {
+      diag_entry_t entries[IOLINK_NUM_DIAG_ENTRIES];
+      uint8_t cnt;
+      iolink_seqlock_t seq;
+      os_mutex_t * mtx;
+   } diag;
 } iolink_al_port_t;
 
 /**
@@ -155,6 +202,7 @@ iolink_error_t AL_GetInputOutput_req (
    iolink_port_t * port,
    uint8_t * len,
    uint8_t * data);
+iolink_error_t AL_GetPD_req (iolink_port_t * port, iolink_pd_t * pd);
 void DL_Event_ind (
    iolink_port_t * port,
    uint16_t eventcode,
@@ -181,6 +229,19 @@ iolink_error_t AL_Abort (iolink_port_t * port);
 iolink_error_t AL_Event_rsp (iolink_port_t * port);
 
 void iolink_al_init (iolink_port_t * port);
+void iolink_al_set_pd_filter (
+   iolink_port_t * port,
+   const iolink_pd_filter_t * filter);
+uint8_t iolink_al_diag_read (
+   iolink_port_t * port,
+   diag_entry_t * entries,
+   uint8_t max);
+void iolink_al_diag_clear (iolink_port_t * port);
+uint8_t iolink_al_event_read (
+   iolink_port_t * port,
+   diag_entry_t * entries,
+   uint8_t max,
+   uint32_t * dropped);
 
 #ifdef UNIT_TEST
 // TODO: A more logical location for this function is in iolink_main, but for
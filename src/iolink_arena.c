@@ -0,0 +1,231 @@
+/*********************************************************************
+ *        _       _         _
+ *  _ __ | |_  _ | |  __ _ | |__   ___
+ * | '__|| __|(_)| | / _` || '_ \ / __|
+ * | |   | |_  _ | || (_| || |_) |\__ \
+ * |_|    \__|(_)|_| \__,_||_.__/ |___/
+ *
+ * www.rt-labs.com
+ * Copyright 2024 rt-labs AB, Sweden.
+ *
+ * This software is dual-licensed under GPLv3 and a commercial
+ * license. See the file LICENSE.md distributed with this software for
+ * full license information.
+ ********************************************************************/
+
+#include "iolink_arena.h"
+
+#include <stdlib.h> /* malloc */
+#include <string.h>
+
+/**
+ * @file
+ * @brief Fixed-size memory arena
+ *
+ */
+
+/* Header of each block. The blocks follow each other from the start of
+ * the arena to its end. */
+typedef struct arena_blk
+{
+   uint32_t size; /* Octets, header included */
+   uint32_t used;
+} arena_blk_t;
+
+static_assert (sizeof (arena_blk_t) == IOLINK_ARENA_HDR_LEN, "");
+
+static inline arena_blk_t * arena_blk (iolink_arena_t * arena, uint32_t pos)
+{
+   return (arena_blk_t *)&arena->mem[pos];
+}
+
+static inline uint32_t arena_pos (iolink_arena_t * arena, arena_blk_t * blk)
+{
+   return (uint8_t *)blk - arena->mem;
+}
+
+/* Merge the free blocks following blk into it */
+static void arena_merge_next (iolink_arena_t * arena, arena_blk_t * blk)
+{
+   uint32_t next = arena_pos (arena, blk) + blk->size;
+
+   while ((next < arena->size) && !arena_blk (arena, next)->used)
+   {
+      blk->size += arena_blk (arena, next)->size;
+      next += arena_blk (arena, next)->size;
+   }
+}
+
+/* Give the octets after the first size octets of blk to a new free block,
+ * unless too few for a block */
+static void arena_split (arena_blk_t * blk, uint32_t size)
+{
+   if (blk->size - size >= IOLINK_ARENA_BLOCK_SIZE (1))
+   {
+      arena_blk_t * rest = (arena_blk_t *)((uint8_t *)blk + size);
+
+      rest->size = blk->size - size;
+      rest->used = 0;
+      blk->size  = size;
+   }
+}
+
+static void arena_mark_used (iolink_arena_t * arena, arena_blk_t * blk)
+{
+   blk->used = 1;
+   arena->used += blk->size;
+   if (arena->used > arena->peak)
+   {
+      arena->peak = arena->used;
+   }
+}
+
+bool iolink_arena_init (iolink_arena_t * arena, void * mem, uint32_t size)
+{
+   arena_blk_t * blk;
+
+   memset (arena, 0, sizeof (*arena));
+
+   size &= ~(IOLINK_ARENA_ALIGN - 1);
+   if (size < IOLINK_ARENA_BLOCK_SIZE (1))
+   {
+      return false;
+   }
+
+   if (mem == NULL)
+   {
+      mem = malloc (size);
+      if (mem == NULL)
+      {
+         return false;
+      }
+      arena->owned = true;
+   }
+
+   arena->mem  = mem;
+   arena->size = size;
+   arena->mtx  = os_mutex_create();
+
+   blk       = arena_blk (arena, 0);
+   blk->size = size;
+   blk->used = 0;
+
+   return true;
+}
+
+void iolink_arena_deinit (iolink_arena_t * arena)
+{
+   if (arena->mem != NULL)
+   {
+      os_mutex_destroy (arena->mtx);
+      if (arena->owned)
+      {
+         free (arena->mem);
+      }
+   }
+
+   memset (arena, 0, sizeof (*arena));
+}
+
+void * iolink_arena_alloc (iolink_arena_t * arena, uint32_t len)
+{
+   uint32_t size = IOLINK_ARENA_BLOCK_SIZE (len);
+   void * p      = NULL;
+   uint32_t pos  = 0;
+
+   if ((len == 0) || (arena->mem == NULL) || (len > arena->size))
+   {
+      return NULL;
+   }
+
+   os_mutex_lock (arena->mtx);
+   while (pos < arena->size)
+   {
+      arena_blk_t * blk = arena_blk (arena, pos);
+
+      if (!blk->used)
+      {
+         arena_merge_next (arena, blk);
+         if (blk->size >= size)
+         {
+            arena_split (blk, size);
+            arena_mark_used (arena, blk);
+            p = blk + 1;
+            break;
+         }
+      }
+
+      pos += blk->size;
+   }
+   os_mutex_unlock (arena->mtx);
+
+   return p;
+}
+
+void iolink_arena_free (iolink_arena_t * arena, void * p)
+{
+   arena_blk_t * blk;
+
+   if (p == NULL)
+   {
+      return;
+   }
+
+   blk = (arena_blk_t *)p - 1;
+   CC_ASSERT (blk->used);
+
+   os_mutex_lock (arena->mtx);
+   blk->used = 0;
+   arena->used -= blk->size;
+   arena_merge_next (arena, blk);
+   os_mutex_unlock (arena->mtx);
+}
+
+void * iolink_arena_realloc (iolink_arena_t * arena, void * p, uint32_t len)
+{
+   uint32_t size = IOLINK_ARENA_BLOCK_SIZE (len);
+   arena_blk_t * blk;
+   uint32_t old_len;
+   void * q;
+
+   if (p == NULL)
+   {
+      return iolink_arena_alloc (arena, len);
+   }
+
+   if (len == 0)
+   {
+      iolink_arena_free (arena, p);
+      return NULL;
+   }
+
+   blk     = (arena_blk_t *)p - 1;
+   old_len = blk->size - IOLINK_ARENA_HDR_LEN;
+
+   /* Shrink, or grow into the free blocks that follow */
+   os_mutex_lock (arena->mtx);
+   arena->used -= blk->size;
+   blk->used = 0;
+   arena_merge_next (arena, blk);
+   if (blk->size >= size)
+   {
+      arena_split (blk, size);
+      arena_mark_used (arena, blk);
+      os_mutex_unlock (arena->mtx);
+      return p;
+   }
+
+   /* Give back what was merged */
+   arena_split (blk, IOLINK_ARENA_BLOCK_SIZE (old_len));
+   arena_mark_used (arena, blk);
+   os_mutex_unlock (arena->mtx);
+
+   q = iolink_arena_alloc (arena, len);
+   if (q != NULL)
+   {
+      memcpy (q, p, old_len);
+      iolink_arena_free (arena, p);
+   }
+
+   return q;
+}
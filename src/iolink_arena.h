@@ -0,0 +1,110 @@
+/*********************************************************************
+ *        _       _         _
+ *  _ __ | |_  _ | |  __ _ | |__   ___
+ * | '__|| __|(_)| | / _` || '_ \ / __|
+ * | |   | |_  _ | || (_| || |_) |\__ \
+ * |_|    \__|(_)|_| \__,_||_.__/ |___/
+ *
+ * www.rt-labs.com
+ * Copyright 2024 rt-labs AB, Sweden.
+ *
+ * This software is dual-licensed under GPLv3 and a commercial
+ * license. See the file LICENSE.md distributed with this software for
+ * full license information.
+ ********************************************************************/
+
+/**
+ * @file
+ * @brief Fixed-size memory arena
+ *
+ * First-fit allocator over one memory area, used for buffers that are
+ * sized at runtime, e.g. the Data Storage sets of the ports. Blocks never
+ * move unless reallocated, and free neighbours are merged. Allocation and
+ * free are serialised by a mutex.
+ */
+
+#ifndef IOLINK_ARENA_H
+#define IOLINK_ARENA_H
+
+#include "iolink_main.h"
+#include "osal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Alignment of allocated blocks */
+#define IOLINK_ARENA_ALIGN 8
+
+/** Octets of the block header preceding each allocation */
+#define IOLINK_ARENA_HDR_LEN 8
+
+/** Arena octets used by an allocation of len octets */
+#define IOLINK_ARENA_BLOCK_SIZE(len)                                           \
+   (((len) + IOLINK_ARENA_HDR_LEN + IOLINK_ARENA_ALIGN - 1) &                  \
+    ~(IOLINK_ARENA_ALIGN - 1))
+
+struct iolink_arena
+{
+   uint8_t * mem;
+   uint32_t size;
+   bool owned; /* mem allocated by iolink_arena_init() */
+   os_mutex_t * mtx;
+
+   uint32_t used; /* Octets in allocated blocks, headers included */
+   uint32_t peak;
+};
+
+/**
+ * Initialise an arena.
+ *
+ * @param arena         Arena
+ * @param mem           Memory of the arena, aligned to IOLINK_ARENA_ALIGN,
+ *                      or NULL to allocate it
+ * @param size          Size of the arena
+ * @return true on success, false if out of memory
+ */
+bool iolink_arena_init (iolink_arena_t * arena, void * mem, uint32_t size);
+
+/**
+ * Release an arena. All blocks are freed.
+ *
+ * @param arena         Arena
+ */
+void iolink_arena_deinit (iolink_arena_t * arena);
+
+/**
+ * Allocate a block.
+ *
+ * @param arena         Arena
+ * @param len           Length of the block
+ * @return The block, or NULL if len is 0 or there is no room
+ */
+void * iolink_arena_alloc (iolink_arena_t * arena, uint32_t len);
+
+/**
+ * Free a block.
+ *
+ * @param arena         Arena
+ * @param p             Block, or NULL
+ */
+void iolink_arena_free (iolink_arena_t * arena, void * p);
+
+/**
+ * Resize a block, keeping its content up to the smaller of the two
+ * lengths. The block is resized in place if possible, otherwise it is
+ * moved.
+ *
+ * @param arena         Arena
+ * @param p             Block, or NULL to allocate a new block
+ * @param len           New length, or 0 to free the block
+ * @return The block, or NULL if there is no room, in which case p is not
+ *         changed
+ */
+void * iolink_arena_realloc (iolink_arena_t * arena, void * p, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IOLINK_ARENA_H */
@@ -21,6 +21,7 @@
 #define SM_Operate                 mock_SM_Operate
 #define SM_SetPortConfig_req       mock_SM_SetPortConfig_req
 #define DS_Delete                  mock_DS_Delete
+#define DS_Release                 mock_DS_Release
 #define DS_Startup                 mock_DS_Startup
 #define OD_Start                   mock_OD_Start
 #define OD_Stop                    mock_OD_Stop
@@ -32,13 +33,12 @@
 #endif /* UNIT_TEST */
 
 #include "iolink_cm.h"
-#include "iolink_ds.h"  /* DS_Delete DS_Startup DS_Chk_Cfg DS_Init */
-#include "iolink_ode.h" /* OD_Start, OD_Stop */
-#include "iolink_pde.h" /* PD_Start, PD_Stop */
-#include "iolink_sm.h"  /* SM_Operate, SM_SetPortConfig_req */
-#ifdef UNIT_TEST
-#include "iolink_al.h"
-#endif
+#include "iolink_al.h"      /* iolink_al_diag_clear, iolink_al_diag_read */
+#include "iolink_ds.h"      /* DS_Delete DS_Startup DS_Chk_Cfg DS_Init */
+#include "iolink_ode.h"     /* OD_Start, OD_Stop */
+#include "iolink_pde.h"     /* PD_Start, PD_Stop */
+#include "iolink_sm.h"      /* SM_Operate, SM_SetPortConfig_req */
+#include "iolink_startup.h" /* iolink_startup_phase_ind */
 
 #include "osal_log.h"
 
@@ -272,6 +272,8 @@ static iolink_fsm_cm_event_t cm_startup (
       DS_Delete (port);
    }
 
+   iolink_al_diag_clear (port);
+
    set_port_config (port, true);
 
    return CM_EVENT_NONE;
@@ -293,6 +295,7 @@ static iolink_fsm_cm_event_t cm_dido (
    }
 
    DS_Delete (port);
+   iolink_al_diag_clear (port);
 
    port_info->revisionid        = 0;
    port_info->transmission_rate = 0;
@@ -627,6 +630,7 @@ static iolink_fsm_cm_event_t cm_deactivate (
       port,
       IOLINK_PORT_STATUS_INFO_DEACTIVATED,
       IOLINK_PORT_QUALITY_INFO_INVALID);
+   iolink_al_diag_clear (port);
 
    memset (&paraml, 0, sizeof (iolink_smp_parameterlist_t));
    paraml.mode = portmode_to_target_mode (cfg_list->portmode);
@@ -639,6 +643,7 @@ static iolink_fsm_cm_event_t cm_deactivate (
        */
       DS_Delete (port);
    }
+   DS_Release (port);
    SM_SetPortConfig_req (port, &paraml);
 
    return CM_EVENT_NONE;
@@ -743,6 +748,37 @@ static const iolink_fsm_cm_state_transitions_t iolink_cm_fsm[] = {
     .transitions     = cm_trans_s7},
 };
 
+/* Record the startup phase of a state. The phases up to the serial number
+ * check are recorded by the SM. */
+static void cm_startup_phase (iolink_port_t * port, iolink_cm_state_t state)
+{
+   iolink_startup_phase_t phase;
+
+   switch (state)
+   {
+   case CM_STATE_DS_ParamManager:
+      phase = IOLINK_STARTUP_PHASE_DS;
+      break;
+   case CM_STATE_WaitingOnOperate:
+      phase = IOLINK_STARTUP_PHASE_OPERATE;
+      break;
+   case CM_STATE_PortFault:
+   case CM_STATE_Port_Active:
+   case CM_STATE_Port_DIDO:
+   case CM_STATE_Port_Deactivated:
+      phase = IOLINK_STARTUP_PHASE_NONE;
+      break;
+   default:
+      return;
+   }
+
+   iolink_startup_phase_ind (
+      iolink_get_startup (port),
+      iolink_get_portnumber (port),
+      phase,
+      os_get_current_time_us());
+}
+
 static void iolink_cm_event (iolink_port_t * port, iolink_fsm_cm_event_t event)
 {
    do
@@ -783,6 +819,10 @@ static void iolink_cm_event (iolink_port_t * port, iolink_fsm_cm_event_t event)
          iolink_cm_event_literals[event],
          iolink_cm_state_literals[previous],
          iolink_cm_state_literals[cm->state]);
+      if (cm->state != previous)
+      {
+         cm_startup_phase (port, cm->state);
+      }
       event = next_trans->action (port, event);
    } while (event != CM_EVENT_NONE);
 }
@@ -1025,6 +1065,7 @@ static void cm_smi_portstatus_cb (iolink_job_t * job)
    {
       arg_block_portstatuslist_t port_status;
       iolink_port_info_t * port_info = iolink_get_port_info (port);
+      iolink_cm_port_t * cm          = iolink_get_cm_ctx (port);
 
       memset (&port_status, 0, sizeof (arg_block_portstatuslist_t));
       port_status.arg_block.id      = IOLINK_ARG_BLOCK_ID_PORT_STATUS_LIST;
@@ -1046,9 +1087,12 @@ static void cm_smi_portstatus_cb (iolink_job_t * job)
 
       port_status.port_quality_info = port_info->port_quality_info;
 
-      // TODO for each diag entry .. number_of_diags++ and append to
-      // diag_entries
-      port_status.number_of_diags = 0;
+      /* Valid until the next PortStatusList of the port */
+      port_status.number_of_diags = iolink_al_diag_read (
+         port,
+         cm->diag_entries,
+         IOLINK_NUM_DIAG_ENTRIES);
+      port_status.diag_entries = cm->diag_entries;
 
       iolink_smi_cnf (
          port,
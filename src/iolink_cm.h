@@ -51,6 +51,8 @@ typedef struct iolink_cm_port
    iolink_smi_service_req_t smi_req;
    portconfiglist_t cfg_list;
    iolink_ds_fault_t ds_fault;
+   /* Diagnosis entries of the last PortStatusList */
+   diag_entry_t diag_entries[IOLINK_NUM_DIAG_ENTRIES];
 } iolink_cm_port_t;
 
 /**
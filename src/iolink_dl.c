@@ -14,7 +14,9 @@
  ********************************************************************/
 
 #include "iolink_dl.h"
-/* DL_Mode_ind_baud, DL_Mode_ind, DL_Read_cnf, DL_Write_cnf */
+/* DL_Mode_ind_baud, DL_Mode_ind, DL_Read_cnf, DL_ReadPage_cnf,
+ * DL_Write_cnf
+ */
 #include "iolink_sm.h"
 /* DL_Control_ind, DL_Event_ind, DL_PDInputTransport_ind, DL_ReadParam_cnf,
  * DL_WriteParam_cnf, DL_ISDUTransport_cnf
@@ -27,6 +29,10 @@
  * PL_DisableCycleTimer, PL_Transfer_req, PL_Resend, PL_EnableCycleTimer,
  * PL_MessageDownload_req
  */
+#include "iolink_startup.h"
+/* iolink_startup_wake_req, iolink_startup_com_ind, iolink_startup_ready_ind,
+ * iolink_startup_cancel
+ */
 #include "osal_log.h"
 
 #include "iolink_main.h" /* iolink_get_portnumber */
@@ -105,6 +111,15 @@ static void MH_Conf (iolink_port_t * port, MHCmd_t cmd);
 static void set_OH_IH_EH_Conf_active (iolink_port_t * port, bool active);
 static void write_master_command (iolink_port_t * port, iolink_status_t errorinfo);
 static void iolink_dl_mh_handle_com_lost (iolink_port_t * port);
+static void dl_page_msg (
+   iolink_dl_t * dl,
+   uint8_t address,
+   uint8_t value,
+   bool write);
+static bool dl_page_read_next (iolink_dl_t * dl);
+#ifdef IOLINK_MAX14819_HW_CYCLIC
+static bool dl_tx_changed (iolink_dl_t * dl, uint8_t txlen);
+#endif
 static iolink_error_t OD_req (
    iolink_dl_t * dl,
    iolink_rwdirection_t rwdirection,
@@ -507,6 +522,39 @@ static void MH_Conf (iolink_port_t * port, MHCmd_t cmd)
    iolink_dl_message_h_sm(port);
 }
 
+/* Let a port waiting for the startup coordinator ask again */
+static void dl_startup_kick (iolink_port_t * port, uint8_t portnumber)
+{
+   iolink_port_t * next;
+
+   if (portnumber != 0)
+   {
+      next = iolink_get_port (iolink_get_master (port), portnumber);
+      os_event_set (iolink_get_dl_ctx (next)->event, IOLINK_DL_EVENT_MDH);
+   }
+}
+
+static void dl_startup_ready (iolink_port_t * port, bool operate)
+{
+   dl_startup_kick (
+      port,
+      iolink_startup_ready_ind (
+         iolink_get_startup (port),
+         iolink_get_portnumber (port),
+         os_get_current_time_us(),
+         operate));
+}
+
+static void dl_startup_cancel (iolink_port_t * port)
+{
+   dl_startup_kick (
+      port,
+      iolink_startup_cancel (
+         iolink_get_startup (port),
+         iolink_get_portnumber (port),
+         os_get_current_time_us()));
+}
+
 static void iolink_dl_mode_h_sm_goto_operate (iolink_port_t * port)
 {
    iolink_dl_t * dl = iolink_get_dl_ctx (port);
@@ -522,6 +570,7 @@ static void iolink_dl_mode_h_sm_goto_operate (iolink_port_t * port)
 
    MH_Conf (port, IOL_MHCMD_OPERATE);
    dl->mode_handler.state = IOL_DL_MDH_ST_OPERATE_4;
+   dl_startup_ready (port, true);
    DL_Mode_ind (port, IOLINK_MHMODE_OPERATE);
 }
 
@@ -543,6 +592,7 @@ static void iolink_dl_mode_h_sm_goto_idle (
    MH_Conf (port, IOL_MHCMD_INACTIVE);
    dl->mode_handler.mhinfo = IOLINK_MHINFO_NONE;
    dl->mode_handler.state  = IOL_DL_MDH_ST_IDLE_0;
+   dl_startup_cancel (port);
    DL_Mode_ind (port, mode);
 }
 
@@ -563,6 +613,28 @@ static void iolink_dl_mode_h_sm_idle0 (iolink_port_t * port)
    if (dl->mode_handler.dl_mode == IOLINK_DLMODE_STARTUP) // T1
    {
 #if IOLINK_HW == IOLINK_HW_MAX14819
+      uint8_t kick;
+      uint32_t wait = iolink_startup_wake_req (
+         iolink_get_startup (port),
+         iolink_get_portnumber (port),
+         os_get_current_time_us(),
+         &kick);
+
+      dl_startup_kick (port, kick);
+      if (wait != 0)
+      {
+         /* Ask again when the time has passed, or when kicked by a port
+          * releasing its slot */
+         if (wait != IOLINK_STARTUP_WAIT_SLOT)
+         {
+            os_timer_stop (dl->timer);
+            os_timer_set (dl->timer, wait);
+            os_timer_start (dl->timer);
+            dl->timer_type = IOL_DL_TIMER_WAKEUP;
+         }
+         return;
+      }
+
       // T15, T16, T17, T18, T19
       if (iolink_pl_init_sdci (port))
       {
@@ -576,6 +648,7 @@ static void iolink_dl_mode_h_sm_idle0 (iolink_port_t * port)
             "%s (%u): Unable to start SDCI\n",
             __func__,
             iolink_get_portnumber (port));
+         dl_startup_cancel (port);
       }
 #endif
    }
@@ -606,6 +679,7 @@ static void iolink_dl_mode_h_sm_startup2 (iolink_port_t * port)
       set_OH_IH_EH_Conf_active (port, true);
       MH_Conf (port, IOL_MHCMD_PREOPERATE);
       dl->mode_handler.state = IOL_DL_MDH_ST_PREOPERATE_3;
+      dl_startup_ready (port, false);
       DL_Mode_ind (port, IOLINK_MHMODE_PREOPERATE);
    }
    else if (dl->mode_handler.dl_mode == IOLINK_DLMODE_OPERATE) // T5
@@ -748,6 +822,35 @@ static void write_master_command (iolink_port_t * port, iolink_status_t errorinf
    }
 }
 
+#ifdef IOLINK_MAX14819_HW_CYCLIC
+/**
+ * Check if the master message in txbuffer differs from the one kept in the
+ * MAX14819 TX FIFO.
+ *
+ * In operate the MAX14819 re-sends the kept message (KeepMsg) on each cycle
+ * timer tick, so the TX FIFO only has to be rewritten when PD out or OD
+ * content has changed. A changed message is remembered as the kept one.
+ *
+ * @param dl            DL context
+ * @param txlen         Length of the master message
+ * @return true if the message must be downloaded, false otherwise
+ */
+static bool dl_tx_changed (iolink_dl_t * dl, uint8_t txlen)
+{
+   if (
+      (dl->tx_stored_len == txlen) &&
+      (memcmp (dl->tx_stored, dl->txbuffer, txlen) == 0))
+   {
+      return false;
+   }
+
+   memcpy (dl->tx_stored, dl->txbuffer, txlen);
+   dl->tx_stored_len = txlen;
+
+   return true;
+}
+#endif
+
 static void iolink_dl_mh_handle_com_lost (iolink_port_t * port)
 {
    iolink_dl_t * dl = iolink_get_dl_ctx (port);
@@ -809,6 +912,7 @@ static void iolink_dl_message_h_sm_startup2 (iolink_port_t * port)
    }
    else if (
       (dl->message_handler.rwcmd == IOL_MHRW_READ) ||
+      (dl->message_handler.rwcmd == IOL_MHRW_READPAGE) ||
       (dl->message_handler.rwcmd == IOL_MHRW_WRITE))
    {
       dl->message_handler.retry = 0;
@@ -858,6 +962,25 @@ static void iolink_dl_message_h_sm_await_reply4 (iolink_port_t * port)
          dl->message_handler.rwcmd = IOL_MHRW_NONE;
          DL_Read_cnf (port, dl->rxbuffer[0], IOLINK_STATUS_NO_ERROR);
       }
+      else if (dl->message_handler.rwcmd == IOL_MHRW_READPAGE)
+      {
+         dl->page_read.data[dl->page_read.pos++] = dl->rxbuffer[0];
+
+         if (dl_page_read_next (dl))
+         {
+            /* Next octet right away, without waiting for the SM */
+            os_event_set (dl->event, IOLINK_DL_EVENT_MH);
+         }
+         else
+         {
+            dl->message_handler.rwcmd = IOL_MHRW_NONE;
+            DL_ReadPage_cnf (
+               port,
+               dl->page_read.data,
+               dl->page_read.len,
+               IOLINK_STATUS_NO_ERROR);
+         }
+      }
       else if (dl->message_handler.rwcmd == IOL_MHRW_WRITE)
       {
          dl->message_handler.rwcmd = IOL_MHRW_NONE;
@@ -898,6 +1021,11 @@ static void iolink_dl_message_h_sm_error_handling5 (iolink_port_t * port)
          dl->message_handler.rwcmd = IOL_MHRW_NONE;
          DL_Read_cnf (port, 0, IOLINK_STATUS_NO_COMM);
       }
+      else if (dl->message_handler.rwcmd == IOL_MHRW_READPAGE)
+      {
+         dl->message_handler.rwcmd = IOL_MHRW_NONE;
+         DL_ReadPage_cnf (port, NULL, 0, IOLINK_STATUS_NO_COMM);
+      }
       else if (dl->message_handler.rwcmd == IOL_MHRW_WRITE)
       {
          dl->message_handler.rwcmd = IOL_MHRW_NONE;
@@ -1016,6 +1144,10 @@ static void iolink_dl_message_h_sm_await_reply9 (iolink_port_t * port)
          if (dl->message_handler.mhcmd == IOL_MHCMD_OPERATE)
          {
             start_timer_initcyc (dl);
+#ifdef IOLINK_MAX14819_HW_CYCLIC
+            /* TX FIFO holds a preoperate message */
+            dl->tx_stored_len = 0;
+#endif
             dl->message_handler.state =
                IOL_DL_MH_ST_AW_REPLY_16; // SDCI_TC_0196
          }
@@ -1173,6 +1305,9 @@ static void iolink_dl_message_h_sm_get_od14 (iolink_port_t * port)
       dl->od_handler.od_rxlen + dl->pd_handler.pd_rxlen + 1,
       dl->od_handler.od_txlen + dl->pd_handler.pd_txlen + 2,
       dl->txbuffer);
+#ifdef IOLINK_MAX14819_HW_CYCLIC
+   dl_tx_changed (dl, dl->od_handler.od_txlen + dl->pd_handler.pd_txlen + 2);
+#endif
    LOG_DEBUG (IOLINK_DL_LOG, "%s: Message sent\n", __func__);
 #endif
    dl->message_handler.state = IOL_DL_MH_ST_RESPONSE_15; // T29
@@ -1264,11 +1399,18 @@ static void iolink_dl_message_h_sm_await_reply16 (iolink_port_t * port)
       iolink_dl_od_h_sm (port);
 #if IOLINK_HW == IOLINK_HW_MAX14819
       os_mutex_lock (dl->mtx);
-      PL_MessageDownload_req (
-         port,
-         dl->od_handler.od_rxlen + dl->pd_handler.pd_rxlen + 1,
-         dl->od_handler.od_txlen + dl->pd_handler.pd_txlen + 2,
-         dl->txbuffer);
+#ifdef IOLINK_MAX14819_HW_CYCLIC
+      if (dl_tx_changed (
+             dl,
+             dl->od_handler.od_txlen + dl->pd_handler.pd_txlen + 2))
+#endif
+      {
+         PL_MessageDownload_req (
+            port,
+            dl->od_handler.od_rxlen + dl->pd_handler.pd_rxlen + 1,
+            dl->od_handler.od_txlen + dl->pd_handler.pd_txlen + 2,
+            dl->txbuffer);
+      }
       os_mutex_unlock (dl->mtx);
 #endif
       dl->message_handler.state = IOL_DL_MH_ST_AW_REPLY_16; // T34
@@ -2832,6 +2974,55 @@ static iolink_error_t MHInfo_ind (iolink_dl_t * dl, iolink_mhinfo_t mhinfo)
    return IOLINK_ERROR_NONE;
 }
 
+/* Prepare a page 1 read or write message */
+static void dl_page_msg (
+   iolink_dl_t * dl,
+   uint8_t address,
+   uint8_t value,
+   bool write)
+{
+   dl->txbuffer[0] =
+      ((write) ? IOLINK_RWDIRECTION_WRITE : IOLINK_RWDIRECTION_READ) |
+      IOLINK_COMCHANNEL_PAGE | address;
+   dl->txbuffer[1] = (IOLINK_MSEQTYPE_TYPE_0 & 0xF0) << 2;
+
+   if (write)
+   {
+      dl->txbuffer[2] = value;
+   }
+
+   dl->od_handler.od_rxlen = (write) ? 0 : 1;
+   dl->od_handler.od_txlen = (write) ? 1 : 0;
+}
+
+/* Prepare the read of the next octet of DL_ReadPage_req(), false if all
+ * octets are read */
+static bool dl_page_read_next (iolink_dl_t * dl)
+{
+   uint8_t address;
+
+   while (dl->page_read.pos < dl->page_read.len)
+   {
+      address = dl->page_read.addr + dl->page_read.pos;
+
+#if IOLINK_HW == IOLINK_HW_MAX14819
+      /* MAX14819 made the initial read of MIN_CYCL, see DL_ReadWrite_req() */
+      if ((address == IOL_DIR_PARAMA_MIN_CYCL) && dl->first_read_min_cycl)
+      {
+         dl->first_read_min_cycl                 = false;
+         dl->page_read.data[dl->page_read.pos++] = dl->cycbyte;
+         continue;
+      }
+#endif /* IOLINK_HW_MAX14819 */
+
+      dl_page_msg (dl, address, 0, false);
+
+      return true;
+   }
+
+   return false;
+}
+
 static iolink_error_t DL_ReadWrite_req (
    iolink_port_t * port,
    uint8_t address,
@@ -2899,18 +3090,7 @@ static iolink_error_t DL_ReadWrite_req (
    }
 #endif /* IOLINK_HW_MAX14819 */
 
-   dl->txbuffer[0] =
-      ((write) ? IOLINK_RWDIRECTION_WRITE : IOLINK_RWDIRECTION_READ) |
-      IOLINK_COMCHANNEL_PAGE | address;
-   dl->txbuffer[1] = (IOLINK_MSEQTYPE_TYPE_0 & 0xF0) << 2;
-
-   if (write)
-   {
-      dl->txbuffer[2] = value;
-   }
-
-   dl->od_handler.od_rxlen   = (write) ? 0 : 1;
-   dl->od_handler.od_txlen   = (write) ? 1 : 0;
+   dl_page_msg (dl, address, value, write);
    dl->message_handler.rwcmd = (write) ? IOL_MHRW_WRITE : IOL_MHRW_READ;
    // LOG_DEBUG(IOLINK_DL_LOG, "Message H triggered by DL_%s\n", (write) ?
    // "Write" : "Read");
@@ -2924,6 +3104,54 @@ iolink_error_t DL_Read_req (iolink_port_t * port, uint8_t address)
    return DL_ReadWrite_req (port, address, 0, false);
 }
 
+iolink_error_t DL_ReadPage_req (
+   iolink_port_t * port,
+   uint8_t address,
+   uint8_t len)
+{
+   iolink_dl_t * dl = iolink_get_dl_ctx (port);
+
+   if (dl->message_handler.state != IOL_DL_MH_ST_STARTUP_2)
+   {
+      LOG_ERROR (
+         IOLINK_DL_LOG,
+         "%s: State not valid: %d\n",
+         __func__,
+         dl->message_handler.state);
+      DL_ReadPage_cnf (port, NULL, 0, IOLINK_STATUS_STATE_CONFLICT);
+
+      return IOLINK_ERROR_STATE_INVALID;
+   }
+   else if ((len == 0) || (address + len > IOLINK_DL_PAGE1_LEN))
+   {
+      LOG_ERROR (
+         IOLINK_DL_LOG,
+         "%s: Range not valid: %d, %d\n",
+         __func__,
+         address,
+         len);
+      DL_ReadPage_cnf (port, NULL, 0, IOLINK_STATUS_VALUE_OUT_OF_RANGE);
+
+      return IOLINK_ERROR_ADDRESS_INVALID;
+   }
+
+   dl->page_read.addr = address;
+   dl->page_read.len  = len;
+   dl->page_read.pos  = 0;
+
+   if (!dl_page_read_next (dl))
+   {
+      DL_ReadPage_cnf (port, dl->page_read.data, len, IOLINK_STATUS_NO_ERROR);
+
+      return IOLINK_ERROR_NONE;
+   }
+
+   dl->message_handler.rwcmd = IOL_MHRW_READPAGE;
+   os_event_set (dl->event, IOLINK_DL_EVENT_MH);
+
+   return IOLINK_ERROR_NONE;
+}
+
 iolink_error_t DL_Write_req (iolink_port_t * port, uint8_t address, uint8_t value)
 {
    return DL_ReadWrite_req (port, address, value, true);
@@ -2945,6 +3173,12 @@ iolink_error_t DL_SetMode_req (
       return IOLINK_ERROR_MODE_INVALID;
    }
 
+   if (mode == IOLINK_DLMODE_INACTIVE)
+   {
+      /* Also while waiting for a slot, or for the WURQ */
+      dl_startup_cancel (port);
+   }
+
    dl->mode_handler.dl_mode = mode;
    dl->mseq                 = valuelist->type;
    dl->cycbyte              = valuelist->time;
@@ -3330,6 +3564,14 @@ static void iolink_dl_wurq_recv (iolink_port_t * port)
    iolink_dl_t * dl = iolink_get_dl_ctx (port);
    dl->baudrate     = iolink_pl_get_baudrate (port);
 
+   dl_startup_kick (
+      port,
+      iolink_startup_com_ind (
+         iolink_get_startup (port),
+         iolink_get_portnumber (port),
+         os_get_current_time_us(),
+         dl->baudrate != IOLINK_BAUDRATE_NONE));
+
    if (dl->baudrate == IOLINK_BAUDRATE_NONE)
    {
       // WURQ Failed
@@ -3485,6 +3727,10 @@ static void dl_main (void * arg)
                iolink_dl_message_h_sm (port);
                dl->timer_elapsed = false;
                break;
+            case IOL_DL_TIMER_WAKEUP:
+               /* Ask the startup coordinator again */
+               os_event_set (dl->event, IOLINK_DL_EVENT_MDH);
+               break;
             default:
                break;
             }
@@ -24,8 +24,6 @@
 #define AL_Write_req           mock_AL_Write_req
 #endif /* UNIT_TEST */
 
-#define DS_INDEX_LIST_MAX_ENTRIES 70
-
 #define DS_PARAM_INDEX 3
 
 #define DS_PARAM_SUBINDEX_CMD        1
@@ -255,6 +253,410 @@ static void ds_AL_Write_ds_cmd_req (
       ds_AL_Write_cnf);
 }
 
+/* CRC-32 (IEEE 802.3) tables for slicing-by-8, see ds_crc32_init() */
+static uint32_t ds_crc_table[8][256];
+
+static void ds_crc32_init (void)
+{
+   uint32_t crc;
+   uint16_t i;
+   uint8_t j;
+
+   for (i = 0; i < 256; i++)
+   {
+      crc = i;
+      for (j = 0; j < 8; j++)
+      {
+         crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+      }
+      ds_crc_table[0][i] = crc;
+   }
+
+   for (i = 0; i < 256; i++)
+   {
+      for (j = 1; j < 8; j++)
+      {
+         crc                = ds_crc_table[j - 1][i];
+         ds_crc_table[j][i] = (crc >> 8) ^ ds_crc_table[0][crc & 0xFF];
+      }
+   }
+}
+
+/* Continue crc over len octets, start with crc 0. Eight octets per step */
+static uint32_t ds_crc32 (uint32_t crc, const uint8_t * p, uint32_t len)
+{
+   uint32_t (*t)[256] = ds_crc_table;
+   uint32_t lo;
+   uint32_t hi;
+
+   crc = ~crc;
+   while (len >= 8)
+   {
+      lo = crc ^ (p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24));
+      hi = p[4] | (p[5] << 8) | (p[6] << 16) | ((uint32_t)p[7] << 24);
+      crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^
+            t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^ t[3][hi & 0xFF] ^
+            t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+      p += 8;
+      len -= 8;
+   }
+
+   while (len--)
+   {
+      crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+   }
+
+   return ~crc;
+}
+
+/* Header of a set in the DS arena */
+typedef struct ds_set
+{
+   uint32_t refcnt; /* Ports holding the set */
+   uint32_t reserved;
+} ds_set_t;
+
+static_assert (sizeof (ds_set_t) == DS_SET_HDR_LEN, "");
+
+static inline ds_set_t * ds_set_of (uint8_t * data)
+{
+   return (ds_set_t *)data - 1;
+}
+
+/* The sets of all ports are serialised by the DS mutex, as a port may hold
+ * the set of another port. Taken by the DS job callbacks on the master
+ * thread and by the API, around any use of master_ds */
+static void ds_lock (iolink_port_t * port)
+{
+   os_mutex_lock (iolink_get_ds_mtx (port));
+}
+
+static void ds_unlock (iolink_port_t * port)
+{
+   os_mutex_unlock (iolink_get_ds_mtx (port));
+}
+
+static bool ds_data_shared (iolink_ds_port_t * ds)
+{
+   return (ds->master_ds.data != NULL) &&
+          (ds_set_of (ds->master_ds.data)->refcnt > 1);
+}
+
+/* Drop the reference of the port to master_ds.data, the set is freed
+ * when no port holds it */
+static void ds_data_put (iolink_port_t * port)
+{
+   iolink_ds_port_t * ds = iolink_get_ds_ctx (port);
+
+   if (ds->master_ds.data != NULL)
+   {
+      ds_set_t * set = ds_set_of (ds->master_ds.data);
+
+      if (--set->refcnt == 0)
+      {
+         iolink_arena_free (iolink_get_ds_arena (port), set);
+      }
+   }
+
+   ds->master_ds.data     = NULL;
+   ds->master_ds.size_max = 0;
+}
+
+/* Resize master_ds.data to size octets, keeping its content. A set shared
+ * with other ports is copied first, so the port may change it. Returns
+ * false, and leaves master_ds unchanged, if the DS arena is exhausted */
+static bool ds_data_resize (iolink_port_t * port, uint32_t size)
+{
+   iolink_ds_port_t * ds  = iolink_get_ds_ctx (port);
+   iolink_arena_t * arena = iolink_get_ds_arena (port);
+   ds_set_t * set;
+
+   if (size == 0)
+   {
+      ds_data_put (port);
+      return true;
+   }
+
+   if (ds_data_shared (ds))
+   {
+      set = iolink_arena_alloc (arena, DS_SET_HDR_LEN + size);
+      if (set == NULL)
+      {
+         return false;
+      }
+
+      memcpy (
+         set + 1,
+         ds->master_ds.data,
+         (size < ds->master_ds.size_max) ? size : ds->master_ds.size_max);
+      ds_data_put (port);
+   }
+   else if (size != ds->master_ds.size_max)
+   {
+      set = iolink_arena_realloc (
+         arena,
+         (ds->master_ds.data != NULL) ? ds_set_of (ds->master_ds.data) : NULL,
+         DS_SET_HDR_LEN + size);
+      if (set == NULL)
+      {
+         return false;
+      }
+   }
+   else
+   {
+      return true;
+   }
+
+   set->refcnt            = 1;
+   ds->master_ds.data     = (uint8_t *)(set + 1);
+   ds->master_ds.size_max = size;
+
+   return true;
+}
+
+/* No upload or download in progress, or about to start */
+static bool ds_is_idle (iolink_ds_port_t * ds)
+{
+   return (ds->state <= DS_STATE_Off) || (ds->state == DS_STATE_DS_Ready) ||
+          (ds->state == DS_STATE_DS_Fault);
+}
+
+/* Let port hold the set of from instead of its own */
+static void ds_data_adopt (iolink_port_t * port, iolink_port_t * from)
+{
+   iolink_ds_port_t * ds      = iolink_get_ds_ctx (port);
+   iolink_ds_port_t * from_ds = iolink_get_ds_ctx (from);
+
+   /* A shared set has no spare room, it is not grown in place */
+   if (!ds_data_shared (from_ds))
+   {
+      ds_data_resize (from, from_ds->master_ds.size);
+   }
+
+   ds_data_put (port);
+   ds_set_of (from_ds->master_ds.data)->refcnt++;
+   ds->master_ds.data     = from_ds->master_ds.data;
+   ds->master_ds.size_max = from_ds->master_ds.size_max;
+}
+
+/* Keep one copy of the set of port if another idle port holds the same
+ * set, as found by its identity, checksum, size and content */
+static void ds_share (iolink_port_t * port)
+{
+   iolink_ds_port_t * ds = iolink_get_ds_ctx (port);
+   iolink_m_t * master   = iolink_get_master (port);
+   uint8_t port_cnt      = iolink_get_port_cnt (port);
+   uint8_t portnumber;
+
+   if (!ds->master_ds.valid || (ds->master_ds.size == 0))
+   {
+      return;
+   }
+
+   for (portnumber = 1; portnumber <= port_cnt; portnumber++)
+   {
+      iolink_port_t * other       = iolink_get_port (master, portnumber);
+      iolink_ds_port_t * other_ds = iolink_get_ds_ctx (other);
+
+      if (
+         (other != port) && ds_is_idle (other_ds) &&
+         other_ds->master_ds.valid &&
+         (other_ds->master_ds.vid == ds->master_ds.vid) &&
+         (other_ds->master_ds.did == ds->master_ds.did) &&
+         (other_ds->master_ds.fid == ds->master_ds.fid) &&
+         (other_ds->master_ds.cs == ds->master_ds.cs) &&
+         (other_ds->master_ds.size == ds->master_ds.size) &&
+         (other_ds->master_ds.crc == ds->master_ds.crc))
+      {
+         if (other_ds->master_ds.data == ds->master_ds.data)
+         {
+            return;
+         }
+
+         if (
+            memcmp (
+               other_ds->master_ds.data,
+               ds->master_ds.data,
+               ds->master_ds.size) == 0)
+         {
+            ds_data_adopt (port, other);
+            return;
+         }
+      }
+   }
+}
+
+static void ds_release_index_list (iolink_port_t * port)
+{
+   iolink_ds_port_t * ds = iolink_get_ds_ctx (port);
+
+   iolink_arena_free (iolink_get_ds_arena (port), ds->index_list.entries);
+   ds->index_list.entries = NULL;
+   ds->index_list.count   = 0;
+   ds->index_list.pos     = 0;
+}
+
+/* The counters are kept, they are reported when the download is done */
+static void ds_release_dl_plan (iolink_port_t * port)
+{
+   iolink_ds_port_t * ds = iolink_get_ds_ctx (port);
+
+   iolink_arena_free (iolink_get_ds_arena (port), ds->dl_plan.offset);
+   ds->dl_plan.offset = NULL;
+}
+
+/* Persist master_ds, if there is a backend */
+static void ds_store (iolink_port_t * port)
+{
+   iolink_ds_port_t * ds = iolink_get_ds_ctx (port);
+   uint8_t portnumber    = iolink_get_portnumber (port);
+   iolink_ds_record_t record;
+
+   if (ds->storage == NULL)
+   {
+      return;
+   }
+
+   record.vendorid   = ds->master_ds.vid;
+   record.deviceid   = ds->master_ds.did;
+   record.functionid = ds->master_ds.fid;
+   record.cs         = ds->master_ds.cs;
+   record.size       = ds->master_ds.size;
+   record.data       = ds->master_ds.data;
+
+   if (!ds->storage->store (ds->storage->arg, portnumber, &record))
+   {
+      LOG_ERROR (
+         IOLINK_DS_LOG,
+         "%u: DS: failed to store Data Storage\n",
+         portnumber);
+   }
+}
+
+/* Restore master_ds from the backend, if there is one */
+static void ds_load (iolink_port_t * port)
+{
+   /* The backend may load a full set. Only used from iolink_ds_init(), so
+    * that the DS arena holds no more than the size of each set. */
+   static uint8_t buf[IOLINK_DS_MAX_SIZE];
+   iolink_ds_port_t * ds = iolink_get_ds_ctx (port);
+   uint8_t portnumber    = iolink_get_portnumber (port);
+   iolink_ds_record_t record;
+
+   if (ds->storage == NULL)
+   {
+      return;
+   }
+
+   memset (&record, 0, sizeof (record));
+   record.data = buf;
+
+   if (
+      !ds->storage->load (ds->storage->arg, portnumber, &record) ||
+      (record.size > IOLINK_DS_MAX_SIZE))
+   {
+      return;
+   }
+
+   if (!ds_data_resize (port, record.size))
+   {
+      LOG_ERROR (
+         IOLINK_DS_LOG,
+         "%u: DS: no room in the DS arena to load Data Storage\n",
+         portnumber);
+      return;
+   }
+   if (record.size > 0)
+   {
+      memcpy (ds->master_ds.data, buf, record.size);
+   }
+
+   ds->master_ds.vid   = record.vendorid;
+   ds->master_ds.did   = record.deviceid;
+   ds->master_ds.fid   = record.functionid;
+   ds->master_ds.cs    = record.cs;
+   ds->master_ds.size  = record.size;
+   ds->master_ds.crc   = ds_crc32 (0, ds->master_ds.data, record.size);
+   ds->master_ds.valid = true;
+   ds_share (port);
+}
+
+/* Split master_ds into the records to write, false if malformed or the
+ * DS arena is exhausted */
+static bool ds_build_dl_plan (iolink_port_t * port)
+{
+   iolink_ds_port_t * ds = iolink_get_ds_ctx (port);
+   uint16_t cnt          = 0;
+   uint32_t pos;
+
+   ds_release_dl_plan (port);
+   ds->dl_plan.cnt      = 0;
+   ds->dl_plan.next     = 0;
+   ds->dl_plan.done     = 0;
+   ds->dl_plan.start_us = os_get_current_time_us();
+
+   for (pos = 0; pos < ds->master_ds.size;
+        pos += DS_RECORD_HDR_LEN + ds->master_ds.data[pos + 3])
+   {
+      if (
+         (pos + DS_RECORD_HDR_LEN > ds->master_ds.size) ||
+         (pos + DS_RECORD_HDR_LEN + ds->master_ds.data[pos + 3] >
+          ds->master_ds.size))
+      {
+         LOG_ERROR (
+            IOLINK_DS_LOG,
+            "%u: DS: malformed Data Storage set\n",
+            iolink_get_portnumber (port));
+         return false;
+      }
+      cnt++;
+   }
+
+   if (cnt == 0)
+   {
+      return true;
+   }
+
+   ds->dl_plan.offset =
+      iolink_arena_alloc (iolink_get_ds_arena (port), cnt * sizeof (uint16_t));
+   if (ds->dl_plan.offset == NULL)
+   {
+      LOG_ERROR (
+         IOLINK_DS_LOG,
+         "%u: DS: no room in the DS arena for the download\n",
+         iolink_get_portnumber (port));
+      return false;
+   }
+
+   for (pos = 0; pos < ds->master_ds.size;
+        pos += DS_RECORD_HDR_LEN + ds->master_ds.data[pos + 3])
+   {
+      ds->dl_plan.offset[ds->dl_plan.cnt++] = pos;
+   }
+
+   return true;
+}
+
+/* Write the next record of the download plan */
+static void ds_write_next_param (iolink_port_t * port)
+{
+   iolink_ds_port_t * ds = iolink_get_ds_ctx (port);
+   const uint8_t * record =
+      &ds->master_ds.data[ds->dl_plan.offset[ds->dl_plan.next]];
+
+   ds->dl_plan.next++;
+   ds->current_index    = (record[0] << 8) | record[1];
+   ds->current_subindex = record[2];
+
+   AL_Write_req (
+      port,
+      ds->current_index,
+      ds->current_subindex,
+      record[3],
+      &record[DS_RECORD_HDR_LEN],
+      ds_AL_Write_cnf);
+}
+
 static iolink_fsm_ds_event_t ds_delete (
    iolink_port_t * port,
    iolink_fsm_ds_event_t event)
@@ -266,6 +668,13 @@ static iolink_fsm_ds_event_t ds_delete (
    ds->master_ds.cs    = 0;
    ds->master_ds.valid = false;
    ds->master_ds.pos   = 0;
+   ds->master_ds.size  = 0;
+   ds_data_resize (port, 0);
+
+   if (ds->storage != NULL)
+   {
+      ds->storage->erase (ds->storage->arg, iolink_get_portnumber (port));
+   }
 
    return DS_EVENT_NONE;
 }
@@ -282,6 +691,8 @@ static iolink_fsm_ds_event_t ds_ul_fault (
    iolink_port_t * port,
    iolink_fsm_ds_event_t event)
 {
+   ds_release_index_list (port);
+
    return DS_EVENT_FAULT_UL;
 }
 
@@ -289,6 +700,8 @@ static iolink_fsm_ds_event_t ds_dl_fault (
    iolink_port_t * port,
    iolink_fsm_ds_event_t event)
 {
+   ds_release_dl_plan (port);
+
    return DS_EVENT_FAULT_DL;
 }
 
@@ -446,11 +859,27 @@ static iolink_fsm_ds_event_t ds_upload (
 
    if (event == DS_EVENT_DO_UPLOAD)
    {
-      ds->master_ds.pos    = 0;
-      ds->index_list.pos   = 0;
-      ds->current_index    = DS_PARAM_INDEX;
-      ds->current_subindex = DS_PARAM_SUBINDEX_INDEX_LIST;
-      res                  = DS_EVENT_MORE_DATA; /* T30 */
+      ds_release_index_list (port);
+      /* The set is overwritten, stop sharing it with other ports */
+      if (!ds_data_resize (port, ds->master_ds.size_max))
+      {
+         LOG_ERROR (
+            IOLINK_DS_LOG,
+            "%u: DS: no room in the DS arena for the upload\n",
+            iolink_get_portnumber (port));
+         return DS_EVENT_COM_ERR; /* T34 */
+      }
+      ds->master_ds.pos     = 0;
+      ds->current_index     = DS_PARAM_INDEX;
+      ds->current_subindex  = DS_PARAM_SUBINDEX_INDEX_LIST;
+      ds->upload.prefetched = false;
+      ds->upload.param_cnt  = 0;
+      ds->upload.start_us   = os_get_current_time_us();
+      ds->upload.prev_valid = ds->master_ds.valid;
+      ds->upload.prev_crc   = ds->master_ds.crc;
+      ds->upload.prev_size  = ds->master_ds.size;
+      ds->master_ds.crc     = 0;
+      res                   = DS_EVENT_MORE_DATA; /* T30 */
    }
    else if (event == DS_EVENT_READ_DONE)
    {
@@ -469,10 +898,15 @@ static iolink_fsm_ds_event_t ds_upload (
       {
          /* No more data */
          ds->master_ds.size = ds->master_ds.pos;
+         ds_release_index_list (port);
          /* T35 */
-         /* Read checksum */
-         ds_AL_Read_req (port, DS_PARAM_INDEX, DS_PARAM_SUBINDEX_CHECKSUM);
-         res = DS_EVENT_STORE_DATA;
+         /* Read checksum, unless already requested */
+         if (!ds->upload.prefetched)
+         {
+            ds_AL_Read_req (port, DS_PARAM_INDEX, DS_PARAM_SUBINDEX_CHECKSUM);
+         }
+         ds->upload.prefetched = false;
+         res                   = DS_EVENT_STORE_DATA;
       }
    }
 
@@ -523,21 +957,11 @@ static iolink_fsm_ds_event_t ds_write_param (
 {
    iolink_ds_port_t * ds = iolink_get_ds_ctx (port);
 
-   uint16_t index = ds->master_ds.data[ds->master_ds.pos] << 8;
-   ds->master_ds.pos++;
-   index += ds->master_ds.data[ds->master_ds.pos];
-   ds->master_ds.pos++;
-   uint8_t subindex = ds->master_ds.data[ds->master_ds.pos];
-   ds->master_ds.pos++;
-   uint8_t len = ds->master_ds.data[ds->master_ds.pos];
-   ds->master_ds.pos++;
-   uint8_t * data = &ds->master_ds.data[ds->master_ds.pos];
-   ds->master_ds.pos += len;
-
-   ds->current_index    = DS_PARAM_INDEX;
-   ds->current_subindex = subindex;
-
-   AL_Write_req (port, index, subindex, len, data, ds_AL_Write_cnf);
+   /* Unless requested when the previous write was confirmed */
+   if (ds->dl_plan.next == ds->dl_plan.done)
+   {
+      ds_write_next_param (port);
+   }
 
    return DS_EVENT_NONE;
 }
@@ -553,6 +977,7 @@ static iolink_fsm_ds_event_t ds_dl_done (
    iolink_port_t * port,
    iolink_fsm_ds_event_t event)
 {
+   ds_release_dl_plan (port);
    ds_AL_Write_ds_cmd_req (port, DS_CMD_DL_END); /* T41 */
 
    return DS_EVENT_NONE;
@@ -564,7 +989,15 @@ static iolink_fsm_ds_event_t ds_readparam (
 {
    iolink_ds_port_t * ds = iolink_get_ds_ctx (port);
 
-   ds_AL_Read_req (port, ds->current_index, ds->current_subindex);
+   if (ds->upload.prefetched)
+   {
+      /* Requested when the previous read was confirmed */
+      ds->upload.prefetched = false;
+   }
+   else
+   {
+      ds_AL_Read_req (port, ds->current_index, ds->current_subindex);
+   }
 
    return DS_EVENT_NONE;
 }
@@ -581,6 +1014,8 @@ static iolink_fsm_ds_event_t ds_ready (
    iolink_port_t * port,
    iolink_fsm_ds_event_t event)
 {
+   /* E.g. after an upload, keep one copy of a set held by other ports */
+   ds_share (port);
    DS_Ready (port);
 
    return DS_EVENT_READY;
@@ -593,12 +1028,12 @@ static iolink_fsm_ds_event_t ds_decompose_set (
    iolink_ds_port_t * ds     = iolink_get_ds_ctx (port);
    iolink_fsm_ds_event_t res = DS_EVENT_NONE;
 
-   if (event == DS_EVENT_DOWNLOAD)
+   if ((event == DS_EVENT_DOWNLOAD) && !ds_build_dl_plan (port))
    {
-      ds->master_ds.pos = 0;
+      return DS_EVENT_DEV_ERR;
    }
 
-   if (ds->master_ds.pos >= ds->master_ds.size)
+   if (ds->dl_plan.done >= ds->dl_plan.cnt)
    {
       res = DS_EVENT_DL_DONE;
    }
@@ -735,6 +1170,7 @@ static const iolink_fsm_ds_transition_t ds_trans_s14[] = {
    {DS_EVENT_MORE_DATA, DS_STATE_Write_Parameter, ds_write_param}, /* T37 */
    {DS_EVENT_DOWNLOAD, DS_STATE_Decompose_Set, ds_decompose_set},  /* T24 */
    {DS_EVENT_DL_DONE, DS_STATE_Download_Done, ds_dl_done},         /* T41 */
+   {DS_EVENT_DEV_ERR, DS_STATE_Download_Fault, ds_dl_fault}, /* Not in spec. */
 };
 static const iolink_fsm_ds_transition_t ds_trans_s15[] = {
    /* Download_10 + Write_Parameter_18 */
@@ -855,7 +1291,7 @@ static void iolink_ds_event (iolink_port_t * port, iolink_fsm_ds_event_t event)
 }
 
 /* DS AL_Read_cnf() and AL_Write_cnf functions */
-static void ds_read_cnf_cb (iolink_job_t * job)
+static void ds_read_cnf (iolink_job_t * job)
 {
    iolink_port_t * port  = job->port;
    iolink_ds_port_t * ds = iolink_get_ds_ctx (port);
@@ -890,6 +1326,17 @@ static void ds_read_cnf_cb (iolink_job_t * job)
                IOLINK_DS_MAX_SIZE,
                (long unsigned int)ds->device_ds.size_max);
          }
+         else if (
+            (ds->device_ds.size_max > ds->master_ds.size_max) &&
+            !ds_data_resize (port, ds->device_ds.size_max))
+         {
+            /* CheckMemSize fails, T17 */
+            LOG_ERROR (
+               IOLINK_DS_LOG,
+               "%u: DS: no room in the DS arena for %lu octets\n",
+               iolink_get_portnumber (port),
+               (long unsigned int)ds->device_ds.size_max);
+         }
          iolink_ds_event (port, DS_EVENT_PASSED);
       }
       break;
@@ -917,38 +1364,55 @@ static void ds_read_cnf_cb (iolink_job_t * job)
             (ds->current_index == DS_PARAM_INDEX) &&
             (ds->current_subindex == DS_PARAM_SUBINDEX_INDEX_LIST))
          {
-            uint8_t i              = 0;
-            uint16_t read_data_pos = 0;
-
-            while (i < DS_INDEX_LIST_MAX_ENTRIES)
+            const uint8_t * il = job->al_read_cnf.data;
+            uint8_t count      = 0;
+            uint8_t i;
+
+            /* Entries up to the termination entry, index 0 */
+            while (
+               (count < DS_INDEX_LIST_MAX_ENTRIES) &&
+               (3 * count + 3 <= job->al_read_cnf.data_len) &&
+               (((il[3 * count] << 8) | il[3 * count + 1]) != 0))
             {
-               uint16_t index = job->al_read_cnf.data[read_data_pos] << 8;
-               read_data_pos++;
-               index += job->al_read_cnf.data[read_data_pos];
-               read_data_pos++;
+               count++;
+            }
 
-               if (index == 0) /* Found termination entry */
+            ds_release_index_list (port);
+            if (count > 0)
+            {
+               ds->index_list.entries = iolink_arena_alloc (
+                  iolink_get_ds_arena (port),
+                  count * sizeof (ds_index_list_entry_t));
+               if (ds->index_list.entries == NULL)
                {
-                  ds->index_list.count = i;
+                  LOG_ERROR (
+                     IOLINK_DS_LOG,
+                     "%u: DS: no room in the DS arena for the index list\n",
+                     iolink_get_portnumber (port));
+                  iolink_ds_event (port, DS_EVENT_DEV_ERR); /* T32 */
                   break;
                }
-               else
-               {
-                  uint8_t subindex = job->al_read_cnf.data[read_data_pos];
-                  read_data_pos++;
+            }
 
-                  ds->index_list.entries[i].index    = index;
-                  ds->index_list.entries[i].subindex = subindex;
-               }
-               i++;
+            for (i = 0; i < count; i++)
+            {
+               ds->index_list.entries[i].index =
+                  (il[3 * i] << 8) | il[3 * i + 1];
+               ds->index_list.entries[i].subindex = il[3 * i + 2];
             }
+            ds->index_list.count = count;
          }
          else
          {
             uint16_t len = job->al_read_cnf.data_len;
 
-            if ((ds->master_ds.pos + 2 + 1 + len) < IOLINK_DS_MAX_SIZE)
+            ds->upload.param_cnt++;
+            if (
+               (uint32_t)ds->master_ds.pos + DS_RECORD_HDR_LEN + len <=
+               ds->master_ds.size_max)
             {
+               uint16_t start = ds->master_ds.pos;
+
                ds->master_ds.data[ds->master_ds.pos] = ds->current_index >> 8;
                ds->master_ds.pos++;
                ds->master_ds.data[ds->master_ds.pos] = ds->current_index;
@@ -962,6 +1426,10 @@ static void ds_read_cnf_cb (iolink_job_t * job)
                   job->al_read_cnf.data,
                   len);
                ds->master_ds.pos += len;
+               ds->master_ds.crc = ds_crc32 (
+                  ds->master_ds.crc,
+                  &ds->master_ds.data[start],
+                  ds->master_ds.pos - start);
             }
             else
             {
@@ -1006,11 +1474,33 @@ static void ds_read_cnf_cb (iolink_job_t * job)
       if (job->al_read_cnf.data_len < sizeof (uint32_t))
       {
          iolink_ds_event (port, DS_EVENT_COM_ERR); /* T42 */
+         break;
       }
       ds->device_ds.cs =
          (job->al_read_cnf.data[0] << 24) + (job->al_read_cnf.data[1] << 16) +
          (job->al_read_cnf.data[2] << 8) + job->al_read_cnf.data[3];
 
+      /* The device now holds master_ds. Keep the checksum it reports, so
+       * that ds_chk_csum() finds them equal after the next startup and
+       * the set is not downloaded again, e.g. when the set came from
+       * SMI_ParServToDS_req without a checksum */
+      if (ds->master_ds.cs != ds->device_ds.cs)
+      {
+         ds->master_ds.cs = ds->device_ds.cs;
+         ds_store (port);
+      }
+
+      ds->stats.download_size      = ds->master_ds.size;
+      ds->stats.download_param_cnt = ds->dl_plan.cnt;
+      ds->stats.download_us =
+         os_get_current_time_us() - ds->dl_plan.start_us;
+      LOG_DEBUG (
+         IOLINK_DS_LOG,
+         "%u: DS: downloaded %u octets in %lu us\n",
+         iolink_get_portnumber (port),
+         ds->stats.download_size,
+         (unsigned long)ds->stats.download_us);
+
       iolink_ds_event (port, DS_EVENT_READY); /* T41 */
       break;
    default:
@@ -1018,7 +1508,7 @@ static void ds_read_cnf_cb (iolink_job_t * job)
    }
 }
 
-static void ds_write_cnf_cb (iolink_job_t * job)
+static void ds_write_cnf (iolink_job_t * job)
 {
    iolink_port_t * port  = job->port;
    iolink_ds_port_t * ds = iolink_get_ds_ctx (port);
@@ -1036,15 +1526,41 @@ static void ds_write_cnf_cb (iolink_job_t * job)
          iolink_ds_event (port, DS_EVENT_DO_UPLOAD); /* T19 */
          break;
       case DS_STATE_Write_Parameter:
+         ds->dl_plan.done++;
          iolink_ds_event (port, DS_EVENT_WR_DONE);
          break;
       case DS_STATE_StoreDataSet:
+      {
+         /* The upload may have read back the set already stored */
+         bool unchanged = ds->upload.prev_valid &&
+                          (ds->master_ds.vid == ds->pending_id.vendorid) &&
+                          (ds->master_ds.did == ds->pending_id.deviceid) &&
+                          (ds->master_ds.cs == ds->device_ds.cs) &&
+                          (ds->master_ds.size == ds->upload.prev_size) &&
+                          (ds->master_ds.crc == ds->upload.prev_crc);
+
          ds->master_ds.vid   = ds->pending_id.vendorid;
          ds->master_ds.did   = ds->pending_id.deviceid;
          ds->master_ds.cs    = ds->device_ds.cs;
          ds->master_ds.valid = true;
+         if (!unchanged)
+         {
+            ds_store (port);
+         }
+
+         ds->stats.upload_size      = ds->master_ds.size;
+         ds->stats.upload_param_cnt = ds->upload.param_cnt;
+         ds->stats.upload_us = os_get_current_time_us() - ds->upload.start_us;
+         LOG_DEBUG (
+            IOLINK_DS_LOG,
+            "%u: DS: uploaded %u octets in %lu us\n",
+            iolink_get_portnumber (port),
+            ds->stats.upload_size,
+            (unsigned long)ds->stats.upload_us);
+
          iolink_ds_event (port, DS_EVENT_UL_DONE); /* T26 */
          break;
+      }
       case DS_STATE_Decompose_Set:
          iolink_ds_event (port, DS_EVENT_DOWNLOAD); /* T24 */
          break;
@@ -1068,7 +1584,8 @@ static void ds_AL_Read_cnf (
    const uint8_t * data,
    iolink_smi_errortypes_t errortype)
 {
-   iolink_job_t * job = iolink_fetch_avail_job (port);
+   iolink_ds_port_t * ds = iolink_get_ds_ctx (port);
+   iolink_job_t * job    = iolink_fetch_avail_job (port);
 
    job->al_read_cnf.data      = data;
    job->al_read_cnf.data_len  = len;
@@ -1079,11 +1596,44 @@ static void ds_AL_Read_cnf (
       job,
       IOLINK_JOB_AL_READ_CNF,
       ds_read_cnf_cb);
+
+   /* During upload, request the next parameter now, queued behind the
+    * confirmation, so that the ISDU channel is not idle while the
+    * confirmation is handled. The data is handled before the next read
+    * is started, so it is not overwritten. */
+   if (
+      (ds->state == DS_STATE_ReadParameter) &&
+      (errortype == IOLINK_SMI_ERRORTYPE_NONE) &&
+      !((ds->current_index == DS_PARAM_INDEX) &&
+        (ds->current_subindex == DS_PARAM_SUBINDEX_INDEX_LIST)))
+   {
+      if (ds->index_list.pos < ds->index_list.count)
+      {
+         ds_index_list_entry_t * il_entry =
+            &ds->index_list.entries[ds->index_list.pos];
+
+         AL_Read_req (
+            port,
+            il_entry->index,
+            il_entry->subindex,
+            ds_AL_Read_cnf);
+      }
+      else
+      {
+         AL_Read_req (
+            port,
+            DS_PARAM_INDEX,
+            DS_PARAM_SUBINDEX_CHECKSUM,
+            ds_AL_Read_cnf);
+      }
+      ds->upload.prefetched = true;
+   }
 }
 
 static void ds_AL_Write_cnf (iolink_port_t * port, iolink_smi_errortypes_t errortype)
 {
-   iolink_job_t * job = iolink_fetch_avail_job (port);
+   iolink_ds_port_t * ds = iolink_get_ds_ctx (port);
+   iolink_job_t * job    = iolink_fetch_avail_job (port);
 
    job->al_write_cnf.errortype = errortype;
 
@@ -1092,17 +1642,48 @@ static void ds_AL_Write_cnf (iolink_port_t * port, iolink_smi_errortypes_t error
       job,
       IOLINK_JOB_AL_WRITE_CNF,
       ds_write_cnf_cb);
+
+   /* During download, write the next record now, queued behind the
+    * confirmation. Nothing more is written after a negative confirmation,
+    * the download is aborted when it is handled. */
+   if (
+      (ds->state == DS_STATE_Write_Parameter) &&
+      (errortype == IOLINK_SMI_ERRORTYPE_NONE) &&
+      (ds->dl_plan.next < ds->dl_plan.cnt))
+   {
+      ds_lock (port);
+      ds_write_next_param (port);
+      ds_unlock (port);
+   }
 }
 
 /* DS job callback functions */
+static void ds_read_cnf_cb (iolink_job_t * job)
+{
+   ds_lock (job->port);
+   ds_read_cnf (job);
+   ds_unlock (job->port);
+}
+
+static void ds_write_cnf_cb (iolink_job_t * job)
+{
+   ds_lock (job->port);
+   ds_write_cnf (job);
+   ds_unlock (job->port);
+}
+
 static void ds_startup_cb (iolink_job_t * job)
 {
+   ds_lock (job->port);
    iolink_ds_event (job->port, DS_EVENT_STARTUP);
+   ds_unlock (job->port);
 }
 
 static void ds_delete_cb (iolink_job_t * job)
 {
+   ds_lock (job->port);
    iolink_ds_event (job->port, DS_EVENT_DELETE);
+   ds_unlock (job->port);
 }
 
 static void ds_init_cb (iolink_job_t * job)
@@ -1136,24 +1717,69 @@ static void ds_init_cb (iolink_job_t * job)
    ds->pending_id.vendorid = cfg_list->vendorid;
    ds->pending_id.deviceid = cfg_list->deviceid;
 
+   ds_lock (port);
    iolink_ds_event (port, DS_EVENT_INIT);
+   ds_unlock (port);
 }
 
 static void ds_upload_cb (iolink_job_t * job)
 {
+   ds_lock (job->port);
    iolink_ds_event (job->port, DS_EVENT_UPLOAD);
+   ds_unlock (job->port);
+}
+
+static void ds_release (iolink_job_t * job)
+{
+   iolink_port_t * port  = job->port;
+   iolink_ds_port_t * ds = iolink_get_ds_ctx (port);
+
+   /* An upload or download in progress releases the index list or the
+    * download plan when it ends, and keeps the capacity of the set */
+   if (ds->state >= DS_STATE_Decompose_IL)
+   {
+      return;
+   }
+
+   ds_release_index_list (port);
+   ds_release_dl_plan (port);
+   if (!ds->master_ds.valid)
+   {
+      ds_data_put (port);
+   }
+   else if (!ds_data_shared (ds))
+   {
+      /* A shared set has no spare room */
+      ds_data_resize (port, ds->master_ds.size);
+   }
+}
+
+static void ds_release_cb (iolink_job_t * job)
+{
+   ds_lock (job->port);
+   ds_release (job);
+   ds_unlock (job->port);
 }
 
 /* Stack internal API */
-void iolink_ds_init (iolink_port_t * port)
+void iolink_ds_init (
+   iolink_port_t * port,
+   const iolink_ds_storage_t * storage)
 {
    iolink_ds_port_t * ds = iolink_get_ds_ctx (port);
 
    memset (ds, 0, sizeof (iolink_ds_port_t));
 
-   ds->state = DS_STATE_CheckActivationState;
+   ds->state   = DS_STATE_CheckActivationState;
+   ds->storage = storage;
+
+   if (ds_crc_table[0][1] == 0)
+   {
+      ds_crc32_init();
+   }
 
-   ds->master_ds.size_max = IOLINK_DS_MAX_SIZE;
+   /* CheckDSValidity compares against the stored set without an upload */
+   ds_load (port);
 }
 
 iolink_error_t DS_Delete (iolink_port_t * port)
@@ -1195,6 +1821,19 @@ iolink_error_t DS_Upload (iolink_port_t * port)
    return IOLINK_ERROR_NONE;
 }
 
+iolink_error_t DS_Release (iolink_port_t * port)
+{
+   iolink_job_t * job = iolink_fetch_avail_job (port);
+
+   iolink_post_job_with_type_and_callback (
+      port,
+      job,
+      IOLINK_JOB_DS_RELEASE,
+      ds_release_cb);
+
+   return IOLINK_ERROR_NONE;
+}
+
 iolink_error_t DS_Init (iolink_port_t * port, const portconfiglist_t * cfg_list)
 {
    iolink_job_t * job = iolink_fetch_avail_job (port);
@@ -1224,7 +1863,7 @@ bool DS_Chk_Cfg (iolink_port_t * port, const portconfiglist_t * cfg_list)
    return false;
 }
 
-iolink_error_t ds_SMI_ParServToDS_req (
+static iolink_error_t ds_par_serv_to_ds (
    iolink_port_t * port,
    iolink_arg_block_id_t exp_arg_block_id,
    uint16_t arg_block_len,
@@ -1232,8 +1871,9 @@ iolink_error_t ds_SMI_ParServToDS_req (
 {
    iolink_arg_block_id_t ref_arg_block_id = arg_block->id;
    iolink_error_t error;
-   iolink_ds_port_t * ds         = iolink_get_ds_ctx (port);
-   uint8_t arg_block_ds_data_len = arg_block_len - sizeof (arg_block_ds_data_t);
+   iolink_ds_port_t * ds          = iolink_get_ds_ctx (port);
+   uint16_t arg_block_ds_data_len =
+      arg_block_len - sizeof (arg_block_ds_data_t);
    iolink_smi_errortypes_t smi_error;
 
    if (exp_arg_block_id != IOLINK_ARG_BLOCK_ID_VOID_BLOCK || ref_arg_block_id != IOLINK_ARG_BLOCK_ID_DS_DATA)
@@ -1243,25 +1883,46 @@ iolink_error_t ds_SMI_ParServToDS_req (
       iolink_smi_joberror_ind (port, exp_arg_block_id, ref_arg_block_id, smi_error);
       error = IOLINK_ERROR_PARAMETER_CONFLICT;
    }
-   else if (arg_block_ds_data_len > ds->master_ds.size_max)
+   else if (
+      (arg_block_len < sizeof (arg_block_ds_data_t)) ||
+      (arg_block_ds_data_len > IOLINK_DS_MAX_SIZE))
    {
       smi_error = IOLINK_SMI_ERRORTYPE_ARGBLOCK_INCONSISTENT; // TODO what to
                                                               // use?
       iolink_smi_joberror_ind (port, exp_arg_block_id, ref_arg_block_id, smi_error);
       error = IOLINK_ERROR_PARAMETER_CONFLICT;
    }
+   else if (!ds_data_resize (port, arg_block_ds_data_len))
+   {
+      iolink_smi_joberror_ind (
+         port,
+         exp_arg_block_id,
+         ref_arg_block_id,
+         IOLINK_SMI_ERRORTYPE_MEMORY_OVERRUN);
+      error = IOLINK_ERROR_OUT_OF_MEMORY;
+   }
    else
    {
       arg_block_ds_data_t * arg_block_ds_data = (arg_block_ds_data_t *)arg_block;
 
-      memcpy (ds->master_ds.data, arg_block_ds_data->ds_data, arg_block_ds_data_len);
+      if (arg_block_ds_data_len > 0)
+      {
+         memcpy (
+            ds->master_ds.data,
+            arg_block_ds_data->ds_data,
+            arg_block_ds_data_len);
+      }
 
-      ds->master_ds.cs    = 0; // TODO?
+      ds->master_ds.cs    = arg_block_ds_data->checksum;
       ds->master_ds.vid   = arg_block_ds_data->vid;
       ds->master_ds.did   = arg_block_ds_data->did;
       ds->master_ds.fid   = arg_block_ds_data->fid;
       ds->master_ds.valid = true;
       ds->master_ds.size  = arg_block_ds_data_len;
+      ds->master_ds.crc =
+         ds_crc32 (0, ds->master_ds.data, arg_block_ds_data_len);
+      ds_share (port);
+      ds_store (port);
 
       iolink_smi_voidblock_cnf (port, ref_arg_block_id);
 
@@ -1270,3 +1931,436 @@ iolink_error_t ds_SMI_ParServToDS_req (
 
    return error;
 }
+
+iolink_error_t ds_SMI_ParServToDS_req (
+   iolink_port_t * port,
+   iolink_arg_block_id_t exp_arg_block_id,
+   uint16_t arg_block_len,
+   arg_block_t * arg_block)
+{
+   iolink_error_t error;
+
+   ds_lock (port);
+   error = ds_par_serv_to_ds (port, exp_arg_block_id, arg_block_len, arg_block);
+   ds_unlock (port);
+
+   return error;
+}
+
+static iolink_error_t ds_to_par_serv (
+   iolink_port_t * port,
+   iolink_arg_block_id_t exp_arg_block_id,
+   uint16_t arg_block_len,
+   arg_block_t * arg_block)
+{
+   iolink_arg_block_id_t ref_arg_block_id = arg_block->id;
+   iolink_ds_port_t * ds                  = iolink_get_ds_ctx (port);
+   /* A whole set is too large for the stack. Serialised by the DS mutex,
+    * a read must not fail because the DS arena is full */
+   static uint8_t buf[sizeof (arg_block_ds_data_t) + IOLINK_DS_MAX_SIZE];
+   arg_block_ds_data_t * arg_block_ds_data = (arg_block_ds_data_t *)buf;
+   /* No data if there is no Data Storage */
+   uint16_t arg_block_ds_data_len = ds->master_ds.valid ? ds->master_ds.size
+                                                        : 0;
+
+   if (
+      (exp_arg_block_id != IOLINK_ARG_BLOCK_ID_DS_DATA) ||
+      (ref_arg_block_id != IOLINK_ARG_BLOCK_ID_VOID_BLOCK))
+   {
+      iolink_smi_joberror_ind (
+         port,
+         exp_arg_block_id,
+         ref_arg_block_id,
+         IOLINK_SMI_ERRORTYPE_ARGBLOCK_NOT_SUPPORTED);
+      return IOLINK_ERROR_PARAMETER_CONFLICT;
+   }
+
+   memset (arg_block_ds_data, 0, sizeof (arg_block_ds_data_t));
+   arg_block_ds_data->arg_block.id = IOLINK_ARG_BLOCK_ID_DS_DATA;
+
+   if (ds->master_ds.valid)
+   {
+      arg_block_ds_data->checksum = ds->master_ds.cs;
+      arg_block_ds_data->vid      = ds->master_ds.vid;
+      arg_block_ds_data->did      = ds->master_ds.did;
+      arg_block_ds_data->fid      = ds->master_ds.fid;
+      memcpy (
+         arg_block_ds_data->ds_data,
+         ds->master_ds.data,
+         arg_block_ds_data_len);
+   }
+
+   iolink_smi_cnf (
+      port,
+      ref_arg_block_id,
+      sizeof (arg_block_ds_data_t) + arg_block_ds_data_len,
+      (arg_block_t *)arg_block_ds_data);
+
+   return IOLINK_ERROR_NONE;
+}
+
+iolink_error_t ds_SMI_DSToParServ_req (
+   iolink_port_t * port,
+   iolink_arg_block_id_t exp_arg_block_id,
+   uint16_t arg_block_len,
+   arg_block_t * arg_block)
+{
+   iolink_error_t error;
+
+   ds_lock (port);
+   error = ds_to_par_serv (port, exp_arg_block_id, arg_block_len, arg_block);
+   ds_unlock (port);
+
+   return error;
+}
+
+/*
+ * Data Storage image of all ports, see iolink_ds_export(). Big-endian,
+ * so that an image can be moved between masters:
+ *
+ *   header   magic (4), version (1), entry count (1), reserved (2),
+ *            length of the image (4)
+ *   entry    portnumber (1), flags (1), vendorid (2), deviceid (4),
+ *            functionid (2), checksum (4), size (2), data (size)
+ *   trailer  CRC-32 of all preceding octets (4)
+ */
+#define DS_IMAGE_MAGIC       0x494F4453 /* "IODS" */
+#define DS_IMAGE_VERSION     1
+#define DS_IMAGE_FLAG_VALID  0x01
+#define DS_IMAGE_HDR_LEN     12
+#define DS_IMAGE_ENTRY_LEN   16
+#define DS_IMAGE_TRAILER_LEN 4
+
+static void ds_put_u16 (uint8_t * p, uint16_t value)
+{
+   p[0] = value >> 8;
+   p[1] = value & 0xFF;
+}
+
+static void ds_put_u32 (uint8_t * p, uint32_t value)
+{
+   p[0] = value >> 24;
+   p[1] = (value >> 16) & 0xFF;
+   p[2] = (value >> 8) & 0xFF;
+   p[3] = value & 0xFF;
+}
+
+static uint16_t ds_get_u16 (const uint8_t * p)
+{
+   return (p[0] << 8) | p[1];
+}
+
+static uint32_t ds_get_u32 (const uint8_t * p)
+{
+   return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+          ((uint32_t)p[2] << 8) | p[3];
+}
+
+static iolink_error_t ds_export (
+   iolink_m_t * master,
+   uint8_t * image,
+   uint32_t size,
+   uint32_t * len)
+{
+   uint8_t port_cnt = iolink_get_port_cnt (iolink_get_port (master, 1));
+   uint32_t pos     = DS_IMAGE_HDR_LEN;
+   uint8_t portnumber;
+
+   for (portnumber = 1; portnumber <= port_cnt; portnumber++)
+   {
+      iolink_port_t * port  = iolink_get_port (master, portnumber);
+      iolink_ds_port_t * ds = iolink_get_ds_ctx (port);
+      uint16_t data_len     = ds->master_ds.valid ? ds->master_ds.size : 0;
+      uint8_t * entry       = &image[pos];
+
+      if (pos + DS_IMAGE_ENTRY_LEN + data_len + DS_IMAGE_TRAILER_LEN > size)
+      {
+         return IOLINK_ERROR_PARAMETER_CONFLICT;
+      }
+
+      memset (entry, 0, DS_IMAGE_ENTRY_LEN);
+      entry[0] = portnumber;
+      if (ds->master_ds.valid)
+      {
+         entry[1] = DS_IMAGE_FLAG_VALID;
+         ds_put_u16 (&entry[2], ds->master_ds.vid);
+         ds_put_u32 (&entry[4], ds->master_ds.did);
+         ds_put_u16 (&entry[8], ds->master_ds.fid);
+         ds_put_u32 (&entry[10], ds->master_ds.cs);
+         ds_put_u16 (&entry[14], data_len);
+         memcpy (&entry[DS_IMAGE_ENTRY_LEN], ds->master_ds.data, data_len);
+      }
+
+      pos += DS_IMAGE_ENTRY_LEN + data_len;
+   }
+
+   ds_put_u32 (&image[0], DS_IMAGE_MAGIC);
+   image[4] = DS_IMAGE_VERSION;
+   image[5] = port_cnt;
+   ds_put_u16 (&image[6], 0);
+   ds_put_u32 (&image[8], pos + DS_IMAGE_TRAILER_LEN);
+   ds_put_u32 (&image[pos], ds_crc32 (0, image, pos));
+
+   *len = pos + DS_IMAGE_TRAILER_LEN;
+
+   return IOLINK_ERROR_NONE;
+}
+
+iolink_error_t ds_image_export (
+   iolink_m_t * master,
+   uint8_t * image,
+   uint32_t size,
+   uint32_t * len)
+{
+   iolink_error_t error;
+
+   ds_lock (iolink_get_port (master, 1));
+   error = ds_export (master, image, size, len);
+   ds_unlock (iolink_get_port (master, 1));
+
+   return error;
+}
+
+static iolink_error_t ds_import (
+   iolink_m_t * master,
+   const uint8_t * image,
+   uint32_t len)
+{
+   iolink_port_t * first             = iolink_get_port (master, 1);
+   uint8_t port_cnt                  = iolink_get_port_cnt (first);
+   iolink_arena_t * arena            = iolink_get_ds_arena (first);
+   uint32_t end                      = len - DS_IMAGE_TRAILER_LEN;
+   uint32_t pos                      = DS_IMAGE_HDR_LEN;
+   bool seen[IOLINK_NUM_PORTS]       = {false};
+   ds_set_t * sets[IOLINK_NUM_PORTS] = {NULL}; /* Of each entry */
+   uint8_t entry_cnt;
+   uint8_t i;
+
+   if (
+      (len < DS_IMAGE_HDR_LEN + DS_IMAGE_TRAILER_LEN) ||
+      (ds_get_u32 (&image[0]) != DS_IMAGE_MAGIC) ||
+      (image[4] != DS_IMAGE_VERSION) || (ds_get_u32 (&image[8]) != len) ||
+      (ds_get_u32 (&image[end]) != ds_crc32 (0, image, end)))
+   {
+      return IOLINK_ERROR_PARAMETER_CONFLICT;
+   }
+
+   /* Check all entries before any port is changed */
+   entry_cnt = image[5];
+   for (i = 0; i < entry_cnt; i++)
+   {
+      const uint8_t * entry = &image[pos];
+
+      if (
+         (pos + DS_IMAGE_ENTRY_LEN > end) || (entry[0] == 0) ||
+         (entry[0] > port_cnt) || seen[entry[0] - 1] ||
+         (ds_get_u16 (&entry[14]) > IOLINK_DS_MAX_SIZE))
+      {
+         return IOLINK_ERROR_PARAMETER_CONFLICT;
+      }
+
+      /* No upload or download may be in progress */
+      if (!ds_is_idle (iolink_get_ds_ctx (iolink_get_port (master, entry[0]))))
+      {
+         return IOLINK_ERROR_STATE_CONFLICT;
+      }
+
+      seen[entry[0] - 1] = true;
+      pos += DS_IMAGE_ENTRY_LEN + ds_get_u16 (&entry[14]);
+   }
+
+   if (pos != end)
+   {
+      return IOLINK_ERROR_PARAMETER_CONFLICT;
+   }
+
+   /* Allocate all sets, so that the import can not fail half way. A set
+    * of the same size, not shared, is overwritten in place. */
+   pos = DS_IMAGE_HDR_LEN;
+   for (i = 0; i < entry_cnt; i++)
+   {
+      const uint8_t * entry = &image[pos];
+      iolink_ds_port_t * ds =
+         iolink_get_ds_ctx (iolink_get_port (master, entry[0]));
+      uint16_t data_len = ds_get_u16 (&entry[14]);
+
+      if (
+         (entry[1] & DS_IMAGE_FLAG_VALID) && (data_len > 0) &&
+         ((data_len != ds->master_ds.size_max) || ds_data_shared (ds)))
+      {
+         sets[i] = iolink_arena_alloc (arena, DS_SET_HDR_LEN + data_len);
+         if (sets[i] == NULL)
+         {
+            while (i-- > 0)
+            {
+               iolink_arena_free (arena, sets[i]);
+            }
+            return IOLINK_ERROR_OUT_OF_MEMORY;
+         }
+      }
+
+      pos += DS_IMAGE_ENTRY_LEN + data_len;
+   }
+
+   pos = DS_IMAGE_HDR_LEN;
+   for (i = 0; i < entry_cnt; i++)
+   {
+      const uint8_t * entry = &image[pos];
+      iolink_port_t * port  = iolink_get_port (master, entry[0]);
+      iolink_ds_port_t * ds = iolink_get_ds_ctx (port);
+      uint16_t data_len     = ds_get_u16 (&entry[14]);
+
+      if (entry[1] & DS_IMAGE_FLAG_VALID)
+      {
+         if (sets[i] != NULL)
+         {
+            ds_data_put (port);
+            sets[i]->refcnt        = 1;
+            ds->master_ds.data     = (uint8_t *)(sets[i] + 1);
+            ds->master_ds.size_max = data_len;
+         }
+         else if (data_len == 0)
+         {
+            ds_data_put (port);
+         }
+         if (data_len > 0)
+         {
+            memcpy (ds->master_ds.data, &entry[DS_IMAGE_ENTRY_LEN], data_len);
+         }
+
+         ds->master_ds.vid   = ds_get_u16 (&entry[2]);
+         ds->master_ds.did   = ds_get_u32 (&entry[4]);
+         ds->master_ds.fid   = ds_get_u16 (&entry[8]);
+         ds->master_ds.cs    = ds_get_u32 (&entry[10]);
+         ds->master_ds.size  = data_len;
+         ds->master_ds.valid = true;
+         ds->master_ds.crc   = ds_crc32 (0, ds->master_ds.data, data_len);
+      }
+      else
+      {
+         ds_delete (port, DS_EVENT_NONE);
+      }
+
+      pos += DS_IMAGE_ENTRY_LEN + data_len;
+   }
+
+   /* Shared once all sets are in place, an overwritten set may not be
+    * shared before that */
+   pos = DS_IMAGE_HDR_LEN;
+   for (i = 0; i < entry_cnt; i++)
+   {
+      const uint8_t * entry = &image[pos];
+      iolink_port_t * port  = iolink_get_port (master, entry[0]);
+
+      if (entry[1] & DS_IMAGE_FLAG_VALID)
+      {
+         ds_share (port);
+         ds_store (port);
+      }
+
+      pos += DS_IMAGE_ENTRY_LEN + ds_get_u16 (&entry[14]);
+   }
+
+   return IOLINK_ERROR_NONE;
+}
+
+iolink_error_t ds_image_import (
+   iolink_m_t * master,
+   const uint8_t * image,
+   uint32_t len)
+{
+   iolink_error_t error;
+
+   ds_lock (iolink_get_port (master, 1));
+   error = ds_import (master, image, len);
+   ds_unlock (iolink_get_port (master, 1));
+
+   return error;
+}
+
+static iolink_error_t ds_push (
+   iolink_m_t * master,
+   const iolink_ds_record_t * record,
+   uint8_t * port_cnt)
+{
+   uint8_t cnt           = iolink_get_port_cnt (iolink_get_port (master, 1));
+   iolink_port_t * first = NULL;
+   uint8_t applied       = 0;
+   uint8_t portnumber;
+
+   if (
+      (record->vendorid == 0) || (record->size > IOLINK_DS_MAX_SIZE) ||
+      ((record->size > 0) && (record->data == NULL)))
+   {
+      return IOLINK_ERROR_PARAMETER_CONFLICT;
+   }
+
+   for (portnumber = 1; portnumber <= cnt; portnumber++)
+   {
+      iolink_port_t * port  = iolink_get_port (master, portnumber);
+      iolink_ds_port_t * ds = iolink_get_ds_ctx (port);
+      bool match =
+         ((ds->pending_id.vendorid == record->vendorid) &&
+          (ds->pending_id.deviceid == record->deviceid)) ||
+         ((ds->master_ds.vid == record->vendorid) &&
+          (ds->master_ds.did == record->deviceid));
+
+      if (!match || !ds_is_idle (ds))
+      {
+         continue;
+      }
+
+      /* The first port gets a copy of the set, the others share it */
+      if (first == NULL)
+      {
+         if (!ds_data_resize (port, record->size))
+         {
+            return IOLINK_ERROR_OUT_OF_MEMORY;
+         }
+         if (record->size > 0)
+         {
+            memcpy (ds->master_ds.data, record->data, record->size);
+         }
+         first = port;
+      }
+      else if (record->size > 0)
+      {
+         ds_data_adopt (port, first);
+      }
+      else
+      {
+         ds_data_put (port);
+      }
+
+      ds->master_ds.vid   = record->vendorid;
+      ds->master_ds.did   = record->deviceid;
+      ds->master_ds.fid   = record->functionid;
+      ds->master_ds.cs    = record->cs;
+      ds->master_ds.size  = record->size;
+      ds->master_ds.valid = true;
+      ds->master_ds.crc   = ds_crc32 (0, record->data, record->size);
+      ds_store (port);
+      applied++;
+   }
+
+   if (port_cnt != NULL)
+   {
+      *port_cnt = applied;
+   }
+
+   return IOLINK_ERROR_NONE;
+}
+
+iolink_error_t ds_template_push (
+   iolink_m_t * master,
+   const iolink_ds_record_t * record,
+   uint8_t * port_cnt)
+{
+   iolink_error_t error;
+
+   ds_lock (iolink_get_port (master, 1));
+   error = ds_push (master, record, port_cnt);
+   ds_unlock (iolink_get_port (master, 1));
+
+   return error;
+}
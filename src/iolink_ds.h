@@ -24,6 +24,7 @@
 
 #include "iolink_types.h"
 #include "iolink_main.h"
+#include "iolink_arena.h"
 
 #include "sys/osal_cc.h"
 
@@ -31,14 +32,34 @@
 extern "C" {
 #endif
 
-#define IOLINK_DS_MAX_SIZE 2048
-
 #define DS_STATE_PROPERTY_STATE_MASK     (3 << 1)
 #define DS_STATE_PROPERTY_STATE_UPLOAD   (1 << 1)
 #define DS_STATE_PROPERTY_STATE_DOWNLOAD (2 << 1)
 #define DS_STATE_PROPERTY_STATE_LOCKED   (3 << 1)
 #define DS_STATE_PROPERTY_UPLOAD_REQ     BIT (7)
 
+/* Record of master_ds.data: index (2), subindex (1), length (1), data */
+#define DS_RECORD_HDR_LEN 4
+
+#define DS_INDEX_LIST_MAX_ENTRIES 70
+#define DS_DL_PLAN_MAX_RECORDS    (IOLINK_DS_MAX_SIZE / DS_RECORD_HDR_LEN)
+
+/* Reference count preceding each set in the DS arena, identical sets of
+ * several ports are kept once */
+#define DS_SET_HDR_LEN 8
+
+/* Octets of the DS arena used by a set of size octets */
+#define DS_SET_BLOCK_SIZE(size)                                                \
+   IOLINK_ARENA_BLOCK_SIZE (DS_SET_HDR_LEN + (size))
+
+/* Octets of the DS arena used by one port in the worst case: a full set,
+ * the index list and the download plan */
+#define DS_ARENA_PORT_SIZE                                                     \
+   (DS_SET_BLOCK_SIZE (IOLINK_DS_MAX_SIZE) +                                   \
+    IOLINK_ARENA_BLOCK_SIZE (                                                  \
+       DS_INDEX_LIST_MAX_ENTRIES * sizeof (ds_index_list_entry_t)) +           \
+    IOLINK_ARENA_BLOCK_SIZE (DS_DL_PLAN_MAX_RECORDS * sizeof (uint16_t)))
+
 typedef enum iolink_ds_command
 {
    DS_CMD_RES      = 0x00,
@@ -106,16 +127,21 @@ typedef struct iolink_ds_port
       uint16_t fid;
       bool valid;
       uint32_t size;
-      uint32_t size_max;
+      uint32_t size_max; /* Capacity of data */
+      uint32_t crc;      /* CRC-32 of data, kept as data is changed */
 
       uint16_t pos; /* Position in data */
-      uint8_t data[IOLINK_DS_MAX_SIZE];
+      /* From the DS arena, NULL if size_max is 0. May be shared with other
+       * ports holding the same set, it is copied before it is changed.
+       * Used under the DS mutex, see iolink_get_ds_mtx() */
+      uint8_t * data;
    } master_ds;
    struct
    {
       uint8_t count;
       uint8_t pos; /* Position in entries */
-      ds_index_list_entry_t entries[70];
+      /* From the DS arena during an upload, count entries */
+      ds_index_list_entry_t * entries;
    } index_list;
 
    iolink_ds_command_t command;
@@ -127,6 +153,31 @@ typedef struct iolink_ds_port
       uint16_t vendorid;
       uint32_t deviceid;
    } pending_id;
+
+   /* Persistence backend of master_ds, NULL if none */
+   const iolink_ds_storage_t * storage;
+
+   struct
+   {
+      bool prefetched; /* Next read requested before the previous cnf */
+      uint8_t param_cnt;
+      uint32_t start_us;
+      /* Set before the upload, to skip storing an identical set */
+      bool prev_valid;
+      uint32_t prev_crc;
+      uint32_t prev_size;
+   } upload;
+   struct
+   {
+      uint16_t cnt;  /* Records in the set */
+      uint16_t next; /* Next record to write */
+      uint16_t done; /* Records confirmed by the device */
+      uint32_t start_us;
+      /* Offset of each record in master_ds.data, from the DS arena
+       * during a download */
+      uint16_t * offset;
+   } dl_plan;
+   iolink_ds_stats_t stats;
 } iolink_ds_port_t;
 
 /**
@@ -171,7 +222,9 @@ typedef enum iolink_fsm_ds_event
    DS_EVENT_LAST,
 } iolink_fsm_ds_event_t;
 
-void iolink_ds_init (iolink_port_t * port);
+void iolink_ds_init (
+   iolink_port_t * port,
+   const iolink_ds_storage_t * storage);
 
 iolink_error_t DS_Delete (iolink_port_t * port);
 
@@ -183,6 +236,15 @@ iolink_error_t DS_Init (
    iolink_port_t * port, // Not in spec
    const portconfiglist_t * cfg_list);
 
+/**
+ * Release the DS arena memory of a deactivated port. A valid set is kept,
+ * shrunk to its size. Not in spec.
+ *
+ * @param port             Port
+ * @return                 Error type
+ */
+iolink_error_t DS_Release (iolink_port_t * port);
+
 bool DS_Chk_Cfg (iolink_port_t * port, const portconfiglist_t * cfg_list);
 
 iolink_error_t ds_SMI_ParServToDS_req (
@@ -196,6 +258,50 @@ iolink_error_t ds_SMI_DSToParServ_req (
    iolink_arg_block_id_t exp_arg_block_id,
    uint16_t arg_block_len,
    arg_block_t * arg_block);
+
+/**
+ * Export the Data Storage of all ports to an image
+ *
+ * @param master           Master
+ * @param image            Destination
+ * @param size             Size of image
+ * @param len              Length of the exported image
+ * @return                 Error type
+ */
+iolink_error_t ds_image_export (
+   iolink_m_t * master,
+   uint8_t * image,
+   uint32_t size,
+   uint32_t * len);
+
+/**
+ * Import the Data Storage of all ports from an image made by
+ * ds_image_export(). Nothing is changed if the image is not valid, a port
+ * of it is not idle, or the sets do not fit in the DS arena.
+ *
+ * @param master           Master
+ * @param image            Image
+ * @param len              Length of image
+ * @return                 Error type
+ */
+iolink_error_t ds_image_import (
+   iolink_m_t * master,
+   const uint8_t * image,
+   uint32_t len);
+
+/**
+ * Give a Data Storage set to all ports configured for, or holding a set
+ * of, the device of record. The ports share one copy of the set.
+ *
+ * @param master           Master
+ * @param record           Set
+ * @param port_cnt         Number of ports given the set, or NULL
+ * @return                 Error type
+ */
+iolink_error_t ds_template_push (
+   iolink_m_t * master,
+   const iolink_ds_record_t * record,
+   uint8_t * port_cnt);
 #ifdef __cplusplus
 }
 #endif
@@ -19,13 +19,17 @@
 #endif /* UNIT_TEST */
 
 #include "iolink_main.h"
-#include "iolink_al.h"  /* iolink_al_init */
-#include "iolink_cm.h"  /* iolink_cm_init */
-#include "iolink_ds.h"  /* iolink_ds_init ds_SMI_ParServToDS_req */
-#include "iolink_ode.h" /* iolink_ode_init */
-#include "iolink_pde.h" /* iolink_pde_init */
-#include "iolink_pl.h"  /* iolink_pl_init */
-#include "iolink_sm.h"  /* iolink_sm_init */
+#include "iolink_al.h"      /* iolink_al_init, iolink_al_set_pd_filter */
+#include "iolink_arena.h"   /* iolink_arena_init */
+#include "iolink_cm.h"      /* iolink_cm_init */
+#include "iolink_ds.h"      /* iolink_ds_init ds_SMI_ParServToDS_req */
+#include "iolink_ode.h"     /* iolink_ode_init */
+#include "iolink_pde.h"     /* iolink_pde_init */
+#include "iolink_pdx.h"     /* iolink_pdx_add, iolink_pdx_decode */
+#include "iolink_pi.h"      /* iolink_pi_init */
+#include "iolink_pl.h"      /* iolink_pl_init */
+#include "iolink_sm.h"      /* iolink_sm_init */
+#include "iolink_startup.h" /* iolink_startup_init */
 
 #include "osal.h"
 
@@ -40,6 +44,22 @@
 #define IOLINK_MASTER_JOB_CNT     40
 #define IOLINK_MASTER_JOB_API_CNT 10
 
+/* Data Storage arena for port_cnt ports, unless set by IOLINK_DS_ARENA_SIZE:
+ * the worst case of each port and a spare set, so that a set can be moved
+ * when it grows */
+#define IOLINK_DS_ARENA_DEFAULT_SIZE(port_cnt)                                 \
+   ((port_cnt) * DS_ARENA_PORT_SIZE + DS_SET_BLOCK_SIZE (IOLINK_DS_MAX_SIZE))
+
+#ifdef IOLINK_DS_STATIC_ARENA
+#if IOLINK_DS_ARENA_SIZE > 0
+#define IOLINK_DS_STATIC_ARENA_SIZE IOLINK_DS_ARENA_SIZE
+#else
+#define IOLINK_DS_STATIC_ARENA_SIZE                                            \
+   IOLINK_DS_ARENA_DEFAULT_SIZE (IOLINK_NUM_PORTS)
+#endif
+static uint64_t ds_arena_mem[(IOLINK_DS_STATIC_ARENA_SIZE + 7) / 8];
+#endif
+
 typedef struct iolink_port
 {
    iolink_m_t * master;
@@ -83,6 +103,21 @@ typedef struct iolink_m
       uint8_t data_len,
       const uint8_t * data);
 
+   /* Process image */
+   iolink_pi_t pi;
+
+   /* PD field extraction */
+   iolink_pdx_t pdx;
+
+   /* Data Storage sets, index lists and download plans of all ports */
+   iolink_arena_t ds_arena;
+   /* Serialises the Data Storage sets, which may be shared between ports,
+    * between the master thread and the API */
+   os_mutex_t * ds_mtx;
+
+   /* Wake-up scheduling of all ports */
+   iolink_startup_t startup;
+
    uint8_t port_cnt;
    struct iolink_port ports[];
 } iolink_m_t;
@@ -189,6 +224,7 @@ static void iolink_main (void * arg)
       case IOLINK_JOB_SM_SET_PORT_CFG_REQ:
       case IOLINK_JOB_DL_MODE_IND:
       case IOLINK_JOB_DL_READ_CNF:
+      case IOLINK_JOB_DL_READPAGE_CNF:
       case IOLINK_JOB_DL_WRITE_CNF:
       case IOLINK_JOB_DL_WRITE_DEVMODE_CNF:
       case IOLINK_JOB_DL_READPARAM_CNF:
@@ -210,6 +246,7 @@ static void iolink_main (void * arg)
       case IOLINK_JOB_DS_READY:
       case IOLINK_JOB_DS_CHANGE:
       case IOLINK_JOB_DS_FAULT:
+      case IOLINK_JOB_DS_RELEASE:
       case IOLINK_JOB_OD_START:
       case IOLINK_JOB_OD_STOP:
       case IOLINK_JOB_AL_EVENT_RSP:
@@ -217,6 +254,7 @@ static void iolink_main (void * arg)
          {
             job->callback (job);
          }
+         iolink_pi_update_port_info (job->port);
          job->type     = IOLINK_JOB_NONE;
          job->callback = NULL;
          os_mbox_post (master->mbox_avail, job, 0);
@@ -230,10 +268,13 @@ static void iolink_main (void * arg)
       case IOLINK_JOB_SMI_DEVICE_WRITE:
       case IOLINK_JOB_SMI_PARAM_READ:
       case IOLINK_JOB_SMI_PARAM_WRITE:
+      case IOLINK_JOB_SMI_OD_CANCEL:
+      case IOLINK_JOB_PI_OUTPUT:
          if (job->callback)
          {
             job->callback (job);
          }
+         iolink_pi_update_port_info (job->port);
          job->type     = IOLINK_JOB_NONE;
          job->callback = NULL;
          os_mbox_post (master->mbox_api_avail, job, 0);
@@ -417,6 +458,11 @@ uint8_t iolink_get_port_cnt (iolink_port_t * port)
    return port->master->port_cnt;
 }
 
+iolink_m_t * iolink_get_master (iolink_port_t * port)
+{
+   return port->master;
+}
+
 iolink_port_info_t * iolink_get_port_info (iolink_port_t * port)
 {
    return &port->port_info;
@@ -472,10 +518,36 @@ iolink_sm_port_t * iolink_get_sm_ctx (iolink_port_t * port)
    return &port->sm;
 }
 
+iolink_pi_t * iolink_get_pi (iolink_port_t * port)
+{
+   return &port->master->pi;
+}
+
+iolink_pdx_t * iolink_get_pdx (iolink_port_t * port)
+{
+   return &port->master->pdx;
+}
+
+iolink_arena_t * iolink_get_ds_arena (iolink_port_t * port)
+{
+   return &port->master->ds_arena;
+}
+
+os_mutex_t * iolink_get_ds_mtx (iolink_port_t * port)
+{
+   return port->master->ds_mtx;
+}
+
+iolink_startup_t * iolink_get_startup (iolink_port_t * port)
+{
+   return &port->master->startup;
+}
+
 /* Public APIs */
 iolink_m_t * iolink_m_init (const iolink_m_cfg_t * m_cfg)
 {
    int i;
+   bool ok;
 
    if (the_master != NULL)
    {
@@ -497,6 +569,35 @@ iolink_m_t * iolink_m_init (const iolink_m_cfg_t * m_cfg)
 
    master->has_exited = false;
 
+   if (!iolink_pi_init (&master->pi, m_cfg))
+   {
+      free (master);
+      return NULL;
+   }
+
+#ifdef IOLINK_DS_STATIC_ARENA
+   ok = iolink_arena_init (
+      &master->ds_arena,
+      ds_arena_mem,
+      sizeof (ds_arena_mem));
+#else
+   ok = iolink_arena_init (
+      &master->ds_arena,
+      NULL,
+      (IOLINK_DS_ARENA_SIZE > 0)
+         ? IOLINK_DS_ARENA_SIZE
+         : IOLINK_DS_ARENA_DEFAULT_SIZE (m_cfg->port_cnt));
+#endif
+   if (!ok)
+   {
+      iolink_pi_deinit (&master->pi);
+      free (master);
+      return NULL;
+   }
+   master->ds_mtx = os_mutex_create();
+
+   iolink_startup_init (&master->startup, m_cfg);
+
    master->port_cnt = m_cfg->port_cnt;
    master->cb_arg   = m_cfg->cb_arg;
    master->cb_smi   = m_cfg->cb_smi;
@@ -516,8 +617,11 @@ iolink_m_t * iolink_m_init (const iolink_m_cfg_t * m_cfg)
       iolink_sm_init (port);
       iolink_al_init (port);
       iolink_cm_init (port);
-      iolink_ds_init (port);
-      iolink_ode_init (port);
+      iolink_ds_init (port, m_cfg->ds_storage);
+      iolink_ode_init (
+         port,
+         m_cfg->od_queue_timeout_ms,
+         m_cfg->od_cache_ttl_ms);
       iolink_pde_init (port);
    }
 
@@ -579,11 +683,17 @@ void iolink_m_deinit (iolink_m_t ** m)
       iolink_port_t * port = &(master->ports[i]);
 
       os_mutex_destroy (port->al.mtx_pdin);
+      os_mutex_destroy (port->al.diag.mtx);
+      os_mutex_destroy (port->al.event_ring.mtx);
    }
 
    os_mbox_destroy (master->mbox);
    os_mbox_destroy (master->mbox_avail);
    os_mbox_destroy (master->mbox_api_avail);
+   iolink_pi_deinit (&master->pi);
+   iolink_arena_deinit (&master->ds_arena);
+   os_mutex_destroy (master->ds_mtx);
+   iolink_startup_deinit (&master->startup);
 
    the_master = NULL;
    free (*m);
@@ -737,6 +847,248 @@ iolink_error_t SMI_ParamWriteBatch_req (
       ode_SMI_ParamWriteBatch_req);
 }
 
+iolink_error_t SMI_ODCancel_req (uint8_t portnumber, arg_block_t * arg_block)
+{
+   iolink_port_t * port = NULL;
+
+   iolink_error_t error = common_smi_check (portnumber, arg_block, &port);
+
+   if (error != IOLINK_ERROR_NONE)
+   {
+      return error;
+   }
+
+   return ode_SMI_ODCancel_req (port, arg_block);
+}
+
+iolink_error_t iolink_pd_filter_set (
+   uint8_t portnumber,
+   const iolink_pd_filter_t * filter)
+{
+   iolink_port_t * port = NULL;
+   iolink_error_t error = portnumber_to_iolinkport (portnumber, &port);
+   uint8_t i;
+
+   if (error != IOLINK_ERROR_NONE)
+   {
+      return error;
+   }
+
+   if (filter != NULL)
+   {
+      if (filter->heartbeat_ms > IOLINK_PD_FILTER_MAX_HEARTBEAT_MS)
+      {
+         return IOLINK_ERROR_PARAMETER_CONFLICT;
+      }
+
+      for (i = 0; i < IOLINK_PD_FILTER_FIELDS; i++)
+      {
+         const iolink_pd_filter_field_t * field = &filter->fields[i];
+
+         switch (field->len)
+         {
+         case 0:
+            continue;
+         case 1:
+         case 2:
+         case 4:
+            break;
+         default:
+            return IOLINK_ERROR_PARAMETER_CONFLICT;
+         }
+
+         if (field->offset + field->len > IOLINK_PD_MAX_SIZE)
+         {
+            return IOLINK_ERROR_PARAMETER_CONFLICT;
+         }
+      }
+   }
+
+   iolink_al_set_pd_filter (port, filter);
+
+   return IOLINK_ERROR_NONE;
+}
+
+iolink_error_t iolink_diag_read (
+   uint8_t portnumber,
+   diag_entry_t * entries,
+   uint8_t * cnt)
+{
+   iolink_port_t * port = NULL;
+   iolink_error_t error = portnumber_to_iolinkport (portnumber, &port);
+
+   if (error != IOLINK_ERROR_NONE)
+   {
+      return error;
+   }
+
+   *cnt = iolink_al_diag_read (port, entries, *cnt);
+
+   return IOLINK_ERROR_NONE;
+}
+
+iolink_error_t iolink_event_read (
+   uint8_t portnumber,
+   diag_entry_t * entries,
+   uint8_t * cnt,
+   uint32_t * dropped)
+{
+   iolink_port_t * port = NULL;
+   iolink_error_t error = portnumber_to_iolinkport (portnumber, &port);
+
+   if (error != IOLINK_ERROR_NONE)
+   {
+      return error;
+   }
+
+   *cnt = iolink_al_event_read (port, entries, *cnt, dropped);
+
+   return IOLINK_ERROR_NONE;
+}
+
+iolink_error_t iolink_pd_read (uint8_t portnumber, iolink_pd_t * pd)
+{
+   iolink_port_t * port = NULL;
+   iolink_error_t error = portnumber_to_iolinkport (portnumber, &port);
+
+   if (error != IOLINK_ERROR_NONE)
+   {
+      return error;
+   }
+
+   return AL_GetPD_req (port, pd);
+}
+
+iolink_error_t iolink_pd_desc_add (const iolink_pd_desc_t * desc)
+{
+   if (the_master == NULL)
+   {
+      return IOLINK_ERROR_STATE_INVALID;
+   }
+
+   return iolink_pdx_add (&the_master->pdx, desc);
+}
+
+iolink_error_t iolink_pd_decode (
+   uint8_t portnumber,
+   float * values,
+   uint8_t * cnt)
+{
+   iolink_port_t * port = NULL;
+   iolink_error_t error = portnumber_to_iolinkport (portnumber, &port);
+
+   if (error != IOLINK_ERROR_NONE)
+   {
+      return error;
+   }
+
+   return iolink_pdx_decode (port, values, cnt);
+}
+
+iolink_error_t iolink_ds_export (
+   uint8_t * image,
+   uint32_t size,
+   uint32_t * len)
+{
+   if (the_master == NULL)
+   {
+      return IOLINK_ERROR_STATE_INVALID;
+   }
+
+   return ds_image_export (the_master, image, size, len);
+}
+
+iolink_error_t iolink_ds_import (const uint8_t * image, uint32_t len)
+{
+   if (the_master == NULL)
+   {
+      return IOLINK_ERROR_STATE_INVALID;
+   }
+
+   return ds_image_import (the_master, image, len);
+}
+
+iolink_error_t iolink_ds_push_template (
+   const iolink_ds_record_t * record,
+   uint8_t * port_cnt)
+{
+   if (the_master == NULL)
+   {
+      return IOLINK_ERROR_STATE_INVALID;
+   }
+
+   return ds_template_push (the_master, record, port_cnt);
+}
+
+iolink_error_t iolink_ds_get_stats (
+   uint8_t portnumber,
+   iolink_ds_stats_t * stats)
+{
+   iolink_port_t * port = NULL;
+   iolink_error_t error = portnumber_to_iolinkport (portnumber, &port);
+
+   if (error != IOLINK_ERROR_NONE)
+   {
+      return error;
+   }
+
+   *stats = port->ds.stats;
+
+   return IOLINK_ERROR_NONE;
+}
+
+iolink_error_t iolink_startup_get_timeline (
+   uint8_t portnumber,
+   iolink_startup_timeline_t * timeline)
+{
+   iolink_port_t * port = NULL;
+   iolink_error_t error = portnumber_to_iolinkport (portnumber, &port);
+
+   if (error != IOLINK_ERROR_NONE)
+   {
+      return error;
+   }
+
+   iolink_startup_read_timeline (&port->master->startup, portnumber, timeline);
+
+   return IOLINK_ERROR_NONE;
+}
+
+iolink_error_t iolink_startup_get_report (iolink_startup_report_t * report)
+{
+   if (the_master == NULL)
+   {
+      return IOLINK_ERROR_STATE_INVALID;
+   }
+
+   iolink_startup_read_report (&the_master->startup, report);
+
+   return IOLINK_ERROR_NONE;
+}
+
+iolink_error_t iolink_pi_read_input (
+   void * data,
+   uint16_t len,
+   uint32_t * generation)
+{
+   if ((the_master == NULL) || (the_master->pi.mem == NULL))
+   {
+      return IOLINK_ERROR_STATE_INVALID;
+   }
+
+   return pi_read_input (&the_master->pi, data, len, generation);
+}
+
+iolink_error_t iolink_pi_write_output (const void * data, uint16_t len)
+{
+   if ((the_master == NULL) || (the_master->pi.mem == NULL))
+   {
+      return IOLINK_ERROR_STATE_INVALID;
+   }
+
+   return pi_write_output (&the_master->ports[0], data, len);
+}
+
 iolink_error_t SMI_PDIn_req (
    uint8_t portnumber,
    iolink_arg_block_id_t exp_arg_block_id,
@@ -779,6 +1131,20 @@ iolink_error_t SMI_PDInOut_req (
       pde_SMI_PDInOut_req);
 }
 
+iolink_error_t SMI_DSToParServ_req (
+   uint8_t portnumber,
+   iolink_arg_block_id_t exp_arg_block_id,
+   uint16_t arg_block_len,
+   arg_block_t * arg_block)
+{
+   return SMI_common_req (
+      portnumber,
+      exp_arg_block_id,
+      arg_block_len,
+      arg_block,
+      ds_SMI_DSToParServ_req);
+}
+
 iolink_error_t SMI_ParServToDS_req (
    uint8_t portnumber,
    iolink_arg_block_id_t exp_arg_block_id,
@@ -0,0 +1,440 @@
+/*********************************************************************
+ *        _       _         _
+ *  _ __ | |_  _ | |  __ _ | |__   ___
+ * | '__|| __|(_)| | / _` || '_ \ / __|
+ * | |   | |_  _ | || (_| || |_) |\__ \
+ * |_|    \__|(_)|_| \__,_||_.__/ |___/
+ *
+ * www.rt-labs.com
+ * Copyright 2024 rt-labs AB, Sweden.
+ *
+ * This software is dual-licensed under GPLv3 and a commercial
+ * license. See the file LICENSE.md distributed with this software for
+ * full license information.
+ ********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "iolink_max14819_bus.h"
+
+/**
+ * @file
+ * @brief SPI bus scheduler for MAX14819 chips
+ *
+ */
+
+#define IOLINK_14819_BUS_GRANT BIT (0)
+
+static bool iolink_14819_bus_before (uint32_t a, uint32_t b)
+{
+   return (int32_t)(a - b) < 0;
+}
+
+/* Insert dev in the queue, in order of deadline. Called with bus->mtx held */
+static void iolink_14819_bus_enqueue (
+   iolink_14819_bus_t * bus,
+   iolink_14819_bus_dev_t * dev)
+{
+   iolink_14819_bus_dev_t ** pp = &bus->queue;
+
+   while (
+      (*pp != NULL) &&
+      !iolink_14819_bus_before (dev->deadline_us, (*pp)->deadline_us))
+   {
+      pp = &(*pp)->next;
+   }
+
+   dev->next = *pp;
+   *pp       = dev;
+}
+
+/*
+ * Issue the operations of the chips at the head of the queue in one vectored
+ * transfer. Called with bus->mtx held and the bus marked busy, the mutex is
+ * released during the transfer.
+ */
+static void iolink_14819_bus_run (iolink_14819_bus_t * bus)
+{
+   iolink_14819_bus_dev_t * batch  = NULL;
+   iolink_14819_bus_dev_t ** tail = &batch;
+   iolink_14819_bus_dev_t * dev;
+   uint8_t n = 0;
+   uint32_t start;
+   uint32_t end;
+
+   while (
+      (bus->queue != NULL) &&
+      (n + bus->queue->cnt <= IOLINK_14819_BUS_MAX_XFERS))
+   {
+      dev        = bus->queue;
+      bus->queue = dev->next;
+      dev->next  = NULL;
+
+      memcpy (&bus->vec[n], dev->xfer, dev->cnt * sizeof (iolink_spi_xfer_t));
+      n += dev->cnt;
+
+      *tail = dev;
+      tail  = &dev->next;
+   }
+
+   os_mutex_unlock (bus->mtx);
+   start = os_get_current_time_us();
+   _iolink_pl_hw_spi_transfer_vec (bus->fd_spi, bus->vec, n);
+   end = os_get_current_time_us();
+   os_mutex_lock (bus->mtx);
+
+   bus->busy_us += end - start;
+   bus->vectors++;
+
+   while (batch != NULL)
+   {
+      uint32_t latency;
+
+      dev     = batch;
+      batch   = dev->next;
+      latency = end - dev->request_us;
+
+      if (latency > bus->max_latency_us[dev->chip_address][dev->ch])
+      {
+         bus->max_latency_us[dev->chip_address][dev->ch] = latency;
+      }
+      if (iolink_14819_bus_before (dev->deadline_us, end))
+      {
+         bus->deadline_misses += dev->cnt;
+      }
+      bus->operations += dev->cnt;
+
+      dev->cnt  = 0;
+      dev->done = true;
+      os_event_set (dev->grant, IOLINK_14819_BUS_GRANT);
+   }
+}
+
+static void iolink_14819_bus_flush (iolink_14819_bus_dev_t * dev)
+{
+   iolink_14819_bus_t * bus = dev->bus;
+   uint32_t value;
+
+   if (dev->cnt == 0)
+   {
+      return;
+   }
+
+   os_mutex_lock (bus->mtx);
+   dev->done = false;
+   iolink_14819_bus_enqueue (bus, dev);
+
+   while (!dev->done)
+   {
+      if (!bus->busy)
+      {
+         /* Take the bus, issuing the operations of other queued chips
+          * as well */
+         bus->busy = true;
+         iolink_14819_bus_run (bus);
+         bus->busy = false;
+
+         if (bus->queue != NULL)
+         {
+            /* Hand the bus over to the most urgent waiting chip */
+            os_event_set (bus->queue->grant, IOLINK_14819_BUS_GRANT);
+         }
+         continue;
+      }
+
+      os_mutex_unlock (bus->mtx);
+      os_event_wait (dev->grant, IOLINK_14819_BUS_GRANT, &value, OS_WAIT_FOREVER);
+      os_event_clr (dev->grant, IOLINK_14819_BUS_GRANT);
+      os_mutex_lock (bus->mtx);
+   }
+   os_mutex_unlock (bus->mtx);
+
+   os_event_clr (dev->grant, IOLINK_14819_BUS_GRANT);
+}
+
+static uint8_t iolink_14819_bus_queue (
+   iolink_14819_bus_dev_t * dev,
+   void * data_read,
+   const void * data_written,
+   size_t len)
+{
+   uint8_t slot;
+
+   if (dev->cnt == IOLINK_14819_BUS_MAX_XFERS)
+   {
+      iolink_14819_bus_flush (dev);
+   }
+
+   if (dev->cnt == 0)
+   {
+      dev->request_us = os_get_current_time_us();
+      if (dev->nesting == 0)
+      {
+         dev->deadline_us = dev->request_us;
+      }
+   }
+
+   slot                                = dev->cnt++;
+   dev->xfer[slot].data_read           = data_read;
+   dev->xfer[slot].data_written        = data_written;
+   dev->xfer[slot].n_bytes_to_transfer = len;
+
+   return slot;
+}
+
+static uint8_t iolink_14819_bus_queue_reg (
+   iolink_14819_bus_dev_t * dev,
+   uint8_t cmd,
+   uint8_t value)
+{
+   uint8_t slot = iolink_14819_bus_queue (dev, NULL, NULL, 2);
+
+   dev->reg_tx[slot][0]         = cmd;
+   dev->reg_tx[slot][1]         = value;
+   dev->xfer[slot].data_read    = dev->reg_rx[slot];
+   dev->xfer[slot].data_written = dev->reg_tx[slot];
+
+   return slot;
+}
+
+bool iolink_14819_bus_dev_init (
+   iolink_14819_bus_dev_t * dev,
+   iolink_14819_bus_t * bus,
+   uint8_t chip_address)
+{
+   CC_ASSERT (chip_address < IOLINK_14819_BUS_MAX_CHIPS);
+
+   memset (dev, 0, sizeof (*dev));
+   dev->bus          = bus;
+   dev->chip_address = chip_address;
+   dev->grant        = os_event_create();
+
+   return (dev->grant != NULL);
+}
+
+void iolink_14819_bus_begin (
+   iolink_14819_bus_dev_t * dev,
+   uint8_t ch,
+   uint32_t deadline_us)
+{
+   if (dev->nesting++ == 0)
+   {
+      dev->ch          = ch;
+      dev->deadline_us = deadline_us;
+   }
+}
+
+void iolink_14819_bus_end (iolink_14819_bus_dev_t * dev)
+{
+   CC_ASSERT (dev->nesting > 0);
+
+   if (--dev->nesting == 0)
+   {
+      iolink_14819_bus_flush (dev);
+   }
+}
+
+void iolink_14819_bus_write (iolink_14819_bus_dev_t * dev, uint8_t cmd, uint8_t value)
+{
+   iolink_14819_bus_queue_reg (dev, cmd, value);
+
+   if (dev->nesting == 0)
+   {
+      iolink_14819_bus_flush (dev);
+   }
+}
+
+uint8_t iolink_14819_bus_read (iolink_14819_bus_dev_t * dev, uint8_t cmd)
+{
+   uint8_t slot = iolink_14819_bus_queue_reg (dev, cmd, 0);
+
+   iolink_14819_bus_flush (dev);
+
+   return dev->reg_rx[slot][1];
+}
+
+void iolink_14819_bus_transfer (
+   iolink_14819_bus_dev_t * dev,
+   void * data_read,
+   const void * data_written,
+   size_t len)
+{
+   iolink_14819_bus_queue (dev, data_read, data_written, len);
+   iolink_14819_bus_flush (dev);
+}
+
+void iolink_14819_bus_free (iolink_14819_bus_t * bus)
+{
+   _iolink_pl_hw_spi_close (bus->fd_spi);
+   os_mutex_destroy (bus->mtx);
+   free (bus);
+}
+
+bool iolink_14819_bus_set_timing (
+   iolink_14819_bus_t * bus,
+   uint32_t clk_hz,
+   uint32_t delay_us)
+{
+   bool applied;
+
+   os_mutex_lock (bus->mtx);
+   applied = _iolink_pl_hw_spi_set_timing (bus->fd_spi, clk_hz, delay_us);
+   if (applied)
+   {
+      bus->clk_hz   = clk_hz;
+      bus->delay_us = delay_us;
+   }
+   os_mutex_unlock (bus->mtx);
+
+   return applied;
+}
+
+static const uint32_t iolink_14819_bus_clk_steps[] = {
+   12000000,
+   10000000,
+   8000000,
+   6000000,
+   5000000,
+   4000000,
+   3000000,
+   2000000,
+   1000000,
+};
+
+static const uint32_t iolink_14819_bus_delay_steps[] = {
+   0,
+   1,
+   2,
+   5,
+   10,
+   20,
+   50,
+   100,
+};
+
+bool iolink_14819_bus_characterize (
+   iolink_14819_bus_t * bus,
+   uint32_t clk_max_hz,
+   bool (*verify) (void * arg),
+   void * arg)
+{
+   uint32_t bus_clk_hz   = bus->clk_hz;
+   uint32_t bus_delay_us = bus->delay_us;
+   bool applied          = false;
+   uint8_t c;
+   uint8_t d;
+
+   if ((bus_clk_hz != 0) && ((clk_max_hz == 0) || (bus_clk_hz < clk_max_hz)))
+   {
+      /* Other chips on the bus have already been characterized */
+      clk_max_hz = bus_clk_hz;
+   }
+
+   for (c = 0; c < NELEMENTS (iolink_14819_bus_clk_steps); c++)
+   {
+      uint32_t clk_hz = iolink_14819_bus_clk_steps[c];
+
+      if ((clk_max_hz != 0) && (clk_hz > clk_max_hz))
+      {
+         continue;
+      }
+
+      for (d = 0; d < NELEMENTS (iolink_14819_bus_delay_steps); d++)
+      {
+         uint32_t delay_us = iolink_14819_bus_delay_steps[d];
+
+         if ((clk_hz == bus_clk_hz) && (delay_us < bus_delay_us))
+         {
+            continue;
+         }
+
+         if (!iolink_14819_bus_set_timing (bus, clk_hz, delay_us))
+         {
+            /* Clock not supported by the backend, try a slower one */
+            break;
+         }
+
+         applied = true;
+         if (verify (arg))
+         {
+            return true;
+         }
+      }
+   }
+
+   if (applied)
+   {
+      /* Nothing passed, use the slowest setting */
+      iolink_14819_bus_set_timing (
+         bus,
+         iolink_14819_bus_clk_steps[NELEMENTS (iolink_14819_bus_clk_steps) - 1],
+         iolink_14819_bus_delay_steps
+            [NELEMENTS (iolink_14819_bus_delay_steps) - 1]);
+   }
+
+   return false;
+}
+
+iolink_14819_bus_t * iolink_14819_bus_init (const char * spi_slave_name)
+{
+   iolink_14819_bus_t * bus;
+
+   bus = calloc (1, sizeof (iolink_14819_bus_t));
+   if (bus == NULL)
+   {
+      return NULL;
+   }
+
+   bus->fd_spi = _iolink_pl_hw_spi_init (spi_slave_name);
+   if (bus->fd_spi == NULL)
+   {
+      free (bus);
+      return NULL;
+   }
+
+   bus->mtx            = os_mutex_create();
+   bus->stats_start_us = os_get_current_time_us();
+
+   return bus;
+}
+
+void iolink_14819_bus_get_stats (
+   iolink_14819_bus_t * bus,
+   iolink_14819_bus_stats_t * stats,
+   bool reset)
+{
+   uint32_t now;
+
+   os_mutex_lock (bus->mtx);
+   now = os_get_current_time_us();
+
+   stats->elapsed_us      = now - bus->stats_start_us;
+   stats->busy_us         = bus->busy_us;
+   stats->operations      = bus->operations;
+   stats->vectors         = bus->vectors;
+   stats->deadline_misses = bus->deadline_misses;
+
+   stats->utilization_permille = 0;
+   if (stats->elapsed_us > 0)
+   {
+      uint64_t permille = (uint64_t)stats->busy_us * 1000 / stats->elapsed_us;
+
+      stats->utilization_permille = (permille > 1000) ? 1000 : (uint16_t)permille;
+   }
+   memcpy (
+      stats->max_latency_us,
+      bus->max_latency_us,
+      sizeof (stats->max_latency_us));
+
+   if (reset)
+   {
+      bus->stats_start_us  = now;
+      bus->busy_us         = 0;
+      bus->operations      = 0;
+      bus->vectors         = 0;
+      bus->deadline_misses = 0;
+      memset (bus->max_latency_us, 0, sizeof (bus->max_latency_us));
+   }
+   os_mutex_unlock (bus->mtx);
+}
@@ -0,0 +1,210 @@
+/*********************************************************************
+ *        _       _         _
+ *  _ __ | |_  _ | |  __ _ | |__   ___
+ * | '__|| __|(_)| | / _` || '_ \ / __|
+ * | |   | |_  _ | || (_| || |_) |\__ \
+ * |_|    \__|(_)|_| \__,_||_.__/ |___/
+ *
+ * www.rt-labs.com
+ * Copyright 2024 rt-labs AB, Sweden.
+ *
+ * This software is dual-licensed under GPLv3 and a commercial
+ * license. See the file LICENSE.md distributed with this software for
+ * full license information.
+ ********************************************************************/
+
+/**
+ * @file
+ * @brief SPI bus scheduler for MAX14819 chips
+ *
+ * All SPI traffic of a chip goes through its bus device. Register writes
+ * made between iolink_14819_bus_begin() and iolink_14819_bus_end() are
+ * deferred and sent together with the next read, burst or end, as one
+ * vectored transfer. When several chips share the bus, the pending
+ * operations of all chips are queued in order of deadline and the chip that
+ * gets the bus issues the operations of the queued chips as well.
+ */
+
+#ifndef IOLINK_MAX14819_BUS_H
+#define IOLINK_MAX14819_BUS_H
+
+#include <iolink.h>
+#include <osal.h>
+#include <osal_spi.h>
+
+#include "iolink_max14819.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Max number of operations in a vectored transfer */
+#define IOLINK_14819_BUS_MAX_XFERS 16
+
+/** Deadline of operations not tied to a cycle, in microseconds */
+#define IOLINK_14819_BUS_DEFAULT_DEADLINE_US 10000
+
+/* Bus device, one per chip */
+typedef struct iolink_14819_bus_dev
+{
+   iolink_14819_bus_t * bus;
+   uint8_t chip_address;
+
+   /* Set when the bus is handed over or the queued operations are done */
+   os_event_t * grant;
+   struct iolink_14819_bus_dev * next;
+   bool done;
+
+   /* Current request */
+   uint8_t ch;
+   uint8_t nesting;
+   uint32_t deadline_us;
+   uint32_t request_us;
+
+   /* Pending operations */
+   iolink_spi_xfer_t xfer[IOLINK_14819_BUS_MAX_XFERS];
+   uint8_t reg_tx[IOLINK_14819_BUS_MAX_XFERS][2];
+   uint8_t reg_rx[IOLINK_14819_BUS_MAX_XFERS][2];
+   uint8_t cnt;
+} iolink_14819_bus_dev_t;
+
+struct iolink_14819_bus
+{
+   void * fd_spi;
+
+   /* Protects the members below */
+   os_mutex_t * mtx;
+   bool busy;
+
+   /* Chips with pending operations, in order of deadline */
+   iolink_14819_bus_dev_t * queue;
+   iolink_spi_xfer_t vec[IOLINK_14819_BUS_MAX_XFERS];
+
+   /* SPI timing, 0 for the backend default */
+   uint32_t clk_hz;
+   uint32_t delay_us;
+
+   /* Statistics */
+   uint32_t stats_start_us;
+   uint32_t busy_us;
+   uint32_t operations;
+   uint32_t vectors;
+   uint32_t deadline_misses;
+   uint32_t max_latency_us[IOLINK_14819_BUS_MAX_CHIPS][2];
+};
+
+/**
+ * Attach a chip to a bus.
+ *
+ * @param dev           Bus device of the chip
+ * @param bus           Bus
+ * @param chip_address  SPI address of the chip
+ * @return true on success, false otherwise
+ */
+bool iolink_14819_bus_dev_init (
+   iolink_14819_bus_dev_t * dev,
+   iolink_14819_bus_t * bus,
+   uint8_t chip_address);
+
+/**
+ * Close a bus. All chips on the bus must be detached.
+ *
+ * @param bus           Bus
+ */
+void iolink_14819_bus_free (iolink_14819_bus_t * bus);
+
+/**
+ * Set the SPI timing of a bus. Must not be called while chips on the bus
+ * are operating.
+ *
+ * @param bus           Bus
+ * @param clk_hz        SPI clock frequency in Hz
+ * @param delay_us      Delay after each transfer in microseconds
+ * @return true if the timing was applied, false otherwise
+ */
+bool iolink_14819_bus_set_timing (
+   iolink_14819_bus_t * bus,
+   uint32_t clk_hz,
+   uint32_t delay_us);
+
+/**
+ * Find the fastest reliable SPI timing of a bus.
+ *
+ * The clock is stepped down from clk_max_hz and, for each clock, the delay
+ * stepped up until verify() passes. Clocks rejected by the SPI backend are
+ * skipped. If the bus already has a timing, set by another chip, it is not
+ * made faster. If nothing passes, the slowest timing is used. If the
+ * backend rejects every timing, its default is kept.
+ *
+ * @param bus           Bus
+ * @param clk_max_hz    Highest clock to try in Hz, 0 for no limit
+ * @param verify        Checks the link with the current timing
+ * @param arg           Argument of verify()
+ * @return true if verify() passed, false otherwise
+ */
+bool iolink_14819_bus_characterize (
+   iolink_14819_bus_t * bus,
+   uint32_t clk_max_hz,
+   bool (*verify) (void * arg),
+   void * arg);
+
+/**
+ * Start a sequence of operations on behalf of a channel.
+ *
+ * Register writes are deferred until the next read, burst or the matching
+ * iolink_14819_bus_end(). Sequences may be nested, the outermost sequence
+ * sets the channel and deadline.
+ *
+ * @param dev           Bus device
+ * @param ch            Channel the operations are made for
+ * @param deadline_us   Time by which the operations should be done
+ */
+void iolink_14819_bus_begin (
+   iolink_14819_bus_dev_t * dev,
+   uint8_t ch,
+   uint32_t deadline_us);
+
+/**
+ * End a sequence of operations, sending any deferred register writes.
+ *
+ * @param dev           Bus device
+ */
+void iolink_14819_bus_end (iolink_14819_bus_dev_t * dev);
+
+/**
+ * Write a register.
+ *
+ * @param dev           Bus device
+ * @param cmd           Command byte
+ * @param value         Register value
+ */
+void iolink_14819_bus_write (iolink_14819_bus_dev_t * dev, uint8_t cmd, uint8_t value);
+
+/**
+ * Read a register. Deferred register writes are sent first.
+ *
+ * @param dev           Bus device
+ * @param cmd           Command byte
+ * @return Register value
+ */
+uint8_t iolink_14819_bus_read (iolink_14819_bus_dev_t * dev, uint8_t cmd);
+
+/**
+ * Burst transfer. Deferred register writes are sent first.
+ *
+ * @param dev           Bus device
+ * @param data_read     Received data
+ * @param data_written  Data to send
+ * @param len           Transfer length
+ */
+void iolink_14819_bus_transfer (
+   iolink_14819_bus_dev_t * dev,
+   void * data_read,
+   const void * data_written,
+   size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IOLINK_MAX14819_BUS_H */
@@ -152,34 +152,29 @@ static void iolink_14819_write_register (
    uint8_t reg,
    uint8_t value)
 {
-   uint8_t wbuf[2];
-   uint8_t rbuf[2];
+   uint8_t cmd;
 
    CC_ASSERT (iolink->fd_spi >= 0);
 
-   wbuf[0] = MAX14819_COMMAND_WRITE |
-             (iolink->chip_address << MAX14819_ADDR_OFFSET) |
-             (reg << MAX14819_REGISTER_OFFSET);
-   wbuf[1] = value;
-   _iolink_pl_hw_spi_transfer (iolink->fd_spi, &rbuf, &wbuf, sizeof (wbuf));
+   cmd = MAX14819_COMMAND_WRITE |
+         (iolink->chip_address << MAX14819_ADDR_OFFSET) |
+         (reg << MAX14819_REGISTER_OFFSET);
+   iolink_14819_bus_write (&iolink->bus, cmd, value);
 }
 
 static uint8_t iolink_14819_read_register (iolink_14819_drv_t * iolink, uint8_t reg)
 {
-   uint8_t wbuf[2];
-   uint8_t rbuf[2];
+   uint8_t cmd;
 
    CC_ASSERT (iolink->fd_spi >= 0);
 
-   wbuf[0] = MAX14819_COMMAND_READ |
-             (iolink->chip_address << MAX14819_ADDR_OFFSET) |
-             (reg << MAX14819_REGISTER_OFFSET);
-   wbuf[1] = 0;
-   _iolink_pl_hw_spi_transfer (iolink->fd_spi, &rbuf, &wbuf, sizeof (wbuf));
-   return rbuf[1];
+   cmd = MAX14819_COMMAND_READ |
+         (iolink->chip_address << MAX14819_ADDR_OFFSET) |
+         (reg << MAX14819_REGISTER_OFFSET);
+   return iolink_14819_bus_read (&iolink->bus, cmd);
 }
 
-static void iolink_14819_burst_write_tx (
+static bool iolink_14819_burst_write_tx (
    iolink_14819_drv_t * iolink,
    iolink_14819_channel_t ch,
    uint8_t * data,
@@ -187,6 +182,7 @@ static void iolink_14819_burst_write_tx (
 {
    uint8_t rxtxreg = REG_TxRxDataA + ch;
    uint8_t idx;
+   bool echo_ok    = true;
    uint8_t data_tx[IOLINK_RXTX_BUFFER_SIZE + 1];
    uint8_t data_rx[IOLINK_RXTX_BUFFER_SIZE + 1] = {0};
 
@@ -194,12 +190,17 @@ static void iolink_14819_burst_write_tx (
                 (iolink->chip_address << MAX14819_ADDR_OFFSET) |
                 (rxtxreg << MAX14819_REGISTER_OFFSET);
    memcpy (&data_tx[1], data, size);
-   _iolink_pl_hw_spi_transfer (iolink->fd_spi, data_rx, data_tx, size + 1);
+   iolink_14819_bus_transfer (&iolink->bus, data_rx, data_tx, size + 1);
 
    for (idx = 0; idx < size; idx++)
    {
       if (data_tx[idx] != data_rx[idx + 1])
       {
+         echo_ok = false;
+         if (iolink->spi_characterizing)
+         {
+            break;
+         }
          // TODO: Fix better id of iolink. Only channel is not good enough
          LOG_ERROR (
             IOLINK_PL_LOG,
@@ -208,6 +209,8 @@ static void iolink_14819_burst_write_tx (
             idx);
       }
    }
+
+   return echo_ok;
 }
 
 static uint8_t iolink_14819_burst_read_rx (
@@ -223,12 +226,27 @@ static uint8_t iolink_14819_burst_read_rx (
    txdata[0] = MAX14819_COMMAND_READ |
                (iolink->chip_address << MAX14819_ADDR_OFFSET) |
                (rxtxreg << MAX14819_REGISTER_OFFSET);
-   _iolink_pl_hw_spi_transfer (iolink->fd_spi, rxdata, txdata, rxbytes + 2);
+   iolink_14819_bus_transfer (&iolink->bus, rxdata, txdata, rxbytes + 2);
    memcpy (data, &rxdata[1], rxbytes);
 
    return rxdata[0];
 }
 
+/* SPI operations for a channel should be done within one cycle */
+static uint32_t iolink_14819_deadline (
+   iolink_14819_drv_t * iolink,
+   iolink_14819_channel_t ch)
+{
+   uint32_t cycle_us = iolink->cycle_us[ch];
+
+   if (cycle_us == 0)
+   {
+      cycle_us = IOLINK_14819_BUS_DEFAULT_DEADLINE_US;
+   }
+
+   return os_get_current_time_us() + cycle_us;
+}
+
 static void iolink_14819_set_DO (
    iolink_14819_drv_t * iolink,
    iolink_14819_channel_t ch,
@@ -421,7 +439,21 @@ static void iolink_pl_max14819_set_cycletime (
    CC_ASSERT (ch >= MAX14819_CH_MIN);
    CC_ASSERT (ch <= MAX14819_CH_MAX);
 
-   uint8_t reg = REG_CyclTmrA + ch;
+   uint8_t reg     = REG_CyclTmrA + ch;
+   uint32_t mult   = cycbyte & 0x3F;
+
+   switch (cycbyte >> 6)
+   {
+   case 0:
+      iolink->cycle_us[ch] = mult * 100;
+      break;
+   case 1:
+      iolink->cycle_us[ch] = 6400 + mult * 400;
+      break;
+   default:
+      iolink->cycle_us[ch] = 32000 + mult * 1600;
+      break;
+   }
 
    iolink_14819_write_register (iolink, reg, cycbyte);
 }
@@ -439,6 +471,8 @@ static bool iolink_pl_max14819_set_mode (
    CC_ASSERT (ch <= MAX14819_CH_MAX);
 
    os_mutex_lock (iolink->exclusive);
+   iolink->cycle_us[ch] = 0;
+   iolink_14819_bus_begin (&iolink->bus, ch, iolink_14819_deadline (iolink, ch));
    switch (mode)
    {
    case iolink_mode_DO:
@@ -474,6 +508,7 @@ static bool iolink_pl_max14819_set_mode (
       iolink_14819_set_SDCI (iolink, ch, &iol_cfg);
       break;
    }
+   iolink_14819_bus_end (&iolink->bus);
    os_mutex_unlock (iolink->exclusive);
 
    return true;
@@ -544,8 +579,10 @@ static void iolink_pl_max14819_get_error (
    CC_ASSERT (ch <= MAX14819_CH_MAX);
 
    os_mutex_lock (iolink->exclusive);
+   iolink_14819_bus_begin (&iolink->bus, ch, iolink_14819_deadline (iolink, ch));
    *cqerr  = iolink_14819_read_register (iolink, REG_CQErrA + ch);
    *devdly = iolink_14819_read_register (iolink, REG_DeviceDlyA + ch);
+   iolink_14819_bus_end (&iolink->bus);
    os_mutex_unlock (iolink->exclusive);
 }
 
@@ -563,6 +600,7 @@ static bool iolink_pl_max14819_get_data (
    CC_ASSERT (ch >= MAX14819_CH_MIN);
    CC_ASSERT (ch <= MAX14819_CH_MAX);
    os_mutex_lock (iolink->exclusive);
+   iolink_14819_bus_begin (&iolink->bus, ch, iolink_14819_deadline (iolink, ch));
    uint8_t RxBytesAct = iolink_14819_read_register (iolink, reg);
    uint8_t rxbytes = iolink_14819_read_register (iolink, lvlreg);
 
@@ -580,6 +618,7 @@ static bool iolink_pl_max14819_get_data (
       uint8_t cqctrl = iolink_14819_read_register (iolink, REG_CQCtrlA + ch);
       cqctrl |= MAX14819_CQCTRL_RX_FIFO_RST;
       iolink_14819_write_register (iolink, REG_CQCtrlA + ch, cqctrl);
+      iolink_14819_bus_end (&iolink->bus);
       return false;
    }
 
@@ -605,6 +644,7 @@ static bool iolink_pl_max14819_get_data (
       }
    }
 
+   iolink_14819_bus_end (&iolink->bus);
    os_mutex_unlock (iolink->exclusive);
 
    return (rxbytes > 0);
@@ -634,8 +674,10 @@ static void iolink_pl_max14819_dl_msg (
    CC_ASSERT (ch >= MAX14819_CH_MIN);
    CC_ASSERT (ch <= MAX14819_CH_MAX);
 
+   iolink_14819_bus_begin (&iolink->bus, ch, iolink_14819_deadline (iolink, ch));
    iolink_14819_delete_master_message (iolink, ch);
    iolink_14819_set_master_message (iolink, ch, data, txbytes, rxbytes, true);
+   iolink_14819_bus_end (&iolink->bus);
 }
 
 static void iolink_pl_max14819_transfer_req (
@@ -651,9 +693,11 @@ static void iolink_pl_max14819_transfer_req (
    CC_ASSERT (ch >= MAX14819_CH_MIN);
    CC_ASSERT (ch <= MAX14819_CH_MAX);
 
+   iolink_14819_bus_begin (&iolink->bus, ch, iolink_14819_deadline (iolink, ch));
    iolink_14819_delete_master_message (iolink, ch);
    iolink_14819_set_master_message (iolink, ch, data, txbytes, rxbytes, true);
    iolink_14819_send_master_message (iolink, ch);
+   iolink_14819_bus_end (&iolink->bus);
 }
 
 static bool iolink_pl_max14819_init_sdci (iolink_hw_drv_t * iolink_hw, void * arg)
@@ -673,6 +717,7 @@ static bool iolink_pl_max14819_init_sdci (iolink_hw_drv_t * iolink_hw, void * ar
       os_mutex_unlock (iolink->exclusive);
       return false;
    }
+   iolink_14819_bus_begin (&iolink->bus, ch, iolink_14819_deadline (iolink, ch));
    reg_val = iolink_14819_read_register (iolink, reg_cqctrl);
    reg_val &= ~MAX14819_CQCTRL_EST_COM;
    reg_val &= ~MAX14819_CQCTRL_CYC_TMR_EN;
@@ -687,6 +732,7 @@ static bool iolink_pl_max14819_init_sdci (iolink_hw_drv_t * iolink_hw, void * ar
    reg_val = MAX14819_CQCTRL_EST_COM;
    iolink_14819_write_register (iolink, reg_cqctrl, reg_val);
 
+   iolink_14819_bus_end (&iolink->bus);
    iolink->wurq_request[ch] = true;
    os_mutex_unlock (iolink->exclusive);
 
@@ -710,6 +756,7 @@ static void iolink_pl_max14819_pl_handler (iolink_hw_drv_t * iolink_hw, void * a
    }
 
    os_mutex_lock (iolink->exclusive);
+   iolink_14819_bus_begin (&iolink->bus, channel, os_get_current_time_us());
    // Check if this chip has interrupted
    // Read interrupt register
    reg = iolink_14819_read_register (iolink, REG_Interrupt);
@@ -766,6 +813,7 @@ static void iolink_pl_max14819_pl_handler (iolink_hw_drv_t * iolink_hw, void * a
          os_event_set (iolink->dl_event[ch], IOLINK_PL_EVENT_RXRDY);
       }
    }
+   iolink_14819_bus_end (&iolink->bus);
    os_mutex_unlock (iolink->exclusive);
 }
 
@@ -802,6 +850,104 @@ error:
 }
 #endif
 
+/* Number of RevID reads and echo checks per candidate setting */
+#define IOLINK_14819_SPI_VERIFY_CNT 32
+
+static bool iolink_14819_spi_verify (
+   iolink_14819_drv_t * iolink,
+   uint8_t rev,
+   uint16_t cnt)
+{
+   uint8_t pattern[IOLINK_RXTX_BUFFER_SIZE];
+   uint16_t i;
+   uint8_t idx;
+   bool echo_ok;
+
+   for (i = 0; i < cnt; i++)
+   {
+      if (iolink_14819_read_register (iolink, REG_RevID) != rev)
+      {
+         return false;
+      }
+   }
+
+   for (idx = 0; idx < sizeof (pattern); idx++)
+   {
+      /* Alternating bits and walking ones */
+      pattern[idx] = (idx & 1) ? 0x55 : (0x80 >> (idx % 8)) ^ 0xAA;
+   }
+
+   /* The TX FIFO is not in use yet, empty it after the echo check */
+   echo_ok = iolink_14819_burst_write_tx (
+      iolink,
+      MAX14819_CH_MIN,
+      pattern,
+      sizeof (pattern));
+   iolink_14819_delete_master_message (iolink, MAX14819_CH_MIN);
+
+   return echo_ok;
+}
+
+typedef struct iolink_14819_spi_verify_arg
+{
+   iolink_14819_drv_t * iolink;
+   uint8_t rev;
+} iolink_14819_spi_verify_arg_t;
+
+/* Confirm a passing setting with a longer run */
+static bool iolink_14819_spi_verify_cb (void * arg)
+{
+   iolink_14819_spi_verify_arg_t * verify = arg;
+
+   return iolink_14819_spi_verify (
+             verify->iolink,
+             verify->rev,
+             IOLINK_14819_SPI_VERIFY_CNT) &&
+          iolink_14819_spi_verify (
+             verify->iolink,
+             verify->rev,
+             4 * IOLINK_14819_SPI_VERIFY_CNT);
+}
+
+/* Find the fastest reliable SPI timing, see iolink_14819_spi_timing_t */
+static void iolink_14819_spi_characterize (
+   iolink_14819_drv_t * iolink,
+   uint8_t rev,
+   uint32_t clk_max_hz)
+{
+   iolink_14819_bus_t * bus             = iolink->bus.bus;
+   iolink_14819_spi_verify_arg_t verify = {iolink, rev};
+
+   iolink->spi_characterizing = true;
+   if (iolink_14819_bus_characterize (
+          bus,
+          clk_max_hz,
+          iolink_14819_spi_verify_cb,
+          &verify))
+   {
+      LOG_INFO (
+         IOLINK_PL_LOG,
+         "PL: SPI chip %u: %u Hz, %u us delay\n",
+         iolink->chip_address,
+         (unsigned int)bus->clk_hz,
+         (unsigned int)bus->delay_us);
+   }
+   else if (bus->clk_hz == 0)
+   {
+      LOG_WARNING (
+         IOLINK_PL_LOG,
+         "PL: SPI timing can not be changed, using default\n");
+   }
+   else
+   {
+      LOG_ERROR (
+         IOLINK_PL_LOG,
+         "PL: SPI chip %u: no reliable timing found\n",
+         iolink->chip_address);
+   }
+   iolink->spi_characterizing = false;
+}
+
 static const iolink_hw_ops_t iolink_hw_ops = {
    .get_baudrate        = iolink_pl_max14819_get_baudrate,
    .get_cycletime       = iolink_pl_max14819_get_cycletime,
@@ -822,6 +968,7 @@ static const iolink_hw_ops_t iolink_hw_ops = {
 iolink_hw_drv_t * iolink_14819_init (const iolink_14819_cfg_t * cfg)
 {
    iolink_14819_drv_t * iolink;
+   iolink_14819_bus_t * bus;
    uint8_t ch;
    uint8_t rev;
    /* Allocate driver structure */
@@ -838,17 +985,42 @@ iolink_hw_drv_t * iolink_14819_init (const iolink_14819_cfg_t * cfg)
    {
       iolink->wurq_request[ch] = false;
    }
-   iolink->fd_spi = _iolink_pl_hw_spi_init(cfg->spi_slave_name);
 
-   if (iolink->fd_spi == NULL)
+   /* Chips without a shared bus get a bus of their own */
+   bus = cfg->bus;
+   if (bus == NULL)
+   {
+      bus = iolink_14819_bus_init (cfg->spi_slave_name);
+   }
+
+   if (bus == NULL)
    {
       free (iolink);
       return NULL;
    }
 
+   if (!iolink_14819_bus_dev_init (&iolink->bus, bus, cfg->chip_address))
+   {
+      if (cfg->bus == NULL)
+      {
+         iolink_14819_bus_free (bus);
+      }
+      free (iolink);
+      return NULL;
+   }
+   iolink->fd_spi = bus->fd_spi;
+
    iolink->exclusive = os_mutex_create();
    iolink->drv.mtx = iolink->exclusive;
 
+   if ((cfg->spi_timing.clk_hz != 0) && !cfg->spi_timing.characterize)
+   {
+      iolink_14819_bus_set_timing (
+         bus,
+         cfg->spi_timing.clk_hz,
+         cfg->spi_timing.delay_us);
+   }
+
    /* Verify chip is supported */
    rev = iolink_14819_read_register (iolink, REG_RevID);
    if (!(rev == MAX14819_REVID_MAX14819 ||
@@ -856,11 +1028,22 @@ iolink_hw_drv_t * iolink_14819_init (const iolink_14819_cfg_t * cfg)
    {
       LOG_ERROR (IOLINK_PL_LOG, "PL: Unsupported chip revision: 0x%02x\n", rev);
       os_mutex_destroy(iolink->exclusive);
-      _iolink_pl_hw_spi_close(iolink->fd_spi);
+      os_event_destroy (iolink->bus.grant);
+      if (cfg->bus == NULL)
+      {
+         iolink_14819_bus_free (bus);
+      }
       free (iolink);
       return NULL;
    }
 
+   if (cfg->spi_timing.characterize)
+   {
+      iolink_14819_spi_characterize (iolink, rev, cfg->spi_timing.clk_hz);
+   }
+
+   iolink_14819_bus_begin (&iolink->bus, MAX14819_CH_MIN, os_get_current_time_us());
+
    // Reset all registers
    // Disable interrupts
    iolink_14819_write_register (iolink, REG_InterruptEn, 0x00);
@@ -907,6 +1090,8 @@ iolink_hw_drv_t * iolink_14819_init (const iolink_14819_cfg_t * cfg)
       iolink_14819_read_register (iolink, REG_ChanStatA + ch);
    }
 
+   iolink_14819_bus_end (&iolink->bus);
+
    if (cfg->register_read_reg_fn != NULL)
    {
       cfg->register_read_reg_fn (iolink_14819_read_register);
@@ -915,6 +1100,17 @@ iolink_hw_drv_t * iolink_14819_init (const iolink_14819_cfg_t * cfg)
    return &iolink->drv;
 }
 
+void iolink_14819_get_spi_timing (
+   iolink_hw_drv_t * drv,
+   iolink_14819_spi_timing_t * timing)
+{
+   iolink_14819_drv_t * iolink = (iolink_14819_drv_t *)drv;
+
+   timing->clk_hz       = iolink->bus.bus->clk_hz;
+   timing->delay_us     = iolink->bus.bus->delay_us;
+   timing->characterize = false;
+}
+
 void iolink_14819_isr (void * arg)
 {
    iolink_14819_drv_t * iolink;
@@ -41,6 +41,7 @@ extern "C" {
 
 #include <osal.h>
 #include <iolink_pl_hw_drv.h>
+#include "iolink_max14819_bus.h"
 
 /* Driver structure */
 typedef struct iolink_14819_drv
@@ -51,6 +52,9 @@ typedef struct iolink_14819_drv
    /* Private data */
    void * fd_spi;
    uint8_t chip_address;
+   iolink_14819_bus_dev_t bus;
+   uint32_t cycle_us[MAX14819_NUM_CHANNELS];
+   bool spi_characterizing;
 
    uint32_t pl_flag;
 
@@ -25,6 +25,7 @@
 #include "iolink_ode.h"
 #include "iolink_al.h"   /* AL_Read_req AL_Write_req */
 #include "iolink_main.h" /* iolink_fetch_avail_job, iolink_fetch_avail_api_job, iolink_post_job, iolink_get_portnumber */
+#include "iolink_sm.h"   /* IOL_DEV_PARAMA_* */
 
 #include "osal_log.h"
 
@@ -118,6 +119,7 @@ static void ode_write_cnf_cb (iolink_job_t * job);
 static void od_start_cb (iolink_job_t * job);
 static void od_stop_cb (iolink_job_t * job);
 static void SMI_rw_req_cb (iolink_job_t * job);
+static void SMI_od_cancel_cb (iolink_job_t * job);
 
 /* Other functions */
 static iolink_fsm_ode_event_t ode_AL_Read_req (iolink_port_t * port);
@@ -143,6 +145,27 @@ static iolink_error_t ode_SMI_DeviceReadWrite_req (
    arg_block_t * arg_block,
    iolink_arg_block_id_t od_or_void,
    iolink_job_type_t type);
+static iolink_fsm_ode_event_t ode_batch_read_start (iolink_port_t * port);
+static iolink_fsm_ode_event_t ode_batch_write_start (iolink_port_t * port);
+static void ode_batch_read_cnf (
+   iolink_port_t * port,
+   uint8_t len,
+   const uint8_t * data,
+   iolink_smi_errortypes_t errortype);
+static void ode_batch_write_cnf (
+   iolink_port_t * port,
+   iolink_smi_errortypes_t errortype);
+static iolink_fsm_ode_event_t ode_queue_next (iolink_port_t * port);
+static void ode_queue_expire (iolink_port_t * port);
+static void ode_queue_flush (iolink_port_t * port, iolink_smi_errortypes_t errortype);
+static void ode_cache_store (
+   iolink_port_t * port,
+   uint16_t index,
+   uint8_t subindex,
+   uint8_t len,
+   const uint8_t * data);
+static void ode_cache_invalidate (iolink_port_t * port, uint16_t index);
+static void ode_cache_clear (iolink_port_t * port);
 
 static iolink_fsm_ode_event_t ode_smi_od_err (
    iolink_port_t * port,
@@ -154,29 +177,19 @@ static iolink_fsm_ode_event_t ode_smi_od_err (
    iolink_arg_block_id_t ref_arg_block_id =
       smi_req->arg_block->id;
 
-   /* SMI_ParamReadBatch and SMI_ParamWriteBatch are not supported */
-   if (
-      ref_arg_block_id == IOLINK_ARG_BLOCK_ID_PORT_INXDEX_LIST ||
-      ref_arg_block_id == IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT)
-   {
-      errortype = IOLINK_SMI_ERRORTYPE_SERVICE_NOT_SUPPORTED;
-   }
-   else
+   switch (event)
    {
-      switch (event)
-      {
-      case ODE_EVENT_SMI_DEV_RW_1:
-         /* Access blocked (inactive) indicate IDX_NOTAVAIL */
-         errortype = IOLINK_SMI_ERRORTYPE_IDX_NOTAVAIL;
-         break;
-      case ODE_EVENT_SMI_DEV_RW_6:
-         /* Access blocked (temporarily) inidcate SERVICE_TEMP_UNAVAILABLE */
-         errortype = IOLINK_SMI_ERRORTYPE_SERVICE_TEMP_UNAVAILABLE;
-         break;
-      default:
-         CC_ASSERT (0);
-         break;
-      }
+   case ODE_EVENT_SMI_DEV_RW_1:
+      /* Access blocked (inactive) indicate IDX_NOTAVAIL */
+      errortype = IOLINK_SMI_ERRORTYPE_IDX_NOTAVAIL;
+      break;
+   case ODE_EVENT_SMI_DEV_RW_6:
+      /* Access blocked (temporarily) inidcate SERVICE_TEMP_UNAVAILABLE */
+      errortype = IOLINK_SMI_ERRORTYPE_SERVICE_TEMP_UNAVAILABLE;
+      break;
+   default:
+      CC_ASSERT (0);
+      break;
    }
 
    switch (ref_arg_block_id)
@@ -212,6 +225,17 @@ static iolink_fsm_ode_event_t ode_od_stop (
    iolink_port_t * port,
    iolink_fsm_ode_event_t event)
 {
+   iolink_ode_port_t * ode = iolink_get_ode_ctx (port);
+
+   /* Drop any batch in progress, its remaining objects are not issued */
+   ode->batch.active = false;
+
+   /* Queued requests get the response of an inactive port */
+   ode_queue_flush (port, IOLINK_SMI_ERRORTYPE_IDX_NOTAVAIL);
+
+   /* COMLOST or new port configuration, the device may be replaced */
+   ode_cache_clear (port);
+
    return ODE_EVENT_NONE;
 }
 
@@ -240,6 +264,8 @@ static iolink_fsm_ode_event_t ode_AL_Write_req (iolink_port_t * port)
       arg_block_data_len = arg_block_len - sizeof (arg_block_od_t);
    }
 
+   ode_cache_invalidate (port, arg_block_od->index);
+
    AL_Write_req (
       port,
       arg_block_od->index,
@@ -274,20 +300,31 @@ static iolink_fsm_ode_event_t ode_smi_rw (
    {
       res_event = ode_AL_Write_req (port);
    }
+   else if (
+      (exp_arg_block_id == IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT) &&
+      (ref_arg_block_id == IOLINK_ARG_BLOCK_ID_PORT_INXDEX_LIST))
+   {
+      res_event = ode_batch_read_start (port);
+   }
+   else if (
+      (exp_arg_block_id == IOLINK_ARG_BLOCK_ID_VOID_BLOCK) &&
+      (ref_arg_block_id == IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT))
+   {
+      res_event = ode_batch_write_start (port);
+   }
    else
    {
-      iolink_smi_errortypes_t errortype =
-         IOLINK_SMI_ERRORTYPE_ARGBLOCK_NOT_SUPPORTED;
-
-      /* SMI_ParamReadBatch and SMI_ParamWriteBatch are not supported */
-      if (
-         (ref_arg_block_id == IOLINK_ARG_BLOCK_ID_PORT_INXDEX_LIST) ||
-         (ref_arg_block_id == IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT))
-      {
-         errortype = IOLINK_SMI_ERRORTYPE_SERVICE_NOT_SUPPORTED;
-      }
+      iolink_smi_joberror_ind (
+         port,
+         exp_arg_block_id,
+         ref_arg_block_id,
+         IOLINK_SMI_ERRORTYPE_ARGBLOCK_NOT_SUPPORTED);
+   }
 
-      iolink_smi_joberror_ind (port, exp_arg_block_id, ref_arg_block_id, errortype);
+   if (res_event == ODE_EVENT_NONE)
+   {
+      /* Not started, continue with the next queued request */
+      res_event = ode_queue_next (port);
    }
 
    return res_event;
@@ -325,17 +362,556 @@ static iolink_fsm_ode_event_t ode_smi_done (
       }
       else if (
          (exp_arg_block_id == IOLINK_ARG_BLOCK_ID_VOID_BLOCK) &&
-         (ref_arg_block_id == IOLINK_ARG_BLOCK_ID_OD_WR))
+         ((ref_arg_block_id == IOLINK_ARG_BLOCK_ID_OD_WR) ||
+          (ref_arg_block_id == IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT)))
       {
          iolink_smi_voidblock_cnf (port, ref_arg_block_id);
       }
+      else if (
+         (exp_arg_block_id == IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT) &&
+         (ref_arg_block_id == IOLINK_ARG_BLOCK_ID_PORT_INXDEX_LIST))
+      {
+         iolink_smi_cnf (
+            port,
+            ref_arg_block_id,
+            ode->batch.res_len,
+            (arg_block_t *)ode->batch.res);
+      }
       else
       {
          CC_ASSERT (0);
       }
    }
 
-   return ODE_EVENT_NONE;
+   return ode_queue_next (port);
+}
+
+/*
+ * Queue of requests made while ODblocked
+ *
+ * Instead of answering SERVICE_TEMP_UNAVAILABLE, requests are queued and
+ * started in order as soon as the current request has been confirmed, that
+ * is when AL is back in OnReq_Idle. Requests not started within
+ * queue_timeout_ms are confirmed with I_SERVICE_TIMEOUT, at the latest on
+ * the next AL confirmation. All requests wait equally long, so the expired
+ * ones are first in the queue.
+ */
+static bool ode_queue_put (iolink_port_t * port, const iolink_smi_service_req_t * req)
+{
+   iolink_ode_port_t * ode = iolink_get_ode_ctx (port);
+   iolink_ode_pending_t * pending;
+
+   switch (req->arg_block->id)
+   {
+   case IOLINK_ARG_BLOCK_ID_OD_RD:
+   case IOLINK_ARG_BLOCK_ID_OD_WR:
+   case IOLINK_ARG_BLOCK_ID_PORT_INXDEX_LIST:
+   case IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT:
+      break;
+   default:
+      /* Rejected at once */
+      return false;
+   }
+
+   ode_queue_expire (port);
+   if (ode->queue_cnt == IOLINK_ODE_QUEUE_LEN)
+   {
+      return false;
+   }
+
+   pending = &ode->queue[(ode->queue_head + ode->queue_cnt) % IOLINK_ODE_QUEUE_LEN];
+   pending->smi_req        = *req;
+   pending->smi_req.result = IOLINK_SMI_ERRORTYPE_NONE;
+   pending->deadline_us =
+      os_get_current_time_us() + ode->queue_timeout_ms * 1000;
+   ode->queue_cnt++;
+
+   return true;
+}
+
+static void ode_queue_expire (iolink_port_t * port)
+{
+   iolink_ode_port_t * ode = iolink_get_ode_ctx (port);
+   uint32_t now            = os_get_current_time_us();
+
+   if (ode->queue_timeout_ms == 0)
+   {
+      return;
+   }
+
+   while (ode->queue_cnt > 0)
+   {
+      iolink_ode_pending_t * pending = &ode->queue[ode->queue_head];
+
+      if ((int32_t)(now - pending->deadline_us) < 0)
+      {
+         break;
+      }
+
+      ode->queue_head = (ode->queue_head + 1) % IOLINK_ODE_QUEUE_LEN;
+      ode->queue_cnt--;
+
+      iolink_smi_joberror_ind (
+         port,
+         pending->smi_req.exp_arg_block_id,
+         pending->smi_req.arg_block->id,
+         IOLINK_SMI_ERRORTYPE_I_SERVICE_TIMEOUT);
+   }
+}
+
+static iolink_fsm_ode_event_t ode_queue_next (iolink_port_t * port)
+{
+   iolink_ode_port_t * ode = iolink_get_ode_ctx (port);
+   iolink_ode_pending_t * pending;
+
+   ode_queue_expire (port);
+   if (ode->queue_cnt == 0)
+   {
+      return ODE_EVENT_NONE;
+   }
+
+   pending         = &ode->queue[ode->queue_head];
+   ode->queue_head = (ode->queue_head + 1) % IOLINK_ODE_QUEUE_LEN;
+   ode->queue_cnt--;
+   ode->smi_req = pending->smi_req;
+
+   return ODE_EVENT_SMI_DEV_RW_4;
+}
+
+static void ode_queue_flush (iolink_port_t * port, iolink_smi_errortypes_t errortype)
+{
+   iolink_ode_port_t * ode = iolink_get_ode_ctx (port);
+
+   while (ode->queue_cnt > 0)
+   {
+      iolink_ode_pending_t * pending = &ode->queue[ode->queue_head];
+
+      ode->queue_head = (ode->queue_head + 1) % IOLINK_ODE_QUEUE_LEN;
+      ode->queue_cnt--;
+
+      iolink_smi_joberror_ind (
+         port,
+         pending->smi_req.exp_arg_block_id,
+         pending->smi_req.arg_block->id,
+         errortype);
+   }
+}
+
+/*
+ * Device parameter cache
+ *
+ * Identification parameters do not change while a device is connected and
+ * are served from the cache once read. Tags are cached until written and
+ * status parameters for at most cache_ttl_ms. A write invalidates the
+ * cached subindexes of the index, a SystemCommand all of them.
+ */
+typedef enum iolink_ode_cache_policy
+{
+   ODE_CACHE_NONE = 0,
+   ODE_CACHE_IMMUTABLE,
+   ODE_CACHE_UNTIL_WRITE,
+   ODE_CACHE_TTL,
+} iolink_ode_cache_policy_t;
+
+static const struct
+{
+   uint16_t index;
+   iolink_ode_cache_policy_t policy;
+} ode_cache_policies[] = {
+   {IOL_DEV_PARAMA_VENDOR_NAME, ODE_CACHE_IMMUTABLE},
+   {IOL_DEV_PARAMA_VENDOR_TEXT, ODE_CACHE_IMMUTABLE},
+   {IOL_DEV_PARAMA_PRODUCT_NAME, ODE_CACHE_IMMUTABLE},
+   {IOL_DEV_PARAMA_PRODUCT_ID, ODE_CACHE_IMMUTABLE},
+   {IOL_DEV_PARAMA_PRODUCT_TEXT, ODE_CACHE_IMMUTABLE},
+   {IOL_DEV_PARAMA_SERIAL_NUMBER, ODE_CACHE_IMMUTABLE},
+   {IOL_DEV_PARAMA_HARDWARE_REV, ODE_CACHE_IMMUTABLE},
+   {IOL_DEV_PARAMA_FIRMWARE_REV, ODE_CACHE_IMMUTABLE},
+   {IOL_DEV_PARAMA_APP_SPEC_TAG, ODE_CACHE_UNTIL_WRITE},
+   {IOL_DEV_PARAMA_FUNCTION_TAG, ODE_CACHE_UNTIL_WRITE},
+   {IOL_DEV_PARAMA_LOCATION_TAG, ODE_CACHE_UNTIL_WRITE},
+   {IOL_DEV_PARAMA_ERROR_COUNT, ODE_CACHE_TTL},
+   {IOL_DEV_PARAMA_DEVICE_STATUS, ODE_CACHE_TTL},
+};
+
+static iolink_ode_cache_policy_t ode_cache_policy (uint16_t index)
+{
+   uint8_t i;
+
+   for (i = 0; i < NELEMENTS (ode_cache_policies); i++)
+   {
+      if (ode_cache_policies[i].index == index)
+      {
+         return ode_cache_policies[i].policy;
+      }
+   }
+
+   return ODE_CACHE_NONE;
+}
+
+static iolink_ode_cache_entry_t * ode_cache_find (
+   iolink_port_t * port,
+   uint16_t index,
+   uint8_t subindex)
+{
+   iolink_ode_port_t * ode = iolink_get_ode_ctx (port);
+   uint8_t i;
+
+   for (i = 0; i < IOLINK_ODE_CACHE_SIZE; i++)
+   {
+      iolink_ode_cache_entry_t * entry = &ode->cache[i];
+
+      if (
+         entry->valid && (entry->index == index) &&
+         (entry->subindex == subindex))
+      {
+         return entry;
+      }
+   }
+
+   return NULL;
+}
+
+static void ode_cache_store (
+   iolink_port_t * port,
+   uint16_t index,
+   uint8_t subindex,
+   uint8_t len,
+   const uint8_t * data)
+{
+   iolink_ode_port_t * ode          = iolink_get_ode_ctx (port);
+   iolink_ode_cache_policy_t policy = ode_cache_policy (index);
+   iolink_ode_cache_entry_t * entry;
+   uint8_t i;
+
+   if (
+      (policy == ODE_CACHE_NONE) ||
+      ((policy == ODE_CACHE_TTL) && (ode->cache_ttl_ms == 0)) ||
+      (len > IOLINK_ODE_CACHE_DATA_LEN))
+   {
+      return;
+   }
+
+   entry = ode_cache_find (port, index, subindex);
+   if (entry == NULL)
+   {
+      /* Use a free entry, else replace the oldest one */
+      entry = &ode->cache[0];
+      for (i = 0; (i < IOLINK_ODE_CACHE_SIZE) && entry->valid; i++)
+      {
+         if (
+            !ode->cache[i].valid ||
+            ((int32_t)(ode->cache[i].stored_us - entry->stored_us) < 0))
+         {
+            entry = &ode->cache[i];
+         }
+      }
+   }
+
+   entry->valid     = true;
+   entry->index     = index;
+   entry->subindex  = subindex;
+   entry->len       = len;
+   entry->stored_us = os_get_current_time_us();
+   memcpy (entry->data, data, len);
+}
+
+static void ode_cache_invalidate (iolink_port_t * port, uint16_t index)
+{
+   iolink_ode_port_t * ode = iolink_get_ode_ctx (port);
+   uint8_t i;
+
+   for (i = 0; i < IOLINK_ODE_CACHE_SIZE; i++)
+   {
+      if (
+         (index == IOL_DEV_PARAMA_SYSTEM_CMD) ||
+         (ode->cache[i].index == index))
+      {
+         ode->cache[i].valid = false;
+      }
+   }
+}
+
+static void ode_cache_clear (iolink_port_t * port)
+{
+   iolink_ode_port_t * ode = iolink_get_ode_ctx (port);
+
+   memset (ode->cache, 0, sizeof (ode->cache));
+}
+
+/* Check if a queued request may write index */
+static bool ode_cache_write_queued (iolink_port_t * port, uint16_t index)
+{
+   iolink_ode_port_t * ode = iolink_get_ode_ctx (port);
+   uint8_t i;
+
+   for (i = 0; i < ode->queue_cnt; i++)
+   {
+      const iolink_ode_pending_t * pending =
+         &ode->queue[(ode->queue_head + i) % IOLINK_ODE_QUEUE_LEN];
+      const arg_block_t * arg_block = pending->smi_req.arg_block;
+
+      if (arg_block->id == IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT)
+      {
+         return true;
+      }
+      if (arg_block->id == IOLINK_ARG_BLOCK_ID_OD_WR)
+      {
+         uint16_t wr_index = ((const arg_block_od_t *)arg_block)->index;
+
+         if ((wr_index == index) || (wr_index == IOL_DEV_PARAMA_SYSTEM_CMD))
+         {
+            return true;
+         }
+      }
+   }
+
+   return false;
+}
+
+/* Confirm a read from the cache, return true if served */
+static bool ode_cache_read (
+   iolink_port_t * port,
+   const iolink_smi_service_req_t * req)
+{
+   iolink_ode_port_t * ode       = iolink_get_ode_ctx (port);
+   arg_block_od_t * arg_block_od = (arg_block_od_t *)req->arg_block;
+   iolink_ode_cache_entry_t * entry;
+
+   if (
+      (req->exp_arg_block_id != IOLINK_ARG_BLOCK_ID_OD_RD) ||
+      (req->arg_block->id != IOLINK_ARG_BLOCK_ID_OD_RD) ||
+      (req->arg_block_len < sizeof (arg_block_od_t)))
+   {
+      return false;
+   }
+
+   entry = ode_cache_find (port, arg_block_od->index, arg_block_od->subindex);
+   if (entry == NULL)
+   {
+      return false;
+   }
+
+   if (
+      (ode_cache_policy (entry->index) == ODE_CACHE_TTL) &&
+      (os_get_current_time_us() - entry->stored_us >= ode->cache_ttl_ms * 1000))
+   {
+      entry->valid = false;
+      return false;
+   }
+
+   /* Keep the order with respect to queued writes. A result that does not
+    * fit is left to the device read to report */
+   if (
+      ode_cache_write_queued (port, entry->index) ||
+      (req->arg_block_len - sizeof (arg_block_od_t) < entry->len))
+   {
+      return false;
+   }
+
+   memset (arg_block_od->data, 0, req->arg_block_len - sizeof (arg_block_od_t));
+   memcpy (arg_block_od->data, entry->data, entry->len);
+   iolink_smi_cnf (
+      port,
+      IOLINK_ARG_BLOCK_ID_OD_RD,
+      sizeof (arg_block_od_t) + entry->len,
+      req->arg_block);
+
+   return true;
+}
+
+/*
+ * SMI_ParamReadBatch and SMI_ParamWriteBatch
+ *
+ * The objects of a batch are transferred back-to-back: the next AL_Read_req
+ * or AL_Write_req is issued directly from the confirmation of the previous
+ * one, with the FSM staying in ODblocked until the last object is done.
+ */
+static void ode_batch_read_next (iolink_port_t * port)
+{
+   iolink_ode_port_t * ode = iolink_get_ode_ctx (port);
+   const port_index_t * entry =
+      (const port_index_t *)((uint8_t *)ode->smi_req.arg_block + ode->batch.pos);
+
+   AL_Read_req (port, entry->index, entry->subindex, ode_AL_Read_cnf);
+}
+
+static void ode_batch_write_next (iolink_port_t * port)
+{
+   iolink_ode_port_t * ode = iolink_get_ode_ctx (port);
+   dev_par_bat_entry_t * entry =
+      (dev_par_bat_entry_t *)((uint8_t *)ode->smi_req.arg_block + ode->batch.pos);
+
+   AL_Write_req (
+      port,
+      entry->index,
+      entry->subindex,
+      entry->len,
+      entry->data,
+      ode_AL_Write_cnf);
+}
+
+static iolink_fsm_ode_event_t ode_batch_read_start (iolink_port_t * port)
+{
+   iolink_ode_port_t * ode            = iolink_get_ode_ctx (port);
+   iolink_smi_service_req_t * smi_req = &ode->smi_req;
+   arg_block_devparbat_t * res        = (arg_block_devparbat_t *)ode->batch.res;
+   uint16_t list_len = smi_req->arg_block_len - sizeof (arg_block_portindexlist_t);
+   uint16_t n_entries = list_len / sizeof (port_index_t);
+
+   /* Check that the list is well-formed and that the result headers fit,
+    * object data that does not fit is reported per object */
+   if (
+      (smi_req->arg_block_len <= sizeof (arg_block_portindexlist_t)) ||
+      ((list_len % sizeof (port_index_t)) != 0) ||
+      (sizeof (arg_block_devparbat_t) + n_entries * sizeof (dev_par_bat_entry_t) >
+       sizeof (ode->batch.res)))
+   {
+      iolink_smi_joberror_ind (
+         port,
+         smi_req->exp_arg_block_id,
+         smi_req->arg_block->id,
+         IOLINK_SMI_ERRORTYPE_ARGBLOCK_LENGTH_INVALID);
+      return ODE_EVENT_NONE;
+   }
+
+   res->arg_block.id = IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT;
+   ode->batch.res_len = sizeof (arg_block_devparbat_t);
+   ode->batch.pos     = sizeof (arg_block_portindexlist_t);
+   ode->batch.active  = true;
+
+   ode_batch_read_next (port);
+
+   return ODE_EVENT_OD_BLOCK;
+}
+
+static iolink_fsm_ode_event_t ode_batch_write_start (iolink_port_t * port)
+{
+   iolink_ode_port_t * ode            = iolink_get_ode_ctx (port);
+   iolink_smi_service_req_t * smi_req = &ode->smi_req;
+   uint16_t pos                       = sizeof (arg_block_devparbat_t);
+
+   /* Check that all objects are within the ArgBlock */
+   while (pos + sizeof (dev_par_bat_entry_t) <= smi_req->arg_block_len)
+   {
+      const dev_par_bat_entry_t * entry =
+         (const dev_par_bat_entry_t *)((uint8_t *)smi_req->arg_block + pos);
+
+      pos += sizeof (dev_par_bat_entry_t) + entry->len;
+   }
+
+   if (
+      (smi_req->arg_block_len <= sizeof (arg_block_devparbat_t)) ||
+      (pos != smi_req->arg_block_len))
+   {
+      iolink_smi_joberror_ind (
+         port,
+         smi_req->exp_arg_block_id,
+         smi_req->arg_block->id,
+         IOLINK_SMI_ERRORTYPE_ARGBLOCK_LENGTH_INVALID);
+      return ODE_EVENT_NONE;
+   }
+
+   /* Reads made during the batch must not be served from the cache, they
+    * could return a value the batch is about to overwrite */
+   for (pos = sizeof (arg_block_devparbat_t); pos < smi_req->arg_block_len;)
+   {
+      const dev_par_bat_entry_t * entry =
+         (const dev_par_bat_entry_t *)((uint8_t *)smi_req->arg_block + pos);
+
+      ode_cache_invalidate (port, entry->index);
+      pos += sizeof (dev_par_bat_entry_t) + entry->len;
+   }
+
+   ode->batch.pos    = sizeof (arg_block_devparbat_t);
+   ode->batch.active = true;
+
+   ode_batch_write_next (port);
+
+   return ODE_EVENT_OD_BLOCK;
+}
+
+static void ode_batch_read_cnf (
+   iolink_port_t * port,
+   uint8_t len,
+   const uint8_t * data,
+   iolink_smi_errortypes_t errortype)
+{
+   iolink_ode_port_t * ode            = iolink_get_ode_ctx (port);
+   iolink_smi_service_req_t * smi_req = &ode->smi_req;
+   const port_index_t * index =
+      (const port_index_t *)((uint8_t *)smi_req->arg_block + ode->batch.pos);
+   dev_par_bat_entry_t * entry =
+      (dev_par_bat_entry_t *)&ode->batch.res[ode->batch.res_len];
+   uint16_t remaining;
+
+   ode->batch.res_len += sizeof (dev_par_bat_entry_t);
+   ode->batch.pos += sizeof (port_index_t);
+
+   /* Room left for the data, after the headers of the remaining objects */
+   remaining = sizeof (ode->batch.res) - ode->batch.res_len -
+               (smi_req->arg_block_len - ode->batch.pos) /
+                  sizeof (port_index_t) * sizeof (dev_par_bat_entry_t);
+
+   entry->index     = index->index;
+   entry->subindex  = index->subindex;
+   entry->errortype = errortype;
+   entry->len       = 0;
+
+   if (errortype == IOLINK_SMI_ERRORTYPE_NONE)
+   {
+      ode_cache_store (port, index->index, index->subindex, len, data);
+
+      if (len <= remaining)
+      {
+         memcpy (entry->data, data, len);
+         entry->len = len;
+         ode->batch.res_len += len;
+      }
+      else
+      {
+         entry->errortype = IOLINK_SMI_ERRORTYPE_VAL_LENOVRRUN;
+      }
+   }
+
+   if (ode->batch.pos < smi_req->arg_block_len)
+   {
+      ode_batch_read_next (port);
+   }
+   else
+   {
+      ode->batch.active = false;
+      iolink_ode_event (port, ODE_EVENT_OD_UNBLOCK);
+   }
+}
+
+static void ode_batch_write_cnf (
+   iolink_port_t * port,
+   iolink_smi_errortypes_t errortype)
+{
+   iolink_ode_port_t * ode            = iolink_get_ode_ctx (port);
+   iolink_smi_service_req_t * smi_req = &ode->smi_req;
+   dev_par_bat_entry_t * entry =
+      (dev_par_bat_entry_t *)((uint8_t *)smi_req->arg_block + ode->batch.pos);
+
+   entry->errortype = errortype;
+   if (
+      (errortype != IOLINK_SMI_ERRORTYPE_NONE) &&
+      (smi_req->result == IOLINK_SMI_ERRORTYPE_NONE))
+   {
+      smi_req->result = errortype;
+   }
+
+   ode->batch.pos += sizeof (dev_par_bat_entry_t) + entry->len;
+
+   if (ode->batch.pos < smi_req->arg_block_len)
+   {
+      ode_batch_write_next (port);
+   }
+   else
+   {
+      ode->batch.active = false;
+      iolink_ode_event (port, ODE_EVENT_OD_UNBLOCK);
+   }
 }
 
 static iolink_fsm_ode_event_t ode_wait (
@@ -455,17 +1031,41 @@ static void ode_read_cnf_cb (iolink_job_t * job)
    iolink_ode_port_t * ode            = iolink_get_ode_ctx (port);
    iolink_smi_service_req_t * smi_req = &ode->smi_req;
 
+   if (ode->state != ODE_STATE_ODblocked)
+   {
+      /* Request dropped by OD_STOP, e.g. aborted by the AL */
+      return;
+   }
+
+   if (ode->batch.active)
+   {
+      /* Do not wait for the whole batch to time out queued requests */
+      ode_queue_expire (port);
+      ode_batch_read_cnf (
+         port,
+         job->al_read_cnf.data_len,
+         job->al_read_cnf.data,
+         job->al_read_cnf.errortype);
+      return;
+   }
+
    smi_req->result = job->al_read_cnf.errortype;
    if (smi_req->result == IOLINK_SMI_ERRORTYPE_NONE)
    {
-      uint8_t arg_block_len      = smi_req->arg_block_len;
-      uint8_t arg_block_data_len = arg_block_len - sizeof (arg_block_od_t);
-      uint8_t len                = job->al_read_cnf.data_len;
+      uint8_t arg_block_len         = smi_req->arg_block_len;
+      uint8_t arg_block_data_len    = arg_block_len - sizeof (arg_block_od_t);
+      uint8_t len                   = job->al_read_cnf.data_len;
+      arg_block_od_t * arg_block_od = (arg_block_od_t *)smi_req->arg_block;
+
+      ode_cache_store (
+         port,
+         arg_block_od->index,
+         arg_block_od->subindex,
+         len,
+         job->al_read_cnf.data);
 
       if (arg_block_data_len >= len)
       {
-         arg_block_od_t * arg_block_od = (arg_block_od_t *)smi_req->arg_block;
-
          memset (arg_block_od->data, 0, arg_block_data_len);
          memcpy (arg_block_od->data, job->al_read_cnf.data, len);
 
@@ -505,6 +1105,20 @@ static void ode_write_cnf_cb (iolink_job_t * job)
    iolink_ode_port_t * ode            = iolink_get_ode_ctx (port);
    iolink_smi_service_req_t * smi_req = &ode->smi_req;
 
+   if (ode->state != ODE_STATE_ODblocked)
+   {
+      /* Request dropped by OD_STOP, e.g. aborted by the AL */
+      return;
+   }
+
+   if (ode->batch.active)
+   {
+      /* Do not wait for the whole batch to time out queued requests */
+      ode_queue_expire (port);
+      ode_batch_write_cnf (port, job->al_write_cnf.errortype);
+      return;
+   }
+
    if (job->al_write_cnf.errortype != IOLINK_SMI_ERRORTYPE_NONE)
    {
       smi_req->result = job->al_write_cnf.errortype;
@@ -542,6 +1156,14 @@ static void SMI_rw_req_cb (iolink_job_t * job)
    iolink_ode_port_t * ode            = iolink_get_ode_ctx (port);
    iolink_smi_service_req_t * smi_req = &ode->smi_req;
 
+   if (
+      (ode->state != ODE_STATE_Inactive) &&
+      ode_cache_read (port, &job->smi_req))
+   {
+      /* Served from the cache, the OD channel is not used */
+      return;
+   }
+
    switch (ode->state)
    {
    case ODE_STATE_ODactive:
@@ -551,27 +1173,87 @@ static void SMI_rw_req_cb (iolink_job_t * job)
       smi_req->arg_block        = job->smi_req.arg_block;
       event                     = ODE_EVENT_SMI_DEV_RW_4;
       break;
-   case ODE_STATE_Inactive:
    case ODE_STATE_ODblocked:
+      if (ode_queue_put (port, &job->smi_req))
+      {
+         /* Started when the current request is confirmed */
+         break;
+      }
+      /* Queue full, store the job for a negative response */
+      ode->job_smi_req_busy = job;
+      event                 = ODE_EVENT_SMI_DEV_RW_6;
+      break;
+   case ODE_STATE_Inactive:
       /* Store the job, for a negative response */
       ode->job_smi_req_busy = job;
-      event = (ode->state == ODE_STATE_Inactive) ? ODE_EVENT_SMI_DEV_RW_1
-                                                 : ODE_EVENT_SMI_DEV_RW_6;
+      event                 = ODE_EVENT_SMI_DEV_RW_1;
       break;
    default:
       CC_ASSERT (0);
       break;
    }
 
-   iolink_ode_event (port, event);
+   if (event != ODE_EVENT_NONE)
+   {
+      iolink_ode_event (port, event);
+   }
+}
+
+static void SMI_od_cancel_cb (iolink_job_t * job)
+{
+   iolink_port_t * port    = job->port;
+   iolink_ode_port_t * ode = iolink_get_ode_ctx (port);
+   uint8_t n               = ode->queue_cnt;
+   uint8_t i;
+
+   /* Compact the queue, keeping the order of the remaining requests */
+   ode->queue_cnt = 0;
+   for (i = 0; i < n; i++)
+   {
+      iolink_ode_pending_t pending =
+         ode->queue[(ode->queue_head + i) % IOLINK_ODE_QUEUE_LEN];
+
+      if (pending.smi_req.arg_block == job->smi_req.arg_block)
+      {
+         iolink_smi_joberror_ind (
+            port,
+            pending.smi_req.exp_arg_block_id,
+            pending.smi_req.arg_block->id,
+            IOLINK_SMI_ERRORTYPE_SERVICE_TEMP_UNAVAILABLE);
+      }
+      else
+      {
+         ode->queue[(ode->queue_head + ode->queue_cnt) % IOLINK_ODE_QUEUE_LEN] =
+            pending;
+         ode->queue_cnt++;
+      }
+   }
 }
 
 /* Stack internal API */
-void iolink_ode_init (iolink_port_t * port)
+void iolink_ode_init (
+   iolink_port_t * port,
+   uint32_t queue_timeout_ms,
+   uint32_t cache_ttl_ms)
 {
    iolink_ode_port_t * ode = iolink_get_ode_ctx (port);
 
-   ode->state = ODE_STATE_Inactive;
+   ode->state            = ODE_STATE_Inactive;
+   ode->queue_head       = 0;
+   ode->queue_cnt        = 0;
+   ode->queue_timeout_ms = queue_timeout_ms;
+   ode->cache_ttl_ms     = cache_ttl_ms;
+
+   /* Longer times would overflow the microsecond deadlines */
+   if (ode->queue_timeout_ms > IOLINK_ODE_MAX_TIMEOUT_MS)
+   {
+      ode->queue_timeout_ms = IOLINK_ODE_MAX_TIMEOUT_MS;
+   }
+   if (ode->cache_ttl_ms > IOLINK_ODE_MAX_TIMEOUT_MS)
+   {
+      ode->cache_ttl_ms = IOLINK_ODE_MAX_TIMEOUT_MS;
+   }
+   ode_cache_clear (port);
 }
 
 iolink_error_t OD_Start (iolink_port_t * port)
@@ -673,3 +1355,17 @@ iolink_error_t ode_SMI_ParamWriteBatch_req (
       arg_block_len,
       arg_block);
 }
+
+iolink_error_t ode_SMI_ODCancel_req (iolink_port_t * port, arg_block_t * arg_block)
+{
+   iolink_job_t * job     = iolink_fetch_avail_api_job (port);
+   job->smi_req.arg_block = arg_block;
+
+   iolink_post_job_with_type_and_callback (
+      port,
+      job,
+      IOLINK_JOB_SMI_OD_CANCEL,
+      SMI_od_cancel_cb);
+
+   return IOLINK_ERROR_NONE;
+}
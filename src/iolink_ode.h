@@ -29,6 +29,10 @@
 extern "C" {
 #endif
 
+/* Longest queue timeout and cache TTL, deadlines are compared as signed
+ * 32-bit microsecond differences */
+#define IOLINK_ODE_MAX_TIMEOUT_MS (INT32_MAX / 1000)
+
 typedef enum iolink_ode_state
 {
    ODE_STATE_Inactive = 0,
@@ -37,14 +41,59 @@ typedef enum iolink_ode_state
    ODE_STATE_LAST
 } iolink_ode_state_t;
 
+/* SMI_ParamReadBatch and SMI_ParamWriteBatch in progress */
+typedef struct iolink_ode_batch
+{
+   bool active;
+   /* Offset of the current object in the request ArgBlock */
+   uint16_t pos;
+   /* Result of SMI_ParamReadBatch, a DeviceParBatch ArgBlock */
+   uint16_t res_len;
+   uint8_t res[IOLINK_ODE_BATCH_SIZE];
+} iolink_ode_batch_t;
+
+/* Request waiting for the OD channel */
+typedef struct iolink_ode_pending
+{
+   iolink_smi_service_req_t smi_req;
+   uint32_t deadline_us;
+} iolink_ode_pending_t;
+
+/* Cached result of a device parameter read */
+typedef struct iolink_ode_cache_entry
+{
+   bool valid;
+   uint8_t subindex;
+   uint16_t index;
+   uint8_t len;
+   uint32_t stored_us;
+   uint8_t data[IOLINK_ODE_CACHE_DATA_LEN];
+} iolink_ode_cache_entry_t;
+
 typedef struct iolink_ode_port
 {
    iolink_ode_state_t state;
    iolink_smi_service_req_t smi_req;
    iolink_job_t * job_smi_req_busy;
+   iolink_ode_batch_t batch;
+
+   /* Requests made while ODblocked, started in order when the current
+    * request is confirmed */
+   iolink_ode_pending_t queue[IOLINK_ODE_QUEUE_LEN];
+   uint8_t queue_head;
+   uint8_t queue_cnt;
+   uint32_t queue_timeout_ms;
+
+   /* Reads of identification and status parameters, served without
+    * using the OD channel. Cleared on OD_STOP */
+   iolink_ode_cache_entry_t cache[IOLINK_ODE_CACHE_SIZE];
+   uint32_t cache_ttl_ms;
 } iolink_ode_port_t;
 
-void iolink_ode_init (iolink_port_t * port);
+void iolink_ode_init (
+   iolink_port_t * port,
+   uint32_t queue_timeout_ms,
+   uint32_t cache_ttl_ms);
 
 iolink_error_t OD_Start (iolink_port_t * port);
 iolink_error_t OD_Stop (iolink_port_t * port);
@@ -72,6 +121,8 @@ iolink_error_t ode_SMI_ParamWriteBatch_req (
    iolink_arg_block_id_t exp_arg_block_id,
    uint16_t arg_block_len,
    arg_block_t * arg_block);
+
+iolink_error_t ode_SMI_ODCancel_req (iolink_port_t * port, arg_block_t * arg_block);
 #ifdef __cplusplus
 }
 #endif
@@ -27,6 +27,7 @@
 #include "iolink_pde.h"
 #include "iolink_al.h" /* AL_Control_req, AL_GetInput_req, AL_GetInputOutput_req, AL_SetOutput_req */
 #include "iolink_main.h" /* iolink_fetch_avail_job, iolink_fetch_avail_api_job, iolink_post_job, iolink_get_portnumber, iolink_get_port_info */
+#include "iolink_pi.h"   /* iolink_pi_send_pdout */
 
 #include "osal_log.h"
 
@@ -135,6 +136,9 @@ iolink_error_t PD_Start (iolink_port_t * port)
 
    pde->state = PD_STATE_PDactive;
 
+   /* The application may have written the output before operate */
+   iolink_pi_send_pdout (port);
+
    return IOLINK_ERROR_NONE;
 }
 
@@ -0,0 +1,200 @@
+/*********************************************************************
+ *        _       _         _
+ *  _ __ | |_  _ | |  __ _ | |__   ___
+ * | '__|| __|(_)| | / _` || '_ \ / __|
+ * | |   | |_  _ | || (_| || |_) |\__ \
+ * |_|    \__|(_)|_| \__,_||_.__/ |___/
+ *
+ * www.rt-labs.com
+ * Copyright 2024 rt-labs AB, Sweden.
+ *
+ * This software is dual-licensed under GPLv3 and a commercial
+ * license. See the file LICENSE.md distributed with this software for
+ * full license information.
+ ********************************************************************/
+
+#include "iolink_pdx.h"
+#include "iolink_al.h" /* AL_GetInput_req */
+
+#include <string.h>
+
+/**
+ * @file
+ * @brief PD field extraction
+ *
+ */
+
+/* Octets readable after the last PD octet, one window */
+#define PDX_WINDOW_LEN 8
+
+static inline uint64_t pdx_load_be64 (const uint8_t * p)
+{
+   return ((uint64_t)p[0] << 56) | ((uint64_t)p[1] << 48) |
+          ((uint64_t)p[2] << 40) | ((uint64_t)p[3] << 32) |
+          ((uint64_t)p[4] << 24) | ((uint64_t)p[5] << 16) |
+          ((uint64_t)p[6] << 8) | (uint64_t)p[7];
+}
+
+static iolink_pdx_prog_t * pdx_find (
+   iolink_pdx_t * pdx,
+   uint16_t vendorid,
+   uint32_t deviceid)
+{
+   uint8_t i;
+
+   for (i = 0; i < IOLINK_PD_DESC_CNT; i++)
+   {
+      iolink_pdx_prog_t * prog = &pdx->prog[i];
+
+      if (
+         prog->used && (prog->vendorid == vendorid) &&
+         (prog->deviceid == deviceid))
+      {
+         return prog;
+      }
+   }
+
+   return NULL;
+}
+
+static bool pdx_compile (
+   iolink_pdx_prog_t * prog,
+   const iolink_pd_desc_t * desc)
+{
+   uint16_t pd_bits = 8 * desc->pdin_len;
+   uint8_t i;
+
+   if (
+      (desc->pdin_len > IOLINK_PD_MAX_SIZE) ||
+      (desc->field_cnt > IOLINK_PD_DESC_FIELDS) ||
+      ((desc->field_cnt > 0) && (desc->fields == NULL)))
+   {
+      return false;
+   }
+
+   for (i = 0; i < desc->field_cnt; i++)
+   {
+      const iolink_pd_field_desc_t * field = &desc->fields[i];
+      iolink_pdx_op_t * op                 = &prog->ops[i];
+      uint16_t first;
+      uint16_t last;
+
+      if (
+         (field->bit_len == 0) || (field->bit_len > 32) ||
+         (field->bit_offset + field->bit_len > pd_bits))
+      {
+         return false;
+      }
+
+      /* Bit positions counted from the MSB of the first octet */
+      first = pd_bits - field->bit_offset - field->bit_len;
+      last  = pd_bits - 1 - field->bit_offset;
+
+      op->octet    = first / 8;
+      op->shift    = 63 - (last - 8 * op->octet);
+      op->mask     = (1ULL << field->bit_len) - 1;
+      op->sign     = field->is_signed ? (1ULL << (field->bit_len - 1)) : 0;
+      op->gradient = (field->gradient != 0) ? field->gradient : 1;
+      op->offset   = field->offset;
+   }
+
+   prog->vendorid = desc->vendorid;
+   prog->deviceid = desc->deviceid;
+   prog->pdin_len = desc->pdin_len;
+   prog->op_cnt   = desc->field_cnt;
+
+   return true;
+}
+
+iolink_error_t iolink_pdx_add (
+   iolink_pdx_t * pdx,
+   const iolink_pd_desc_t * desc)
+{
+   iolink_pdx_prog_t prog;
+   iolink_pdx_prog_t * slot;
+   uint8_t i;
+
+   memset (&prog, 0, sizeof (prog));
+   if (!pdx_compile (&prog, desc))
+   {
+      return IOLINK_ERROR_PARAMETER_CONFLICT;
+   }
+
+   slot = pdx_find (pdx, desc->vendorid, desc->deviceid);
+   for (i = 0; (slot == NULL) && (i < IOLINK_PD_DESC_CNT); i++)
+   {
+      if (!pdx->prog[i].used)
+      {
+         slot = &pdx->prog[i];
+      }
+   }
+
+   if (slot == NULL)
+   {
+      return IOLINK_ERROR_OUT_OF_MEMORY;
+   }
+
+   prog.used = true;
+   *slot     = prog;
+
+   return IOLINK_ERROR_NONE;
+}
+
+void iolink_pdx_run (
+   const iolink_pdx_prog_t * prog,
+   const uint8_t * pd,
+   float * values)
+{
+   uint8_t i;
+
+   for (i = 0; i < prog->op_cnt; i++)
+   {
+      const iolink_pdx_op_t * op = &prog->ops[i];
+      uint64_t raw = (pdx_load_be64 (&pd[op->octet]) >> op->shift) & op->mask;
+      int64_t value = (int64_t)(raw ^ op->sign) - (int64_t)op->sign;
+
+      values[i] = (float)value * op->gradient + op->offset;
+   }
+}
+
+iolink_error_t iolink_pdx_decode (
+   iolink_port_t * port,
+   float * values,
+   uint8_t * cnt)
+{
+   iolink_pdx_t * pdx                   = iolink_get_pdx (port);
+   const iolink_port_info_t * port_info = iolink_get_port_info (port);
+   uint8_t i                            = iolink_get_portnumber (port) - 1;
+   const iolink_pdx_prog_t * prog       = pdx->bound[i];
+   uint8_t pd[IOLINK_PD_MAX_SIZE + PDX_WINDOW_LEN];
+   uint8_t pdin_len;
+
+   if (
+      (prog == NULL) || (prog->vendorid != port_info->vendorid) ||
+      (prog->deviceid != port_info->deviceid))
+   {
+      prog = pdx_find (pdx, port_info->vendorid, port_info->deviceid);
+      if (prog == NULL)
+      {
+         return IOLINK_ERROR_STATE_INVALID;
+      }
+      pdx->bound[i] = prog;
+   }
+
+   if (*cnt < prog->op_cnt)
+   {
+      return IOLINK_ERROR_PARAMETER_CONFLICT;
+   }
+
+   memset (pd, 0, sizeof (pd));
+   AL_GetInput_req (port, &pdin_len, pd);
+   if (pdin_len != prog->pdin_len)
+   {
+      return IOLINK_ERROR_PDINLENGTH;
+   }
+
+   iolink_pdx_run (prog, pd, values);
+   *cnt = prog->op_cnt;
+
+   return IOLINK_ERROR_NONE;
+}
@@ -0,0 +1,105 @@
+/*********************************************************************
+ *        _       _         _
+ *  _ __ | |_  _ | |  __ _ | |__   ___
+ * | '__|| __|(_)| | / _` || '_ \ / __|
+ * | |   | |_  _ | || (_| || |_) |\__ \
+ * |_|    \__|(_)|_| \__,_||_.__/ |___/
+ *
+ * www.rt-labs.com
+ * Copyright 2024 rt-labs AB, Sweden.
+ *
+ * This software is dual-licensed under GPLv3 and a commercial
+ * license. See the file LICENSE.md distributed with this software for
+ * full license information.
+ ********************************************************************/
+
+/**
+ * @file
+ * @brief PD field extraction
+ *
+ * PD descriptions are compiled into a flat list of operations, one per
+ * field. Each operation loads a 64-bit big-endian window of PD input and
+ * extracts the field with a shift and a mask, so decoding a field takes
+ * no branches.
+ */
+
+#ifndef IOLINK_PDX_H
+#define IOLINK_PDX_H
+
+#include "iolink_main.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct iolink_pdx_op
+{
+   uint8_t octet; /* First octet of the window */
+   uint8_t shift; /* Right shift of the window to the field LSB */
+   uint64_t mask;
+   uint64_t sign; /* Sign bit of the field, 0 if unsigned */
+   float gradient;
+   float offset;
+} iolink_pdx_op_t;
+
+typedef struct iolink_pdx_prog
+{
+   bool used;
+   uint16_t vendorid;
+   uint32_t deviceid;
+   uint8_t pdin_len;
+   uint8_t op_cnt;
+   iolink_pdx_op_t ops[IOLINK_PD_DESC_FIELDS];
+} iolink_pdx_prog_t;
+
+struct iolink_pdx
+{
+   iolink_pdx_prog_t prog[IOLINK_PD_DESC_CNT];
+
+   /* Program of the device last decoded on each port */
+   const iolink_pdx_prog_t * bound[IOLINK_NUM_PORTS];
+};
+
+/**
+ * Compile a PD description and add it, replacing a previous program for
+ * the same device.
+ *
+ * @param pdx           PD extraction
+ * @param desc          Description
+ * @return Error type
+ */
+iolink_error_t iolink_pdx_add (
+   iolink_pdx_t * pdx,
+   const iolink_pd_desc_t * desc);
+
+/**
+ * Run a program.
+ *
+ * @param prog          Program
+ * @param pd            PD input, readable up to IOLINK_PD_MAX_SIZE + 8
+ *                      octets
+ * @param values        Destination, prog->op_cnt values
+ */
+void iolink_pdx_run (
+   const iolink_pdx_prog_t * prog,
+   const uint8_t * pd,
+   float * values);
+
+/**
+ * Decode the PD input of a port with the program of its device.
+ *
+ * @param port          Port
+ * @param values        Destination
+ * @param cnt           In: size of values. Out: number of values
+ * @return Error type
+ */
+iolink_error_t iolink_pdx_decode (
+   iolink_port_t * port,
+   float * values,
+   uint8_t * cnt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IOLINK_PDX_H */
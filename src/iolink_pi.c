@@ -0,0 +1,302 @@
+/*********************************************************************
+ *        _       _         _
+ *  _ __ | |_  _ | |  __ _ | |__   ___
+ * | '__|| __|(_)| | / _` || '_ \ / __|
+ * | |   | |_  _ | || (_| || |_) |\__ \
+ * |_|    \__|(_)|_| \__,_||_.__/ |___/
+ *
+ * www.rt-labs.com
+ * Copyright 2024 rt-labs AB, Sweden.
+ *
+ * This software is dual-licensed under GPLv3 and a commercial
+ * license. See the file LICENSE.md distributed with this software for
+ * full license information.
+ ********************************************************************/
+
+#ifdef UNIT_TEST
+#include "mocks.h"
+#define AL_SetOutput_req           mock_AL_SetOutput_req
+#define iolink_fetch_avail_api_job mock_iolink_fetch_avail_api_job
+#endif /* UNIT_TEST */
+
+#include "iolink_pi.h"
+#include "iolink_al.h"   /* AL_SetOutput_req */
+#include "iolink_main.h" /* iolink_fetch_avail_api_job, iolink_get_pi */
+#include "iolink_pde.h"  /* iolink_pde_port_t */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @file
+ * @brief Master process image
+ *
+ */
+
+#define IOLINK_PI_ROUND_UP(n)                                                  \
+   (((n) + IOLINK_PI_ALIGN - 1) & ~(IOLINK_PI_ALIGN - 1))
+
+static bool pi_in_area (uint16_t offset, uint16_t len, uint16_t size)
+{
+   return (offset == IOLINK_PI_UNMAPPED) || ((uint32_t)offset + len <= size);
+}
+
+static void pi_write_begin (iolink_pi_t * pi)
+{
+   os_mutex_lock (pi->mtx);
+   iolink_seqlock_write_begin (&pi->generation);
+}
+
+static void pi_write_end (iolink_pi_t * pi)
+{
+   iolink_seqlock_write_end (&pi->generation);
+   os_mutex_unlock (pi->mtx);
+}
+
+bool iolink_pi_init (iolink_pi_t * pi, const iolink_m_cfg_t * m_cfg)
+{
+   uint16_t input_alloc  = IOLINK_PI_ROUND_UP (m_cfg->pi_input_size);
+   uint16_t output_alloc = IOLINK_PI_ROUND_UP (m_cfg->pi_output_size);
+   uint16_t in           = m_cfg->pi_input_size;
+   uint16_t out          = m_cfg->pi_output_size;
+   uint8_t i;
+
+   memset (pi, 0, sizeof (*pi));
+
+   if ((in == 0) && (out == 0))
+   {
+      return true;
+   }
+
+   for (i = 0; i < m_cfg->port_cnt; i++)
+   {
+      const iolink_pi_map_t * map = m_cfg->port_cfgs[i].pi_map;
+
+      if (map == NULL)
+      {
+         continue;
+      }
+
+      if (
+         !pi_in_area (map->pqi_offset, 1, in) ||
+         !pi_in_area (map->status_offset, 1, in) ||
+         !pi_in_area (map->pdin_offset, map->pdin_len, in) ||
+         !pi_in_area (map->pdout_offset, map->pdout_len, out) ||
+         (map->pdin_len > IOLINK_PD_MAX_SIZE) ||
+         (map->pdout_len > IOLINK_PD_MAX_SIZE))
+      {
+         return false;
+      }
+
+      pi->mapped[i] = true;
+      pi->map[i]    = *map;
+   }
+
+   pi->mem = calloc (1, input_alloc + output_alloc + IOLINK_PI_ALIGN - 1);
+   if (pi->mem == NULL)
+   {
+      return false;
+   }
+
+   pi->input       = (uint8_t *)IOLINK_PI_ROUND_UP ((uintptr_t)pi->mem);
+   pi->output      = pi->input + input_alloc;
+   pi->input_size  = in;
+   pi->output_size = out;
+   pi->mtx         = os_mutex_create();
+   iolink_seqlock_init (&pi->generation, pi->mtx);
+
+   return true;
+}
+
+void iolink_pi_deinit (iolink_pi_t * pi)
+{
+   if (pi->mem != NULL)
+   {
+      os_mutex_destroy (pi->mtx);
+      free (pi->mem);
+   }
+
+   memset (pi, 0, sizeof (*pi));
+}
+
+void iolink_pi_update_pdin (
+   iolink_port_t * port,
+   const uint8_t * data,
+   uint8_t len)
+{
+   iolink_pi_t * pi            = iolink_get_pi (port);
+   uint8_t i                   = iolink_get_portnumber (port) - 1;
+   const iolink_pi_map_t * map = &pi->map[i];
+   uint8_t * slot;
+
+   if (!pi->mapped[i] || (map->pdin_offset == IOLINK_PI_UNMAPPED))
+   {
+      return;
+   }
+
+   slot = &pi->input[map->pdin_offset];
+   if (len > map->pdin_len)
+   {
+      len = map->pdin_len;
+   }
+
+   pi_write_begin (pi);
+   memcpy (slot, data, len);
+   memset (&slot[len], 0, map->pdin_len - len);
+   pi_write_end (pi);
+}
+
+void iolink_pi_update_port_info (iolink_port_t * port)
+{
+   iolink_pi_t * pi                 = iolink_get_pi (port);
+   uint8_t i                        = iolink_get_portnumber (port) - 1;
+   const iolink_pi_map_t * map      = &pi->map[i];
+   const iolink_port_info_t * info  = iolink_get_port_info (port);
+   iolink_port_qualifier_info_t pqi = IOLINK_PORT_QUALIFIER_INFO_PQ_VALID;
+   uint8_t status                   = info->port_status_info;
+   bool changed                     = false;
+
+   if (!pi->mapped[i])
+   {
+      return;
+   }
+
+   if (info->port_quality_info & IOLINK_PORT_QUALITY_INFO_INVALID)
+   {
+      pqi = IOLINK_PORT_QUALIFIER_INFO_PQ_INVALID;
+   }
+
+   /* The master thread is the only writer of these, no lock needed to
+    * check for a change */
+   if (map->pqi_offset != IOLINK_PI_UNMAPPED)
+   {
+      changed |= (pi->input[map->pqi_offset] != pqi);
+   }
+   if (map->status_offset != IOLINK_PI_UNMAPPED)
+   {
+      changed |= (pi->input[map->status_offset] != status);
+   }
+
+   if (!changed)
+   {
+      return;
+   }
+
+   pi_write_begin (pi);
+   if (map->pqi_offset != IOLINK_PI_UNMAPPED)
+   {
+      pi->input[map->pqi_offset] = pqi;
+   }
+   if (map->status_offset != IOLINK_PI_UNMAPPED)
+   {
+      pi->input[map->status_offset] = status;
+   }
+   pi_write_end (pi);
+}
+
+void iolink_pi_send_pdout (iolink_port_t * port)
+{
+   iolink_pi_t * pi            = iolink_get_pi (port);
+   uint8_t i                   = iolink_get_portnumber (port) - 1;
+   const iolink_pi_map_t * map = &pi->map[i];
+   iolink_pde_port_t * pde     = iolink_get_pde_ctx (port);
+   uint8_t data[IOLINK_PD_MAX_SIZE];
+
+   if (
+      !pi->mapped[i] || (map->pdout_offset == IOLINK_PI_UNMAPPED) ||
+      (pde->state != PD_STATE_PDactive))
+   {
+      return;
+   }
+
+   /* The device may have more PD output than the slot */
+   memset (data, 0, sizeof (data));
+   os_mutex_lock (pi->mtx);
+   memcpy (data, &pi->output[map->pdout_offset], map->pdout_len);
+   os_mutex_unlock (pi->mtx);
+
+   AL_SetOutput_req (port, data);
+}
+
+iolink_error_t pi_read_input (
+   iolink_pi_t * pi,
+   void * data,
+   uint16_t len,
+   uint32_t * generation)
+{
+   iolink_seqlock_read_t read = {0};
+
+   if (len > pi->input_size)
+   {
+      return IOLINK_ERROR_PARAMETER_CONFLICT;
+   }
+
+   do
+   {
+      iolink_seqlock_read_begin (&pi->generation, &read);
+      memcpy (data, pi->input, len);
+   } while (iolink_seqlock_read_retry (&pi->generation, &read));
+
+   if (generation != NULL)
+   {
+      *generation = read.seq / 2;
+   }
+
+   return IOLINK_ERROR_NONE;
+}
+
+static void pi_output_cb (iolink_job_t * job)
+{
+   iolink_pi_t * pi    = iolink_get_pi (job->port);
+   iolink_m_t * master = iolink_get_master (job->port);
+   uint8_t i;
+
+   /* Writes from now on queue a new job */
+   os_mutex_lock (pi->mtx);
+   pi->output_queued = false;
+   os_mutex_unlock (pi->mtx);
+
+   for (i = 0; i < IOLINK_NUM_PORTS; i++)
+   {
+      if (pi->mapped[i])
+      {
+         iolink_pi_send_pdout (iolink_get_port (master, i + 1));
+      }
+   }
+}
+
+iolink_error_t pi_write_output (
+   iolink_port_t * port,
+   const void * data,
+   uint16_t len)
+{
+   iolink_pi_t * pi = iolink_get_pi (port);
+   iolink_job_t * job;
+   bool queue;
+
+   if (len > pi->output_size)
+   {
+      return IOLINK_ERROR_PARAMETER_CONFLICT;
+   }
+
+   /* The AL is only used from the master thread. One job at a time is
+    * enough, it sends the latest output. */
+   os_mutex_lock (pi->mtx);
+   memcpy (pi->output, data, len);
+   queue             = !pi->output_queued;
+   pi->output_queued = true;
+   os_mutex_unlock (pi->mtx);
+
+   if (queue)
+   {
+      job = iolink_fetch_avail_api_job (port);
+      iolink_post_job_with_type_and_callback (
+         port,
+         job,
+         IOLINK_JOB_PI_OUTPUT,
+         pi_output_cb);
+   }
+
+   return IOLINK_ERROR_NONE;
+}
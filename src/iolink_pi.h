@@ -0,0 +1,128 @@
+/*********************************************************************
+ *        _       _         _
+ *  _ __ | |_  _ | |  __ _ | |__   ___
+ * | '__|| __|(_)| | / _` || '_ \ / __|
+ * | |   | |_  _ | || (_| || |_) |\__ \
+ * |_|    \__|(_)|_| \__,_||_.__/ |___/
+ *
+ * www.rt-labs.com
+ * Copyright 2024 rt-labs AB, Sweden.
+ *
+ * This software is dual-licensed under GPLv3 and a commercial
+ * license. See the file LICENSE.md distributed with this software for
+ * full license information.
+ ********************************************************************/
+
+/**
+ * @file
+ * @brief Master process image
+ *
+ * Input and output areas holding the PD, PQI and port status of all mapped
+ * ports at configurable offsets. The input area is updated in place by the
+ * DL and master threads. Readers copy it under a sequence lock, whose
+ * sequence is the generation of the image.
+ */
+
+#ifndef IOLINK_PI_H
+#define IOLINK_PI_H
+
+#include "iolink_main.h"
+#include "iolink_seqlock.h"
+#include "osal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Alignment of the input and output areas, a cache line */
+#define IOLINK_PI_ALIGN 64
+
+struct iolink_pi
+{
+   uint8_t * mem;
+   uint8_t * input;
+   uint8_t * output;
+   uint16_t input_size;
+   uint16_t output_size;
+
+   /* Serialises writers of the input area and users of the output area */
+   os_mutex_t * mtx;
+   iolink_seqlock_t generation;
+
+   /* A job to send the output area is queued to the master thread */
+   bool output_queued;
+
+   bool mapped[IOLINK_NUM_PORTS];
+   iolink_pi_map_t map[IOLINK_NUM_PORTS];
+};
+
+/**
+ * Allocate the process image and check the port maps.
+ *
+ * @param pi            Process image
+ * @param m_cfg         Master configuration
+ * @return true on success, false if a map is outside the image or out of
+ *         memory
+ */
+bool iolink_pi_init (iolink_pi_t * pi, const iolink_m_cfg_t * m_cfg);
+
+/**
+ * Free the process image.
+ *
+ * @param pi            Process image
+ */
+void iolink_pi_deinit (iolink_pi_t * pi);
+
+/**
+ * Update the PD input of a port. Called from the DL thread.
+ *
+ * @param port          Port
+ * @param data          PD input
+ * @param len           PD input length
+ */
+void iolink_pi_update_pdin (
+   iolink_port_t * port,
+   const uint8_t * data,
+   uint8_t len);
+
+/**
+ * Update the PQI and port status of a port, if changed. Called from the
+ * master thread.
+ *
+ * @param port          Port
+ */
+void iolink_pi_update_port_info (iolink_port_t * port);
+
+/**
+ * Send the PD output of a port from the output area to the device. Called
+ * from the master thread.
+ *
+ * @param port          Port
+ */
+void iolink_pi_send_pdout (iolink_port_t * port);
+
+iolink_error_t pi_read_input (
+   iolink_pi_t * pi,
+   void * data,
+   uint16_t len,
+   uint32_t * generation);
+
+/**
+ * Write the output area and queue a job to send it to the devices. Called
+ * from the application.
+ *
+ * @param port          Any port of the master
+ * @param data          Output image
+ * @param len           Output image length
+ * @return IOLINK_ERROR_NONE on success
+ */
+iolink_error_t pi_write_output (
+   iolink_port_t * port,
+   const void * data,
+   uint16_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IOLINK_PI_H */
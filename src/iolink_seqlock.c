@@ -0,0 +1,80 @@
+/*********************************************************************
+ *        _       _         _
+ *  _ __ | |_  _ | |  __ _ | |__   ___
+ * | '__|| __|(_)| | / _` || '_ \ / __|
+ * | |   | |_  _ | || (_| || |_) |\__ \
+ * |_|    \__|(_)|_| \__,_||_.__/ |___/
+ *
+ * www.rt-labs.com
+ * Copyright 2024 rt-labs AB, Sweden.
+ *
+ * This software is dual-licensed under GPLv3 and a commercial
+ * license. See the file LICENSE.md distributed with this software for
+ * full license information.
+ ********************************************************************/
+
+#include "iolink_seqlock.h"
+
+/**
+ * @file
+ * @brief Sequence lock
+ *
+ */
+
+void iolink_seqlock_init (iolink_seqlock_t * lock, os_mutex_t * mtx)
+{
+   lock->mtx = mtx;
+   lock->seq = 0;
+}
+
+void iolink_seqlock_write_begin (iolink_seqlock_t * lock)
+{
+   __atomic_fetch_add (&lock->seq, 1, __ATOMIC_ACQ_REL);
+}
+
+void iolink_seqlock_write_end (iolink_seqlock_t * lock)
+{
+   __atomic_fetch_add (&lock->seq, 1, __ATOMIC_RELEASE);
+}
+
+void iolink_seqlock_read_begin (
+   iolink_seqlock_t * lock,
+   iolink_seqlock_read_t * read)
+{
+   while (read->tries < IOLINK_SEQLOCK_MAX_RETRIES)
+   {
+      read->seq = __atomic_load_n (&lock->seq, __ATOMIC_ACQUIRE);
+      if ((read->seq & 1) == 0)
+      {
+         return;
+      }
+
+      /* Update in progress */
+      read->tries++;
+   }
+
+   /* Wait for the writers instead */
+   os_mutex_lock (lock->mtx);
+   read->seq    = __atomic_load_n (&lock->seq, __ATOMIC_RELAXED);
+   read->locked = true;
+}
+
+bool iolink_seqlock_read_retry (
+   iolink_seqlock_t * lock,
+   iolink_seqlock_read_t * read)
+{
+   if (read->locked)
+   {
+      os_mutex_unlock (lock->mtx);
+      return false;
+   }
+
+   __atomic_thread_fence (__ATOMIC_ACQUIRE);
+   if (__atomic_load_n (&lock->seq, __ATOMIC_RELAXED) == read->seq)
+   {
+      return false;
+   }
+
+   read->tries++;
+   return true;
+}
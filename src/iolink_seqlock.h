@@ -0,0 +1,114 @@
+/*********************************************************************
+ *        _       _         _
+ *  _ __ | |_  _ | |  __ _ | |__   ___
+ * | '__|| __|(_)| | / _` || '_ \ / __|
+ * | |   | |_  _ | || (_| || |_) |\__ \
+ * |_|    \__|(_)|_| \__,_||_.__/ |___/
+ *
+ * www.rt-labs.com
+ * Copyright 2024 rt-labs AB, Sweden.
+ *
+ * This software is dual-licensed under GPLv3 and a commercial
+ * license. See the file LICENSE.md distributed with this software for
+ * full license information.
+ ********************************************************************/
+
+/**
+ * @file
+ * @brief Sequence lock
+ *
+ * Lets readers copy data without taking the mutex of its writers. Writers
+ * hold the mutex and bump the sequence before and after an update, so it
+ * is odd while the data is written. Readers copy the data and retry if the
+ * sequence was odd or changed meanwhile:
+ *
+ * @code
+ * iolink_seqlock_read_t read = {0};
+ *
+ * do
+ * {
+ *    iolink_seqlock_read_begin (&lock, &read);
+ *    memcpy (copy, data, len);
+ * } while (iolink_seqlock_read_retry (&lock, &read));
+ * @endcode
+ *
+ * A reader that has retried IOLINK_SEQLOCK_MAX_RETRIES times takes the
+ * mutex instead, so frequent updates can not keep it spinning.
+ */
+
+#ifndef IOLINK_SEQLOCK_H
+#define IOLINK_SEQLOCK_H
+
+#include "osal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Lock-free tries of a reader before it takes the mutex */
+#define IOLINK_SEQLOCK_MAX_RETRIES 100
+
+typedef struct iolink_seqlock
+{
+   os_mutex_t * mtx; /* Held by writers, not owned */
+   uint32_t seq;     /* Accessed with __atomic builtins */
+} iolink_seqlock_t;
+
+/* Read in progress, zeroed before the first iolink_seqlock_read_begin() */
+typedef struct iolink_seqlock_read
+{
+   uint32_t seq;
+   uint16_t tries;
+   bool locked;
+} iolink_seqlock_read_t;
+
+/**
+ * Initialise a sequence lock.
+ *
+ * @param lock          Sequence lock
+ * @param mtx           Mutex held by the writers
+ */
+void iolink_seqlock_init (iolink_seqlock_t * lock, os_mutex_t * mtx);
+
+/**
+ * Start an update. Called with the mutex held.
+ *
+ * @param lock          Sequence lock
+ */
+void iolink_seqlock_write_begin (iolink_seqlock_t * lock);
+
+/**
+ * End an update. Called with the mutex held.
+ *
+ * @param lock          Sequence lock
+ */
+void iolink_seqlock_write_end (iolink_seqlock_t * lock);
+
+/**
+ * Start a copy of the data.
+ *
+ * @param lock          Sequence lock
+ * @param read          Read in progress. read->seq is the even sequence
+ *                      the copy is made at
+ */
+void iolink_seqlock_read_begin (
+   iolink_seqlock_t * lock,
+   iolink_seqlock_read_t * read);
+
+/**
+ * Check a copy of the data.
+ *
+ * @param lock          Sequence lock
+ * @param read          Read in progress
+ * @return true if the data was updated during the copy, which must then be
+ *         made again, false if the copy is consistent
+ */
+bool iolink_seqlock_read_retry (
+   iolink_seqlock_t * lock,
+   iolink_seqlock_read_t * read);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IOLINK_SEQLOCK_H */
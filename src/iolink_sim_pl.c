@@ -0,0 +1,1119 @@
+/*********************************************************************
+ *        _       _         _
+ *  _ __ | |_  _ | |  __ _ | |__   ___
+ * | '__|| __|(_)| | / _` || '_ \ / __|
+ * | |   | |_  _ | || (_| || |_) |\__ \
+ * |_|    \__|(_)|_| \__,_||_.__/ |___/
+ *
+ * www.rt-labs.com
+ * Copyright 2024 rt-labs AB, Sweden.
+ *
+ * This software is dual-licensed under GPLv3 and a commercial
+ * license. See the file LICENSE.md distributed with this software for
+ * full license information.
+ ********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <iolink_dl.h>
+
+#include "iolink_sim.h"
+#include "iolink_main.h" /* iservice_t */
+#include "iolink_pl_hw_drv.h"
+#include "osal_log.h"
+
+/**
+ * @file
+ * @brief Simulated IO-Link devices
+ *
+ * Implements the device side of the IO-Link message exchange behind the PL
+ * driver interface. Master messages handed over by the DL (MC, CKT, PD out
+ * and OD out) are answered with the reply of a virtual device (OD in, PD in
+ * and CKS), exactly as they would be read back from the MAX14819 RX FIFO.
+ *
+ * As with the MAX14819, the checksum of the master message is not part of
+ * the data handed over by the DL, and the CKS checksum bits of the reply are
+ * not checked by the DL. Checksum errors are reported through get_error.
+ */
+
+#define SIM_MC_READ         BIT (7)
+#define SIM_MC_CHANNEL_MASK 0x60
+#define SIM_MC_ADDR_MASK    0x1F
+#define SIM_CKT_TYPE(ckt)   ((ckt) >> 6)
+#define SIM_CKT_TYPE_2      2
+#define SIM_CKS_EVENT       BIT (7)
+#define SIM_CKS_PD_INVALID  BIT (6)
+
+/* Error bits as reported by the MAX14819 CQErr and DeviceDly registers */
+#define SIM_CQERR_RCHKSMER  BIT (3)
+#define SIM_DEVDLY_DELAYERR BIT (7)
+
+/* Direct parameter page 1 addresses */
+#define SIM_PAGE_MASTERCMD 0
+#define SIM_PAGE_MINCYCL   2
+#define SIM_PAGE_PDIN      5
+#define SIM_PAGE_PDOUT     6
+#define SIM_PAGE_SIZE      16
+
+#define SIM_ISDU_BUSY     ((IOL_ISERVICE_DEVICE_NO_SERVICE << 4) | 0x01)
+#define SIM_ISDU_BUF_SIZE (IOLINK_ISDU_MAX_SIZE + IOLINK_OD_MAX_SIZE)
+
+typedef struct iolink_sim_event
+{
+   uint8_t qualifier;
+   uint16_t code;
+} iolink_sim_event_t;
+
+typedef struct iolink_sim_ch
+{
+   struct iolink_sim_drv * sim;
+   iolink_sim_device_cfg_t dev;
+   iolink_sim_faults_t faults;
+   iolink_pl_mode_t mode;
+
+   os_event_t * dl_event;
+   uint32_t pending;
+   bool wurq_done;
+
+   uint8_t cycbyte;
+   bool cycle_timer_en;
+   os_timer_t * cycle_timer;
+   os_timer_t * reply_timer;
+
+   /* Master message, as downloaded to the "TX FIFO" */
+   uint8_t msg[IOLINK_RXTX_BUFFER_SIZE];
+   uint8_t msg_txlen;
+   uint8_t msg_rxlen;
+
+   /* Device reply, as read from the "RX FIFO" */
+   uint8_t reply[IOLINK_RXTX_BUFFER_SIZE];
+   uint8_t reply_len;
+   bool reply_busy;
+   bool reply_ready;
+   bool reply_error;
+
+   uint8_t cqerr;
+   uint8_t devdly;
+
+   uint8_t pdin[IOLINK_PD_MAX_SIZE];
+   bool pdin_valid;
+   uint8_t pdout[IOLINK_PD_MAX_SIZE];
+   uint8_t pdout_len;
+
+   struct
+   {
+      uint8_t req[SIM_ISDU_BUF_SIZE];
+      uint16_t req_pos;
+      uint8_t rsp[SIM_ISDU_BUF_SIZE];
+      uint16_t rsp_len;
+      uint16_t rsp_pos;
+      bool rsp_ready;
+      uint8_t busy_left;
+   } isdu;
+
+   iolink_sim_event_t events[IOLINK_SIM_MAX_EVENTS];
+   uint8_t event_cnt;
+} iolink_sim_ch_t;
+
+typedef struct iolink_sim_drv
+{
+   /* Generic driver interface */
+   iolink_hw_drv_t drv;
+
+   os_mutex_t * exclusive;
+   uint32_t pl_flag;
+   uint32_t rng;
+   uint8_t channel_cnt;
+   iolink_sim_ch_t * ch;
+} iolink_sim_drv_t;
+
+static iolink_sim_ch_t * iolink_sim_get_ch (iolink_hw_drv_t * iolink_hw, void * arg)
+{
+   iolink_sim_drv_t * sim = (iolink_sim_drv_t *)iolink_hw;
+   uintptr_t ch           = (uintptr_t)arg;
+
+   CC_ASSERT (ch < sim->channel_cnt);
+
+   return &sim->ch[ch];
+}
+
+static bool iolink_sim_chance (iolink_sim_drv_t * sim, uint16_t permille)
+{
+   /* xorshift32 */
+   sim->rng ^= sim->rng << 13;
+   sim->rng ^= sim->rng >> 17;
+   sim->rng ^= sim->rng << 5;
+
+   return (sim->rng % 1000) < permille;
+}
+
+static uint8_t iolink_sim_pd_len (uint8_t pd)
+{
+   uint8_t len = pd & 0x1F;
+
+   if (pd & BIT (7))
+   {
+      /* Length in octets, minus one */
+      return len + 1;
+   }
+
+   /* Length in bits */
+   return (len + 7) / 8;
+}
+
+static uint32_t iolink_sim_cycletime_us (uint8_t cycbyte)
+{
+   uint32_t mult = cycbyte & 0x3F;
+
+   switch (cycbyte >> 6)
+   {
+   case 0:
+      return mult * 100;
+   case 1:
+      return 6400 + mult * 400;
+   default:
+      return 32000 + mult * 1600;
+   }
+}
+
+static uint8_t iolink_sim_chkpdu (const uint8_t * data, uint16_t len)
+{
+   uint8_t chk = 0;
+   uint16_t i;
+
+   for (i = 0; i < len; i++)
+   {
+      chk ^= data[i];
+   }
+
+   return chk;
+}
+
+/* Report PL events to the DL, the way the MAX14819 IRQ does */
+static void iolink_sim_raise (iolink_sim_ch_t * c, uint32_t events)
+{
+   c->pending |= events;
+
+   if (c->dl_event != NULL)
+   {
+      os_event_set (c->dl_event, c->sim->pl_flag);
+   }
+}
+
+static void iolink_sim_isdu_reset (iolink_sim_ch_t * c)
+{
+   c->isdu.req_pos   = 0;
+   c->isdu.rsp_len   = 0;
+   c->isdu.rsp_pos   = 0;
+   c->isdu.rsp_ready = false;
+}
+
+static void iolink_sim_isdu_respond (
+   iolink_sim_ch_t * c,
+   bool read,
+   iolink_smi_errortypes_t errortype,
+   const uint8_t * data,
+   uint8_t len)
+{
+   uint8_t * rsp = c->isdu.rsp;
+   uint16_t total;
+
+   if (read && (len > IOLINK_ISDU_MAX_DATA_SIZE))
+   {
+      /* Does not fit the ExtLength octet */
+      errortype = IOLINK_SMI_ERRORTYPE_VAL_LENOVRRUN;
+   }
+
+   if (errortype != IOLINK_SMI_ERRORTYPE_NONE)
+   {
+      iservice_t iserv = (read) ? IOL_ISERVICE_DEVICE_READ_RESPONSE_NEG
+                                : IOL_ISERVICE_DEVICE_WRITE_RESPONSE_NEG;
+      total  = 4;
+      rsp[0] = (iserv << 4) | total;
+      rsp[1] = (uint16_t)errortype >> 8;
+      rsp[2] = (uint16_t)errortype & 0xFF;
+   }
+   else if (!read)
+   {
+      total  = 2;
+      rsp[0] = (IOL_ISERVICE_DEVICE_WRITE_RESPONSE_POS << 4) | total;
+   }
+   else if (len + 2 <= 15)
+   {
+      total  = len + 2;
+      rsp[0] = (IOL_ISERVICE_DEVICE_READ_RESPONSE_POS << 4) | total;
+      memcpy (&rsp[1], data, len);
+   }
+   else
+   {
+      total  = len + 3;
+      rsp[0] = (IOL_ISERVICE_DEVICE_READ_RESPONSE_POS << 4) | 1;
+      rsp[1] = total;
+      memcpy (&rsp[2], data, len);
+   }
+
+   rsp[total - 1] = 0;
+   rsp[total - 1] = iolink_sim_chkpdu (rsp, total - 1);
+
+   /* Pad the last segment */
+   memset (&rsp[total], 0, SIM_ISDU_BUF_SIZE - total);
+
+   c->isdu.rsp_len   = total;
+   c->isdu.rsp_pos   = 0;
+   c->isdu.rsp_ready = true;
+   c->isdu.busy_left = c->faults.isdu_busy_cycles;
+}
+
+static void iolink_sim_isdu_execute (iolink_sim_ch_t * c, uint16_t total)
+{
+   const uint8_t * req = c->isdu.req;
+   uint8_t hdr         = ((req[0] & 0x0F) == 1) ? 2 : 1;
+   bool read           = (req[0] & (BIT (3) << 4)) != 0;
+   uint8_t kind        = (req[0] >> 4) & 0x07;
+   uint16_t index;
+   uint8_t subindex = 0;
+   uint8_t data_len;
+   uint16_t i;
+
+   if (iolink_sim_chkpdu (req, total) != 0)
+   {
+      iolink_sim_isdu_respond (c, read, IOLINK_SMI_ERRORTYPE_APP_DEV, NULL, 0);
+      return;
+   }
+
+   switch (kind)
+   {
+   case IOL_ISERVICE_MASTER_WRITE_8I:
+      index = req[hdr];
+      hdr += 1;
+      break;
+   case IOL_ISERVICE_MASTER_WRITE_8I_8SI:
+      index    = req[hdr];
+      subindex = req[hdr + 1];
+      hdr += 2;
+      break;
+   case IOL_ISERVICE_MASTER_WRITE_16I_16SI:
+      index    = (req[hdr] << 8) | req[hdr + 1];
+      subindex = req[hdr + 2];
+      hdr += 3;
+      break;
+   default:
+      iolink_sim_isdu_respond (c, read, IOLINK_SMI_ERRORTYPE_SERV_NOTAVAIL, NULL, 0);
+      return;
+   }
+
+   if (total < hdr + 1)
+   {
+      iolink_sim_isdu_respond (c, read, IOLINK_SMI_ERRORTYPE_APP_DEV, NULL, 0);
+      return;
+   }
+
+   data_len = total - hdr - 1;
+
+   if (index == 0)
+   {
+      /* Direct parameter page 1 */
+      if (!read)
+      {
+         iolink_sim_isdu_respond (
+            c,
+            read,
+            IOLINK_SMI_ERRORTYPE_IDX_NOT_ACCESSIBLE,
+            NULL,
+            0);
+      }
+      else if (subindex == 0)
+      {
+         iolink_sim_isdu_respond (
+            c,
+            read,
+            IOLINK_SMI_ERRORTYPE_NONE,
+            c->dev.page,
+            SIM_PAGE_SIZE);
+      }
+      else if (subindex <= SIM_PAGE_SIZE)
+      {
+         iolink_sim_isdu_respond (
+            c,
+            read,
+            IOLINK_SMI_ERRORTYPE_NONE,
+            &c->dev.page[subindex - 1],
+            1);
+      }
+      else
+      {
+         iolink_sim_isdu_respond (
+            c,
+            read,
+            IOLINK_SMI_ERRORTYPE_SUBIDX_NOTAVAIL,
+            NULL,
+            0);
+      }
+      return;
+   }
+
+   for (i = 0; i < c->dev.isdu_cnt; i++)
+   {
+      iolink_sim_isdu_entry_t * entry = &c->dev.isdu[i];
+
+      if (entry->index != index)
+      {
+         continue;
+      }
+
+      if (entry->subindex != subindex)
+      {
+         continue;
+      }
+
+      if (read)
+      {
+         iolink_sim_isdu_respond (
+            c,
+            read,
+            IOLINK_SMI_ERRORTYPE_NONE,
+            entry->data,
+            entry->len);
+      }
+      else if (entry->read_only)
+      {
+         iolink_sim_isdu_respond (
+            c,
+            read,
+            IOLINK_SMI_ERRORTYPE_IDX_NOT_ACCESSIBLE,
+            NULL,
+            0);
+      }
+      else if (data_len > entry->size)
+      {
+         iolink_sim_isdu_respond (
+            c,
+            read,
+            IOLINK_SMI_ERRORTYPE_VAL_LENOVRRUN,
+            NULL,
+            0);
+      }
+      else
+      {
+         memcpy (entry->data, &req[hdr], data_len);
+         entry->len = data_len;
+         iolink_sim_isdu_respond (c, read, IOLINK_SMI_ERRORTYPE_NONE, NULL, 0);
+      }
+      return;
+   }
+
+   for (i = 0; i < c->dev.isdu_cnt; i++)
+   {
+      if (c->dev.isdu[i].index == index)
+      {
+         iolink_sim_isdu_respond (
+            c,
+            read,
+            IOLINK_SMI_ERRORTYPE_SUBIDX_NOTAVAIL,
+            NULL,
+            0);
+         return;
+      }
+   }
+
+   iolink_sim_isdu_respond (c, read, IOLINK_SMI_ERRORTYPE_IDX_NOTAVAIL, NULL, 0);
+}
+
+static void iolink_sim_od_isdu (
+   iolink_sim_ch_t * c,
+   bool read,
+   uint8_t flowctrl,
+   const uint8_t * od_out,
+   uint8_t * od_in,
+   uint8_t od_len)
+{
+   if (flowctrl == IOLINK_FLOWCTRL_ABORT)
+   {
+      iolink_sim_isdu_reset (c);
+      return;
+   }
+
+   if (!read)
+   {
+      uint16_t total;
+
+      if (flowctrl == IOLINK_FLOWCTRL_START)
+      {
+         iolink_sim_isdu_reset (c);
+      }
+      else if ((flowctrl > 0x0F) || (c->isdu.req_pos == 0))
+      {
+         return;
+      }
+
+      if (c->isdu.req_pos + od_len > SIM_ISDU_BUF_SIZE)
+      {
+         iolink_sim_isdu_reset (c);
+         return;
+      }
+
+      memcpy (&c->isdu.req[c->isdu.req_pos], od_out, od_len);
+      c->isdu.req_pos += od_len;
+
+      total = c->isdu.req[0] & 0x0F;
+      if (total == 1)
+      {
+         total = c->isdu.req[1];
+      }
+
+      if ((total >= 2) && (c->isdu.req_pos >= total))
+      {
+         iolink_sim_isdu_execute (c, total);
+         c->isdu.req_pos = 0;
+      }
+      return;
+   }
+
+   if ((flowctrl == IOLINK_FLOWCTRL_IDLE_1) || (flowctrl == IOLINK_FLOWCTRL_IDLE_2))
+   {
+      if (c->isdu.rsp_ready && (c->isdu.rsp_pos >= c->isdu.rsp_len))
+      {
+         /* Response completely read */
+         iolink_sim_isdu_reset (c);
+      }
+      return;
+   }
+
+   if (!c->isdu.rsp_ready)
+   {
+      /* No service */
+      return;
+   }
+
+   if (flowctrl == IOLINK_FLOWCTRL_START)
+   {
+      if (c->isdu.busy_left > 0)
+      {
+         c->isdu.busy_left--;
+         od_in[0] = SIM_ISDU_BUSY;
+         return;
+      }
+
+      c->isdu.rsp_pos = 0;
+   }
+
+   if (c->isdu.rsp_pos + od_len <= SIM_ISDU_BUF_SIZE)
+   {
+      memcpy (od_in, &c->isdu.rsp[c->isdu.rsp_pos], od_len);
+      c->isdu.rsp_pos += od_len;
+   }
+}
+
+/* Page and diagnosis accesses cover od_len consecutive addresses */
+static void iolink_sim_od_page (
+   iolink_sim_ch_t * c,
+   bool read,
+   uint8_t addr,
+   const uint8_t * od_out,
+   uint8_t * od_in,
+   uint8_t od_len)
+{
+   uint8_t i;
+
+   for (i = 0; (i < od_len) && (addr + i < SIM_PAGE_SIZE); i++)
+   {
+      /* Page 2 is not implemented, reads as zero */
+      if (read)
+      {
+         od_in[i] = c->dev.page[addr + i];
+         continue;
+      }
+
+      c->dev.page[addr + i] = od_out[i];
+
+      if (addr + i == SIM_PAGE_MASTERCMD)
+      {
+         LOG_DEBUG (
+            IOLINK_PL_LOG,
+            "SIM (%u): MasterCommand 0x%02x\n",
+            (unsigned int)(c - c->sim->ch),
+            od_out[i]);
+      }
+   }
+}
+
+static uint8_t iolink_sim_event_memory (iolink_sim_ch_t * c, uint8_t addr)
+{
+   const iolink_sim_event_t * event;
+
+   if (addr == 0)
+   {
+      /* StatusCode type 2 */
+      return (c->event_cnt > 0) ? (0x80 | (BIT (c->event_cnt) - 1)) : 0;
+   }
+
+   if (addr > IOLINK_SIM_MAX_EVENTS * 3)
+   {
+      return 0;
+   }
+
+   event = &c->events[(addr - 1) / 3];
+
+   switch ((addr - 1) % 3)
+   {
+   case 0:
+      return event->qualifier;
+   case 1:
+      return event->code >> 8;
+   default:
+      return event->code & 0xFF;
+   }
+}
+
+static void iolink_sim_od_diagnosis (
+   iolink_sim_ch_t * c,
+   bool read,
+   uint8_t addr,
+   uint8_t * od_in,
+   uint8_t od_len)
+{
+   uint8_t i;
+
+   if (!read)
+   {
+      /* Event confirmation */
+      c->event_cnt = 0;
+      return;
+   }
+
+   for (i = 0; i < od_len; i++)
+   {
+      od_in[i] = iolink_sim_event_memory (c, addr + i);
+   }
+}
+
+static void iolink_sim_deliver (iolink_sim_ch_t * c)
+{
+   c->reply_busy = false;
+
+   if (c->reply_error)
+   {
+      iolink_sim_raise (c, IOLINK_PL_EVENT_RXERR);
+   }
+   else
+   {
+      c->reply_ready = true;
+      iolink_sim_raise (c, IOLINK_PL_EVENT_RXRDY);
+   }
+}
+
+/* Let the virtual device answer the master message in the "TX FIFO" */
+static void iolink_sim_transmit (iolink_sim_ch_t * c)
+{
+   iolink_sim_drv_t * sim = c->sim;
+   uint8_t mc             = c->msg[0];
+   uint8_t ckt            = c->msg[1];
+   bool read              = (mc & SIM_MC_READ) != 0;
+   uint8_t addr           = mc & SIM_MC_ADDR_MASK;
+   uint8_t pdin_len       = 0;
+   uint8_t pdout_len      = 0;
+   uint8_t od_len         = 0;
+   uint8_t * od_in        = c->reply;
+   const uint8_t * od_out;
+   uint8_t cks = 0;
+
+   if (c->reply_busy || (c->msg_txlen < 2))
+   {
+      return;
+   }
+
+   c->reply_busy  = true;
+   c->reply_ready = false;
+   c->reply_error = false;
+
+   if (
+      !c->dev.present || !c->wurq_done || (c->mode != iolink_mode_SDCI) ||
+      iolink_sim_chance (sim, c->faults.no_response_permille))
+   {
+      c->devdly |= SIM_DEVDLY_DELAYERR;
+      c->reply_error = true;
+      iolink_sim_deliver (c);
+      return;
+   }
+
+   if (SIM_CKT_TYPE (ckt) == SIM_CKT_TYPE_2)
+   {
+      pdin_len  = iolink_sim_pd_len (c->dev.page[SIM_PAGE_PDIN]);
+      pdout_len = iolink_sim_pd_len (c->dev.page[SIM_PAGE_PDOUT]);
+   }
+
+   if (read && (c->msg_rxlen > pdin_len))
+   {
+      od_len = c->msg_rxlen - 1 - pdin_len;
+   }
+   else if (!read && (c->msg_txlen > 2 + pdout_len))
+   {
+      od_len = c->msg_txlen - 2 - pdout_len;
+   }
+
+   if (
+      (od_len > IOLINK_OD_MAX_SIZE) ||
+      (2 + pdout_len + ((read) ? 0 : od_len) > c->msg_txlen))
+   {
+      LOG_ERROR (
+         IOLINK_PL_LOG,
+         "SIM (%u): Unexpected message length, tx %u rx %u\n",
+         (unsigned int)(c - sim->ch),
+         c->msg_txlen,
+         c->msg_rxlen);
+      c->devdly |= SIM_DEVDLY_DELAYERR;
+      c->reply_error = true;
+      iolink_sim_deliver (c);
+      return;
+   }
+
+   od_out = &c->msg[2 + pdout_len];
+
+   if (pdout_len > 0)
+   {
+      memcpy (c->pdout, &c->msg[2], pdout_len);
+      c->pdout_len = pdout_len;
+   }
+
+   memset (c->reply, 0, sizeof (c->reply));
+
+   switch (mc & SIM_MC_CHANNEL_MASK)
+   {
+   case IOLINK_COMCHANNEL_PAGE:
+      iolink_sim_od_page (c, read, addr, od_out, od_in, od_len);
+      break;
+   case IOLINK_COMCHANNEL_DIAGNOSIS:
+      iolink_sim_od_diagnosis (c, read, addr, od_in, od_len);
+      break;
+   case IOLINK_COMCHANNEL_ISDU:
+      iolink_sim_od_isdu (c, read, addr, od_out, od_in, od_len);
+      break;
+   default:
+      /* Interleaved process data is not supported */
+      break;
+   }
+
+   c->reply_len = (read) ? od_len : 0;
+
+   if (pdin_len > 0)
+   {
+      bool valid = c->pdin_valid;
+
+      if (c->dev.pdin_gen != NULL)
+      {
+         valid = c->dev.pdin_gen (c->dev.pdin_gen_arg, c->pdin, pdin_len);
+      }
+
+      memcpy (&c->reply[c->reply_len], c->pdin, pdin_len);
+      c->reply_len += pdin_len;
+
+      if (!valid)
+      {
+         cks |= SIM_CKS_PD_INVALID;
+      }
+   }
+
+   if (c->event_cnt > 0)
+   {
+      cks |= SIM_CKS_EVENT;
+   }
+
+   c->reply[c->reply_len++] = cks;
+
+   if (iolink_sim_chance (sim, c->faults.checksum_error_permille))
+   {
+      c->cqerr |= SIM_CQERR_RCHKSMER;
+      c->reply_error = true;
+   }
+
+   if (c->faults.response_delay_us > 0)
+   {
+      os_timer_set (c->reply_timer, c->faults.response_delay_us);
+      os_timer_start (c->reply_timer);
+   }
+   else
+   {
+      iolink_sim_deliver (c);
+   }
+}
+
+static void iolink_sim_reply_timeout (os_timer_t * timer, void * arg)
+{
+   iolink_sim_ch_t * c = arg;
+
+   os_mutex_lock (c->sim->exclusive);
+   if (c->reply_busy)
+   {
+      iolink_sim_deliver (c);
+   }
+   os_mutex_unlock (c->sim->exclusive);
+}
+
+static void iolink_sim_cycle_timeout (os_timer_t * timer, void * arg)
+{
+   iolink_sim_ch_t * c = arg;
+
+   os_mutex_lock (c->sim->exclusive);
+   if (c->cycle_timer_en)
+   {
+      iolink_sim_transmit (c);
+   }
+   os_mutex_unlock (c->sim->exclusive);
+}
+
+/*
+ * Driver operations
+ */
+static iolink_baudrate_t iolink_pl_sim_get_baudrate (
+   iolink_hw_drv_t * iolink_hw,
+   void * arg)
+{
+   iolink_sim_ch_t * c = iolink_sim_get_ch (iolink_hw, arg);
+
+   if (c->dev.present && c->wurq_done)
+   {
+      return c->dev.baudrate;
+   }
+
+   return IOLINK_BAUDRATE_NONE;
+}
+
+static uint8_t iolink_pl_sim_get_cycletime (iolink_hw_drv_t * iolink_hw, void * arg)
+{
+   return iolink_sim_get_ch (iolink_hw, arg)->cycbyte;
+}
+
+static void iolink_pl_sim_set_cycletime (
+   iolink_hw_drv_t * iolink_hw,
+   void * arg,
+   uint8_t cycbyte)
+{
+   iolink_sim_ch_t * c = iolink_sim_get_ch (iolink_hw, arg);
+
+   c->cycbyte = cycbyte;
+}
+
+static bool iolink_pl_sim_set_mode (
+   iolink_hw_drv_t * iolink_hw,
+   void * arg,
+   iolink_pl_mode_t mode)
+{
+   iolink_sim_ch_t * c = iolink_sim_get_ch (iolink_hw, arg);
+
+   c->mode           = mode;
+   c->wurq_done      = false;
+   c->cycle_timer_en = false;
+   c->reply_busy     = false;
+   c->reply_ready    = false;
+   c->msg_txlen      = 0;
+   os_timer_stop (c->cycle_timer);
+   os_timer_stop (c->reply_timer);
+   iolink_sim_isdu_reset (c);
+
+   return true;
+}
+
+static void iolink_pl_sim_enable_cycle_timer (iolink_hw_drv_t * iolink_hw, void * arg)
+{
+   iolink_sim_ch_t * c = iolink_sim_get_ch (iolink_hw, arg);
+   uint32_t us         = iolink_sim_cycletime_us (c->cycbyte);
+
+   if (c->cycle_timer_en || (us == 0))
+   {
+      return;
+   }
+
+   c->cycle_timer_en = true;
+   os_timer_set (c->cycle_timer, us);
+   os_timer_start (c->cycle_timer);
+}
+
+static void iolink_pl_sim_disable_cycle_timer (iolink_hw_drv_t * iolink_hw, void * arg)
+{
+   iolink_sim_ch_t * c = iolink_sim_get_ch (iolink_hw, arg);
+
+   c->cycle_timer_en = false;
+   os_timer_stop (c->cycle_timer);
+}
+
+static void iolink_pl_sim_get_error (
+   iolink_hw_drv_t * iolink_hw,
+   void * arg,
+   uint8_t * cqerr,
+   uint8_t * devdly)
+{
+   iolink_sim_ch_t * c = iolink_sim_get_ch (iolink_hw, arg);
+
+   *cqerr    = c->cqerr;
+   *devdly   = c->devdly;
+   c->cqerr  = 0;
+   c->devdly = 0;
+}
+
+static bool iolink_pl_sim_get_data (
+   iolink_hw_drv_t * iolink_hw,
+   void * arg,
+   uint8_t * rxdata,
+   uint8_t len)
+{
+   iolink_sim_ch_t * c = iolink_sim_get_ch (iolink_hw, arg);
+
+   if (!c->reply_ready)
+   {
+      return false;
+   }
+
+   c->reply_ready = false;
+   memcpy (rxdata, c->reply, (len < c->reply_len) ? len : c->reply_len);
+
+   return (c->reply_len > 0);
+}
+
+static void iolink_pl_sim_send_msg (iolink_hw_drv_t * iolink_hw, void * arg)
+{
+   iolink_sim_transmit (iolink_sim_get_ch (iolink_hw, arg));
+}
+
+static void iolink_pl_sim_dl_msg (
+   iolink_hw_drv_t * iolink_hw,
+   void * arg,
+   uint8_t rxbytes,
+   uint8_t txbytes,
+   uint8_t * data)
+{
+   iolink_sim_ch_t * c = iolink_sim_get_ch (iolink_hw, arg);
+
+   CC_ASSERT (txbytes <= sizeof (c->msg));
+
+   memcpy (c->msg, data, txbytes);
+   c->msg_txlen = txbytes;
+   c->msg_rxlen = rxbytes;
+}
+
+static void iolink_pl_sim_transfer_req (
+   iolink_hw_drv_t * iolink_hw,
+   void * arg,
+   uint8_t rxbytes,
+   uint8_t txbytes,
+   uint8_t * data)
+{
+   iolink_pl_sim_dl_msg (iolink_hw, arg, rxbytes, txbytes, data);
+   iolink_pl_sim_send_msg (iolink_hw, arg);
+}
+
+static bool iolink_pl_sim_init_sdci (iolink_hw_drv_t * iolink_hw, void * arg)
+{
+   iolink_sim_ch_t * c = iolink_sim_get_ch (iolink_hw, arg);
+
+   /* Wake-up is answered at once, a missing device leaves the baudrate
+    * undetermined */
+   c->wurq_done = c->dev.present;
+   if (c->dev.present)
+   {
+      c->cycbyte = c->dev.page[SIM_PAGE_MINCYCL];
+   }
+   iolink_sim_raise (c, IOLINK_PL_EVENT_WURQ);
+
+   return true;
+}
+
+static void iolink_pl_sim_configure_event (
+   iolink_hw_drv_t * iolink_hw,
+   void * arg,
+   os_event_t * event,
+   uint32_t flag)
+{
+   iolink_sim_drv_t * sim = (iolink_sim_drv_t *)iolink_hw;
+   iolink_sim_ch_t * c    = iolink_sim_get_ch (iolink_hw, arg);
+
+   c->dl_event  = event;
+   sim->pl_flag = flag;
+}
+
+static void iolink_pl_sim_pl_handler (iolink_hw_drv_t * iolink_hw, void * arg)
+{
+   iolink_sim_ch_t * c = iolink_sim_get_ch (iolink_hw, arg);
+   uint32_t pending    = c->pending;
+
+   c->pending = 0;
+
+   if ((pending != 0) && (c->dl_event != NULL))
+   {
+      os_event_set (c->dl_event, pending);
+   }
+}
+
+static const iolink_hw_ops_t iolink_sim_ops = {
+   .get_baudrate        = iolink_pl_sim_get_baudrate,
+   .get_cycletime       = iolink_pl_sim_get_cycletime,
+   .set_cycletime       = iolink_pl_sim_set_cycletime,
+   .set_mode            = iolink_pl_sim_set_mode,
+   .enable_cycle_timer  = iolink_pl_sim_enable_cycle_timer,
+   .disable_cycle_timer = iolink_pl_sim_disable_cycle_timer,
+   .get_error           = iolink_pl_sim_get_error,
+   .get_data            = iolink_pl_sim_get_data,
+   .send_msg            = iolink_pl_sim_send_msg,
+   .dl_msg              = iolink_pl_sim_dl_msg,
+   .transfer_req        = iolink_pl_sim_transfer_req,
+   .init_sdci           = iolink_pl_sim_init_sdci,
+   .configure_event     = iolink_pl_sim_configure_event,
+   .pl_handler          = iolink_pl_sim_pl_handler,
+};
+
+/*
+ * Public API
+ */
+iolink_hw_drv_t * iolink_sim_init (const iolink_sim_cfg_t * cfg)
+{
+   iolink_sim_drv_t * sim;
+   uint8_t ch;
+
+   if ((cfg == NULL) || (cfg->channel_cnt == 0) || (cfg->devices == NULL))
+   {
+      return NULL;
+   }
+
+   sim = calloc (1, sizeof (iolink_sim_drv_t));
+   if (sim == NULL)
+   {
+      return NULL;
+   }
+
+   sim->ch = calloc (cfg->channel_cnt, sizeof (iolink_sim_ch_t));
+   if (sim->ch == NULL)
+   {
+      free (sim);
+      return NULL;
+   }
+
+   sim->drv.ops     = &iolink_sim_ops;
+   sim->exclusive   = os_mutex_create();
+   sim->drv.mtx     = sim->exclusive;
+   sim->channel_cnt = cfg->channel_cnt;
+   sim->rng         = (cfg->seed != 0) ? cfg->seed : 0x2545F491;
+
+   for (ch = 0; ch < cfg->channel_cnt; ch++)
+   {
+      iolink_sim_ch_t * c = &sim->ch[ch];
+
+      c->sim        = sim;
+      c->dev        = cfg->devices[ch];
+      c->faults     = cfg->devices[ch].faults;
+      c->mode       = iolink_mode_INACTIVE;
+      c->pdin_valid = true;
+      c->cycle_timer =
+         os_timer_create (1000, iolink_sim_cycle_timeout, c, false);
+      c->reply_timer =
+         os_timer_create (1000, iolink_sim_reply_timeout, c, true);
+   }
+
+   return &sim->drv;
+}
+
+void iolink_sim_deinit (iolink_hw_drv_t ** drv)
+{
+   iolink_sim_drv_t * sim = (iolink_sim_drv_t *)*drv;
+   uint8_t ch;
+
+   if (sim == NULL)
+   {
+      return;
+   }
+
+   for (ch = 0; ch < sim->channel_cnt; ch++)
+   {
+      os_timer_destroy (sim->ch[ch].cycle_timer);
+      os_timer_destroy (sim->ch[ch].reply_timer);
+   }
+
+   os_mutex_destroy (sim->exclusive);
+   free (sim->ch);
+   free (sim);
+   *drv = NULL;
+}
+
+void iolink_sim_set_present (iolink_hw_drv_t * drv, uint8_t ch, bool present)
+{
+   iolink_sim_drv_t * sim = (iolink_sim_drv_t *)drv;
+   iolink_sim_ch_t * c    = iolink_sim_get_ch (drv, (void *)(uintptr_t)ch);
+
+   os_mutex_lock (sim->exclusive);
+   c->dev.present = present;
+   if (!present)
+   {
+      c->wurq_done = false;
+      iolink_sim_isdu_reset (c);
+   }
+   os_mutex_unlock (sim->exclusive);
+}
+
+void iolink_sim_set_pdin (
+   iolink_hw_drv_t * drv,
+   uint8_t ch,
+   const uint8_t * pdin,
+   uint8_t len,
+   bool valid)
+{
+   iolink_sim_drv_t * sim = (iolink_sim_drv_t *)drv;
+   iolink_sim_ch_t * c    = iolink_sim_get_ch (drv, (void *)(uintptr_t)ch);
+
+   CC_ASSERT (len <= IOLINK_PD_MAX_SIZE);
+
+   os_mutex_lock (sim->exclusive);
+   memcpy (c->pdin, pdin, len);
+   c->pdin_valid = valid;
+   os_mutex_unlock (sim->exclusive);
+}
+
+uint8_t iolink_sim_get_pdout (iolink_hw_drv_t * drv, uint8_t ch, uint8_t * pdout)
+{
+   iolink_sim_drv_t * sim = (iolink_sim_drv_t *)drv;
+   iolink_sim_ch_t * c    = iolink_sim_get_ch (drv, (void *)(uintptr_t)ch);
+   uint8_t len;
+
+   os_mutex_lock (sim->exclusive);
+   len = c->pdout_len;
+   memcpy (pdout, c->pdout, len);
+   os_mutex_unlock (sim->exclusive);
+
+   return len;
+}
+
+iolink_error_t iolink_sim_event_inject (
+   iolink_hw_drv_t * drv,
+   uint8_t ch,
+   uint8_t qualifier,
+   uint16_t code)
+{
+   iolink_sim_drv_t * sim = (iolink_sim_drv_t *)drv;
+   iolink_sim_ch_t * c    = iolink_sim_get_ch (drv, (void *)(uintptr_t)ch);
+   iolink_error_t res     = IOLINK_ERROR_NONE;
+
+   os_mutex_lock (sim->exclusive);
+   if (c->event_cnt < IOLINK_SIM_MAX_EVENTS)
+   {
+      c->events[c->event_cnt].qualifier = qualifier;
+      c->events[c->event_cnt].code      = code;
+      c->event_cnt++;
+   }
+   else
+   {
+      res = IOLINK_ERROR_STATE_INVALID;
+   }
+   os_mutex_unlock (sim->exclusive);
+
+   return res;
+}
+
+void iolink_sim_set_faults (
+   iolink_hw_drv_t * drv,
+   uint8_t ch,
+   const iolink_sim_faults_t * faults)
+{
+   iolink_sim_drv_t * sim = (iolink_sim_drv_t *)drv;
+   iolink_sim_ch_t * c    = iolink_sim_get_ch (drv, (void *)(uintptr_t)ch);
+
+   os_mutex_lock (sim->exclusive);
+   c->faults = *faults;
+   os_mutex_unlock (sim->exclusive);
+}
@@ -17,6 +17,7 @@
 #include "mocks.h"
 #define DL_Write_req            mock_DL_Write_req
 #define DL_Read_req             mock_DL_Read_req
+#define DL_ReadPage_req         mock_DL_ReadPage_req
 #define DL_SetMode_req          mock_DL_SetMode_req
 #define DL_Write_Devicemode_req mock_DL_Write_Devicemode_req
 #define PL_SetMode_req          mock_PL_SetMode_req
@@ -28,12 +29,14 @@
 #endif /* UNIT_TEST */
 
 #include "iolink_sm.h"
-#include "iolink_dl.h" /* DL_Read_req DL_Write_req DL_SetMode_req */
+#include "iolink_dl.h" /* DL_Read_req DL_ReadPage_req DL_Write_req
+                          DL_SetMode_req */
 #include "iolink_al.h" /* AL_Read_req AL_Write_req */
 #include "iolink_pl.h" /* PL_SetMode_req */
 #include "iolink_cm.h" /* SM_PortMode_ind */
 #include "iolink_ds.h"
 #include "iolink_main.h" /* iolink_fetch_avail_job, iolink_post_job, iolink_get_portnumber */
+#include "iolink_startup.h" /* iolink_startup_phase_ind */
 #include "osal.h"
 #include "osal_log.h"
 
@@ -220,6 +223,7 @@ static void sm_setportcfg_req_cb (iolink_job_t * job);
 static void sm_AL_Read_cnf_cb (iolink_job_t * job);
 static void sm_DL_Mode_ind_cb (iolink_job_t * job);
 static void sm_DL_Read_cnf_cb (iolink_job_t * job);
+static void sm_DL_ReadPage_cnf_cb (iolink_job_t * job);
 static void sm_DL_Write_cnf_cb (iolink_job_t * job);
 static void sm_DL_Write_Devmode_cnf (iolink_job_t * job);
 
@@ -228,11 +232,15 @@ static void sm_DL_Mode_ind_cb_preop_op (
    iolink_job_t * job,
    iolink_mhmode_t mode,
    iolink_fsm_sm_event_t event);
-static void sm_DL_Read_cnf_check_comp (
-   iolink_job_t * job,
+static void sm_DL_ReadPage_cnf_check_comp (
+   iolink_port_t * port,
    iolink_sm_state_t state);
-static void sm_DL_Read_cnf_read_com_param (iolink_job_t * job);
+static void sm_DL_ReadPage_cnf_read_com_param (iolink_port_t * port);
 static iolink_fsm_sm_event_t sm_DL_Read_req (iolink_port_t * port, uint8_t addr);
+static iolink_fsm_sm_event_t sm_DL_ReadPage_req (
+   iolink_port_t * port,
+   uint8_t addr,
+   uint8_t last);
 static void sm_DL_Write_cnf_checkvxy (iolink_job_t * job);
 static void sm_DL_Write_cnf_restart_dev (iolink_job_t * job);
 static void sm_DL_Write_cnf_waiton_operate (iolink_job_t * job);
@@ -366,6 +374,34 @@ static iolink_fsm_sm_event_t sm_DL_Read_req (iolink_port_t * port, uint8_t addr)
    return sm_DL_Read_Write_req (port, addr, 0, true);
 }
 
+/* Read addr to last in one request */
+static iolink_fsm_sm_event_t sm_DL_ReadPage_req (
+   iolink_port_t * port,
+   uint8_t addr,
+   uint8_t last)
+{
+   iolink_sm_port_t * sm = iolink_get_sm_ctx (port);
+   iolink_error_t res;
+
+   CC_ASSERT (
+      (addr >= IOL_DIR_PARAMA_MIN_CYCL) && (last <= IOL_DIR_PARAMA_FID_2) &&
+      (addr <= last));
+
+   sm->dl_addr = addr;
+   res         = DL_ReadPage_req (port, addr, last - addr + 1);
+
+   if (res != IOLINK_ERROR_NONE)
+   {
+      LOG_WARNING (
+         IOLINK_SM_LOG,
+         "SM: %u: DL_ReadPage_req failed: %s\n",
+         iolink_get_portnumber (port),
+         iolink_error_literals[res]);
+   }
+
+   return SM_EVENT_NONE; /* Always wait for DL_ReadPage_cnf() */
+}
+
 static iolink_fsm_sm_event_t sm_DL_Write_req (
    iolink_port_t * port,
    uint8_t addr,
@@ -436,7 +472,7 @@ static iolink_fsm_sm_event_t sm_checkCompV10_21 (
    iolink_fsm_sm_event_t event)
 {
    /* Read 0x07 to 0x0D */
-   return sm_DL_Read_req (port, IOL_DIR_PARAMA_VID_1);
+   return sm_DL_ReadPage_req (port, IOL_DIR_PARAMA_VID_1, IOL_DIR_PARAMA_FID_2);
 }
 
 static void sm_do_check_comp_v10 (iolink_port_t * port)
@@ -569,7 +605,10 @@ static iolink_fsm_sm_event_t sm_readcomparameter (
    }
 
    /* Read 0x02 to 0x06 */
-   return sm_DL_Read_req (port, IOL_DIR_PARAMA_MIN_CYCL);
+   return sm_DL_ReadPage_req (
+      port,
+      IOL_DIR_PARAMA_MIN_CYCL,
+      IOL_DIR_PARAMA_PDO);
 }
 
 static iolink_fsm_sm_event_t sm_restartDevice (
@@ -594,7 +633,7 @@ static iolink_fsm_sm_event_t sm_checkComp (
    iolink_fsm_sm_event_t event)
 {
    /* Read 0x07 to 0x0D */
-   return sm_DL_Read_req (port, IOL_DIR_PARAMA_VID_1);
+   return sm_DL_ReadPage_req (port, IOL_DIR_PARAMA_VID_1, IOL_DIR_PARAMA_FID_2);
 }
 
 static void sm_do_check_comp (iolink_port_t * port)
@@ -883,39 +922,22 @@ static iolink_fsm_sm_event_t sm_dido (
    return SM_EVENT_NONE;
 }
 
-static void sm_DL_Read_cnf_read_com_param (iolink_job_t * job)
+static void sm_DL_ReadPage_cnf_read_com_param (iolink_port_t * port)
 {
-   iolink_port_t * port = job->port;
-   uint8_t addr         = job->dl_rw_cnf.addr;
+   iolink_sm_port_t * sm                       = iolink_get_sm_ctx (port);
+   iolink_smp_parameterlist_t * real_paramlist = &sm->real_paramlist;
 
-   if (addr != IOL_DIR_PARAMA_PDO)
-   {
-      sm_DL_Read_req (port, ++addr);
-   }
-   else
-   {
-      iolink_sm_port_t * sm                       = iolink_get_sm_ctx (port);
-      iolink_smp_parameterlist_t * real_paramlist = &sm->real_paramlist;
-      iolink_sm_event (
-         port,
-         (real_paramlist->revisionid == IOL_DIR_PARAM_REV_V10)
-            ? SM_EVENT_V10
-            : SM_EVENT_NOT_V10);
-   }
+   iolink_sm_event (
+      port,
+      (real_paramlist->revisionid == IOL_DIR_PARAM_REV_V10) ? SM_EVENT_V10
+                                                            : SM_EVENT_NOT_V10);
 }
 
-static void sm_DL_Read_cnf_check_comp (
-   iolink_job_t * job,
+static void sm_DL_ReadPage_cnf_check_comp (
+   iolink_port_t * port,
    iolink_sm_state_t state)
 {
-   iolink_port_t * port = job->port;
-   uint8_t addr         = job->dl_rw_cnf.addr;
-
-   if (addr != IOL_DIR_PARAMA_FID_2)
-   {
-      sm_DL_Read_req (port, ++addr);
-   }
-   else if (state == SM_STATE_CheckCompV10)
+   if (state == SM_STATE_CheckCompV10)
    {
       sm_do_check_comp_v10 (port);
    }
@@ -1317,6 +1339,45 @@ static const iolink_fsm_sm_state_transitions_t iolink_sm_fsm[] = {
     .transitions     = sm_trans_s15},
 };
 
+/* Record the startup phase of a state. The phases that follow the
+ * serial number check are recorded by the CM. */
+static void sm_startup_phase (iolink_port_t * port, iolink_sm_state_t state)
+{
+   iolink_startup_phase_t phase;
+
+   switch (state)
+   {
+   case SM_STATE_ReadComParameter:
+      phase = IOLINK_STARTUP_PHASE_READ_COM;
+      break;
+   case SM_STATE_CheckCompV10:
+   case SM_STATE_CheckVxy:
+   case SM_STATE_CheckComp:
+   case SM_STATE_RestartDevice:
+      phase = IOLINK_STARTUP_PHASE_CHECK_COMP;
+      break;
+   case SM_STATE_waitonDLPreoperate:
+      phase = IOLINK_STARTUP_PHASE_PREOPERATE;
+      break;
+   case SM_STATE_checkSerNum:
+      phase = IOLINK_STARTUP_PHASE_SERNUM;
+      break;
+   case SM_STATE_PortInactive:
+   case SM_STATE_wait:
+   case SM_STATE_DIDO:
+      phase = IOLINK_STARTUP_PHASE_NONE;
+      break;
+   default:
+      return;
+   }
+
+   iolink_startup_phase_ind (
+      iolink_get_startup (port),
+      iolink_get_portnumber (port),
+      phase,
+      os_get_current_time_us());
+}
+
 static void iolink_sm_event (iolink_port_t * port, iolink_fsm_sm_event_t event)
 {
    do
@@ -1359,6 +1420,11 @@ static void iolink_sm_event (iolink_port_t * port, iolink_fsm_sm_event_t event)
          iolink_sm_state_literals[previous],
          iolink_sm_state_literals[sm->state]);
 
+      if (sm->state != previous)
+      {
+         sm_startup_phase (port, sm->state);
+      }
+
       event = next_trans->action (port, event);
    } while (event != SM_EVENT_NONE);
 }
@@ -1970,29 +2036,13 @@ static void sm_setportcfg_req_cb (iolink_job_t * job)
    iolink_sm_event (port, event);
 }
 
-static void sm_DL_Read_cnf_cb (iolink_job_t * job)
+static void sm_store_parameter_retrieved_from_device (
+   iolink_port_t * port,
+   uint8_t addr,
+   uint8_t value)
 {
-   iolink_port_t * port                        = job->port;
    iolink_sm_port_t * sm                       = iolink_get_sm_ctx (port);
    iolink_smp_parameterlist_t * real_paramlist = &sm->real_paramlist;
-   uint8_t addr                                = job->dl_rw_cnf.addr;
-   uint8_t value                               = job->dl_rw_cnf.val;
-
-   if (job->dl_rw_cnf.stat != IOLINK_STATUS_NO_ERROR)
-   {
-      iolink_sm_event (port, SM_EVENT_CNF_COMLOST);
-
-      return;
-   }
-
-   if (addr == IOL_DIR_PARAMA_DUMMY_WURQ)
-   {
-      /* DL message handler will respond with a test message (MIN_CYCL) after
-       * successful WURQ.
-       * Ignore it this time, and don't expect until after PortInactive
-       */
-      return;
-   }
 
    switch (addr)
    {
@@ -2065,21 +2115,76 @@ static void sm_DL_Read_cnf_cb (iolink_job_t * job)
       CC_ASSERT (0);
       break;
    }
+}
+
+static void sm_DL_Read_cnf_cb (iolink_job_t * job)
+{
+   iolink_port_t * port  = job->port;
+   iolink_sm_port_t * sm = iolink_get_sm_ctx (port);
+   uint8_t addr          = job->dl_rw_cnf.addr;
+   uint8_t value         = job->dl_rw_cnf.val;
+
+   if (job->dl_rw_cnf.stat != IOLINK_STATUS_NO_ERROR)
+   {
+      iolink_sm_event (port, SM_EVENT_CNF_COMLOST);
+
+      return;
+   }
+
+   if (addr == IOL_DIR_PARAMA_DUMMY_WURQ)
+   {
+      /* DL message handler will respond with a test message (MIN_CYCL) after
+       * successful WURQ.
+       * Ignore it this time, and don't expect until after PortInactive
+       */
+      return;
+   }
+
+   sm_store_parameter_retrieved_from_device (port, addr, value);
+
+   switch (sm->state)
+   {
+   case SM_STATE_RestartDevice:
+      iolink_sm_event (port, SM_EVENT_WriteDone);
+      break;
+   default:
+      CC_ASSERT (0); // TODO
+      break;
+   }
+}
+
+static void sm_DL_ReadPage_cnf_cb (iolink_job_t * job)
+{
+   iolink_port_t * port  = job->port;
+   iolink_sm_port_t * sm = iolink_get_sm_ctx (port);
+   uint8_t i;
+
+   if (job->dl_readpage_cnf.stat != IOLINK_STATUS_NO_ERROR)
+   {
+      iolink_sm_event (port, SM_EVENT_CNF_COMLOST);
+
+      return;
+   }
+
+   for (i = 0; i < job->dl_readpage_cnf.len; i++)
+   {
+      sm_store_parameter_retrieved_from_device (
+         port,
+         job->dl_readpage_cnf.addr + i,
+         job->dl_readpage_cnf.data[i]);
+   }
 
    switch (sm->state)
    {
    case SM_STATE_ReadComParameter:
-      sm_DL_Read_cnf_read_com_param (job);
+      sm_DL_ReadPage_cnf_read_com_param (port);
       break;
    case SM_STATE_CheckComp:
    case SM_STATE_CheckCompV10:
-      sm_DL_Read_cnf_check_comp (job, sm->state);
-      break;
-   case SM_STATE_RestartDevice:
-      iolink_sm_event (port, SM_EVENT_WriteDone);
+      sm_DL_ReadPage_cnf_check_comp (port, sm->state);
       break;
    default:
-      CC_ASSERT (0); // TODO
+      CC_ASSERT (0);
       break;
    }
 }
@@ -2230,6 +2335,27 @@ void DL_Read_cnf (iolink_port_t * port, uint8_t value, iolink_status_t errorinfo
       sm_DL_Read_cnf_cb);
 }
 
+void DL_ReadPage_cnf (
+   iolink_port_t * port,
+   const uint8_t * data,
+   uint8_t len,
+   iolink_status_t errorinfo)
+{
+   iolink_sm_port_t * sm = iolink_get_sm_ctx (port);
+
+   iolink_job_t * job        = iolink_fetch_avail_job (port);
+   job->dl_readpage_cnf.addr = sm->dl_addr;
+   job->dl_readpage_cnf.len  = len;
+   job->dl_readpage_cnf.data = data;
+   job->dl_readpage_cnf.stat = errorinfo;
+
+   iolink_post_job_with_type_and_callback (
+      port,
+      job,
+      IOLINK_JOB_DL_READPAGE_CNF,
+      sm_DL_ReadPage_cnf_cb);
+}
+
 void DL_Write_cnf (iolink_port_t * port, iolink_status_t errorinfo)
 {
    iolink_sm_port_t * sm = iolink_get_sm_ctx (port);
@@ -73,6 +73,9 @@ extern "C" {
 #define IOL_DEV_PARAMA_SERIAL_NUMBER   0x0015
 #define IOL_DEV_PARAMA_HARDWARE_REV    0x0016
 #define IOL_DEV_PARAMA_FIRMWARE_REV    0x0017
+#define IOL_DEV_PARAMA_APP_SPEC_TAG    0x0018
+#define IOL_DEV_PARAMA_FUNCTION_TAG    0x0019
+#define IOL_DEV_PARAMA_LOCATION_TAG    0x001A
 #define IOL_DEV_PARAMA_ERROR_COUNT     0x0020
 #define IOL_DEV_PARAMA_DEVICE_STATUS   0x0024
 
@@ -157,6 +160,11 @@ iolink_error_t SM_SetPortConfig_req (
    iolink_port_t * port,
    iolink_smp_parameterlist_t * parameterlist);
 void DL_Read_cnf (iolink_port_t * port, uint8_t value, iolink_status_t errorinfo);
+void DL_ReadPage_cnf (
+   iolink_port_t * port,
+   const uint8_t * data,
+   uint8_t len,
+   iolink_status_t errorinfo);
 void DL_Write_cnf (iolink_port_t * port, iolink_status_t errorinfo);
 
 void DL_Write_Devicemode_cnf (
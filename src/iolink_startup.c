@@ -0,0 +1,339 @@
+/*********************************************************************
+ *        _       _         _
+ *  _ __ | |_  _ | |  __ _ | |__   ___
+ * | '__|| __|(_)| | / _` || '_ \ / __|
+ * | |   | |_  _ | || (_| || |_) |\__ \
+ * |_|    \__|(_)|_| \__,_||_.__/ |___/
+ *
+ * www.rt-labs.com
+ * Copyright 2024 rt-labs AB, Sweden.
+ *
+ * This software is dual-licensed under GPLv3 and a commercial
+ * license. See the file LICENSE.md distributed with this software for
+ * full license information.
+ ********************************************************************/
+
+#include "iolink_startup.h"
+
+#include <string.h>
+
+/**
+ * @file
+ * @brief Startup coordinator
+ *
+ */
+
+static bool startup_slot_free (iolink_startup_t * startup)
+{
+   return (startup->max_ports == 0) || (startup->active < startup->max_ports);
+}
+
+/* Waiting port that asked first, 0 if none */
+static uint8_t startup_first_waiting (iolink_startup_t * startup)
+{
+   uint8_t first = 0;
+   uint8_t i;
+
+   for (i = 0; i < startup->port_cnt; i++)
+   {
+      if (
+         startup->port[i].waiting &&
+         ((first == 0) ||
+          (startup->port[i].seq < startup->port[first - 1].seq)))
+      {
+         first = i + 1;
+      }
+   }
+
+   return first;
+}
+
+/* Port to kick when a slot may be free, 0 if none */
+static uint8_t startup_next (iolink_startup_t * startup)
+{
+   return startup_slot_free (startup) ? startup_first_waiting (startup) : 0;
+}
+
+static uint8_t startup_release (iolink_startup_t * startup, uint8_t portnumber)
+{
+   iolink_startup_port_t * p = &startup->port[portnumber - 1];
+
+   if (p->active)
+   {
+      p->active = false;
+      startup->active--;
+   }
+   p->waiting = false;
+
+   return startup_next (startup);
+}
+
+/* Enter a phase, ending the current one. Several states of the SM may
+ * make up a phase. */
+static void startup_phase (
+   iolink_startup_port_t * p,
+   iolink_startup_phase_t phase,
+   uint32_t now_us)
+{
+   iolink_startup_phase_rec_t * rec;
+
+   if (phase == p->phase)
+   {
+      return;
+   }
+
+   if (p->phase != IOLINK_STARTUP_PHASE_NONE)
+   {
+      p->timeline.phase[p->phase].duration_us += now_us - p->phase_us;
+   }
+
+   p->phase    = phase;
+   p->phase_us = now_us;
+
+   if (phase != IOLINK_STARTUP_PHASE_NONE)
+   {
+      rec = &p->timeline.phase[phase];
+      if (rec->cnt == 0)
+      {
+         rec->start_us = now_us;
+      }
+      rec->cnt++;
+   }
+}
+
+static void startup_stats_add (
+   iolink_startup_phase_stats_t * stats,
+   uint32_t us)
+{
+   if ((stats->port_cnt == 0) || (us < stats->min_us))
+   {
+      stats->min_us = us;
+   }
+   if (us > stats->max_us)
+   {
+      stats->max_us = us;
+   }
+   stats->total_us += us;
+   stats->port_cnt++;
+}
+
+void iolink_startup_init (
+   iolink_startup_t * startup,
+   const iolink_m_cfg_t * m_cfg)
+{
+   uint8_t i;
+
+   memset (startup, 0, sizeof (*startup));
+
+   startup->mtx        = os_mutex_create();
+   startup->port_cnt   = m_cfg->port_cnt;
+   startup->max_ports  = m_cfg->startup_max_ports;
+   startup->spacing_us = m_cfg->startup_wurq_spacing_us;
+
+   for (i = 0; i < IOLINK_NUM_PORTS; i++)
+   {
+      startup->port[i].phase = IOLINK_STARTUP_PHASE_NONE;
+   }
+}
+
+void iolink_startup_deinit (iolink_startup_t * startup)
+{
+   if (startup->mtx != NULL)
+   {
+      os_mutex_destroy (startup->mtx);
+   }
+
+   memset (startup, 0, sizeof (*startup));
+}
+
+uint32_t iolink_startup_wake_req (
+   iolink_startup_t * startup,
+   uint8_t portnumber,
+   uint32_t now_us,
+   uint8_t * kick)
+{
+   iolink_startup_port_t * p = &startup->port[portnumber - 1];
+   uint32_t wait             = 0;
+   uint32_t elapsed;
+
+   *kick = 0;
+
+   os_mutex_lock (startup->mtx);
+   if (p->active)
+   {
+      os_mutex_unlock (startup->mtx);
+      return 0;
+   }
+
+   if (!p->waiting)
+   {
+      /* A retry after a failed WURQ is part of the same startup */
+      if (!p->retry)
+      {
+         memset (&p->timeline, 0, sizeof (p->timeline));
+         p->timeline.request_us = now_us;
+         p->phase               = IOLINK_STARTUP_PHASE_NONE;
+      }
+      startup_phase (p, IOLINK_STARTUP_PHASE_WAIT, now_us);
+      p->waiting = true;
+      p->seq     = startup->seq++;
+   }
+
+   elapsed = now_us - startup->last_wurq_us;
+   if (
+      (startup_first_waiting (startup) != portnumber) ||
+      !startup_slot_free (startup))
+   {
+      wait = IOLINK_STARTUP_WAIT_SLOT;
+   }
+   else if (startup->wurq_sent && (elapsed < startup->spacing_us))
+   {
+      wait = startup->spacing_us - elapsed;
+   }
+   else
+   {
+      p->waiting = false;
+      p->active  = true;
+      p->retry   = false;
+      startup->active++;
+      startup->wurq_sent    = true;
+      startup->last_wurq_us = now_us;
+      p->timeline.wurq_us   = now_us;
+      p->timeline.wurq_cnt++;
+      startup_phase (p, IOLINK_STARTUP_PHASE_WURQ, now_us);
+
+      /* The next port waits for the spacing from now on */
+      *kick = startup_next (startup);
+   }
+   os_mutex_unlock (startup->mtx);
+
+   return wait;
+}
+
+uint8_t iolink_startup_com_ind (
+   iolink_startup_t * startup,
+   uint8_t portnumber,
+   uint32_t now_us,
+   bool ok)
+{
+   iolink_startup_port_t * p = &startup->port[portnumber - 1];
+   uint8_t kick              = 0;
+
+   os_mutex_lock (startup->mtx);
+   startup_phase (p, IOLINK_STARTUP_PHASE_NONE, now_us);
+   if (ok)
+   {
+      p->timeline.com_us = now_us;
+   }
+   else
+   {
+      p->retry = true;
+      kick     = startup_release (startup, portnumber);
+   }
+   os_mutex_unlock (startup->mtx);
+
+   return kick;
+}
+
+uint8_t iolink_startup_ready_ind (
+   iolink_startup_t * startup,
+   uint8_t portnumber,
+   uint32_t now_us,
+   bool operate)
+{
+   iolink_startup_port_t * p = &startup->port[portnumber - 1];
+   uint8_t kick              = 0;
+
+   os_mutex_lock (startup->mtx);
+   if (p->timeline.ready_us == 0)
+   {
+      p->timeline.ready_us = now_us;
+   }
+   if (operate && (p->timeline.operate_us == 0))
+   {
+      p->timeline.operate_us = now_us;
+   }
+   if (p->active)
+   {
+      kick = startup_release (startup, portnumber);
+   }
+   os_mutex_unlock (startup->mtx);
+
+   return kick;
+}
+
+uint8_t iolink_startup_cancel (
+   iolink_startup_t * startup,
+   uint8_t portnumber,
+   uint32_t now_us)
+{
+   iolink_startup_port_t * p = &startup->port[portnumber - 1];
+   uint8_t kick              = 0;
+
+   os_mutex_lock (startup->mtx);
+   p->retry = false;
+   startup_phase (p, IOLINK_STARTUP_PHASE_NONE, now_us);
+   if (p->active || p->waiting)
+   {
+      kick = startup_release (startup, portnumber);
+   }
+   os_mutex_unlock (startup->mtx);
+
+   return kick;
+}
+
+void iolink_startup_read_timeline (
+   iolink_startup_t * startup,
+   uint8_t portnumber,
+   iolink_startup_timeline_t * timeline)
+{
+   os_mutex_lock (startup->mtx);
+   *timeline = startup->port[portnumber - 1].timeline;
+   os_mutex_unlock (startup->mtx);
+}
+
+void iolink_startup_phase_ind (
+   iolink_startup_t * startup,
+   uint8_t portnumber,
+   iolink_startup_phase_t phase,
+   uint32_t now_us)
+{
+   os_mutex_lock (startup->mtx);
+   startup_phase (&startup->port[portnumber - 1], phase, now_us);
+   os_mutex_unlock (startup->mtx);
+}
+
+void iolink_startup_read_report (
+   iolink_startup_t * startup,
+   iolink_startup_report_t * report)
+{
+   const iolink_startup_timeline_t * timeline;
+   uint8_t i;
+   uint8_t phase;
+
+   memset (report, 0, sizeof (*report));
+
+   os_mutex_lock (startup->mtx);
+   for (i = 0; i < startup->port_cnt; i++)
+   {
+      timeline = &startup->port[i].timeline;
+
+      for (phase = 0; phase < IOLINK_STARTUP_PHASE_LAST; phase++)
+      {
+         if (timeline->phase[phase].cnt != 0)
+         {
+            startup_stats_add (
+               &report->phase[phase],
+               timeline->phase[phase].duration_us);
+         }
+      }
+
+      if (timeline->operate_us != 0)
+      {
+         startup_stats_add (
+            &report->operate,
+            timeline->operate_us - timeline->request_us);
+      }
+   }
+   os_mutex_unlock (startup->mtx);
+}
@@ -0,0 +1,198 @@
+/*********************************************************************
+ *        _       _         _
+ *  _ __ | |_  _ | |  __ _ | |__   ___
+ * | '__|| __|(_)| | / _` || '_ \ / __|
+ * | |   | |_  _ | || (_| || |_) |\__ \
+ * |_|    \__|(_)|_| \__,_||_.__/ |___/
+ *
+ * www.rt-labs.com
+ * Copyright 2024 rt-labs AB, Sweden.
+ *
+ * This software is dual-licensed under GPLv3 and a commercial
+ * license. See the file LICENSE.md distributed with this software for
+ * full license information.
+ ********************************************************************/
+
+/**
+ * @file
+ * @brief Startup coordinator
+ *
+ * Schedules the wake-up of the devices of all ports. A port asks for a
+ * slot before it sends its WURQ and holds it until the startup of the
+ * device is done, i.e. until the DL reaches PREOPERATE or OPERATE, or the
+ * startup fails. The number of slots, and the time between two WURQs, are
+ * limited by the master configuration, so that ports sharing a bus do not
+ * all wake up and read their direct parameters at once. Waiting ports get
+ * a slot in the order they asked for one. Called from the DL threads.
+ *
+ * Also records the time spent by each port in each phase of its startup,
+ * as reported by the DL, SM and CM.
+ */
+
+#ifndef IOLINK_STARTUP_H
+#define IOLINK_STARTUP_H
+
+#include "iolink_main.h"
+#include "osal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Returned by iolink_startup_wake_req() to a port waiting for a slot */
+#define IOLINK_STARTUP_WAIT_SLOT UINT32_MAX
+
+/** Phase of a port that is not starting up */
+#define IOLINK_STARTUP_PHASE_NONE IOLINK_STARTUP_PHASE_LAST
+
+typedef struct iolink_startup_port
+{
+   bool waiting; /* Asked for a slot, not granted yet */
+   bool active;  /* Holding a slot */
+   bool retry;   /* WURQ failed, the startup is not over */
+   uint32_t seq; /* Order of the request */
+   iolink_startup_phase_t phase;
+   uint32_t phase_us; /* The current phase was entered */
+   iolink_startup_timeline_t timeline;
+} iolink_startup_port_t;
+
+struct iolink_startup
+{
+   os_mutex_t * mtx;
+   uint8_t port_cnt;
+   uint8_t max_ports;   /* Slots, 0 for no limit */
+   uint32_t spacing_us; /* Min time between two WURQs */
+
+   uint8_t active;
+   uint32_t seq;
+   bool wurq_sent;
+   uint32_t last_wurq_us;
+   iolink_startup_port_t port[IOLINK_NUM_PORTS];
+};
+
+/**
+ * Initialise the startup coordinator.
+ *
+ * @param startup       Startup coordinator
+ * @param m_cfg         Master configuration
+ */
+void iolink_startup_init (
+   iolink_startup_t * startup,
+   const iolink_m_cfg_t * m_cfg);
+
+/**
+ * Release the startup coordinator.
+ *
+ * @param startup       Startup coordinator
+ */
+void iolink_startup_deinit (iolink_startup_t * startup);
+
+/**
+ * Ask for a slot to wake up the device of a port. A port that is not
+ * granted one asks again when the returned time has passed, or when it is
+ * kicked.
+ *
+ * @param startup       Startup coordinator
+ * @param portnumber    Port number
+ * @param now_us        Current time
+ * @param kick          Set to a waiting port to kick, i.e. that should ask
+ *                      again now, or 0
+ * @return 0 if the port holds a slot and may send its WURQ, the time in
+ *         microseconds to wait before asking again, or
+ *         IOLINK_STARTUP_WAIT_SLOT to wait for a kick
+ */
+uint32_t iolink_startup_wake_req (
+   iolink_startup_t * startup,
+   uint8_t portnumber,
+   uint32_t now_us,
+   uint8_t * kick);
+
+/**
+ * The WURQ of a port is done. A port that failed to establish
+ * communication releases its slot.
+ *
+ * @param startup       Startup coordinator
+ * @param portnumber    Port number
+ * @param now_us        Current time
+ * @param ok            Communication established
+ * @return Waiting port to kick, or 0
+ */
+uint8_t iolink_startup_com_ind (
+   iolink_startup_t * startup,
+   uint8_t portnumber,
+   uint32_t now_us,
+   bool ok);
+
+/**
+ * The DL of a port reached PREOPERATE or OPERATE. The port releases its
+ * slot.
+ *
+ * @param startup       Startup coordinator
+ * @param portnumber    Port number
+ * @param now_us        Current time
+ * @param operate       OPERATE reached
+ * @return Waiting port to kick, or 0
+ */
+uint8_t iolink_startup_ready_ind (
+   iolink_startup_t * startup,
+   uint8_t portnumber,
+   uint32_t now_us,
+   bool operate);
+
+/**
+ * The startup of a port is abandoned, e.g. the port is deactivated. The
+ * port releases its slot, or stops waiting for one.
+ *
+ * @param startup       Startup coordinator
+ * @param portnumber    Port number
+ * @param now_us        Current time
+ * @return Waiting port to kick, or 0
+ */
+uint8_t iolink_startup_cancel (
+   iolink_startup_t * startup,
+   uint8_t portnumber,
+   uint32_t now_us);
+
+/**
+ * A port entered a startup phase. The time spent in the previous phase, if
+ * any, is added to its record.
+ *
+ * @param startup       Startup coordinator
+ * @param portnumber    Port number
+ * @param phase         Phase, or IOLINK_STARTUP_PHASE_NONE when the
+ *                      startup is over
+ * @param now_us        Current time
+ */
+void iolink_startup_phase_ind (
+   iolink_startup_t * startup,
+   uint8_t portnumber,
+   iolink_startup_phase_t phase,
+   uint32_t now_us);
+
+/**
+ * Get the startup timeline of a port.
+ *
+ * @param startup       Startup coordinator
+ * @param portnumber    Port number
+ * @param timeline      Destination
+ */
+void iolink_startup_read_timeline (
+   iolink_startup_t * startup,
+   uint8_t portnumber,
+   iolink_startup_timeline_t * timeline);
+
+/**
+ * Get the startup report of all ports.
+ *
+ * @param startup       Startup coordinator
+ * @param report        Destination
+ */
+void iolink_startup_read_report (
+   iolink_startup_t * startup,
+   iolink_startup_report_t * report);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IOLINK_STARTUP_H */
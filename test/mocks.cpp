@@ -16,6 +16,7 @@
 #include "mocks.h"
 #include "test_util.h"
 #include "iolink_max14819.h"
+#include "iolink_dl.h"
 #include "iolink_sm.h"
 #include "iolink_al.h"
 #include "iolink_main.h"
@@ -61,7 +62,9 @@ uint8_t mock_iolink_al_newinput_inf_cnt               = 0;
 uint8_t mock_iolink_al_event_cnt                      = 0;
 uint8_t mock_iolink_sm_operate_cnt                    = 0;
 uint8_t mock_iolink_ds_delete_cnt                     = 0;
+uint8_t mock_iolink_ds_release_cnt                    = 0;
 uint8_t mock_iolink_ds_startup_cnt                    = 0;
+uint8_t mock_iolink_ds_upload_cnt                     = 0;
 uint8_t mock_iolink_ds_ready_cnt                      = 0;
 uint8_t mock_iolink_ds_fault_cnt                      = 0;
 iolink_ds_fault_t mock_iolink_ds_fault                = IOLINK_DS_FAULT_NONE;
@@ -114,7 +117,7 @@ iolink_error_t mock_DL_Write_req (iolink_port_t * port, uint8_t address, uint8_t
    return IOLINK_ERROR_NONE;
 }
 
-iolink_error_t mock_DL_Read_req (iolink_port_t * port, uint8_t address)
+static bool mock_dl_page_value (uint8_t address, uint8_t * value)
 {
    uint8_t data;
 
@@ -167,6 +170,19 @@ iolink_error_t mock_DL_Read_req (iolink_port_t * port, uint8_t address)
       break;
    default:
       printf ("DL_Read: Address not valid: %u\n", address);
+      return false;
+   }
+
+   *value = data;
+   return true;
+}
+
+iolink_error_t mock_DL_Read_req (iolink_port_t * port, uint8_t address)
+{
+   uint8_t data;
+
+   if (!mock_dl_page_value (address, &data))
+   {
       return IOLINK_ERROR_ADDRESS_INVALID;
    }
    DL_Read_cnf (port, data, IOLINK_STATUS_NO_ERROR);
@@ -175,6 +191,26 @@ iolink_error_t mock_DL_Read_req (iolink_port_t * port, uint8_t address)
    return IOLINK_ERROR_NONE;
 }
 
+iolink_error_t mock_DL_ReadPage_req (
+   iolink_port_t * port,
+   uint8_t address,
+   uint8_t len)
+{
+   static uint8_t data[IOLINK_DL_PAGE1_LEN];
+   uint8_t i;
+
+   for (i = 0; i < len; i++)
+   {
+      if (!mock_dl_page_value (address + i, &data[i]))
+      {
+         return IOLINK_ERROR_ADDRESS_INVALID;
+      }
+   }
+   DL_ReadPage_cnf (port, data, len, IOLINK_STATUS_NO_ERROR);
+
+   return IOLINK_ERROR_NONE;
+}
+
 iolink_error_t mock_DL_SetMode_req (
    iolink_port_t * port,
    iolink_dl_mode_t mode,
@@ -516,6 +552,13 @@ iolink_error_t mock_DS_Delete (iolink_port_t * port)
    return IOLINK_ERROR_NONE;
 }
 
+iolink_error_t mock_DS_Release (iolink_port_t * port)
+{
+   mock_iolink_ds_release_cnt++;
+
+   return IOLINK_ERROR_NONE;
+}
+
 iolink_error_t mock_DS_Startup (iolink_port_t * port)
 {
    mock_iolink_ds_startup_cnt++;
@@ -523,6 +566,13 @@ iolink_error_t mock_DS_Startup (iolink_port_t * port)
    return IOLINK_ERROR_NONE;
 }
 
+iolink_error_t mock_DS_Upload (iolink_port_t * port)
+{
+   mock_iolink_ds_upload_cnt++;
+
+   return IOLINK_ERROR_NONE;
+}
+
 void mock_DS_Ready (iolink_port_t * port)
 {
    mock_iolink_ds_ready_cnt++;
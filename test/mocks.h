@@ -57,6 +57,7 @@ extern uint8_t mock_iolink_dl_pdin_data[IOLINK_PD_MAX_SIZE];
 extern uint8_t mock_iolink_dl_pdin_data_len;
 extern uint8_t mock_iolink_dl_control_req_cnt;
 extern uint8_t mock_iolink_dl_eventconf_req_cnt;
+extern uint8_t mock_iolink_al_setoutput_req_cnt;
 extern uint8_t mock_iolink_al_getinput_req_cnt;
 extern uint8_t mock_iolink_al_getinputoutput_req_cnt;
 extern uint8_t mock_iolink_al_newinput_inf_cnt;
@@ -66,7 +67,9 @@ extern iolink_controlcode_t mock_iolink_controlcode;
 extern uint8_t mock_iolink_al_event_cnt;
 extern uint8_t mock_iolink_sm_operate_cnt;
 extern uint8_t mock_iolink_ds_delete_cnt;
+extern uint8_t mock_iolink_ds_release_cnt;
 extern uint8_t mock_iolink_ds_startup_cnt;
+extern uint8_t mock_iolink_ds_upload_cnt;
 extern uint8_t mock_iolink_ds_ready_cnt;
 extern uint8_t mock_iolink_ds_fault_cnt;
 extern iolink_ds_fault_t mock_iolink_ds_fault;
@@ -101,6 +104,10 @@ iolink_error_t mock_DL_Write_req (
    uint8_t address,
    uint8_t value);
 iolink_error_t mock_DL_Read_req (iolink_port_t * port, uint8_t address);
+iolink_error_t mock_DL_ReadPage_req (
+   iolink_port_t * port,
+   uint8_t address,
+   uint8_t len);
 iolink_error_t mock_DL_SetMode_req (
    iolink_port_t * port,
    iolink_dl_mode_t mode,
@@ -185,7 +192,9 @@ void mock_SM_PortMode_ind (iolink_port_t * port, iolink_sm_portmode_t mode);
 
 void mock_DS_Fault (iolink_port_t * port, iolink_ds_fault_t fault);
 iolink_error_t mock_DS_Delete (iolink_port_t * port);
+iolink_error_t mock_DS_Release (iolink_port_t * port);
 iolink_error_t mock_DS_Startup (iolink_port_t * port);
+iolink_error_t mock_DS_Upload (iolink_port_t * port);
 
 void mock_DS_Ready (iolink_port_t * port);
 
@@ -377,9 +377,10 @@ TEST_F (ALTest, Al_write_param_abort_isdu_2)
 
 TEST_F (ALTest, Al_read_param_0_1_multiple_al_service_calls)
 {
-   uint16_t index     = 0;
-   uint8_t subindex   = 0;
-   uint8_t read_value = 0x12;
+   uint16_t index           = 0;
+   uint8_t subindex         = 0;
+   uint8_t read_value       = 0x12;
+   uint8_t exp_read_cnf_cnt = 0;
 
    for (index = 0; index < 2; index++)
    {
@@ -391,30 +392,41 @@ TEST_F (ALTest, Al_read_param_0_1_multiple_al_service_calls)
 
       EXPECT_EQ (AL_OD_STATE_Await_DL_param_cnf, al->od_state);
 
+      /* Same read joins the ongoing read, no confirmation yet */
       AL_Read_req (port, index, subindex, mock_AL_Read_cnf);
       mock_iolink_job.callback (&mock_iolink_job);
       EXPECT_EQ (mock_iolink_al_data_len, 0);
-      EXPECT_EQ (mock_iolink_al_read_cnf_cnt, (index * 2) + 1);
+      EXPECT_EQ (mock_iolink_al_read_cnf_cnt, exp_read_cnf_cnt);
+
+      /* Other index, busy */
+      AL_Read_req (port, index + 2, subindex, mock_AL_Read_cnf);
+      mock_iolink_job.callback (&mock_iolink_job);
+      exp_read_cnf_cnt++;
+      EXPECT_EQ (mock_iolink_al_data_len, 0);
+      EXPECT_EQ (mock_iolink_al_read_cnf_cnt, exp_read_cnf_cnt);
       EXPECT_EQ (
          mock_iolink_al_read_errortype,
          IOLINK_SMI_ERRORTYPE_SERVICE_TEMP_UNAVAILABLE);
 
+      /* Write, busy */
       AL_Write_req (port, index, subindex, 0, NULL, mock_AL_Write_cnf);
       mock_iolink_job.callback (&mock_iolink_job);
       EXPECT_EQ (mock_iolink_al_data_len, 0);
       EXPECT_EQ (mock_iolink_al_write_cnf_cnt, index + 1);
-      EXPECT_EQ (mock_iolink_al_read_cnf_cnt, (index * 2) + 1);
       EXPECT_EQ (
-         mock_iolink_al_read_errortype,
+         mock_iolink_al_write_errortype,
          IOLINK_SMI_ERRORTYPE_SERVICE_TEMP_UNAVAILABLE);
+      EXPECT_EQ (mock_iolink_al_read_cnf_cnt, exp_read_cnf_cnt);
 
       DL_ReadParam_cnf (port, read_value, IOLINK_STATUS_NO_ERROR);
       mock_iolink_job.callback (&mock_iolink_job);
       EXPECT_EQ (AL_OD_STATE_OnReq_Idle, al->od_state);
 
+      /* The ongoing and the joined read confirmed with the value */
+      exp_read_cnf_cnt += 2;
       EXPECT_EQ (mock_iolink_al_data[0], read_value);
       EXPECT_EQ (mock_iolink_al_data_len, 1);
-      EXPECT_EQ (mock_iolink_al_read_cnf_cnt, (index * 2) + 2);
+      EXPECT_EQ (mock_iolink_al_read_cnf_cnt, exp_read_cnf_cnt);
       EXPECT_EQ (mock_iolink_al_read_errortype, IOLINK_SMI_ERRORTYPE_NONE);
       EXPECT_EQ (mock_iolink_al_write_cnf_cnt, index + 1);
       EXPECT_EQ (mock_iolink_dl_control_req_cnt, 0);
@@ -425,6 +437,35 @@ TEST_F (ALTest, Al_read_param_0_1_multiple_al_service_calls)
    }
 }
 
+TEST_F (ALTest, Al_read_isdu_joined_abort)
+{
+   iolink_al_port_t * al = iolink_get_al_ctx (port);
+   uint8_t i;
+
+   AL_Read_req (port, 0x10, 0, mock_AL_Read_cnf);
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (AL_OD_STATE_Await_DL_ISDU_cnf, al->od_state);
+
+   /* Joined reads up to the limit, then busy */
+   for (i = 0; i < IOLINK_AL_OD_JOIN_MAX + 1; i++)
+   {
+      AL_Read_req (port, 0x10, 0, mock_AL_Read_cnf);
+      mock_iolink_job.callback (&mock_iolink_job);
+   }
+   EXPECT_EQ (1, mock_iolink_al_read_cnf_cnt);
+   EXPECT_EQ (
+      IOLINK_SMI_ERRORTYPE_SERVICE_TEMP_UNAVAILABLE,
+      mock_iolink_al_read_errortype);
+
+   /* All confirmed with the error of the ongoing read */
+   AL_Abort (port);
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (AL_OD_STATE_OnReq_Idle, al->od_state);
+   EXPECT_EQ (IOLINK_AL_OD_JOIN_MAX + 2, mock_iolink_al_read_cnf_cnt);
+   EXPECT_EQ (IOLINK_SMI_ERRORTYPE_APP_DEV, mock_iolink_al_read_errortype);
+   EXPECT_EQ (0, al->service.joined_cnt);
+}
+
 static void al_verify_events (
    iolink_port_t * port,
    uint8_t event_cnt,
@@ -630,6 +671,147 @@ TEST_F (ALTest, Al_Event_6)
    al_verify_events (port, ARRAY_SIZE (events), events);
 }
 
+static void al_diag_event (
+   iolink_port_t * port,
+   uint16_t eventcode,
+   iolink_event_mode_t mode)
+{
+   uint8_t event_qualifier = (mode << 6) |
+                             (IOLINK_EVENT_TYPE_WARNING << 4) |
+                             (IOLINK_EVENT_SOURCE_DEVICE << 3) |
+                             IOLINK_EVENT_INSTANCE_APPLICATION;
+
+   DL_Event_ind (port, eventcode, event_qualifier, 0);
+   mock_iolink_job.callback (&mock_iolink_job);
+   AL_Event_rsp (port);
+   mock_iolink_job.callback (&mock_iolink_job);
+}
+
+TEST_F (ALTest, Al_Diag)
+{
+   diag_entry_t entries[IOLINK_NUM_DIAG_ENTRIES];
+   uint8_t cnt = NELEMENTS (entries);
+   /* Copies of the packed entry members */
+   iolink_eventcode_t code;
+   uint8_t qualifier;
+   unsigned int i;
+
+   al_diag_event (port, 0x4000, IOLINK_EVENT_MODE_APPEARS);
+   al_diag_event (port, 0x5000, IOLINK_EVENT_MODE_SINGLE_SHOT);
+   al_diag_event (port, 0x6000, IOLINK_EVENT_MODE_APPEARS);
+
+   /* Already appeared */
+   al_diag_event (port, 0x4000, IOLINK_EVENT_MODE_APPEARS);
+
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_diag_read (portnumber, entries, &cnt));
+   EXPECT_EQ (3, cnt);
+   code = entries[0].event_code;
+   EXPECT_EQ (0x4000, code);
+   qualifier = entries[0].event_qualifier;
+   EXPECT_EQ (IOLINK_EVENT_MODE_APPEARS, qualifier >> 6);
+   code = entries[1].event_code;
+   EXPECT_EQ (0x5000, code);
+   code = entries[2].event_code;
+   EXPECT_EQ (0x6000, code);
+
+   /* Removed with its disappearing event */
+   al_diag_event (port, 0x4000, IOLINK_EVENT_MODE_DISAPPEARS);
+   al_diag_event (port, 0x7000, IOLINK_EVENT_MODE_DISAPPEARS);
+   cnt = NELEMENTS (entries);
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_diag_read (portnumber, entries, &cnt));
+   EXPECT_EQ (2, cnt);
+   code = entries[0].event_code;
+   EXPECT_EQ (0x5000, code);
+   code = entries[1].event_code;
+   EXPECT_EQ (0x6000, code);
+
+   /* Limited by the destination */
+   cnt = 1;
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_diag_read (portnumber, entries, &cnt));
+   EXPECT_EQ (1, cnt);
+
+   /* Oldest entry dropped when full */
+   for (i = 0; i < IOLINK_NUM_DIAG_ENTRIES - 1; i++)
+   {
+      al_diag_event (port, 0x8000 + i, IOLINK_EVENT_MODE_SINGLE_SHOT);
+   }
+   cnt = NELEMENTS (entries);
+   iolink_diag_read (portnumber, entries, &cnt);
+   EXPECT_EQ (IOLINK_NUM_DIAG_ENTRIES, cnt);
+   code = entries[0].event_code;
+   EXPECT_EQ (0x6000, code);
+   code = entries[1].event_code;
+   EXPECT_EQ (0x8000, code);
+
+   iolink_al_diag_clear (port);
+   cnt = NELEMENTS (entries);
+   iolink_diag_read (portnumber, entries, &cnt);
+   EXPECT_EQ (0, cnt);
+}
+
+TEST_F (ALTest, Al_EventQueue)
+{
+   iolink_al_port_t * al = iolink_get_al_ctx (port);
+   uint8_t qualifier     = (IOLINK_EVENT_MODE_SINGLE_SHOT << 6) |
+                           (IOLINK_EVENT_TYPE_NOTIFICATION << 4) |
+                           (IOLINK_EVENT_SOURCE_DEVICE << 3) |
+                           IOLINK_EVENT_INSTANCE_APPLICATION;
+   diag_entry_t entries[IOLINK_EVENT_RING_SIZE];
+   uint8_t cnt = NELEMENTS (entries);
+   iolink_eventcode_t code;
+   uint32_t dropped;
+   unsigned int i;
+
+   /* DS upload request followed by another event in the same set */
+   DL_Event_ind (port, IOLINK_EVENTCODE_DEV_DS_UPLOAD_REQ, qualifier, 1);
+   mock_iolink_job.callback (&mock_iolink_job);
+   DL_Event_ind (port, 0x1800, qualifier, 0);
+   mock_iolink_job.callback (&mock_iolink_job);
+
+   /* Confirmed without AL_Event_rsp() */
+   EXPECT_EQ (AL_EVENT_STATE_Event_idle, al->event_state);
+   EXPECT_EQ (0, al->event.event_cnt);
+   EXPECT_EQ (1, mock_iolink_ds_upload_cnt);
+   EXPECT_EQ (2, mock_iolink_al_event_cnt);
+
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      iolink_event_read (portnumber, entries, &cnt, &dropped));
+   EXPECT_EQ (2, cnt);
+   EXPECT_EQ (0u, dropped);
+   code = entries[0].event_code;
+   EXPECT_EQ (IOLINK_EVENTCODE_DEV_DS_UPLOAD_REQ, code);
+   code = entries[1].event_code;
+   EXPECT_EQ (0x1800, code);
+
+   /* Read events are removed */
+   cnt = NELEMENTS (entries);
+   iolink_event_read (portnumber, entries, &cnt, NULL);
+   EXPECT_EQ (0, cnt);
+
+   /* Oldest events dropped when full */
+   for (i = 0; i < IOLINK_EVENT_RING_SIZE + 2; i++)
+   {
+      DL_Event_ind (port, 0x1800 + i, qualifier, 0);
+      mock_iolink_job.callback (&mock_iolink_job);
+   }
+   EXPECT_EQ (1, mock_iolink_ds_upload_cnt);
+
+   cnt = 1;
+   iolink_event_read (portnumber, entries, &cnt, &dropped);
+   EXPECT_EQ (1, cnt);
+   EXPECT_EQ (2u, dropped);
+   code = entries[0].event_code;
+   EXPECT_EQ (0x1802, code);
+
+   cnt = NELEMENTS (entries);
+   iolink_event_read (portnumber, entries, &cnt, &dropped);
+   EXPECT_EQ (IOLINK_EVENT_RING_SIZE - 1, cnt);
+   EXPECT_EQ (0u, dropped);
+   code = entries[cnt - 1].event_code;
+   EXPECT_EQ (0x1800 + IOLINK_EVENT_RING_SIZE + 1, code);
+}
+
 TEST_F (ALTest, Al_SetOutput)
 {
    uint8_t data[8] = {1, 2, 3, 4, 5, 6, 7, 8};
@@ -668,3 +850,170 @@ TEST_F (ALTest, Al_GetInput)
    EXPECT_EQ (exp_al_data_len, pdin_data_len);
    EXPECT_TRUE (ArraysMatchN (&data[offset], pdin_data, exp_al_data_len));
 }
+
+TEST_F (ALTest, Al_PDRead)
+{
+   uint8_t data[3]   = {0x11, 0x22, 0x33};
+   uint8_t pdout[2]  = {0xAA, 0xBB};
+   uint32_t start_us = os_get_current_time_us();
+   iolink_pd_t pd;
+
+   DL_PDInputTransport_ind (port, data, sizeof (data));
+   memcpy (mock_iolink_dl_pdout_data, pdout, sizeof (pdout));
+   mock_iolink_dl_pdout_data_len = sizeof (pdout);
+   iolink_get_port_info (port)->port_quality_info =
+      IOLINK_PORT_QUALITY_INFO_VALID;
+
+   memset (&pd, 0, sizeof (pd));
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_pd_read (portnumber, &pd));
+   EXPECT_EQ (sizeof (data), pd.pdin_len);
+   EXPECT_TRUE (ArraysMatchN (data, pd.pdin, sizeof (data)));
+   EXPECT_EQ (sizeof (pdout), pd.pdout_len);
+   EXPECT_TRUE (ArraysMatchN (pdout, pd.pdout, sizeof (pdout)));
+   EXPECT_EQ (IOLINK_PORT_QUALIFIER_INFO_PQ_VALID, pd.pqi);
+   EXPECT_LE (start_us, pd.pdin_time_us);
+
+   iolink_get_port_info (port)->port_quality_info =
+      IOLINK_PORT_QUALITY_INFO_INVALID;
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_pd_read (portnumber, &pd));
+   EXPECT_EQ (IOLINK_PORT_QUALIFIER_INFO_PQ_INVALID, pd.pqi);
+
+   mock_iolink_dl_pdout_data_len = 0;
+}
+
+TEST_F (ALTest, Al_PDInputFilter)
+{
+   uint8_t data[4]              = {0x01, 0x00, 0x10, 0x00};
+   uint8_t exp_newinput_ind_cnt = mock_iolink_al_newinput_inf_cnt;
+   iolink_pd_filter_t filter;
+
+   /* Bit 0 of octet 0 and a 16-bit value at octet 2 */
+   memset (&filter, 0, sizeof (filter));
+   filter.mask[0]            = 0x01;
+   filter.fields[0].offset   = 2;
+   filter.fields[0].len      = 2;
+   filter.fields[0].deadband = 0x10;
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_pd_filter_set (portnumber, &filter));
+
+   /* First PD input is always notified */
+   DL_PDInputTransport_ind (port, data, sizeof (data));
+   exp_newinput_ind_cnt++;
+   EXPECT_EQ (exp_newinput_ind_cnt, mock_iolink_al_newinput_inf_cnt);
+
+   /* Bits outside the mask and changes within the deadband */
+   data[0] = 0x03;
+   data[1] = 0xFF;
+   data[3] = 0x10;
+   DL_PDInputTransport_ind (port, data, sizeof (data));
+   EXPECT_EQ (exp_newinput_ind_cnt, mock_iolink_al_newinput_inf_cnt);
+
+   /* Compared with the last notified value */
+   data[3] = 0x11;
+   DL_PDInputTransport_ind (port, data, sizeof (data));
+   exp_newinput_ind_cnt++;
+   EXPECT_EQ (exp_newinput_ind_cnt, mock_iolink_al_newinput_inf_cnt);
+
+   data[2] = 0x0F;
+   data[3] = 0xF0;
+   DL_PDInputTransport_ind (port, data, sizeof (data));
+   exp_newinput_ind_cnt++;
+   EXPECT_EQ (exp_newinput_ind_cnt, mock_iolink_al_newinput_inf_cnt);
+
+   /* Masked bit */
+   data[0] = 0x02;
+   DL_PDInputTransport_ind (port, data, sizeof (data));
+   exp_newinput_ind_cnt++;
+   EXPECT_EQ (exp_newinput_ind_cnt, mock_iolink_al_newinput_inf_cnt);
+
+   /* Length change */
+   DL_PDInputTransport_ind (port, data, 2);
+   exp_newinput_ind_cnt++;
+   EXPECT_EQ (exp_newinput_ind_cnt, mock_iolink_al_newinput_inf_cnt);
+
+   /* Filtered input is still available to AL_GetInput_req */
+   uint8_t pdin_data[32] = {0};
+   uint8_t pdin_data_len = 0;
+   data[1]               = 0x42;
+   DL_PDInputTransport_ind (port, data, 2);
+   EXPECT_EQ (exp_newinput_ind_cnt, mock_iolink_al_newinput_inf_cnt);
+   AL_GetInput_req (port, &pdin_data_len, pdin_data);
+   EXPECT_EQ (2, pdin_data_len);
+   EXPECT_EQ (0x42, pdin_data[1]);
+
+   /* Every cycle without a filter */
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_pd_filter_set (portnumber, NULL));
+   DL_PDInputTransport_ind (port, data, 2);
+   DL_PDInputTransport_ind (port, data, 2);
+   exp_newinput_ind_cnt += 2;
+   EXPECT_EQ (exp_newinput_ind_cnt, mock_iolink_al_newinput_inf_cnt);
+}
+
+TEST_F (ALTest, Al_PDInputFilter_invalid)
+{
+   iolink_pd_filter_t filter;
+
+   memset (&filter, 0, sizeof (filter));
+   filter.fields[0].len = 3;
+   EXPECT_EQ (
+      IOLINK_ERROR_PARAMETER_CONFLICT,
+      iolink_pd_filter_set (portnumber, &filter));
+
+   filter.fields[0].len    = 4;
+   filter.fields[0].offset = IOLINK_PD_MAX_SIZE - 3;
+   EXPECT_EQ (
+      IOLINK_ERROR_PARAMETER_CONFLICT,
+      iolink_pd_filter_set (portnumber, &filter));
+
+   filter.fields[0].offset = IOLINK_PD_MAX_SIZE - 4;
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_pd_filter_set (portnumber, &filter));
+
+   filter.heartbeat_ms = IOLINK_PD_FILTER_MAX_HEARTBEAT_MS + 1;
+   EXPECT_EQ (
+      IOLINK_ERROR_PARAMETER_CONFLICT,
+      iolink_pd_filter_set (portnumber, &filter));
+
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_pd_filter_set (portnumber, NULL));
+}
+
+TEST_F (ALTest, Al_PDInputFilter_signed_heartbeat)
+{
+   uint8_t data[2]              = {0x00, 0x05};
+   uint8_t exp_newinput_ind_cnt = mock_iolink_al_newinput_inf_cnt;
+   iolink_pd_filter_t filter;
+
+   memset (&filter, 0, sizeof (filter));
+   filter.fields[0].offset    = 0;
+   filter.fields[0].len       = 2;
+   filter.fields[0].is_signed = true;
+   filter.fields[0].deadband  = 10;
+   filter.heartbeat_ms        = 1;
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_pd_filter_set (portnumber, &filter));
+
+   DL_PDInputTransport_ind (port, data, sizeof (data));
+   exp_newinput_ind_cnt++;
+   EXPECT_EQ (exp_newinput_ind_cnt, mock_iolink_al_newinput_inf_cnt);
+
+   /* 5 -> -5 is within the deadband */
+   data[0] = 0xFF;
+   data[1] = 0xFB;
+   DL_PDInputTransport_ind (port, data, sizeof (data));
+   EXPECT_EQ (exp_newinput_ind_cnt, mock_iolink_al_newinput_inf_cnt);
+
+   /* 5 -> -6 is not */
+   data[1] = 0xFA;
+   DL_PDInputTransport_ind (port, data, sizeof (data));
+   exp_newinput_ind_cnt++;
+   EXPECT_EQ (exp_newinput_ind_cnt, mock_iolink_al_newinput_inf_cnt);
+
+   /* Unchanged input is notified when the heartbeat has elapsed */
+   os_usleep (2 * 1000);
+   DL_PDInputTransport_ind (port, data, sizeof (data));
+   exp_newinput_ind_cnt++;
+   EXPECT_EQ (exp_newinput_ind_cnt, mock_iolink_al_newinput_inf_cnt);
+
+   /* and after PD input has been invalid */
+   DL_Control_ind (port, IOLINK_CONTROLCODE_INVALID);
+   DL_PDInputTransport_ind (port, data, sizeof (data));
+   exp_newinput_ind_cnt++;
+   EXPECT_EQ (exp_newinput_ind_cnt, mock_iolink_al_newinput_inf_cnt);
+}
@@ -0,0 +1,131 @@
+/*********************************************************************
+ *        _       _         _
+ *  _ __ | |_  _ | |  __ _ | |__   ___
+ * | '__|| __|(_)| | / _` || '_ \ / __|
+ * | |   | |_  _ | || (_| || |_) |\__ \
+ * |_|    \__|(_)|_| \__,_||_.__/ |___/
+ *
+ * www.rt-labs.com
+ * Copyright 2024 rt-labs AB, Sweden.
+ *
+ * This software is dual-licensed under GPLv3 and a commercial
+ * license. See the file LICENSE.md distributed with this software for
+ * full license information.
+ ********************************************************************/
+
+#include "options.h"
+#include "osal.h"
+#include <gtest/gtest.h>
+
+#include "iolink_arena.h"
+
+#define ARENA_SIZE 256
+
+// Test fixture
+
+class ArenaTest : public ::testing::Test
+{
+ protected:
+   virtual void SetUp()
+   {
+      ASSERT_TRUE (iolink_arena_init (&arena, mem, sizeof (mem)));
+   };
+
+   virtual void TearDown()
+   {
+      iolink_arena_deinit (&arena);
+   };
+
+   uint64_t mem[ARENA_SIZE / 8];
+   iolink_arena_t arena;
+};
+
+TEST_F (ArenaTest, Arena_AllocFree)
+{
+   uint8_t * a = (uint8_t *)iolink_arena_alloc (&arena, 10);
+   uint8_t * b = (uint8_t *)iolink_arena_alloc (&arena, 100);
+
+   ASSERT_TRUE (a != NULL);
+   ASSERT_TRUE (b != NULL);
+   EXPECT_EQ (0u, (uintptr_t)a % IOLINK_ARENA_ALIGN);
+   EXPECT_EQ (0u, (uintptr_t)b % IOLINK_ARENA_ALIGN);
+   EXPECT_GE (b, a + 10);
+   EXPECT_EQ (
+      IOLINK_ARENA_BLOCK_SIZE (10) + IOLINK_ARENA_BLOCK_SIZE (100),
+      arena.used);
+
+   EXPECT_TRUE (iolink_arena_alloc (&arena, 0) == NULL);
+   EXPECT_TRUE (iolink_arena_alloc (&arena, ARENA_SIZE) == NULL);
+
+   /* Freed blocks are merged, the whole arena can be allocated again */
+   iolink_arena_free (&arena, a);
+   iolink_arena_free (&arena, b);
+   EXPECT_EQ (0u, arena.used);
+   EXPECT_EQ (
+      IOLINK_ARENA_BLOCK_SIZE (10) + IOLINK_ARENA_BLOCK_SIZE (100),
+      arena.peak);
+
+   a = (uint8_t *)
+      iolink_arena_alloc (&arena, ARENA_SIZE - IOLINK_ARENA_HDR_LEN);
+   EXPECT_TRUE (a != NULL);
+   EXPECT_TRUE (iolink_arena_alloc (&arena, 1) == NULL);
+}
+
+TEST_F (ArenaTest, Arena_Exhausted)
+{
+   void * blocks[ARENA_SIZE / IOLINK_ARENA_BLOCK_SIZE (8)];
+   unsigned int i;
+
+   for (i = 0; i < NELEMENTS (blocks); i++)
+   {
+      blocks[i] = iolink_arena_alloc (&arena, 8);
+      EXPECT_TRUE (blocks[i] != NULL);
+   }
+   EXPECT_TRUE (iolink_arena_alloc (&arena, 1) == NULL);
+
+   /* A hole fits a block of its size only */
+   iolink_arena_free (&arena, blocks[2]);
+   EXPECT_TRUE (iolink_arena_alloc (&arena, 9) == NULL);
+   EXPECT_EQ (blocks[2], iolink_arena_alloc (&arena, 8));
+}
+
+TEST_F (ArenaTest, Arena_Realloc)
+{
+   uint8_t * a = (uint8_t *)iolink_arena_alloc (&arena, 16);
+   uint8_t * b;
+   uint8_t * c;
+   uint8_t i;
+
+   ASSERT_TRUE (a != NULL);
+   for (i = 0; i < 16; i++)
+   {
+      a[i] = i;
+   }
+
+   /* Grow in place into the free space that follows */
+   EXPECT_EQ (a, iolink_arena_realloc (&arena, a, 64));
+   EXPECT_EQ (15, a[15]);
+
+   /* Shrink in place, the rest is free again */
+   EXPECT_EQ (a, iolink_arena_realloc (&arena, a, 16));
+   EXPECT_EQ (IOLINK_ARENA_BLOCK_SIZE (16), arena.used);
+   b = (uint8_t *)iolink_arena_alloc (&arena, 16);
+   ASSERT_TRUE (b != NULL);
+
+   /* Moved when the next block is in use, the content is kept */
+   c = (uint8_t *)iolink_arena_realloc (&arena, a, 64);
+   ASSERT_TRUE (c != NULL);
+   EXPECT_NE (a, c);
+   for (i = 0; i < 16; i++)
+   {
+      EXPECT_EQ (i, c[i]);
+   }
+
+   /* Unchanged when there is no room */
+   EXPECT_TRUE (iolink_arena_realloc (&arena, c, ARENA_SIZE) == NULL);
+   EXPECT_EQ (15, c[15]);
+
+   EXPECT_TRUE (iolink_arena_realloc (&arena, c, 0) == NULL);
+   iolink_arena_free (&arena, b);
+   EXPECT_EQ (0u, arena.used);
+}
@@ -18,6 +18,7 @@
 #include <gtest/gtest.h>
 
 #include "mocks.h"
+#include "iolink_al.h"
 #include "iolink_cm.h"
 #include "test_util.h"
 
@@ -252,6 +253,15 @@ static void cm_verify_portstatus (
       EXPECT_EQ (exp_vendorid, port_status_list->vendorid);
       EXPECT_EQ (exp_deviceid, port_status_list->deviceid);
       EXPECT_EQ (exp_number_of_diags, port_status_list->number_of_diags);
+      if (exp_number_of_diags > 0)
+      {
+         EXPECT_EQ (
+            0,
+            memcmp (
+               exp_diag_entries,
+               port_status_list->diag_entries,
+               exp_number_of_diags * sizeof (diag_entry_t)));
+      }
    }
 }
 
@@ -746,6 +756,7 @@ static void cm_x_to_deactive (iolink_port_t * port, iolink_cm_state_t exp_state)
    uint8_t exp_sm_operate_cnt        = mock_iolink_sm_operate_cnt;
    uint8_t exp_ds_startup_cnt        = mock_iolink_ds_startup_cnt;
    uint8_t exp_ds_delete_cnt         = mock_iolink_ds_delete_cnt;
+   uint8_t exp_ds_release_cnt        = mock_iolink_ds_release_cnt + 1;
    uint8_t exp_smi_portcfg_cnf_cnt   = mock_iolink_smi_portcfg_cnf_cnt + 1;
    uint8_t exp_od_start_cnt          = mock_iolink_od_start_cnt;
    uint8_t exp_od_stop_cnt           = mock_iolink_od_stop_cnt + 1;
@@ -802,6 +813,7 @@ static void cm_x_to_deactive (iolink_port_t * port, iolink_cm_state_t exp_state)
       exp_od_stop_cnt,
       exp_pd_start_cnt,
       exp_pd_stop_cnt);
+   EXPECT_EQ (exp_ds_release_cnt, mock_iolink_ds_release_cnt);
 
    SM_PortMode_ind (port, IOLINK_SM_PORTMODE_INACTIVE);
    mock_iolink_job.callback (&mock_iolink_job);
@@ -1218,6 +1230,76 @@ TEST_F (CMTest, Cm_active)
    cm_deactive_to_port_active (port);
 }
 
+TEST_F (CMTest, Cm_startup_phases)
+{
+   iolink_startup_timeline_t before;
+   iolink_startup_timeline_t timeline;
+   int phase;
+
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      iolink_startup_get_timeline (portnumber, &before));
+
+   cm_deactive_to_port_active (port);
+
+   // DS_ParamManager and WaitingOnOperate were entered once each
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      iolink_startup_get_timeline (portnumber, &timeline));
+   EXPECT_EQ (
+      before.phase[IOLINK_STARTUP_PHASE_DS].cnt + 1,
+      timeline.phase[IOLINK_STARTUP_PHASE_DS].cnt);
+   EXPECT_EQ (
+      before.phase[IOLINK_STARTUP_PHASE_OPERATE].cnt + 1,
+      timeline.phase[IOLINK_STARTUP_PHASE_OPERATE].cnt);
+   EXPECT_LE (
+      timeline.phase[IOLINK_STARTUP_PHASE_DS].start_us,
+      timeline.phase[IOLINK_STARTUP_PHASE_OPERATE].start_us);
+
+   // The phases before are left to the SM
+   for (phase = IOLINK_STARTUP_PHASE_WAIT; phase < IOLINK_STARTUP_PHASE_DS;
+        phase++)
+   {
+      EXPECT_EQ (before.phase[phase].cnt, timeline.phase[phase].cnt);
+   }
+}
+
+TEST_F (CMTest, Cm_startup_phases_ds_fault)
+{
+   iolink_startup_timeline_t before;
+   iolink_startup_timeline_t timeline;
+
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      iolink_startup_get_timeline (portnumber, &before));
+
+   cm_deactive_to_ds_parammanager (port);
+   DS_Fault (port, IOLINK_DS_FAULT_ID);
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (CM_STATE_PortFault, cm_get_state (port));
+
+   // The fault ends the DS phase, WaitingOnOperate is never entered
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      iolink_startup_get_timeline (portnumber, &timeline));
+   EXPECT_EQ (
+      before.phase[IOLINK_STARTUP_PHASE_DS].cnt + 1,
+      timeline.phase[IOLINK_STARTUP_PHASE_DS].cnt);
+   EXPECT_EQ (
+      before.phase[IOLINK_STARTUP_PHASE_OPERATE].cnt,
+      timeline.phase[IOLINK_STARTUP_PHASE_OPERATE].cnt);
+
+   // Entering DS_ParamManager again is counted
+   cm_x_to_deactive (port, CM_STATE_PortFault);
+   cm_deactive_to_ds_parammanager (port);
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      iolink_startup_get_timeline (portnumber, &timeline));
+   EXPECT_EQ (
+      before.phase[IOLINK_STARTUP_PHASE_DS].cnt + 2,
+      timeline.phase[IOLINK_STARTUP_PHASE_DS].cnt);
+}
+
 TEST_F (CMTest, Cm_acitve_unexpected_inactive)
 {
    uint8_t exp_smi_portevent_ind_cnt = mock_iolink_smi_portevent_ind_cnt + 1;
@@ -1393,6 +1475,41 @@ TEST_F (CMTest, Cm_deactivate)
    EXPECT_EQ (mock_iolink_ds_delete_cnt, exp_ds_delete_cnt);
 }
 
+TEST_F (CMTest, Cm_PortStatus_diag)
+{
+   diag_entry_t exp_diag_entries[1];
+
+   mock_iolink_trans_rate = IOLINK_TRANSMISSION_RATE_COM2;
+   cm_deactive_to_port_active (port);
+
+   /* Appearing temperature fault, error, application instance */
+   exp_diag_entries[0].event_qualifier = 0xF4;
+   exp_diag_entries[0].event_code      = (iolink_eventcode_t)0x4000;
+   DL_Event_ind (
+      port,
+      exp_diag_entries[0].event_code,
+      exp_diag_entries[0].event_qualifier,
+      0);
+   mock_iolink_job.callback (&mock_iolink_job);
+   AL_Event_rsp (port);
+   mock_iolink_job.callback (&mock_iolink_job);
+
+   cm_verify_portstatus (
+      port,
+      IOLINK_PORT_STATUS_INFO_OP,
+      IOLINK_PORT_QUALITY_INFO_VALID,
+      mock_iolink_revisionid,
+      IOLINK_TRANSMISSION_RATE_COM2,
+      mock_iolink_min_cycletime,
+      mock_iolink_vendorid,
+      mock_iolink_deviceid,
+      1,
+      exp_diag_entries);
+
+   /* Cleared on deactivation */
+   cm_x_to_deactive (port, CM_STATE_Port_Active);
+}
+
 TEST_F (CMTest, Cm_SMI_PortConfig_unknown_portmode)
 {
    arg_block_portconfiglist_t port_cfg;
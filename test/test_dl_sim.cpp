@@ -0,0 +1,521 @@
+/*********************************************************************
+ *        _       _         _
+ *  _ __ | |_  _ | |  __ _ | |__   ___
+ * | '__|| __|(_)| | / _` || '_ \ / __|
+ * | |   | |_  _ | || (_| || |_) |\__ \
+ * |_|    \__|(_)|_| \__,_||_.__/ |___/
+ *
+ * www.rt-labs.com
+ * Copyright 2024 rt-labs AB, Sweden.
+ *
+ * This software is dual-licensed under GPLv3 and a commercial
+ * license. See the file LICENSE.md distributed with this software for
+ * full license information.
+ ********************************************************************/
+
+#include "options.h"
+#include "osal.h"
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include "iolink_dl.h"
+#include "iolink_main.h"
+#include "iolink_pl.h"
+#include "iolink_sim.h"
+#include "iolink_startup.h"
+
+/*
+ * The DL and PL of each port run on their own thread, over a simulated
+ * device. The test stands in for the master, which owns the ports, and for
+ * the SM and AL, which get the indications and confirmations of the DL.
+ */
+
+#define DL_SIM_PORT_CNT   3
+#define DL_SIM_TIMEOUT_MS 2000
+#define DL_SIM_CYCBYTE    0x17 /* 2.3 ms */
+#define DL_SIM_SPACING_US 50000
+
+typedef struct dl_sim_rec
+{
+   iolink_mhmode_t mode;
+   uint8_t op_cnt;
+   bool read_done;
+   uint8_t read_value;
+   iolink_status_t read_stat;
+   uint8_t pdin[2];
+   uint16_t pdin_cnt;
+} dl_sim_rec_t;
+
+struct iolink_port
+{
+   iolink_m_t * master;
+   uint8_t portnumber;
+   iolink_pl_port_t pl;
+   iolink_dl_t dl;
+   dl_sim_rec_t rec;
+};
+
+struct iolink_m
+{
+   os_mutex_t * mtx;
+   iolink_hw_drv_t * drv;
+   iolink_startup_t startup;
+   uint8_t startup_order[DL_SIM_PORT_CNT];
+   uint8_t startup_cnt;
+   struct iolink_port ports[DL_SIM_PORT_CNT];
+};
+
+/* The DL threads never exit, so the ports live as long as the test */
+static iolink_m_t dl_sim_master;
+
+/*
+ * Master
+ */
+extern "C" iolink_port_t * iolink_get_port (
+   iolink_m_t * master,
+   uint8_t portnumber)
+{
+   return &master->ports[portnumber - 1];
+}
+
+extern "C" uint8_t iolink_get_portnumber (iolink_port_t * port)
+{
+   return port->portnumber;
+}
+
+extern "C" iolink_m_t * iolink_get_master (iolink_port_t * port)
+{
+   return port->master;
+}
+
+extern "C" iolink_dl_t * iolink_get_dl_ctx (iolink_port_t * port)
+{
+   return &port->dl;
+}
+
+extern "C" iolink_pl_port_t * iolink_get_pl_ctx (iolink_port_t * port)
+{
+   return &port->pl;
+}
+
+extern "C" iolink_startup_t * iolink_get_startup (iolink_port_t * port)
+{
+   return &port->master->startup;
+}
+
+/*
+ * SM and AL
+ */
+extern "C" void DL_Mode_ind (iolink_port_t * port, iolink_mhmode_t realmode)
+{
+   iolink_m_t * master = port->master;
+
+   os_mutex_lock (master->mtx);
+   port->rec.mode = realmode;
+   if (realmode == IOLINK_MHMODE_STARTUP)
+   {
+      master->startup_order[master->startup_cnt++ % DL_SIM_PORT_CNT] =
+         port->portnumber;
+   }
+   else if (realmode == IOLINK_MHMODE_OPERATE)
+   {
+      port->rec.op_cnt++;
+   }
+   os_mutex_unlock (master->mtx);
+}
+
+extern "C" void DL_Mode_ind_baud (iolink_port_t * port, iolink_mhmode_t realmode)
+{
+}
+
+extern "C" void DL_Read_cnf (
+   iolink_port_t * port,
+   uint8_t value,
+   iolink_status_t errorinfo)
+{
+   os_mutex_lock (port->master->mtx);
+   port->rec.read_value = value;
+   port->rec.read_stat  = errorinfo;
+   port->rec.read_done  = true;
+   os_mutex_unlock (port->master->mtx);
+}
+
+extern "C" void DL_ReadPage_cnf (
+   iolink_port_t * port,
+   const uint8_t * data,
+   uint8_t len,
+   iolink_status_t errorinfo)
+{
+}
+
+extern "C" void DL_Write_cnf (iolink_port_t * port, iolink_status_t errorinfo)
+{
+}
+
+extern "C" void DL_Write_Devicemode_cnf (
+   iolink_port_t * port,
+   iolink_status_t errorinfo,
+   iolink_dl_mode_t devicemode)
+{
+}
+
+extern "C" void DL_ReadParam_cnf (
+   iolink_port_t * port,
+   uint8_t value,
+   iolink_status_t errinfo)
+{
+}
+
+extern "C" void DL_WriteParam_cnf (iolink_port_t * port, iolink_status_t errinfo)
+{
+}
+
+extern "C" void DL_ISDUTransport_cnf (
+   iolink_port_t * port,
+   uint8_t * data,
+   uint8_t length,
+   iservice_t qualifier,
+   iolink_status_t errinfo)
+{
+}
+
+extern "C" void DL_Control_ind (
+   iolink_port_t * port,
+   iolink_controlcode_t controlcode)
+{
+}
+
+extern "C" void DL_Event_ind (
+   iolink_port_t * port,
+   uint16_t eventcode,
+   uint8_t event_qualifier,
+   uint8_t eventsleft)
+{
+}
+
+extern "C" void DL_PDInputTransport_ind (
+   iolink_port_t * port,
+   uint8_t * inputdata,
+   uint8_t length)
+{
+   os_mutex_lock (port->master->mtx);
+   if (length == sizeof (port->rec.pdin))
+   {
+      memcpy (port->rec.pdin, inputdata, length);
+      port->rec.pdin_cnt++;
+   }
+   os_mutex_unlock (port->master->mtx);
+}
+
+// Test fixture
+
+class DlSimTest : public ::testing::Test
+{
+ protected:
+   iolink_m_t * master = &dl_sim_master;
+
+   virtual void SetUp()
+   {
+      static iolink_sim_device_cfg_t devices[DL_SIM_PORT_CNT];
+      iolink_sim_cfg_t sim_cfg;
+      iolink_m_cfg_t m_cfg;
+      uint8_t i;
+
+      if (master->drv == NULL)
+      {
+         for (i = 0; i < DL_SIM_PORT_CNT; i++)
+         {
+            devices[i].present  = true;
+            devices[i].baudrate = IOLINK_BAUDRATE_COM2;
+            devices[i].page[2]  = DL_SIM_CYCBYTE;
+            devices[i].page[4]  = 0x10; /* Legacy device */
+            devices[i].page[5]  = 0x10; /* 16 bits PD in */
+            devices[i].page[7]  = 0x01 + i;
+         }
+
+         sim_cfg.channel_cnt = DL_SIM_PORT_CNT;
+         sim_cfg.devices     = devices;
+         sim_cfg.seed        = 1;
+
+         master->mtx = os_mutex_create();
+         master->drv = iolink_sim_init (&sim_cfg);
+         ASSERT_TRUE (master->drv != NULL);
+
+         for (i = 0; i < DL_SIM_PORT_CNT; i++)
+         {
+            iolink_port_t * port = &master->ports[i];
+
+            port->master     = master;
+            port->portnumber = i + 1;
+            iolink_pl_init (port, master->drv, (void *)(uintptr_t)i);
+            iolink_dl_instantiate (port, 0, 0);
+         }
+      }
+
+      memset (&m_cfg, 0, sizeof (m_cfg));
+      m_cfg.port_cnt = DL_SIM_PORT_CNT;
+      init (&m_cfg);
+   }
+
+   virtual void TearDown()
+   {
+      uint8_t i;
+
+      for (i = 1; i <= DL_SIM_PORT_CNT; i++)
+      {
+         set_mode (i, IOLINK_DLMODE_INACTIVE);
+         EXPECT_TRUE (wait_mode (i, IOLINK_MHMODE_INACTIVE));
+         PL_SetMode_req (port (i), iolink_mode_INACTIVE);
+      }
+
+      iolink_startup_deinit (&master->startup);
+   }
+
+   /* Clear the records and set up the startup coordinator. Ports must be
+    * inactive. */
+   void init (const iolink_m_cfg_t * m_cfg)
+   {
+      uint8_t i;
+
+      iolink_startup_deinit (&master->startup);
+      iolink_startup_init (&master->startup, m_cfg);
+
+      os_mutex_lock (master->mtx);
+      for (i = 0; i < DL_SIM_PORT_CNT; i++)
+      {
+         memset (&master->ports[i].rec, 0, sizeof (dl_sim_rec_t));
+         master->ports[i].rec.mode = IOLINK_MHMODE_INACTIVE;
+      }
+      master->startup_cnt = 0;
+      os_mutex_unlock (master->mtx);
+   }
+
+   iolink_port_t * port (uint8_t portnumber)
+   {
+      return &master->ports[portnumber - 1];
+   }
+
+   dl_sim_rec_t rec (uint8_t portnumber)
+   {
+      dl_sim_rec_t copy;
+
+      os_mutex_lock (master->mtx);
+      copy = port (portnumber)->rec;
+      os_mutex_unlock (master->mtx);
+
+      return copy;
+   }
+
+   /* What the SM asks for in each mode, for the legacy device */
+   void set_mode (uint8_t portnumber, iolink_dl_mode_t mode)
+   {
+      iolink_mode_vl_t valuelist;
+
+      memset (&valuelist, 0, sizeof (valuelist));
+      if (mode == IOLINK_DLMODE_STARTUP)
+      {
+         PL_SetMode_req (port (portnumber), iolink_mode_SDCI);
+         valuelist.onreqdatalengthpermessage = 1;
+         valuelist.type                      = IOLINK_MSEQTYPE_TYPE_0;
+      }
+      else if (mode == IOLINK_DLMODE_OPERATE)
+      {
+         valuelist.onreqdatalengthpermessage = 1;
+         valuelist.pdinputlength             = 2;
+         valuelist.time                      = DL_SIM_CYCBYTE;
+         valuelist.type                      = IOLINK_MSEQTYPE_TYPE_2_2;
+      }
+      else
+      {
+         valuelist.type = IOLINK_MSEQTYPE_TYPE_NONE;
+      }
+
+      EXPECT_EQ (
+         IOLINK_ERROR_NONE,
+         DL_SetMode_req (port (portnumber), mode, &valuelist));
+   }
+
+   /* Wait for a DL_Read_cnf() */
+   bool wait_read (uint8_t portnumber)
+   {
+      iolink_port_t * p = port (portnumber);
+      bool done         = false;
+      uint32_t ms;
+
+      for (ms = 0; (ms < DL_SIM_TIMEOUT_MS) && !done; ms++)
+      {
+         os_mutex_lock (master->mtx);
+         done             = p->rec.read_done;
+         p->rec.read_done = false;
+         os_mutex_unlock (master->mtx);
+         if (!done)
+         {
+            os_usleep (1000);
+         }
+      }
+
+      return done;
+   }
+
+   iolink_startup_timeline_t timeline (uint8_t portnumber)
+   {
+      iolink_startup_timeline_t tl;
+
+      iolink_startup_read_timeline (&master->startup, portnumber, &tl);
+
+      return tl;
+   }
+
+   /* Wait for the port to ask the startup coordinator for a slot */
+   bool wait_wake_req (uint8_t portnumber)
+   {
+      uint32_t ms;
+
+      for (ms = 0; ms < DL_SIM_TIMEOUT_MS; ms++)
+      {
+         if (timeline (portnumber).phase[IOLINK_STARTUP_PHASE_WAIT].cnt > 0)
+         {
+            return true;
+         }
+         os_usleep (1000);
+      }
+
+      return false;
+   }
+
+   /* One port at a time, with DL_SIM_SPACING_US between the WURQs */
+   void init_startup (void)
+   {
+      iolink_m_cfg_t m_cfg;
+
+      memset (&m_cfg, 0, sizeof (m_cfg));
+      m_cfg.port_cnt                = DL_SIM_PORT_CNT;
+      m_cfg.startup_max_ports       = 1;
+      m_cfg.startup_wurq_spacing_us = DL_SIM_SPACING_US;
+      init (&m_cfg);
+   }
+
+   bool wait_mode (uint8_t portnumber, iolink_mhmode_t mode)
+   {
+      uint32_t ms;
+
+      for (ms = 0; ms < DL_SIM_TIMEOUT_MS; ms++)
+      {
+         if (rec (portnumber).mode == mode)
+         {
+            return true;
+         }
+         os_usleep (1000);
+      }
+
+      return false;
+   }
+};
+
+TEST_F (DlSimTest, Dl_Sim_Operate)
+{
+   uint8_t pdin[2] = {0x12, 0x34};
+   uint32_t ms;
+
+   iolink_sim_set_pdin (master->drv, 0, pdin, sizeof (pdin), true);
+
+   set_mode (1, IOLINK_DLMODE_STARTUP);
+   ASSERT_TRUE (wait_mode (1, IOLINK_MHMODE_STARTUP));
+
+   /* MinCycleTime, read by the transceiver along with the WURQ */
+   ASSERT_TRUE (wait_read (1));
+   EXPECT_EQ (DL_SIM_CYCBYTE, rec (1).read_value);
+
+   /* VendorID 1, read from the page of the device */
+   EXPECT_EQ (IOLINK_ERROR_NONE, DL_Read_req (port (1), 7));
+   ASSERT_TRUE (wait_read (1));
+   EXPECT_EQ (IOLINK_STATUS_NO_ERROR, rec (1).read_stat);
+   EXPECT_EQ (0x01, rec (1).read_value);
+
+   set_mode (1, IOLINK_DLMODE_OPERATE);
+   ASSERT_TRUE (wait_mode (1, IOLINK_MHMODE_OPERATE));
+
+   /* Process data is exchanged every cycle */
+   for (ms = 0; (ms < DL_SIM_TIMEOUT_MS) && (rec (1).pdin_cnt < 3); ms++)
+   {
+      os_usleep (1000);
+   }
+   EXPECT_LE (3, rec (1).pdin_cnt);
+   EXPECT_EQ (0x12, rec (1).pdin[0]);
+   EXPECT_EQ (0x34, rec (1).pdin[1]);
+}
+
+TEST_F (DlSimTest, Dl_Sim_Startup_Spacing)
+{
+   iolink_startup_timeline_t tl[DL_SIM_PORT_CNT];
+   uint8_t i;
+
+   init_startup();
+
+   for (i = 1; i <= DL_SIM_PORT_CNT; i++)
+   {
+      set_mode (i, IOLINK_DLMODE_STARTUP);
+      ASSERT_TRUE (wait_wake_req (i));
+   }
+
+   for (i = 1; i <= DL_SIM_PORT_CNT; i++)
+   {
+      ASSERT_TRUE (wait_mode (i, IOLINK_MHMODE_STARTUP));
+
+      /* The next port waits for the slot */
+      if (i < DL_SIM_PORT_CNT)
+      {
+         os_usleep (5 * 1000);
+         EXPECT_EQ (IOLINK_MHMODE_INACTIVE, rec (i + 1).mode);
+      }
+
+      /* Releasing the slot kicks the next port, which then waits for the
+       * spacing on the WAKEUP timer */
+      set_mode (i, IOLINK_DLMODE_OPERATE);
+      ASSERT_TRUE (wait_mode (i, IOLINK_MHMODE_OPERATE));
+      EXPECT_EQ (1, rec (i).op_cnt);
+   }
+
+   EXPECT_EQ (DL_SIM_PORT_CNT, master->startup_cnt);
+   for (i = 0; i < DL_SIM_PORT_CNT; i++)
+   {
+      EXPECT_EQ (i + 1, master->startup_order[i]);
+      tl[i] = timeline (i + 1);
+      EXPECT_EQ (1, tl[i].wurq_cnt);
+      EXPECT_NE (0u, tl[i].operate_us);
+      if (i > 0)
+      {
+         EXPECT_LE (DL_SIM_SPACING_US, tl[i].wurq_us - tl[i - 1].wurq_us);
+      }
+   }
+}
+
+TEST_F (DlSimTest, Dl_Sim_Startup_Cancel)
+{
+   init_startup();
+
+   set_mode (1, IOLINK_DLMODE_STARTUP);
+   ASSERT_TRUE (wait_mode (1, IOLINK_MHMODE_STARTUP));
+   set_mode (2, IOLINK_DLMODE_STARTUP);
+   ASSERT_TRUE (wait_wake_req (2));
+   set_mode (3, IOLINK_DLMODE_STARTUP);
+   ASSERT_TRUE (wait_wake_req (3));
+
+   /* Port 2 gives up while waiting for the slot */
+   set_mode (2, IOLINK_DLMODE_INACTIVE);
+
+   set_mode (1, IOLINK_DLMODE_OPERATE);
+   ASSERT_TRUE (wait_mode (1, IOLINK_MHMODE_OPERATE));
+
+   /* Port 3 is next */
+   ASSERT_TRUE (wait_mode (3, IOLINK_MHMODE_STARTUP));
+   set_mode (3, IOLINK_DLMODE_OPERATE);
+   ASSERT_TRUE (wait_mode (3, IOLINK_MHMODE_OPERATE));
+
+   EXPECT_EQ (2, master->startup_cnt);
+   EXPECT_EQ (1, master->startup_order[0]);
+   EXPECT_EQ (3, master->startup_order[1]);
+   EXPECT_EQ (IOLINK_MHMODE_INACTIVE, rec (2).mode);
+   EXPECT_EQ (0, timeline (2).wurq_cnt);
+   EXPECT_LE (DL_SIM_SPACING_US, timeline (3).wurq_us - timeline (1).wurq_us);
+}
@@ -180,6 +180,64 @@ static void ds_state_0_to_10 (
    mock_iolink_job.callback (&mock_iolink_job);
 }
 
+/* Data Storage backend keeping the set of one port in RAM */
+static struct
+{
+   bool valid;
+   uint8_t portnumber;
+   iolink_ds_record_t record;
+   uint8_t data[IOLINK_DS_MAX_SIZE];
+} ram_ds;
+
+static bool ram_ds_load (
+   void * arg,
+   uint8_t portnumber,
+   iolink_ds_record_t * record)
+{
+   if (!ram_ds.valid || (ram_ds.portnumber != portnumber))
+   {
+      return false;
+   }
+
+   memcpy (record->data, ram_ds.data, ram_ds.record.size);
+   record->vendorid   = ram_ds.record.vendorid;
+   record->deviceid   = ram_ds.record.deviceid;
+   record->functionid = ram_ds.record.functionid;
+   record->cs         = ram_ds.record.cs;
+   record->size       = ram_ds.record.size;
+
+   return true;
+}
+
+static bool ram_ds_store (
+   void * arg,
+   uint8_t portnumber,
+   const iolink_ds_record_t * record)
+{
+   ram_ds.valid       = true;
+   ram_ds.portnumber  = portnumber;
+   ram_ds.record      = *record;
+   ram_ds.record.data = ram_ds.data;
+   memcpy (ram_ds.data, record->data, record->size);
+
+   return true;
+}
+
+static void ram_ds_erase (void * arg, uint8_t portnumber)
+{
+   if (ram_ds.portnumber == portnumber)
+   {
+      ram_ds.valid = false;
+   }
+}
+
+static const iolink_ds_storage_t ram_ds_storage = {
+   .arg   = NULL,
+   .load  = ram_ds_load,
+   .store = ram_ds_store,
+   .erase = ram_ds_erase,
+};
+
 // Test fixture
 
 class DSTest : public TestBase
@@ -310,6 +368,9 @@ TEST_F (DSTest, DS_download)
 
    uint32_t checksum[]      = {123};
    uint8_t state_property[] = {0};
+   const uint16_t index[]   = {0x0123, 0x0124, 0x0124};
+   iolink_ds_stats_t stats;
+   uint8_t write_req_cnt;
 
    int i;
 
@@ -326,7 +387,15 @@ TEST_F (DSTest, DS_download)
    for (i = 0; i < 3; i++) // Number of parameters in DS
    {
       EXPECT_EQ (DS_STATE_Write_Parameter, ds_get_state (port));
+      EXPECT_EQ (index[i], mock_iolink_al_data_index);
+      EXPECT_EQ (i, mock_iolink_al_data_subindex);
+      write_req_cnt = mock_iolink_al_write_req_cnt;
       mock_iolink_al_write_cnf_cb (port, IOLINK_SMI_ERRORTYPE_NONE);
+
+      /* Next record written before the confirmation is handled */
+      EXPECT_EQ (
+         write_req_cnt + ((i < 2) ? 1 : 0),
+         mock_iolink_al_write_req_cnt);
       mock_iolink_job.callback (&mock_iolink_job);
    }
    EXPECT_EQ (DS_STATE_Download_Done, ds_get_state (port));
@@ -345,6 +414,40 @@ TEST_F (DSTest, DS_download)
    EXPECT_EQ (DS_STATE_WaitingOnDSActivity, ds_get_state (port));
 
    EXPECT_EQ (1, mock_iolink_ds_ready_cnt);
+
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_ds_get_stats (portnumber, &stats));
+   EXPECT_EQ (3, stats.download_param_cnt);
+   EXPECT_EQ (sizeof (data_store_data), stats.download_size);
+
+   /* Checksum of the device kept, no download after the next startup */
+   EXPECT_EQ (
+      iolink_get_ds_ctx (port)->device_ds.cs,
+      iolink_get_ds_ctx (port)->master_ds.cs);
+}
+
+TEST_F (DSTest, DS_download_malformed)
+{
+   uint8_t data_storage_size[] = {0, 0, 8, 0}; // 2048 B
+   /* Second record claims more data than the set holds */
+   uint8_t data_store_data[] =
+      {0x01, 0x23, 0x00, 0x01, 0x12, 0x01, 0x24, 0x01, 0x05, 0x55};
+   uint8_t state_property[] = {0};
+
+   ds_state_0_to_10 (
+      port,
+      sizeof (data_store_data),
+      data_store_data,
+      mock_iolink_vendorid,
+      mock_iolink_deviceid,
+      data_storage_size,
+      IOLINK_VALIDATION_CHECK_V11_RESTORE,
+      state_property);
+
+   /* Nothing written but DS_CMD_DL_START and DS_CMD_BREAK */
+   EXPECT_EQ (DS_STATE_DS_Fault, ds_get_state (port));
+   EXPECT_EQ (0x0003, mock_iolink_al_data_index);
+   EXPECT_EQ (DS_CMD_BREAK, mock_iolink_al_data[0]);
+   ds_check_fault (port, IOLINK_DS_FAULT_DOWN);
 }
 
 TEST_F (DSTest, DS_download_upload_req)
@@ -434,6 +537,8 @@ TEST_F (DSTest, DS_upload_upload_req)
          .subindex = 0,
       },
    };
+   iolink_ds_stats_t stats;
+   uint8_t read_req_cnt;
    uint8_t i;
 
    ds_state_0_to_5 (
@@ -479,16 +584,23 @@ TEST_F (DSTest, DS_upload_upload_req)
 
       EXPECT_EQ (htons (il_entry->index), mock_iolink_al_data_index);
       EXPECT_EQ (il_entry->subindex, mock_iolink_al_data_subindex);
+      read_req_cnt = mock_iolink_al_read_req_cnt;
 
       mock_iolink_al_read_cnf_cb (
          port,
          sizeof (param_data),
          param_data,
          IOLINK_SMI_ERRORTYPE_NONE);
+
+      /* Next read requested before the confirmation is handled */
+      EXPECT_EQ (read_req_cnt + 1, mock_iolink_al_read_req_cnt);
       mock_iolink_job.callback (&mock_iolink_job);
+      EXPECT_EQ (read_req_cnt + 1, mock_iolink_al_read_req_cnt);
    }
 
    EXPECT_EQ (DS_STATE_StoreDataSet, ds_get_state (port));
+   EXPECT_EQ (3, mock_iolink_al_data_index);
+   EXPECT_EQ (4, mock_iolink_al_data_subindex);
    // Read checksum
    mock_iolink_al_read_cnf_cb (
       port,
@@ -505,6 +617,24 @@ TEST_F (DSTest, DS_upload_upload_req)
    EXPECT_EQ (DS_STATE_WaitingOnDSActivity, ds_get_state (port));
 
    EXPECT_EQ (1, mock_iolink_ds_ready_cnt);
+
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_ds_get_stats (portnumber, &stats));
+   EXPECT_EQ (3, stats.upload_param_cnt);
+   EXPECT_EQ (3 * (4 + 4), stats.upload_size);
+
+   /* CRC-32 of the records, updated as they were read */
+   EXPECT_EQ (0x6A29DE54u, iolink_get_ds_ctx (port)->master_ds.crc);
+}
+
+TEST_F (DSTest, DS_Crc)
+{
+   iolink_ds_port_t * ds = iolink_get_ds_ctx (port);
+   const char * check    = "123456789";
+
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      par_serv_to_ds (port, strlen (check), (const uint8_t *)check, 1, 2));
+   EXPECT_EQ (0xCBF43926u, ds->master_ds.crc);
 }
 
 TEST_F (DSTest, DS_upload_DS_invalid)
@@ -1190,6 +1320,9 @@ TEST_F (DSTest, DS_Fault_DL_Write_Param_Dev_Err)
       mock_iolink_job.callback (&mock_iolink_job);
    }
 
+   /* Third record not written */
+   EXPECT_EQ (0x0003, mock_iolink_al_data_index);
+   EXPECT_EQ (DS_CMD_BREAK, mock_iolink_al_data[0]);
    ds_check_fault (port, IOLINK_DS_FAULT_DOWN);
 }
 
@@ -1381,3 +1514,497 @@ TEST_F (DSTest, DS_Chk_Cfg_no_ds)
 
    EXPECT_FALSE (DS_Chk_Cfg (port, &cfg_list));
 }
+
+TEST_F (DSTest, DS_Storage)
+{
+   iolink_port_cfg_t port_cfgs[] = {
+      {
+         .name = "/ioltest1/0",
+         .mode = NULL,
+      },
+   };
+   iolink_m_cfg_t m_cfg = {
+      .cb_arg                   = NULL,
+      .cb_smi                   = mock_SMI_cnf,
+      .cb_pd                    = NULL,
+      .port_cnt                 = NELEMENTS (port_cfgs),
+      .port_cfgs                = port_cfgs,
+      .master_thread_prio       = IOLINK_MASTER_THREAD_PRIO,
+      .master_thread_stack_size = IOLINK_MASTER_THREAD_STACK_SIZE,
+      .dl_thread_prio           = IOLINK_DL_THREAD_PRIO,
+      .dl_thread_stack_size     = IOLINK_DL_THREAD_STACK_SIZE,
+      .ds_storage               = &ram_ds_storage,
+   };
+   uint8_t data_storage_size[] = {0, 0, 8, 0}; // 2048 B
+   uint8_t data_store_data[]   = {0x01, 0x23, 0x00, 0x02, 0x12, 0x34};
+   uint8_t state_property[]    = {0};
+   uint32_t checksum[]         = {123};
+   portconfiglist_t cfg_list;
+
+   /* Set stored before the master was started */
+   memset (&ram_ds, 0, sizeof (ram_ds));
+   memcpy (ram_ds.data, data_store_data, sizeof (data_store_data));
+   ram_ds.valid           = true;
+   ram_ds.portnumber      = 1;
+   ram_ds.record.vendorid = mock_iolink_vendorid;
+   ram_ds.record.deviceid = mock_iolink_deviceid;
+   ram_ds.record.cs       = 0x7B000000; /* checksum, read big-endian */
+   ram_ds.record.size     = sizeof (data_store_data);
+
+   iolink_m_deinit (&m);
+   m    = iolink_m_init (&m_cfg);
+   port = iolink_get_port (m, 1);
+
+   /* Loaded into a set of its own size, never a full set */
+   EXPECT_EQ (
+      DS_SET_BLOCK_SIZE (sizeof (data_store_data)),
+      iolink_get_ds_arena (port)->peak);
+
+   memset (&cfg_list, 0, sizeof (portconfiglist_t));
+   cfg_list.vendorid = mock_iolink_vendorid;
+   cfg_list.deviceid = mock_iolink_deviceid;
+   EXPECT_TRUE (DS_Chk_Cfg (port, &cfg_list));
+
+   /* Same checksum in the device, no upload or download */
+   ds_state_0_to_6 (
+      port,
+      0,
+      NULL,
+      mock_iolink_vendorid,
+      mock_iolink_deviceid,
+      data_storage_size,
+      IOLINK_VALIDATION_CHECK_V11_BAK_RESTORE,
+      state_property);
+   EXPECT_EQ (DS_STATE_CheckUpload, ds_get_state (port));
+   mock_iolink_al_read_cnf_cb (
+      port,
+      sizeof (checksum),
+      (uint8_t *)checksum,
+      IOLINK_SMI_ERRORTYPE_NONE);
+   mock_iolink_job.callback (&mock_iolink_job);
+
+   EXPECT_EQ (DS_STATE_WaitingOnDSActivity, ds_get_state (port));
+   EXPECT_EQ (1, mock_iolink_ds_ready_cnt);
+   EXPECT_EQ (0, mock_iolink_al_write_req_cnt);
+
+   /* Stored when set by the application */
+   data_store_data[5] = 0x56;
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      par_serv_to_ds (port, sizeof (data_store_data), data_store_data, 1, 2));
+   EXPECT_TRUE (ram_ds.valid);
+   EXPECT_EQ (1, ram_ds.record.vendorid);
+   EXPECT_EQ (2u, ram_ds.record.deviceid);
+   EXPECT_EQ (0x56, ram_ds.data[5]);
+
+   /* Erased on delete */
+   EXPECT_EQ (IOLINK_ERROR_NONE, DS_Delete (port));
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_FALSE (ram_ds.valid);
+}
+
+TEST_F (DSTest, DS_DSToParServ)
+{
+   uint8_t data[] = {0x01, 0x23, 0x00, 0x02, 0x12, 0x34};
+   uint8_t buf[sizeof (arg_block_ds_data_t) + sizeof (data)];
+   arg_block_ds_data_t * arg_block_ds_data = (arg_block_ds_data_t *)buf;
+   iolink_arena_t * arena                  = iolink_get_ds_arena (port);
+   arg_block_t arg_block_void;
+   void * hog;
+   /* Copies of the packed ArgBlock members */
+   iolink_arg_block_id_t arg_block_id;
+   uint32_t checksum;
+   uint16_t vid;
+   uint32_t did;
+   uint16_t fid;
+
+   memset (&arg_block_void, 0, sizeof (arg_block_t));
+   arg_block_void.id = IOLINK_ARG_BLOCK_ID_VOID_BLOCK;
+
+   /* No Data Storage */
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      SMI_DSToParServ_req (
+         portnumber,
+         IOLINK_ARG_BLOCK_ID_DS_DATA,
+         sizeof (arg_block_t),
+         &arg_block_void));
+   EXPECT_EQ (1, mock_iolink_smi_cnf_cnt);
+   EXPECT_EQ (sizeof (arg_block_ds_data_t), mock_iolink_smi_arg_block_len);
+   arg_block_id = mock_iolink_smi_arg_block->id;
+   EXPECT_EQ (IOLINK_ARG_BLOCK_ID_DS_DATA, arg_block_id);
+
+   memset (buf, 0, sizeof (buf));
+   arg_block_ds_data->arg_block.id = IOLINK_ARG_BLOCK_ID_DS_DATA;
+   arg_block_ds_data->checksum     = 0x12345678;
+   arg_block_ds_data->vid          = mock_iolink_vendorid;
+   arg_block_ds_data->did          = mock_iolink_deviceid;
+   arg_block_ds_data->fid          = mock_iolink_functionid;
+   memcpy (arg_block_ds_data->ds_data, data, sizeof (data));
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      SMI_ParServToDS_req (
+         portnumber,
+         IOLINK_ARG_BLOCK_ID_VOID_BLOCK,
+         sizeof (buf),
+         (arg_block_t *)buf));
+
+   /* Same set back, with its checksum */
+   memset (buf, 0, sizeof (buf));
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      SMI_DSToParServ_req (
+         portnumber,
+         IOLINK_ARG_BLOCK_ID_DS_DATA,
+         sizeof (arg_block_t),
+         &arg_block_void));
+   EXPECT_EQ (sizeof (buf), mock_iolink_smi_arg_block_len);
+   memcpy (buf, mock_iolink_smi_arg_block, sizeof (buf));
+   arg_block_id = arg_block_ds_data->arg_block.id;
+   checksum     = arg_block_ds_data->checksum;
+   vid          = arg_block_ds_data->vid;
+   did          = arg_block_ds_data->did;
+   fid          = arg_block_ds_data->fid;
+   EXPECT_EQ (IOLINK_ARG_BLOCK_ID_DS_DATA, arg_block_id);
+   EXPECT_EQ (0x12345678u, checksum);
+   EXPECT_EQ (mock_iolink_vendorid, vid);
+   EXPECT_EQ (mock_iolink_deviceid, did);
+   EXPECT_EQ (mock_iolink_functionid, fid);
+   EXPECT_EQ (0, memcmp (arg_block_ds_data->ds_data, data, sizeof (data)));
+
+   /* The DS arena is not used, a full arena does not fail the read */
+   EXPECT_EQ (DS_SET_BLOCK_SIZE (sizeof (data)), arena->used);
+   hog = iolink_arena_alloc (
+      arena,
+      (arena->size - arena->used - IOLINK_ARENA_HDR_LEN) &
+         ~(IOLINK_ARENA_ALIGN - 1));
+   ASSERT_TRUE (hog != NULL);
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      SMI_DSToParServ_req (
+         portnumber,
+         IOLINK_ARG_BLOCK_ID_DS_DATA,
+         sizeof (arg_block_t),
+         &arg_block_void));
+   EXPECT_EQ (4, mock_iolink_smi_cnf_cnt);
+   EXPECT_EQ (sizeof (buf), mock_iolink_smi_arg_block_len);
+   iolink_arena_free (arena, hog);
+
+   /* Wrong expected block */
+   EXPECT_EQ (
+      IOLINK_ERROR_PARAMETER_CONFLICT,
+      SMI_DSToParServ_req (
+         portnumber,
+         IOLINK_ARG_BLOCK_ID_VOID_BLOCK,
+         sizeof (arg_block_t),
+         &arg_block_void));
+   EXPECT_EQ (1, mock_iolink_smi_joberror_cnt);
+}
+
+TEST_F (DSTest, DS_Image)
+{
+   iolink_ds_port_t * ds  = iolink_get_ds_ctx (port);
+   iolink_port_t * port2  = iolink_get_port (m, 2);
+   iolink_ds_port_t * ds2 = iolink_get_ds_ctx (port2);
+   uint8_t data[]         = {0x01, 0x23, 0x00, 0x02, 0x12, 0x34};
+   uint8_t image[IOLINK_DS_IMAGE_SIZE (2)];
+   uint32_t len;
+
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      par_serv_to_ds (port, sizeof (data), data, 0x0136, 0x000123));
+   ds->master_ds.cs = 0x12345678;
+
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      iolink_ds_export (image, sizeof (image), &len));
+   EXPECT_EQ (12 + 16 + sizeof (data) + 16 + 4, len);
+
+   /* Too small */
+   EXPECT_EQ (
+      IOLINK_ERROR_PARAMETER_CONFLICT,
+      iolink_ds_export (image, len - 1, &len));
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      iolink_ds_export (image, sizeof (image), &len));
+
+   /* Restored to both ports, port 2 had no set */
+   EXPECT_EQ (IOLINK_ERROR_NONE, DS_Delete (port));
+   mock_iolink_job.callback (&mock_iolink_job);
+   par_serv_to_ds (port2, sizeof (data), data, 1, 2);
+   EXPECT_FALSE (ds->master_ds.valid);
+   EXPECT_TRUE (ds2->master_ds.valid);
+
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_ds_import (image, len));
+   EXPECT_TRUE (ds->master_ds.valid);
+   ds_verify_id (port, 0x0136, 0x000123);
+   EXPECT_EQ (0x12345678u, ds->master_ds.cs);
+   EXPECT_EQ (sizeof (data), ds->master_ds.size);
+   EXPECT_EQ (0, memcmp (ds->master_ds.data, data, sizeof (data)));
+   EXPECT_FALSE (ds2->master_ds.valid);
+
+   /* Damaged image not imported */
+   EXPECT_EQ (IOLINK_ERROR_NONE, DS_Delete (port));
+   mock_iolink_job.callback (&mock_iolink_job);
+   image[12 + 16] ^= 0x01;
+   EXPECT_EQ (IOLINK_ERROR_PARAMETER_CONFLICT, iolink_ds_import (image, len));
+   EXPECT_EQ (
+      IOLINK_ERROR_PARAMETER_CONFLICT,
+      iolink_ds_import (image, len - 1));
+   EXPECT_FALSE (ds->master_ds.valid);
+}
+
+TEST_F (DSTest, DS_ImageAllOrNothing)
+{
+   iolink_ds_port_t * ds  = iolink_get_ds_ctx (port);
+   iolink_port_t * port2  = iolink_get_port (m, 2);
+   iolink_ds_port_t * ds2 = iolink_get_ds_ctx (port2);
+   iolink_arena_t * arena = iolink_get_ds_arena (port);
+   uint8_t data[]         = {0x01, 0x23, 0x00, 0x02, 0x12, 0x34};
+   uint8_t other[]        = {0x01, 0x23, 0x00, 0x02, 0x56, 0x78};
+   uint8_t image[IOLINK_DS_IMAGE_SIZE (2)];
+   uint32_t block = DS_SET_BLOCK_SIZE (sizeof (data));
+   uint32_t used;
+   uint32_t len;
+   void * hog;
+
+   par_serv_to_ds (port, sizeof (data), data, 1, 2);
+   par_serv_to_ds (port2, sizeof (data), data, 1, 2);
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      iolink_ds_export (image, sizeof (image), &len));
+
+   /* Both ports share the other set */
+   par_serv_to_ds (port, sizeof (other), other, 1, 2);
+   par_serv_to_ds (port2, sizeof (other), other, 1, 2);
+   EXPECT_EQ (ds->master_ds.data, ds2->master_ds.data);
+
+   /* Port 2 busy, port 1 not changed */
+   ds2->state = DS_STATE_ReadParameter;
+   EXPECT_EQ (IOLINK_ERROR_STATE_CONFLICT, iolink_ds_import (image, len));
+   EXPECT_EQ (0, memcmp (ds->master_ds.data, other, sizeof (other)));
+   ds2->state = DS_STATE_DS_Ready;
+
+   /* Room for the set of port 1 only, port 1 not changed */
+   used = arena->used;
+   hog  = iolink_arena_alloc (
+      arena,
+      arena->size - used - (block + IOLINK_ARENA_ALIGN) - IOLINK_ARENA_HDR_LEN);
+   ASSERT_TRUE (hog != NULL);
+   EXPECT_EQ (IOLINK_ERROR_OUT_OF_MEMORY, iolink_ds_import (image, len));
+   EXPECT_EQ (0, memcmp (ds->master_ds.data, other, sizeof (other)));
+   EXPECT_EQ (ds->master_ds.data, ds2->master_ds.data);
+   iolink_arena_free (arena, hog);
+   EXPECT_EQ (used, arena->used);
+
+   /* Imported, the ports share the set again */
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_ds_import (image, len));
+   EXPECT_EQ (0, memcmp (ds->master_ds.data, data, sizeof (data)));
+   EXPECT_EQ (ds->master_ds.data, ds2->master_ds.data);
+   EXPECT_EQ (used, arena->used);
+}
+
+TEST_F (DSTest, DS_Arena)
+{
+   iolink_ds_port_t * ds       = iolink_get_ds_ctx (port);
+   iolink_arena_t * arena      = iolink_get_ds_arena (port);
+   uint8_t data_storage_size[] = {0, 0, 0, 40}; // 40 B
+   uint8_t data[]              = {0x0, 0x21, 0x0, 0x01, 0x2};
+
+   /* Nothing allocated without a set */
+   EXPECT_TRUE (ds->master_ds.data == NULL);
+   EXPECT_EQ (0u, ds->master_ds.size_max);
+   EXPECT_EQ (0u, arena->used);
+
+   /* Sized from the set, freed when it is deleted */
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      par_serv_to_ds (port, sizeof (data), data, 0, 0));
+   EXPECT_EQ (sizeof (data), ds->master_ds.size_max);
+   EXPECT_EQ (DS_SET_BLOCK_SIZE (sizeof (data)), arena->used);
+
+   EXPECT_EQ (IOLINK_ERROR_NONE, DS_Delete (port));
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_TRUE (ds->master_ds.data == NULL);
+   EXPECT_EQ (0u, arena->used);
+
+   /* Grown to the size of the device on identification */
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      par_serv_to_ds (port, sizeof (data), data, 0, 0));
+
+   ds_state_0_to_5 (
+      port,
+      0,
+      NULL,
+      0,
+      0,
+      data_storage_size,
+      IOLINK_VALIDATION_CHECK_V11_RESTORE);
+   EXPECT_EQ (DS_STATE_CheckMemSize, ds_get_state (port));
+   EXPECT_EQ (40u, ds->master_ds.size_max);
+   EXPECT_EQ (0, memcmp (ds->master_ds.data, data, sizeof (data)));
+
+   /* Deactivation shrinks to the set, which is kept */
+   EXPECT_EQ (IOLINK_ERROR_NONE, DS_Release (port));
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_TRUE (ds->master_ds.valid);
+   EXPECT_EQ (sizeof (data), ds->master_ds.size_max);
+   EXPECT_EQ (0, memcmp (ds->master_ds.data, data, sizeof (data)));
+   EXPECT_EQ (DS_SET_BLOCK_SIZE (sizeof (data)), arena->used);
+}
+
+TEST_F (DSTest, DS_Arena_Exhausted)
+{
+   iolink_ds_port_t * ds       = iolink_get_ds_ctx (port);
+   iolink_arena_t * arena      = iolink_get_ds_arena (port);
+   uint8_t data_storage_size[] = {0, 0, 8, 0}; // 2048 B
+   uint8_t data[]              = {0x0, 0x21, 0x0, 0x01, 0x2};
+   uint8_t large[IOLINK_DS_MAX_SIZE - 8];
+
+   /* Leave less than a full set */
+   ASSERT_TRUE (
+      iolink_arena_alloc (arena, arena->size - IOLINK_DS_MAX_SIZE) != NULL);
+
+   ds_state_0_to_5 (
+      port,
+      0,
+      NULL,
+      0,
+      0,
+      data_storage_size,
+      IOLINK_VALIDATION_CHECK_V11_RESTORE);
+   ds_check_fault (port, IOLINK_DS_FAULT_SIZE);
+
+   /* A small set still fits */
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      par_serv_to_ds (port, sizeof (data), data, 0, 0));
+
+   /* Not a set larger than what is left */
+   memset (large, 0, sizeof (large));
+   EXPECT_EQ (
+      IOLINK_ERROR_OUT_OF_MEMORY,
+      par_serv_to_ds (port, sizeof (large), large, 0, 0));
+   EXPECT_EQ (1, mock_iolink_smi_joberror_cnt);
+   EXPECT_EQ (0, memcmp (ds->master_ds.data, data, sizeof (data)));
+}
+
+TEST_F (DSTest, DS_Share)
+{
+   iolink_ds_port_t * ds       = iolink_get_ds_ctx (port);
+   iolink_port_t * port2       = iolink_get_port (m, 2);
+   iolink_ds_port_t * ds2      = iolink_get_ds_ctx (port2);
+   iolink_arena_t * arena      = iolink_get_ds_arena (port);
+   uint8_t data_storage_size[] = {0, 0, 0, 40}; // 40 B
+   uint8_t data[]              = {0x01, 0x23, 0x00, 0x02, 0x12, 0x34};
+   uint8_t other[]             = {0x01, 0x23, 0x00, 0x02, 0x56, 0x78};
+   uint16_t vid                = mock_iolink_vendorid;
+   uint32_t did                = mock_iolink_deviceid;
+
+   /* Identical sets are kept once */
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      par_serv_to_ds (port, sizeof (data), data, vid, did));
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      par_serv_to_ds (port2, sizeof (data), data, vid, did));
+   EXPECT_EQ (ds->master_ds.data, ds2->master_ds.data);
+   EXPECT_EQ (DS_SET_BLOCK_SIZE (sizeof (data)), arena->used);
+
+   /* Copied when changed */
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      par_serv_to_ds (port2, sizeof (other), other, vid, did));
+   EXPECT_NE (ds->master_ds.data, ds2->master_ds.data);
+   EXPECT_EQ (0, memcmp (ds->master_ds.data, data, sizeof (data)));
+   EXPECT_EQ (0, memcmp (ds2->master_ds.data, other, sizeof (other)));
+   EXPECT_EQ (2 * DS_SET_BLOCK_SIZE (sizeof (data)), arena->used);
+
+   /* Not the same device */
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      par_serv_to_ds (port2, sizeof (data), data, vid, did + 1));
+   EXPECT_NE (ds->master_ds.data, ds2->master_ds.data);
+
+   /* Kept by the other port when deleted */
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      par_serv_to_ds (port2, sizeof (data), data, vid, did));
+   EXPECT_EQ (ds->master_ds.data, ds2->master_ds.data);
+   EXPECT_EQ (IOLINK_ERROR_NONE, DS_Delete (port2));
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_TRUE (ds2->master_ds.data == NULL);
+   EXPECT_EQ (0, memcmp (ds->master_ds.data, data, sizeof (data)));
+   EXPECT_EQ (DS_SET_BLOCK_SIZE (sizeof (data)), arena->used);
+
+   /* Copied when grown on identification */
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      par_serv_to_ds (port2, sizeof (data), data, vid, did));
+   ds_state_0_to_5 (
+      port,
+      0,
+      NULL,
+      vid,
+      did,
+      data_storage_size,
+      IOLINK_VALIDATION_CHECK_V11_RESTORE);
+   EXPECT_EQ (40u, ds->master_ds.size_max);
+   EXPECT_NE (ds->master_ds.data, ds2->master_ds.data);
+   EXPECT_EQ (0, memcmp (ds->master_ds.data, data, sizeof (data)));
+   EXPECT_EQ (sizeof (data), ds2->master_ds.size_max);
+   EXPECT_EQ (0, memcmp (ds2->master_ds.data, data, sizeof (data)));
+}
+
+TEST_F (DSTest, DS_Template)
+{
+   iolink_ds_port_t * ds  = iolink_get_ds_ctx (port);
+   iolink_port_t * port2  = iolink_get_port (m, 2);
+   iolink_ds_port_t * ds2 = iolink_get_ds_ctx (port2);
+   iolink_arena_t * arena = iolink_get_ds_arena (port);
+   uint8_t data[]         = {0x01, 0x23, 0x00, 0x02, 0x12, 0x34};
+   uint8_t other[]        = {0x01, 0x23, 0x00, 0x01, 0x56};
+   iolink_ds_record_t record;
+   portconfiglist_t cfg_list;
+   uint8_t port_cnt;
+
+   /* Port 1 configured for the device, port 2 holds a set of it */
+   memset (&cfg_list, 0, sizeof (portconfiglist_t));
+   cfg_list.portmode = IOLINK_PORTMODE_IOL_MAN;
+   cfg_list.vendorid = 0x0136;
+   cfg_list.deviceid = 0x000123;
+   EXPECT_EQ (IOLINK_ERROR_NONE, DS_Init (port, &cfg_list));
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      par_serv_to_ds (port2, sizeof (other), other, 0x0136, 0x000123));
+
+   memset (&record, 0, sizeof (record));
+   record.vendorid = 0x0136;
+   record.deviceid = 0x000123;
+   record.cs       = 0x12345678;
+   record.size     = sizeof (data);
+   record.data     = data;
+
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_ds_push_template (&record, &port_cnt));
+   EXPECT_EQ (2, port_cnt);
+   EXPECT_TRUE (ds->master_ds.valid);
+   ds_verify_id (port, 0x0136, 0x000123);
+   ds_verify_id (port2, 0x0136, 0x000123);
+   EXPECT_EQ (0x12345678u, ds->master_ds.cs);
+   EXPECT_EQ (0x12345678u, ds2->master_ds.cs);
+   EXPECT_EQ (ds->master_ds.data, ds2->master_ds.data);
+   EXPECT_EQ (0, memcmp (ds->master_ds.data, data, sizeof (data)));
+   EXPECT_EQ (DS_SET_BLOCK_SIZE (sizeof (data)), arena->used);
+
+   /* No port of another device */
+   record.deviceid = 0x000124;
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_ds_push_template (&record, &port_cnt));
+   EXPECT_EQ (0, port_cnt);
+
+   record.vendorid = 0;
+   EXPECT_EQ (
+      IOLINK_ERROR_PARAMETER_CONFLICT,
+      iolink_ds_push_template (&record, NULL));
+}
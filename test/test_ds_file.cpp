@@ -0,0 +1,179 @@
+/*********************************************************************
+ *        _       _         _
+ *  _ __ | |_  _ | |  __ _ | |__   ___
+ * | '__|| __|(_)| | / _` || '_ \ / __|
+ * | |   | |_  _ | || (_| || |_) |\__ \
+ * |_|    \__|(_)|_| \__,_||_.__/ |___/
+ *
+ * www.rt-labs.com
+ * Copyright 2024 rt-labs AB, Sweden.
+ *
+ * This software is dual-licensed under GPLv3 and a commercial
+ * license. See the file LICENSE.md distributed with this software for
+ * full license information.
+ ********************************************************************/
+
+#include "options.h"
+#include "osal.h"
+#include <gtest/gtest.h>
+
+#include "osal_ds_file.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define DS_FILE_PORT_CNT 2
+
+// Test fixture
+
+class DSFileTest : public ::testing::Test
+{
+ protected:
+   virtual void SetUp()
+   {
+      strcpy (dir, "/tmp/iolink_ds_XXXXXX");
+      ASSERT_TRUE (mkdtemp (dir) != NULL);
+
+      storage = iolink_ds_file_init (dir, DS_FILE_PORT_CNT);
+      ASSERT_TRUE (storage != NULL);
+   };
+
+   virtual void TearDown()
+   {
+      uint8_t portnumber;
+
+      if (storage != NULL)
+      {
+         iolink_ds_file_deinit (storage);
+      }
+
+      for (portnumber = 1; portnumber <= DS_FILE_PORT_CNT; portnumber++)
+      {
+         port_path (portnumber);
+         unlink (path);
+      }
+      rmdir (dir);
+   };
+
+   const char * port_path (uint8_t portnumber)
+   {
+      snprintf (path, sizeof (path), "%s/ds_port%u.bin", dir, portnumber);
+      return path;
+   }
+
+   bool store (uint8_t portnumber, uint32_t cs, uint8_t fill, uint16_t size)
+   {
+      iolink_ds_record_t record;
+
+      memset (data, fill, sizeof (data));
+      record.vendorid   = 0x0136;
+      record.deviceid   = 0x000123;
+      record.functionid = 0;
+      record.cs         = cs;
+      record.size       = size;
+      record.data       = data;
+
+      return storage->store (storage->arg, portnumber, &record);
+   }
+
+   char dir[64];
+   char path[128];
+   uint8_t data[IOLINK_DS_MAX_SIZE];
+   const iolink_ds_storage_t * storage = NULL;
+};
+
+TEST_F (DSFileTest, DS_File_StoreLoad)
+{
+   uint8_t loaded[IOLINK_DS_MAX_SIZE];
+   iolink_ds_record_t record;
+
+   memset (&record, 0, sizeof (record));
+   record.data = loaded;
+
+   /* New file */
+   EXPECT_FALSE (storage->load (storage->arg, 1, &record));
+
+   EXPECT_TRUE (store (1, 0x11111111, 0xAA, 16));
+   EXPECT_TRUE (store (1, 0x22222222, 0xBB, 32));
+
+   /* Latest set, also after a restart */
+   iolink_ds_file_deinit (storage);
+   storage = NULL;
+   storage = iolink_ds_file_init (dir, DS_FILE_PORT_CNT);
+   ASSERT_TRUE (storage != NULL);
+
+   EXPECT_TRUE (storage->load (storage->arg, 1, &record));
+   EXPECT_EQ (0x0136, record.vendorid);
+   EXPECT_EQ (0x000123u, record.deviceid);
+   EXPECT_EQ (0x22222222u, record.cs);
+   EXPECT_EQ (32, record.size);
+   EXPECT_EQ (0xBB, loaded[0]);
+   EXPECT_EQ (0xBB, loaded[31]);
+
+   /* Other port not affected */
+   EXPECT_FALSE (storage->load (storage->arg, 2, &record));
+
+   /* Invalid */
+   EXPECT_FALSE (store (DS_FILE_PORT_CNT + 1, 0, 0, 1));
+   EXPECT_FALSE (store (1, 0, 0, IOLINK_DS_MAX_SIZE + 1));
+}
+
+TEST_F (DSFileTest, DS_File_Corrupt)
+{
+   uint8_t loaded[IOLINK_DS_MAX_SIZE];
+   iolink_ds_record_t record;
+   struct stat st;
+   uint8_t octet = 0;
+   off_t slot_len;
+   int fd;
+
+   memset (&record, 0, sizeof (record));
+   record.data = loaded;
+
+   EXPECT_TRUE (store (1, 0x11111111, 0xAA, 16));
+   EXPECT_TRUE (store (1, 0x22222222, 0xBB, 16));
+   iolink_ds_file_deinit (storage);
+   storage = NULL;
+
+   /* Damage the data of the latest set, in the second slot */
+   ASSERT_EQ (0, stat (port_path (1), &st));
+   slot_len = st.st_size / 2;
+   fd       = open (port_path (1), O_WRONLY);
+   ASSERT_NE (-1, fd);
+   EXPECT_EQ (
+      1,
+      pwrite (fd, &octet, 1, slot_len + slot_len - IOLINK_DS_MAX_SIZE));
+   close (fd);
+
+   /* The previous set is used */
+   storage = iolink_ds_file_init (dir, DS_FILE_PORT_CNT);
+   ASSERT_TRUE (storage != NULL);
+   EXPECT_TRUE (storage->load (storage->arg, 1, &record));
+   EXPECT_EQ (0x11111111u, record.cs);
+   EXPECT_EQ (0xAA, loaded[0]);
+
+   /* and not overwritten by the next store */
+   EXPECT_TRUE (store (1, 0x33333333, 0xCC, 16));
+   EXPECT_TRUE (storage->load (storage->arg, 1, &record));
+   EXPECT_EQ (0x33333333u, record.cs);
+}
+
+TEST_F (DSFileTest, DS_File_Erase)
+{
+   uint8_t loaded[IOLINK_DS_MAX_SIZE];
+   iolink_ds_record_t record;
+
+   memset (&record, 0, sizeof (record));
+   record.data = loaded;
+
+   EXPECT_TRUE (store (1, 0x11111111, 0xAA, 16));
+   EXPECT_TRUE (store (2, 0x22222222, 0xBB, 16));
+
+   storage->erase (storage->arg, 1);
+   EXPECT_FALSE (storage->load (storage->arg, 1, &record));
+   EXPECT_TRUE (storage->load (storage->arg, 2, &record));
+}
@@ -0,0 +1,421 @@
+/*********************************************************************
+ *        _       _         _
+ *  _ __ | |_  _ | |  __ _ | |__   ___
+ * | '__|| __|(_)| | / _` || '_ \ / __|
+ * | |   | |_  _ | || (_| || |_) |\__ \
+ * |_|    \__|(_)|_| \__,_||_.__/ |___/
+ *
+ * www.rt-labs.com
+ * Copyright 2024 rt-labs AB, Sweden.
+ *
+ * This software is dual-licensed under GPLv3 and a commercial
+ * license. See the file LICENSE.md distributed with this software for
+ * full license information.
+ ********************************************************************/
+
+#include "options.h"
+#include "osal.h"
+#include <gtest/gtest.h>
+#include <string.h>
+#include <thread>
+
+#include "iolink_max14819_bus.h"
+
+static unsigned int spi_vectors;
+static size_t spi_xfers[8];
+static uint8_t spi_cmds[32];
+static unsigned int spi_cmd_cnt;
+static uint32_t spi_clk_max_hz;
+
+/* Fake SPI, answers register reads with the inverted command byte */
+extern "C" void * _iolink_pl_hw_spi_init (const char * spi_slave_name)
+{
+   return (void *)1;
+}
+
+extern "C" void _iolink_pl_hw_spi_close (void * fd)
+{
+}
+
+extern "C" bool _iolink_pl_hw_spi_set_timing (
+   void * fd,
+   uint32_t clk_hz,
+   uint32_t delay_us)
+{
+   return (clk_hz <= spi_clk_max_hz);
+}
+
+extern "C" void _iolink_pl_hw_spi_transfer_vec (
+   void * fd,
+   const iolink_spi_xfer_t * xfers,
+   size_t n_xfers)
+{
+   size_t i;
+
+   spi_xfers[spi_vectors++ % NELEMENTS (spi_xfers)] = n_xfers;
+
+   for (i = 0; i < n_xfers; i++)
+   {
+      const uint8_t * tx = (const uint8_t *)xfers[i].data_written;
+      uint8_t * rx       = (uint8_t *)xfers[i].data_read;
+
+      spi_cmds[spi_cmd_cnt++ % sizeof (spi_cmds)] = tx[0];
+      memset (rx, 0, xfers[i].n_bytes_to_transfer);
+      rx[1] = ~tx[0];
+   }
+}
+
+class Max14819BusTest : public ::testing::Test
+{
+ protected:
+   iolink_14819_bus_t * bus;
+   iolink_14819_bus_dev_t dev;
+
+   virtual void SetUp()
+   {
+      spi_vectors    = 0;
+      spi_cmd_cnt    = 0;
+      spi_clk_max_hz = 10000000;
+      memset (spi_xfers, 0, sizeof (spi_xfers));
+
+      bus = iolink_14819_bus_init ("0");
+      ASSERT_TRUE (bus != NULL);
+      ASSERT_TRUE (iolink_14819_bus_dev_init (&dev, bus, 1));
+   }
+
+   virtual void TearDown()
+   {
+      os_event_destroy (dev.grant);
+      iolink_14819_bus_free (bus);
+   }
+
+   /* Keep the bus busy, as if another chip was transferring */
+   void hold_bus()
+   {
+      os_mutex_lock (bus->mtx);
+      bus->busy = true;
+      os_mutex_unlock (bus->mtx);
+   }
+
+   /* Wait until cnt chips are queued for the bus */
+   bool wait_queued (uint8_t cnt)
+   {
+      iolink_14819_bus_dev_t * queued;
+      uint8_t n = 0;
+      uint32_t ms;
+
+      for (ms = 0; (ms < 1000) && (n < cnt); ms++)
+      {
+         n = 0;
+         os_mutex_lock (bus->mtx);
+         for (queued = bus->queue; queued != NULL; queued = queued->next)
+         {
+            n++;
+         }
+         os_mutex_unlock (bus->mtx);
+         os_usleep (1000);
+      }
+
+      return n == cnt;
+   }
+
+   /* Release the bus to the most urgent queued chip */
+   void release_bus()
+   {
+      os_mutex_lock (bus->mtx);
+      bus->busy = false;
+      os_event_set (bus->queue->grant, BIT (0)); /* IOLINK_14819_BUS_GRANT */
+      os_mutex_unlock (bus->mtx);
+   }
+};
+
+/* Write cnt registers, starting at cmd, in one sequence */
+static void bus_write_seq (
+   iolink_14819_bus_dev_t * dev,
+   uint8_t cmd,
+   uint8_t cnt,
+   uint32_t deadline_us)
+{
+   uint8_t i;
+
+   iolink_14819_bus_begin (dev, 0, deadline_us);
+   for (i = 0; i < cnt; i++)
+   {
+      iolink_14819_bus_write (dev, cmd + i, i);
+   }
+   iolink_14819_bus_end (dev);
+}
+
+TEST_F (Max14819BusTest, UnbatchedWrites)
+{
+   iolink_14819_bus_write (&dev, 0x10, 1);
+   iolink_14819_bus_write (&dev, 0x11, 2);
+
+   EXPECT_EQ (2u, spi_vectors);
+   EXPECT_EQ (1u, spi_xfers[0]);
+   EXPECT_EQ (1u, spi_xfers[1]);
+}
+
+TEST_F (Max14819BusTest, WritesDeferredToRead)
+{
+   uint8_t value;
+
+   iolink_14819_bus_begin (&dev, 1, os_get_current_time_us() + 1000);
+   iolink_14819_bus_write (&dev, 0x10, 1);
+   iolink_14819_bus_write (&dev, 0x11, 2);
+   iolink_14819_bus_write (&dev, 0x12, 3);
+   EXPECT_EQ (0u, spi_vectors);
+
+   value = iolink_14819_bus_read (&dev, 0x93);
+   EXPECT_EQ (1u, spi_vectors);
+   EXPECT_EQ (4u, spi_xfers[0]);
+   EXPECT_EQ ((uint8_t)~0x93, value);
+
+   /* Issued in order */
+   EXPECT_EQ (0x10, spi_cmds[0]);
+   EXPECT_EQ (0x11, spi_cmds[1]);
+   EXPECT_EQ (0x12, spi_cmds[2]);
+   EXPECT_EQ (0x93, spi_cmds[3]);
+
+   iolink_14819_bus_write (&dev, 0x14, 4);
+   EXPECT_EQ (1u, spi_vectors);
+   iolink_14819_bus_end (&dev);
+   EXPECT_EQ (2u, spi_vectors);
+   EXPECT_EQ (1u, spi_xfers[1]);
+}
+
+TEST_F (Max14819BusTest, NestedSequence)
+{
+   iolink_14819_bus_begin (&dev, 0, os_get_current_time_us() + 1000);
+   iolink_14819_bus_write (&dev, 0x10, 1);
+   iolink_14819_bus_begin (&dev, 1, os_get_current_time_us());
+   iolink_14819_bus_write (&dev, 0x11, 2);
+   iolink_14819_bus_end (&dev);
+   EXPECT_EQ (0u, spi_vectors);
+   EXPECT_EQ (0, dev.ch);
+   iolink_14819_bus_end (&dev);
+   EXPECT_EQ (1u, spi_vectors);
+   EXPECT_EQ (2u, spi_xfers[0]);
+}
+
+TEST_F (Max14819BusTest, FullBatchIsSent)
+{
+   uint8_t i;
+
+   iolink_14819_bus_begin (&dev, 0, os_get_current_time_us() + 1000);
+   for (i = 0; i < IOLINK_14819_BUS_MAX_XFERS + 1; i++)
+   {
+      iolink_14819_bus_write (&dev, i, i);
+   }
+   EXPECT_EQ (1u, spi_vectors);
+   EXPECT_EQ ((size_t)IOLINK_14819_BUS_MAX_XFERS, spi_xfers[0]);
+   iolink_14819_bus_end (&dev);
+   EXPECT_EQ (2u, spi_vectors);
+   EXPECT_EQ (1u, spi_xfers[1]);
+}
+
+TEST_F (Max14819BusTest, Stats)
+{
+   iolink_14819_bus_stats_t stats;
+   uint8_t buf[4] = {0x20};
+   uint8_t rx[4];
+
+   iolink_14819_bus_begin (&dev, 1, os_get_current_time_us() + 1000);
+   iolink_14819_bus_write (&dev, 0x10, 1);
+   iolink_14819_bus_transfer (&dev, rx, buf, sizeof (buf));
+   iolink_14819_bus_end (&dev);
+
+   iolink_14819_bus_get_stats (bus, &stats, true);
+   EXPECT_EQ (2u, stats.operations);
+   EXPECT_EQ (1u, stats.vectors);
+   EXPECT_EQ (0u, stats.deadline_misses);
+   EXPECT_LE (stats.utilization_permille, 1000);
+
+   iolink_14819_bus_get_stats (bus, &stats, false);
+   EXPECT_EQ (0u, stats.operations);
+   EXPECT_EQ (0u, stats.vectors);
+   EXPECT_EQ (0u, stats.max_latency_us[1][1]);
+}
+
+TEST_F (Max14819BusTest, Timing)
+{
+   EXPECT_EQ (0u, bus->clk_hz);
+
+   EXPECT_TRUE (iolink_14819_bus_set_timing (bus, 8000000, 2));
+   EXPECT_EQ (8000000u, bus->clk_hz);
+   EXPECT_EQ (2u, bus->delay_us);
+
+   /* Rejected by the backend, previous timing kept */
+   EXPECT_FALSE (iolink_14819_bus_set_timing (bus, 12000000, 0));
+   EXPECT_EQ (8000000u, bus->clk_hz);
+   EXPECT_EQ (2u, bus->delay_us);
+}
+
+/* Link that is reliable up to clk_hz, with at least delay_us */
+typedef struct verify_link
+{
+   iolink_14819_bus_t * bus;
+   uint32_t clk_hz;
+   uint32_t delay_us;
+   unsigned int cnt;
+} verify_link_t;
+
+static bool verify_link (void * arg)
+{
+   verify_link_t * link = (verify_link_t *)arg;
+
+   link->cnt++;
+   return (link->bus->clk_hz <= link->clk_hz) &&
+          (link->bus->delay_us >= link->delay_us);
+}
+
+TEST_F (Max14819BusTest, CharacterizeStepsDown)
+{
+   verify_link_t link = {bus, 5000000, 2, 0};
+
+   /* 12 MHz is rejected by the backend, 10 MHz is the first tried */
+   EXPECT_TRUE (iolink_14819_bus_characterize (bus, 0, verify_link, &link));
+   EXPECT_EQ (5000000u, bus->clk_hz);
+   EXPECT_EQ (2u, bus->delay_us);
+   EXPECT_EQ (3u * 8u + 3u, link.cnt);
+}
+
+TEST_F (Max14819BusTest, CharacterizeFromMaxClock)
+{
+   verify_link_t link = {bus, 12000000, 0, 0};
+
+   EXPECT_TRUE (
+      iolink_14819_bus_characterize (bus, 6000000, verify_link, &link));
+   EXPECT_EQ (6000000u, bus->clk_hz);
+   EXPECT_EQ (0u, bus->delay_us);
+   EXPECT_EQ (1u, link.cnt);
+}
+
+TEST_F (Max14819BusTest, CharacterizeKeepsSlowerBusTiming)
+{
+   verify_link_t link = {bus, 12000000, 0, 0};
+
+   /* Set by another chip on the bus */
+   ASSERT_TRUE (iolink_14819_bus_set_timing (bus, 4000000, 10));
+
+   EXPECT_TRUE (iolink_14819_bus_characterize (bus, 0, verify_link, &link));
+   EXPECT_EQ (4000000u, bus->clk_hz);
+   EXPECT_EQ (10u, bus->delay_us);
+   EXPECT_EQ (1u, link.cnt);
+}
+
+TEST_F (Max14819BusTest, CharacterizeFallback)
+{
+   verify_link_t link = {bus, 0, 0, 0};
+
+   /* Nothing passes, the slowest timing is used */
+   EXPECT_FALSE (iolink_14819_bus_characterize (bus, 0, verify_link, &link));
+   EXPECT_EQ (1000000u, bus->clk_hz);
+   EXPECT_EQ (100u, bus->delay_us);
+   EXPECT_EQ (8u * 8u, link.cnt);
+}
+
+TEST_F (Max14819BusTest, CharacterizeNotSupported)
+{
+   verify_link_t link = {bus, 12000000, 0, 0};
+
+   /* The backend default is kept */
+   spi_clk_max_hz = 0;
+   EXPECT_FALSE (iolink_14819_bus_characterize (bus, 0, verify_link, &link));
+   EXPECT_EQ (0u, bus->clk_hz);
+   EXPECT_EQ (0u, link.cnt);
+}
+
+TEST_F (Max14819BusTest, ChipsBatchedByDeadline)
+{
+   iolink_14819_bus_dev_t dev2;
+   uint32_t now = os_get_current_time_us();
+
+   ASSERT_TRUE (iolink_14819_bus_dev_init (&dev2, bus, 2));
+   hold_bus();
+
+   /* The chip with the later deadline asks first */
+   std::thread late (bus_write_seq, &dev, 0x10, 2, now + 5000);
+   ASSERT_TRUE (wait_queued (1));
+   std::thread early (bus_write_seq, &dev2, 0x20, 3, now + 1000);
+   ASSERT_TRUE (wait_queued (2));
+   EXPECT_EQ (&dev2, bus->queue);
+   EXPECT_EQ (0u, spi_vectors);
+
+   /* Both chips in one vector, the most urgent one first */
+   release_bus();
+   early.join();
+   late.join();
+   EXPECT_EQ (1u, spi_vectors);
+   EXPECT_EQ (5u, spi_xfers[0]);
+   EXPECT_EQ (0x20, spi_cmds[0]);
+   EXPECT_EQ (0x21, spi_cmds[1]);
+   EXPECT_EQ (0x22, spi_cmds[2]);
+   EXPECT_EQ (0x10, spi_cmds[3]);
+   EXPECT_EQ (0x11, spi_cmds[4]);
+   EXPECT_TRUE (bus->queue == NULL);
+   EXPECT_FALSE (bus->busy);
+
+   os_event_destroy (dev2.grant);
+}
+
+TEST_F (Max14819BusTest, ChipsSplitWhenBatchIsFull)
+{
+   iolink_14819_bus_dev_t dev2;
+   iolink_14819_bus_stats_t stats;
+   uint32_t now = os_get_current_time_us();
+
+   ASSERT_TRUE (iolink_14819_bus_dev_init (&dev2, bus, 2));
+   iolink_14819_bus_get_stats (bus, &stats, true);
+   hold_bus();
+
+   std::thread late (bus_write_seq, &dev, 0x10, 10, now + 5000);
+   ASSERT_TRUE (wait_queued (1));
+   std::thread early (bus_write_seq, &dev2, 0x30, 10, now + 1000);
+   ASSERT_TRUE (wait_queued (2));
+
+   /* 20 operations do not fit one vector, the later chip gets the bus
+    * next */
+   release_bus();
+   early.join();
+   late.join();
+   EXPECT_EQ (2u, spi_vectors);
+   EXPECT_EQ (10u, spi_xfers[0]);
+   EXPECT_EQ (10u, spi_xfers[1]);
+   EXPECT_EQ (0x30, spi_cmds[0]);
+   EXPECT_EQ (0x10, spi_cmds[10]);
+
+   iolink_14819_bus_get_stats (bus, &stats, false);
+   EXPECT_EQ (20u, stats.operations);
+   EXPECT_EQ (2u, stats.vectors);
+
+   os_event_destroy (dev2.grant);
+}
+
+TEST_F (Max14819BusTest, ChipsDeadlineMiss)
+{
+   iolink_14819_bus_dev_t dev2;
+   iolink_14819_bus_stats_t stats;
+   uint32_t now = os_get_current_time_us();
+
+   ASSERT_TRUE (iolink_14819_bus_dev_init (&dev2, bus, 2));
+   iolink_14819_bus_get_stats (bus, &stats, true);
+   hold_bus();
+
+   /* Only the chip whose deadline has passed counts as a miss */
+   std::thread missed (bus_write_seq, &dev, 0x10, 2, now - 1);
+   std::thread in_time (bus_write_seq, &dev2, 0x20, 1, now + 1000000);
+   ASSERT_TRUE (wait_queued (2));
+   EXPECT_EQ (&dev, bus->queue);
+
+   release_bus();
+   missed.join();
+   in_time.join();
+   EXPECT_EQ (1u, spi_vectors);
+
+   iolink_14819_bus_get_stats (bus, &stats, false);
+   EXPECT_EQ (3u, stats.operations);
+   EXPECT_EQ (2u, stats.deadline_misses);
+
+   os_event_destroy (dev2.grant);
+}
@@ -119,6 +119,24 @@ static void ode_verify_smi_write (
    EXPECT_EQ (exp_len, mock_iolink_smi_arg_block_len);
 }
 
+static dev_par_bat_entry_t * ode_verify_devparbat_entry (
+   dev_par_bat_entry_t * entry,
+   uint16_t exp_index,
+   uint8_t exp_subindex,
+   iolink_smi_errortypes_t exp_errortype,
+   uint8_t exp_len)
+{
+   uint16_t index                    = entry->index;
+   iolink_smi_errortypes_t errortype = entry->errortype;
+
+   EXPECT_EQ (exp_index, index);
+   EXPECT_EQ (exp_subindex, entry->subindex);
+   EXPECT_EQ (exp_errortype, errortype);
+   EXPECT_EQ (exp_len, entry->len);
+
+   return (dev_par_bat_entry_t *)&entry->data[entry->len];
+}
+
 static void ode_start (iolink_port_t * port)
 {
    /* Start ODE */
@@ -531,9 +549,25 @@ TEST_F (ODETest, Ode_DeviceRead_busy)
    EXPECT_EQ (mock_iolink_al_write_req_cnt, 0);
    EXPECT_EQ (mock_iolink_smi_cnf_cnt, 0);
 
+   /* Requests made while ODE is busy are queued */
+   for (i = 0; i < IOLINK_ODE_QUEUE_LEN; i++)
+   {
+      EXPECT_EQ (
+         IOLINK_ERROR_NONE,
+         SMI_DeviceRead_req (
+            portnumber,
+            IOLINK_ARG_BLOCK_ID_OD_RD,
+            sizeof (arg_block_od_t) + sizeof (data),
+            (arg_block_t *)arg_block_od_busy));
+      mock_iolink_job.callback (&mock_iolink_job);
+   }
+   EXPECT_EQ (ODE_STATE_ODblocked, ode_get_state (port));
+   EXPECT_EQ (mock_iolink_smi_joberror_cnt, 0);
+   EXPECT_EQ (mock_iolink_smi_cnf_cnt, 0);
+
    for (i = 0; i < 5; i++)
    {
-      /* ODE is now busy, waiting for AL_Read_cnf() */
+      /* Queue full, ODE is busy, waiting for AL_Read_cnf() */
       EXPECT_EQ (
          IOLINK_ERROR_NONE,
          SMI_DeviceRead_req (
@@ -561,7 +595,7 @@ TEST_F (ODETest, Ode_DeviceRead_busy)
       data);
    EXPECT_EQ (mock_iolink_smi_cnf_cnt, 1);
    EXPECT_EQ (mock_iolink_smi_joberror_cnt, 5);
-   EXPECT_EQ (mock_iolink_al_read_req_cnt, 1);
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 2); /* Next queued request started */
    EXPECT_EQ (mock_iolink_al_write_req_cnt, 0);
    EXPECT_EQ (mock_iolink_al_data_index, index);
    EXPECT_EQ (mock_iolink_al_data_subindex, subindex);
@@ -849,9 +883,25 @@ TEST_F (ODETest, Ode_DeviceWrite_busy)
    EXPECT_EQ (mock_iolink_al_read_req_cnt, 0);
    EXPECT_EQ (mock_iolink_smi_cnf_cnt, 0);
 
+   /* Requests made while ODE is busy are queued */
+   for (i = 0; i < IOLINK_ODE_QUEUE_LEN; i++)
+   {
+      EXPECT_EQ (
+         IOLINK_ERROR_NONE,
+         SMI_DeviceWrite_req (
+            portnumber,
+            IOLINK_ARG_BLOCK_ID_VOID_BLOCK,
+            sizeof (arg_block_od_t) + sizeof (data),
+            (arg_block_t *)arg_block_od_busy));
+      mock_iolink_job.callback (&mock_iolink_job);
+   }
+   EXPECT_EQ (ODE_STATE_ODblocked, ode_get_state (port));
+   EXPECT_EQ (mock_iolink_smi_joberror_cnt, 0);
+   EXPECT_EQ (mock_iolink_smi_cnf_cnt, 0);
+
    for (i = 0; i < 5; i++)
    {
-      /* ODE is now busy, waiting for AL_Write_cnf() */
+      /* Queue full, ODE is busy, waiting for AL_Write_cnf() */
       EXPECT_EQ (
          IOLINK_ERROR_NONE,
          SMI_DeviceWrite_req (
@@ -880,7 +930,7 @@ TEST_F (ODETest, Ode_DeviceWrite_busy)
    EXPECT_TRUE (ArraysMatchN (data, mock_iolink_al_data, sizeof (data)));
    EXPECT_EQ (mock_iolink_smi_cnf_cnt, 1);
    EXPECT_EQ (mock_iolink_smi_joberror_cnt, 5);
-   EXPECT_EQ (mock_iolink_al_write_req_cnt, 1);
+   EXPECT_EQ (mock_iolink_al_write_req_cnt, 2); /* Next queued request started */
    EXPECT_EQ (mock_iolink_al_read_req_cnt, 0);
    EXPECT_EQ (mock_iolink_al_data_index, index);
    EXPECT_EQ (mock_iolink_al_data_subindex, subindex);
@@ -956,10 +1006,97 @@ TEST_F (ODETest, Ode_ParamReadBatch_inactive)
    ode_verify_smi_err (
       IOLINK_ARG_BLOCK_ID_PORT_INXDEX_LIST,
       IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT,
-      IOLINK_SMI_ERRORTYPE_SERVICE_NOT_SUPPORTED);
+      IOLINK_SMI_ERRORTYPE_IDX_NOTAVAIL);
+}
+
+TEST_F (ODETest, Ode_ParamReadBatch)
+{
+   uint8_t list_buf[sizeof (arg_block_portindexlist_t) + 3 * sizeof (port_index_t)];
+   arg_block_portindexlist_t * list = (arg_block_portindexlist_t *)list_buf;
+   arg_block_devparbat_t * res;
+   dev_par_bat_entry_t * entry;
+   iolink_arg_block_id_t arg_block_id;
+   uint8_t data1[2] = {0x12, 0x34};
+   uint8_t data3[1] = {0x56};
+
+   list->arg_block.id        = IOLINK_ARG_BLOCK_ID_PORT_INXDEX_LIST;
+   list->entries[0].index    = 16;
+   list->entries[0].subindex = 0;
+   list->entries[1].index    = 17;
+   list->entries[1].subindex = 0;
+   list->entries[2].index    = 64;
+   list->entries[2].subindex = 2;
+
+   ode_start (port);
+
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      SMI_ParamReadBatch_req (
+         portnumber,
+         IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT,
+         sizeof (list_buf),
+         &list->arg_block));
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (ODE_STATE_ODblocked, ode_get_state (port));
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 1);
+   EXPECT_EQ (mock_iolink_al_data_index, 16);
+
+   /* Next object is read directly from the confirmation */
+   mock_iolink_al_read_cnf_cb (port, sizeof (data1), data1, IOLINK_SMI_ERRORTYPE_NONE);
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (ODE_STATE_ODblocked, ode_get_state (port));
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 2);
+   EXPECT_EQ (mock_iolink_al_data_index, 17);
+   EXPECT_EQ (mock_iolink_smi_cnf_cnt, 0);
+
+   mock_iolink_al_read_cnf_cb (port, 0, NULL, IOLINK_SMI_ERRORTYPE_IDX_NOTAVAIL);
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (ODE_STATE_ODblocked, ode_get_state (port));
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 3);
+   EXPECT_EQ (mock_iolink_al_data_index, 64);
+   EXPECT_EQ (mock_iolink_al_data_subindex, 2);
+
+   mock_iolink_al_read_cnf_cb (port, sizeof (data3), data3, IOLINK_SMI_ERRORTYPE_NONE);
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (ODE_STATE_ODactive, ode_get_state (port));
+
+   /* One aggregated result */
+   EXPECT_EQ (mock_iolink_smi_cnf_cnt, 1);
+   EXPECT_EQ (mock_iolink_smi_joberror_cnt, 0);
+   EXPECT_EQ (IOLINK_ARG_BLOCK_ID_PORT_INXDEX_LIST, mock_iolink_smi_ref_arg_block_id);
+   EXPECT_EQ (
+      sizeof (arg_block_devparbat_t) + 3 * sizeof (dev_par_bat_entry_t) +
+         sizeof (data1) + sizeof (data3),
+      mock_iolink_smi_arg_block_len);
+
+   res          = (arg_block_devparbat_t *)mock_iolink_smi_arg_block;
+   arg_block_id = res->arg_block.id;
+   EXPECT_EQ (IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT, arg_block_id);
+
+   entry = (dev_par_bat_entry_t *)res->entries;
+   EXPECT_TRUE (ArraysMatchN (data1, entry->data, sizeof (data1)));
+   entry = ode_verify_devparbat_entry (
+      entry,
+      16,
+      0,
+      IOLINK_SMI_ERRORTYPE_NONE,
+      sizeof (data1));
+   entry = ode_verify_devparbat_entry (
+      entry,
+      17,
+      0,
+      IOLINK_SMI_ERRORTYPE_IDX_NOTAVAIL,
+      0);
+   EXPECT_EQ (data3[0], entry->data[0]);
+   ode_verify_devparbat_entry (
+      entry,
+      64,
+      2,
+      IOLINK_SMI_ERRORTYPE_NONE,
+      sizeof (data3));
 }
 
-TEST_F (ODETest, Ode_ParamReadBatch_not_supported)
+TEST_F (ODETest, Ode_ParamReadBatch_invalid_len)
 {
    arg_block_test_t arg_block;
 
@@ -972,7 +1109,7 @@ TEST_F (ODETest, Ode_ParamReadBatch_not_supported)
       SMI_ParamReadBatch_req (
          portnumber,
          IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT,
-         sizeof (arg_block_test_t),
+         sizeof (arg_block_portindexlist_t) + sizeof (port_index_t) + 1,
          &arg_block.arg_block));
    mock_iolink_job.callback (&mock_iolink_job);
    EXPECT_EQ (ODE_STATE_ODactive, ode_get_state (port));
@@ -980,12 +1117,11 @@ TEST_F (ODETest, Ode_ParamReadBatch_not_supported)
    EXPECT_EQ (mock_iolink_smi_cnf_cnt, 0);
    EXPECT_EQ (mock_iolink_smi_joberror_cnt, 1);
    EXPECT_EQ (mock_iolink_al_read_req_cnt, 0);
-   EXPECT_EQ (mock_iolink_al_write_req_cnt, 0);
 
    ode_verify_smi_err (
       IOLINK_ARG_BLOCK_ID_PORT_INXDEX_LIST,
       IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT,
-      IOLINK_SMI_ERRORTYPE_SERVICE_NOT_SUPPORTED);
+      IOLINK_SMI_ERRORTYPE_ARGBLOCK_LENGTH_INVALID);
 }
 
 TEST_F (ODETest, Ode_ParamReadBatch_busy)
@@ -994,6 +1130,7 @@ TEST_F (ODETest, Ode_ParamReadBatch_busy)
 
    arg_block_od_t * arg_block_od_first = NULL;
    arg_block_test_t arg_block_readbatch;
+   port_index_t * batch_index;
 
    uint8_t data[1]  = {0x65};
    uint16_t index   = 8;
@@ -1007,8 +1144,12 @@ TEST_F (ODETest, Ode_ParamReadBatch_busy)
    arg_block_od_first->subindex     = subindex;
    arg_block_od_first->data[0]      = 2;
 
+   memset (&arg_block_readbatch, 0, sizeof (arg_block_readbatch));
    arg_block_readbatch.arg_block.id =
       IOLINK_ARG_BLOCK_ID_PORT_INXDEX_LIST;
+   batch_index           = (port_index_t *)arg_block_readbatch.data;
+   batch_index->index    = index;
+   batch_index->subindex = subindex;
 
    ode_start (port);
 
@@ -1026,15 +1167,31 @@ TEST_F (ODETest, Ode_ParamReadBatch_busy)
    EXPECT_EQ (mock_iolink_al_write_req_cnt, 0);
    EXPECT_EQ (mock_iolink_smi_cnf_cnt, 0);
 
+   /* Requests made while ODE is busy are queued */
+   for (i = 0; i < IOLINK_ODE_QUEUE_LEN; i++)
+   {
+      EXPECT_EQ (
+         IOLINK_ERROR_NONE,
+         SMI_ParamReadBatch_req (
+            portnumber,
+            IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT,
+            sizeof (arg_block_portindexlist_t) + sizeof (port_index_t),
+            &arg_block_readbatch.arg_block));
+      mock_iolink_job.callback (&mock_iolink_job);
+   }
+   EXPECT_EQ (ODE_STATE_ODblocked, ode_get_state (port));
+   EXPECT_EQ (mock_iolink_smi_joberror_cnt, 0);
+   EXPECT_EQ (mock_iolink_smi_cnf_cnt, 0);
+
    for (i = 0; i < 5; i++)
    {
-      /* ODE is now busy, waiting for AL_Read_cnf() */
+      /* Queue full, ODE is busy, waiting for AL_Read_cnf() */
       EXPECT_EQ (
          IOLINK_ERROR_NONE,
          SMI_ParamReadBatch_req (
             portnumber,
             IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT,
-            sizeof (arg_block_test_t),
+            sizeof (arg_block_portindexlist_t) + sizeof (port_index_t),
             &arg_block_readbatch.arg_block));
       mock_iolink_job.callback (&mock_iolink_job);
       /* Verify JOB_ERROR */
@@ -1043,7 +1200,7 @@ TEST_F (ODETest, Ode_ParamReadBatch_busy)
       ode_verify_smi_err (
          IOLINK_ARG_BLOCK_ID_PORT_INXDEX_LIST,
          IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT,
-         IOLINK_SMI_ERRORTYPE_SERVICE_NOT_SUPPORTED);
+         IOLINK_SMI_ERRORTYPE_SERVICE_TEMP_UNAVAILABLE);
    }
 
    mock_iolink_al_read_cnf_cb (port, sizeof (data), data, IOLINK_SMI_ERRORTYPE_NONE);
@@ -1056,7 +1213,7 @@ TEST_F (ODETest, Ode_ParamReadBatch_busy)
       data);
    EXPECT_EQ (mock_iolink_smi_cnf_cnt, 1);
    EXPECT_EQ (mock_iolink_smi_joberror_cnt, 5);
-   EXPECT_EQ (mock_iolink_al_read_req_cnt, 1);
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 2); /* Next queued request started */
    EXPECT_EQ (mock_iolink_al_write_req_cnt, 0);
    EXPECT_EQ (mock_iolink_al_data_index, index);
    EXPECT_EQ (mock_iolink_al_data_subindex, subindex);
@@ -1090,14 +1247,28 @@ TEST_F (ODETest, Ode_ParamWriteBatch_inactive)
    ode_verify_smi_err (
       IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT,
       IOLINK_ARG_BLOCK_ID_VOID_BLOCK,
-      IOLINK_SMI_ERRORTYPE_SERVICE_NOT_SUPPORTED);
+      IOLINK_SMI_ERRORTYPE_IDX_NOTAVAIL);
 }
 
-TEST_F (ODETest, Ode_ParamWriteBatch_not_supported)
+TEST_F (ODETest, Ode_ParamWriteBatch)
 {
-   arg_block_test_t arg_block;
-
-   arg_block.arg_block.id = IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT;
+   uint8_t batch_buf[sizeof (arg_block_devparbat_t) + 2 * sizeof (dev_par_bat_entry_t) + 3];
+   arg_block_devparbat_t * batch = (arg_block_devparbat_t *)batch_buf;
+   dev_par_bat_entry_t * entry1  = (dev_par_bat_entry_t *)batch->entries;
+   dev_par_bat_entry_t * entry2;
+
+   memset (batch_buf, 0, sizeof (batch_buf));
+   batch->arg_block.id = IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT;
+   entry1->index       = 24;
+   entry1->subindex    = 0;
+   entry1->len         = 2;
+   entry1->data[0]     = 0xAB;
+   entry1->data[1]     = 0xCD;
+   entry2              = (dev_par_bat_entry_t *)&entry1->data[entry1->len];
+   entry2->index       = 80;
+   entry2->subindex    = 1;
+   entry2->len         = 1;
+   entry2->data[0]     = 0xEF;
 
    ode_start (port);
 
@@ -1106,20 +1277,95 @@ TEST_F (ODETest, Ode_ParamWriteBatch_not_supported)
       SMI_ParamWriteBatch_req (
          portnumber,
          IOLINK_ARG_BLOCK_ID_VOID_BLOCK,
-         sizeof (arg_block_test_t),
-         &arg_block.arg_block));
+         sizeof (batch_buf),
+         &batch->arg_block));
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (ODE_STATE_ODblocked, ode_get_state (port));
+   EXPECT_EQ (mock_iolink_al_write_req_cnt, 1);
+   EXPECT_EQ (mock_iolink_al_data_index, 24);
+   EXPECT_EQ (mock_iolink_al_data[1], 0xCD);
+
+   mock_iolink_al_write_cnf_cb (port, IOLINK_SMI_ERRORTYPE_PAR_VALOUTOFRNG);
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (ODE_STATE_ODblocked, ode_get_state (port));
+   EXPECT_EQ (mock_iolink_al_write_req_cnt, 2);
+   EXPECT_EQ (mock_iolink_al_data_index, 80);
+   EXPECT_EQ (mock_iolink_al_data_subindex, 1);
+   EXPECT_EQ (mock_iolink_al_data[0], 0xEF);
+   EXPECT_EQ (mock_iolink_smi_joberror_cnt, 0);
+
+   mock_iolink_al_write_cnf_cb (port, IOLINK_SMI_ERRORTYPE_NONE);
    mock_iolink_job.callback (&mock_iolink_job);
    EXPECT_EQ (ODE_STATE_ODactive, ode_get_state (port));
 
+   /* The first error is reported, each object holds its own result */
    EXPECT_EQ (mock_iolink_smi_cnf_cnt, 0);
    EXPECT_EQ (mock_iolink_smi_joberror_cnt, 1);
-   EXPECT_EQ (mock_iolink_al_read_req_cnt, 0);
+   ode_verify_smi_err (
+      IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT,
+      IOLINK_ARG_BLOCK_ID_VOID_BLOCK,
+      IOLINK_SMI_ERRORTYPE_PAR_VALOUTOFRNG);
+   ode_verify_devparbat_entry (
+      entry1,
+      24,
+      0,
+      IOLINK_SMI_ERRORTYPE_PAR_VALOUTOFRNG,
+      2);
+   ode_verify_devparbat_entry (entry2, 80, 1, IOLINK_SMI_ERRORTYPE_NONE, 1);
+
+   /* Again, all objects written */
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      SMI_ParamWriteBatch_req (
+         portnumber,
+         IOLINK_ARG_BLOCK_ID_VOID_BLOCK,
+         sizeof (batch_buf),
+         &batch->arg_block));
+   mock_iolink_job.callback (&mock_iolink_job);
+   mock_iolink_al_write_cnf_cb (port, IOLINK_SMI_ERRORTYPE_NONE);
+   mock_iolink_job.callback (&mock_iolink_job);
+   mock_iolink_al_write_cnf_cb (port, IOLINK_SMI_ERRORTYPE_NONE);
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (ODE_STATE_ODactive, ode_get_state (port));
+   EXPECT_EQ (mock_iolink_al_write_req_cnt, 4);
+   EXPECT_EQ (mock_iolink_smi_cnf_cnt, 1);
+   ode_verify_smi_write (
+      IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT,
+      IOLINK_ARG_BLOCK_ID_VOID_BLOCK,
+      sizeof (arg_block_void_t));
+   ode_verify_devparbat_entry (entry1, 24, 0, IOLINK_SMI_ERRORTYPE_NONE, 2);
+}
+
+TEST_F (ODETest, Ode_ParamWriteBatch_invalid_len)
+{
+   uint8_t batch_buf[sizeof (arg_block_devparbat_t) + sizeof (dev_par_bat_entry_t) + 2];
+   arg_block_devparbat_t * batch = (arg_block_devparbat_t *)batch_buf;
+   dev_par_bat_entry_t * entry   = (dev_par_bat_entry_t *)batch->entries;
+
+   memset (batch_buf, 0, sizeof (batch_buf));
+   batch->arg_block.id = IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT;
+   entry->index        = 24;
+   entry->len          = 4; /* Beyond the end of the ArgBlock */
+
+   ode_start (port);
+
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      SMI_ParamWriteBatch_req (
+         portnumber,
+         IOLINK_ARG_BLOCK_ID_VOID_BLOCK,
+         sizeof (batch_buf),
+         &batch->arg_block));
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (ODE_STATE_ODactive, ode_get_state (port));
+
+   EXPECT_EQ (mock_iolink_smi_joberror_cnt, 1);
    EXPECT_EQ (mock_iolink_al_write_req_cnt, 0);
 
    ode_verify_smi_err (
       IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT,
       IOLINK_ARG_BLOCK_ID_VOID_BLOCK,
-      IOLINK_SMI_ERRORTYPE_SERVICE_NOT_SUPPORTED);
+      IOLINK_SMI_ERRORTYPE_ARGBLOCK_LENGTH_INVALID);
 }
 
 TEST_F (ODETest, Ode_ParamWriteBatch_busy)
@@ -1128,6 +1374,7 @@ TEST_F (ODETest, Ode_ParamWriteBatch_busy)
 
    arg_block_od_t * arg_block_od_first = NULL;
    arg_block_test_t arg_block_readbatch;
+   dev_par_bat_entry_t * batch_entry;
 
    uint8_t data[1]  = {0x65};
    uint16_t index   = 8;
@@ -1141,7 +1388,11 @@ TEST_F (ODETest, Ode_ParamWriteBatch_busy)
    arg_block_od_first->subindex     = subindex;
    arg_block_od_first->data[0]      = 2;
 
+   memset (&arg_block_readbatch, 0, sizeof (arg_block_readbatch));
    arg_block_readbatch.arg_block.id = IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT;
+   batch_entry           = (dev_par_bat_entry_t *)arg_block_readbatch.data;
+   batch_entry->index    = index;
+   batch_entry->subindex = subindex;
 
    ode_start (port);
 
@@ -1159,15 +1410,31 @@ TEST_F (ODETest, Ode_ParamWriteBatch_busy)
    EXPECT_EQ (mock_iolink_al_write_req_cnt, 0);
    EXPECT_EQ (mock_iolink_smi_cnf_cnt, 0);
 
+   /* Requests made while ODE is busy are queued */
+   for (i = 0; i < IOLINK_ODE_QUEUE_LEN; i++)
+   {
+      EXPECT_EQ (
+         IOLINK_ERROR_NONE,
+         SMI_ParamWriteBatch_req (
+            portnumber,
+            IOLINK_ARG_BLOCK_ID_VOID_BLOCK,
+            sizeof (arg_block_devparbat_t) + sizeof (dev_par_bat_entry_t),
+            &arg_block_readbatch.arg_block));
+      mock_iolink_job.callback (&mock_iolink_job);
+   }
+   EXPECT_EQ (ODE_STATE_ODblocked, ode_get_state (port));
+   EXPECT_EQ (mock_iolink_smi_joberror_cnt, 0);
+   EXPECT_EQ (mock_iolink_smi_cnf_cnt, 0);
+
    for (i = 0; i < 5; i++)
    {
-      /* ODE is now busy, waiting for AL_Read_cnf() */
+      /* Queue full, ODE is busy, waiting for AL_Read_cnf() */
       EXPECT_EQ (
          IOLINK_ERROR_NONE,
          SMI_ParamWriteBatch_req (
             portnumber,
             IOLINK_ARG_BLOCK_ID_VOID_BLOCK,
-            sizeof (arg_block_test_t),
+            sizeof (arg_block_devparbat_t) + sizeof (dev_par_bat_entry_t),
             &arg_block_readbatch.arg_block));
       mock_iolink_job.callback (&mock_iolink_job);
       /* Verify JOB_ERROR */
@@ -1176,7 +1443,7 @@ TEST_F (ODETest, Ode_ParamWriteBatch_busy)
       ode_verify_smi_err (
          IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT,
          IOLINK_ARG_BLOCK_ID_VOID_BLOCK,
-         IOLINK_SMI_ERRORTYPE_SERVICE_NOT_SUPPORTED);
+         IOLINK_SMI_ERRORTYPE_SERVICE_TEMP_UNAVAILABLE);
    }
 
    mock_iolink_al_read_cnf_cb (port, sizeof (data), data, IOLINK_SMI_ERRORTYPE_NONE);
@@ -1189,10 +1456,638 @@ TEST_F (ODETest, Ode_ParamWriteBatch_busy)
       data);
    EXPECT_EQ (mock_iolink_smi_cnf_cnt, 1);
    EXPECT_EQ (mock_iolink_smi_joberror_cnt, 5);
-   EXPECT_EQ (mock_iolink_al_write_req_cnt, 0);
+   EXPECT_EQ (mock_iolink_al_write_req_cnt, 1); /* Next queued request started */
    EXPECT_EQ (mock_iolink_al_read_req_cnt, 1);
    EXPECT_EQ (mock_iolink_al_data_index, index);
    EXPECT_EQ (mock_iolink_al_data_subindex, subindex);
 
    free (arg_block_od_first);
 }
+
+TEST_F (ODETest, Ode_queue_in_order)
+{
+   uint8_t data[1]                = {0x42};
+   arg_block_od_t * arg_block_od1 = ode_create_ArgBlock_od (sizeof (data));
+   arg_block_od_t * arg_block_od2 = ode_create_ArgBlock_od (sizeof (data));
+   arg_block_od_t * arg_block_od3 = ode_create_ArgBlock_od (sizeof (data));
+
+   ASSERT_TRUE (arg_block_od1);
+   ASSERT_TRUE (arg_block_od2);
+   ASSERT_TRUE (arg_block_od3);
+
+   arg_block_od1->arg_block.id = IOLINK_ARG_BLOCK_ID_OD_RD;
+   arg_block_od1->index        = 16;
+   arg_block_od2->arg_block.id = IOLINK_ARG_BLOCK_ID_OD_WR;
+   arg_block_od2->index        = 17;
+   arg_block_od2->data[0]      = data[0];
+   arg_block_od3->arg_block.id = IOLINK_ARG_BLOCK_ID_OD_RD;
+   arg_block_od3->index        = 18;
+
+   ode_start (port);
+
+   SMI_DeviceRead_req (
+      portnumber,
+      IOLINK_ARG_BLOCK_ID_OD_RD,
+      sizeof (arg_block_od_t) + sizeof (data),
+      (arg_block_t *)arg_block_od1);
+   mock_iolink_job.callback (&mock_iolink_job);
+   SMI_DeviceWrite_req (
+      portnumber,
+      IOLINK_ARG_BLOCK_ID_VOID_BLOCK,
+      sizeof (arg_block_od_t) + sizeof (data),
+      (arg_block_t *)arg_block_od2);
+   mock_iolink_job.callback (&mock_iolink_job);
+   SMI_DeviceRead_req (
+      portnumber,
+      IOLINK_ARG_BLOCK_ID_OD_RD,
+      sizeof (arg_block_od_t) + sizeof (data),
+      (arg_block_t *)arg_block_od3);
+   mock_iolink_job.callback (&mock_iolink_job);
+
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 1);
+   EXPECT_EQ (mock_iolink_al_write_req_cnt, 0);
+   EXPECT_EQ (mock_iolink_al_data_index, 16);
+
+   mock_iolink_al_read_cnf_cb (port, sizeof (data), data, IOLINK_SMI_ERRORTYPE_NONE);
+   mock_iolink_job.callback (&mock_iolink_job);
+   ode_verify_smi_read (
+      IOLINK_ARG_BLOCK_ID_OD_RD,
+      IOLINK_ARG_BLOCK_ID_OD_RD,
+      sizeof (arg_block_od_t) + sizeof (data),
+      data);
+   EXPECT_EQ (mock_iolink_al_write_req_cnt, 1);
+   EXPECT_EQ (mock_iolink_al_data_index, 17);
+
+   mock_iolink_al_write_cnf_cb (port, IOLINK_SMI_ERRORTYPE_NONE);
+   mock_iolink_job.callback (&mock_iolink_job);
+   ode_verify_smi_write (
+      IOLINK_ARG_BLOCK_ID_OD_WR,
+      IOLINK_ARG_BLOCK_ID_VOID_BLOCK,
+      sizeof (arg_block_void_t));
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 2);
+   EXPECT_EQ (mock_iolink_al_data_index, 18);
+
+   mock_iolink_al_read_cnf_cb (port, sizeof (data), data, IOLINK_SMI_ERRORTYPE_NONE);
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (ODE_STATE_ODactive, ode_get_state (port));
+   EXPECT_EQ (mock_iolink_smi_cnf_cnt, 3);
+   EXPECT_EQ (mock_iolink_smi_joberror_cnt, 0);
+
+   free (arg_block_od1);
+   free (arg_block_od2);
+   free (arg_block_od3);
+}
+
+TEST_F (ODETest, Ode_queue_timeout)
+{
+   iolink_ode_port_t * ode       = iolink_get_ode_ctx (port);
+   uint8_t data[1]               = {0x42};
+   arg_block_od_t * arg_block_od = ode_create_ArgBlock_od (sizeof (data));
+   arg_block_od_t * arg_block_od_late = ode_create_ArgBlock_od (sizeof (data));
+
+   ASSERT_TRUE (arg_block_od);
+   ASSERT_TRUE (arg_block_od_late);
+
+   arg_block_od->arg_block.id      = IOLINK_ARG_BLOCK_ID_OD_RD;
+   arg_block_od_late->arg_block.id = IOLINK_ARG_BLOCK_ID_OD_RD;
+
+   ode->queue_timeout_ms = 1;
+   ode_start (port);
+
+   SMI_DeviceRead_req (
+      portnumber,
+      IOLINK_ARG_BLOCK_ID_OD_RD,
+      sizeof (arg_block_od_t) + sizeof (data),
+      (arg_block_t *)arg_block_od);
+   mock_iolink_job.callback (&mock_iolink_job);
+   SMI_DeviceRead_req (
+      portnumber,
+      IOLINK_ARG_BLOCK_ID_OD_RD,
+      sizeof (arg_block_od_t) + sizeof (data),
+      (arg_block_t *)arg_block_od_late);
+   mock_iolink_job.callback (&mock_iolink_job);
+
+   /* The queued request is not started before its deadline */
+   os_usleep (2 * 1000);
+
+   mock_iolink_al_read_cnf_cb (port, sizeof (data), data, IOLINK_SMI_ERRORTYPE_NONE);
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (ODE_STATE_ODactive, ode_get_state (port));
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 1);
+   EXPECT_EQ (mock_iolink_smi_cnf_cnt, 1);
+   EXPECT_EQ (mock_iolink_smi_joberror_cnt, 1);
+   ode_verify_smi_err (
+      IOLINK_ARG_BLOCK_ID_OD_RD,
+      IOLINK_ARG_BLOCK_ID_OD_RD,
+      IOLINK_SMI_ERRORTYPE_I_SERVICE_TIMEOUT);
+
+   free (arg_block_od);
+   free (arg_block_od_late);
+}
+
+TEST_F (ODETest, Ode_queue_timeout_during_batch)
+{
+   iolink_ode_port_t * ode = iolink_get_ode_ctx (port);
+   uint8_t list_buf[sizeof (arg_block_portindexlist_t) + 2 * sizeof (port_index_t)];
+   arg_block_portindexlist_t * list = (arg_block_portindexlist_t *)list_buf;
+   uint8_t data[1]                  = {0x42};
+   arg_block_od_t * arg_block_od    = ode_create_ArgBlock_od (sizeof (data));
+
+   ASSERT_TRUE (arg_block_od);
+
+   list->arg_block.id        = IOLINK_ARG_BLOCK_ID_PORT_INXDEX_LIST;
+   list->entries[0].index    = 16;
+   list->entries[0].subindex = 0;
+   list->entries[1].index    = 17;
+   list->entries[1].subindex = 0;
+   arg_block_od->arg_block.id = IOLINK_ARG_BLOCK_ID_OD_RD;
+
+   ode->queue_timeout_ms = 1;
+   ode_start (port);
+
+   SMI_ParamReadBatch_req (
+      portnumber,
+      IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT,
+      sizeof (list_buf),
+      &list->arg_block);
+   mock_iolink_job.callback (&mock_iolink_job);
+   SMI_DeviceRead_req (
+      portnumber,
+      IOLINK_ARG_BLOCK_ID_OD_RD,
+      sizeof (arg_block_od_t) + sizeof (data),
+      (arg_block_t *)arg_block_od);
+   mock_iolink_job.callback (&mock_iolink_job);
+
+   os_usleep (2 * 1000);
+
+   /* Timed out on the first object, not when the batch is done */
+   mock_iolink_al_read_cnf_cb (port, sizeof (data), data, IOLINK_SMI_ERRORTYPE_NONE);
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (ODE_STATE_ODblocked, ode_get_state (port));
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 2);
+   EXPECT_EQ (mock_iolink_smi_cnf_cnt, 0);
+   EXPECT_EQ (mock_iolink_smi_joberror_cnt, 1);
+   ode_verify_smi_err (
+      IOLINK_ARG_BLOCK_ID_OD_RD,
+      IOLINK_ARG_BLOCK_ID_OD_RD,
+      IOLINK_SMI_ERRORTYPE_I_SERVICE_TIMEOUT);
+
+   mock_iolink_al_read_cnf_cb (port, sizeof (data), data, IOLINK_SMI_ERRORTYPE_NONE);
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (ODE_STATE_ODactive, ode_get_state (port));
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 2);
+   EXPECT_EQ (mock_iolink_smi_cnf_cnt, 1);
+   EXPECT_EQ (mock_iolink_smi_joberror_cnt, 1);
+
+   free (arg_block_od);
+}
+
+TEST_F (ODETest, Ode_queue_timeout_limit)
+{
+   iolink_ode_port_t * ode = iolink_get_ode_ctx (port);
+
+   /* Would overflow the deadline in microseconds */
+   iolink_ode_init (port, UINT32_MAX, UINT32_MAX);
+   EXPECT_EQ ((uint32_t)IOLINK_ODE_MAX_TIMEOUT_MS, ode->queue_timeout_ms);
+   EXPECT_EQ ((uint32_t)IOLINK_ODE_MAX_TIMEOUT_MS, ode->cache_ttl_ms);
+
+   iolink_ode_init (port, 100, 200);
+   EXPECT_EQ (100u, ode->queue_timeout_ms);
+   EXPECT_EQ (200u, ode->cache_ttl_ms);
+}
+
+TEST_F (ODETest, Ode_queue_cancel)
+{
+   uint8_t data[1]                = {0x42};
+   arg_block_od_t * arg_block_od1 = ode_create_ArgBlock_od (sizeof (data));
+   arg_block_od_t * arg_block_od2 = ode_create_ArgBlock_od (sizeof (data));
+   arg_block_od_t * arg_block_od3 = ode_create_ArgBlock_od (sizeof (data));
+
+   ASSERT_TRUE (arg_block_od1);
+   ASSERT_TRUE (arg_block_od2);
+   ASSERT_TRUE (arg_block_od3);
+
+   arg_block_od1->arg_block.id = IOLINK_ARG_BLOCK_ID_OD_RD;
+   arg_block_od1->index        = 16;
+   arg_block_od2->arg_block.id = IOLINK_ARG_BLOCK_ID_OD_RD;
+   arg_block_od2->index        = 17;
+   arg_block_od3->arg_block.id = IOLINK_ARG_BLOCK_ID_OD_RD;
+   arg_block_od3->index        = 18;
+
+   ode_start (port);
+
+   SMI_DeviceRead_req (
+      portnumber,
+      IOLINK_ARG_BLOCK_ID_OD_RD,
+      sizeof (arg_block_od_t) + sizeof (data),
+      (arg_block_t *)arg_block_od1);
+   mock_iolink_job.callback (&mock_iolink_job);
+   SMI_DeviceRead_req (
+      portnumber,
+      IOLINK_ARG_BLOCK_ID_OD_RD,
+      sizeof (arg_block_od_t) + sizeof (data),
+      (arg_block_t *)arg_block_od2);
+   mock_iolink_job.callback (&mock_iolink_job);
+   SMI_DeviceRead_req (
+      portnumber,
+      IOLINK_ARG_BLOCK_ID_OD_RD,
+      sizeof (arg_block_od_t) + sizeof (data),
+      (arg_block_t *)arg_block_od3);
+   mock_iolink_job.callback (&mock_iolink_job);
+
+   /* Cancel the first queued request */
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      SMI_ODCancel_req (portnumber, (arg_block_t *)arg_block_od2));
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (mock_iolink_smi_joberror_cnt, 1);
+   ode_verify_smi_err (
+      IOLINK_ARG_BLOCK_ID_OD_RD,
+      IOLINK_ARG_BLOCK_ID_OD_RD,
+      IOLINK_SMI_ERRORTYPE_SERVICE_TEMP_UNAVAILABLE);
+
+   /* The request in progress is not cancelled */
+   SMI_ODCancel_req (portnumber, (arg_block_t *)arg_block_od1);
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (mock_iolink_smi_joberror_cnt, 1);
+   EXPECT_EQ (ODE_STATE_ODblocked, ode_get_state (port));
+
+   mock_iolink_al_read_cnf_cb (port, sizeof (data), data, IOLINK_SMI_ERRORTYPE_NONE);
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (mock_iolink_smi_cnf_cnt, 1);
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 2);
+   EXPECT_EQ (mock_iolink_al_data_index, 18);
+
+   free (arg_block_od1);
+   free (arg_block_od2);
+   free (arg_block_od3);
+}
+
+TEST_F (ODETest, Ode_queue_stop)
+{
+   uint8_t data[1]                = {0x42};
+   arg_block_od_t * arg_block_od1 = ode_create_ArgBlock_od (sizeof (data));
+   arg_block_od_t * arg_block_od2 = ode_create_ArgBlock_od (sizeof (data));
+
+   ASSERT_TRUE (arg_block_od1);
+   ASSERT_TRUE (arg_block_od2);
+
+   arg_block_od1->arg_block.id = IOLINK_ARG_BLOCK_ID_OD_RD;
+   arg_block_od2->arg_block.id = IOLINK_ARG_BLOCK_ID_OD_RD;
+
+   ode_start (port);
+
+   SMI_DeviceRead_req (
+      portnumber,
+      IOLINK_ARG_BLOCK_ID_OD_RD,
+      sizeof (arg_block_od_t) + sizeof (data),
+      (arg_block_t *)arg_block_od1);
+   mock_iolink_job.callback (&mock_iolink_job);
+   SMI_DeviceRead_req (
+      portnumber,
+      IOLINK_ARG_BLOCK_ID_OD_RD,
+      sizeof (arg_block_od_t) + sizeof (data),
+      (arg_block_t *)arg_block_od2);
+   mock_iolink_job.callback (&mock_iolink_job);
+
+   OD_Stop (port);
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (ODE_STATE_Inactive, ode_get_state (port));
+
+   /* Queued requests get the response of an inactive port */
+   EXPECT_EQ (mock_iolink_smi_joberror_cnt, 1);
+   ode_verify_smi_err (
+      IOLINK_ARG_BLOCK_ID_OD_RD,
+      IOLINK_ARG_BLOCK_ID_OD_RD,
+      IOLINK_SMI_ERRORTYPE_IDX_NOTAVAIL);
+
+   free (arg_block_od1);
+   free (arg_block_od2);
+}
+
+static void ode_read_index (
+   uint8_t portnumber,
+   uint16_t index,
+   arg_block_od_t * arg_block_od,
+   uint8_t data_len)
+{
+   arg_block_od->arg_block.id = IOLINK_ARG_BLOCK_ID_OD_RD;
+   arg_block_od->index        = index;
+   arg_block_od->subindex     = 0;
+
+   SMI_DeviceRead_req (
+      portnumber,
+      IOLINK_ARG_BLOCK_ID_OD_RD,
+      sizeof (arg_block_od_t) + data_len,
+      (arg_block_t *)arg_block_od);
+   mock_iolink_job.callback (&mock_iolink_job);
+}
+
+static void ode_read_cnf (
+   iolink_port_t * port,
+   uint8_t len,
+   const uint8_t * data)
+{
+   mock_iolink_al_read_cnf_cb (port, len, data, IOLINK_SMI_ERRORTYPE_NONE);
+   mock_iolink_job.callback (&mock_iolink_job);
+}
+
+TEST_F (ODETest, Ode_cache_immutable)
+{
+   uint8_t data[]                = {'r', 't', '-', 'l', 'a', 'b', 's'};
+   arg_block_od_t * arg_block_od = ode_create_ArgBlock_od (16);
+
+   ASSERT_TRUE (arg_block_od);
+
+   ode_start (port);
+
+   ode_read_index (portnumber, IOL_DEV_PARAMA_VENDOR_NAME, arg_block_od, 16);
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 1);
+   ode_read_cnf (port, sizeof (data), data);
+   EXPECT_EQ (mock_iolink_smi_cnf_cnt, 1);
+
+   /* Served from the cache */
+   memset (arg_block_od->data, 0, 16);
+   ode_read_index (portnumber, IOL_DEV_PARAMA_VENDOR_NAME, arg_block_od, 16);
+   EXPECT_EQ (ODE_STATE_ODactive, ode_get_state (port));
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 1);
+   EXPECT_EQ (mock_iolink_smi_cnf_cnt, 2);
+   ode_verify_smi_read (
+      IOLINK_ARG_BLOCK_ID_OD_RD,
+      IOLINK_ARG_BLOCK_ID_OD_RD,
+      sizeof (arg_block_od_t) + sizeof (data),
+      data);
+
+   /* Other indexes are always read from the device */
+   ode_read_index (portnumber, 0x40, arg_block_od, 16);
+   ode_read_cnf (port, sizeof (data), data);
+   ode_read_index (portnumber, 0x40, arg_block_od, 16);
+   ode_read_cnf (port, sizeof (data), data);
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 3);
+
+   /* Cleared on OD_STOP, the device may be replaced */
+   OD_Stop (port);
+   mock_iolink_job.callback (&mock_iolink_job);
+   ode_start (port);
+   ode_read_index (portnumber, IOL_DEV_PARAMA_VENDOR_NAME, arg_block_od, 16);
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 4);
+   EXPECT_EQ (ODE_STATE_ODblocked, ode_get_state (port));
+
+   free (arg_block_od);
+}
+
+TEST_F (ODETest, Ode_late_cnf_after_stop)
+{
+   uint8_t data[]                = {'r', 't', '-', 'l', 'a', 'b', 's'};
+   arg_block_od_t * arg_block_od = ode_create_ArgBlock_od (16);
+
+   ASSERT_TRUE (arg_block_od);
+
+   ode_start (port);
+   ode_read_index (portnumber, IOL_DEV_PARAMA_VENDOR_NAME, arg_block_od, 16);
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 1);
+
+   OD_Stop (port);
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (ODE_STATE_Inactive, ode_get_state (port));
+
+   /* Confirmation of the dropped request is ignored */
+   ode_read_cnf (port, sizeof (data), data);
+   EXPECT_EQ (ODE_STATE_Inactive, ode_get_state (port));
+   EXPECT_EQ (mock_iolink_smi_cnf_cnt, 0);
+   EXPECT_EQ (mock_iolink_smi_joberror_cnt, 0);
+
+   /* Nor cached */
+   ode_start (port);
+   ode_read_index (portnumber, IOL_DEV_PARAMA_VENDOR_NAME, arg_block_od, 16);
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 2);
+   EXPECT_EQ (ODE_STATE_ODblocked, ode_get_state (port));
+
+   free (arg_block_od);
+}
+
+TEST_F (ODETest, Ode_late_batch_cnf_after_stop)
+{
+   uint8_t list_buf[sizeof (arg_block_portindexlist_t) + 2 * sizeof (port_index_t)];
+   arg_block_portindexlist_t * list = (arg_block_portindexlist_t *)list_buf;
+   uint8_t data[2]                  = {0x12, 0x34};
+
+   list->arg_block.id        = IOLINK_ARG_BLOCK_ID_PORT_INXDEX_LIST;
+   list->entries[0].index    = 16;
+   list->entries[0].subindex = 0;
+   list->entries[1].index    = 17;
+   list->entries[1].subindex = 0;
+
+   ode_start (port);
+
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      SMI_ParamReadBatch_req (
+         portnumber,
+         IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT,
+         sizeof (list_buf),
+         &list->arg_block));
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 1);
+
+   OD_Stop (port);
+   mock_iolink_job.callback (&mock_iolink_job);
+
+   /* The rest of the batch is not issued */
+   ode_read_cnf (port, sizeof (data), data);
+   EXPECT_EQ (ODE_STATE_Inactive, ode_get_state (port));
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 1);
+   EXPECT_EQ (mock_iolink_smi_cnf_cnt, 0);
+
+   /* A write confirmation is ignored as well */
+   mock_iolink_al_write_cnf_cb (port, IOLINK_SMI_ERRORTYPE_NONE);
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (ODE_STATE_Inactive, ode_get_state (port));
+   EXPECT_EQ (mock_iolink_smi_cnf_cnt, 0);
+   EXPECT_EQ (mock_iolink_smi_joberror_cnt, 0);
+}
+
+TEST_F (ODETest, Ode_cache_served_while_busy)
+{
+   uint8_t data[]                 = {0x12, 0x34};
+   arg_block_od_t * arg_block_od  = ode_create_ArgBlock_od (16);
+   arg_block_od_t * arg_block_od2 = ode_create_ArgBlock_od (16);
+
+   ASSERT_TRUE (arg_block_od);
+   ASSERT_TRUE (arg_block_od2);
+
+   ode_start (port);
+
+   ode_read_index (portnumber, IOL_DEV_PARAMA_SERIAL_NUMBER, arg_block_od, 16);
+   ode_read_cnf (port, sizeof (data), data);
+
+   /* Occupy the OD channel */
+   ode_read_index (portnumber, 0x40, arg_block_od2, 16);
+   EXPECT_EQ (ODE_STATE_ODblocked, ode_get_state (port));
+
+   ode_read_index (portnumber, IOL_DEV_PARAMA_SERIAL_NUMBER, arg_block_od, 16);
+   EXPECT_EQ (mock_iolink_smi_cnf_cnt, 2);
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 2);
+   ode_verify_smi_read (
+      IOLINK_ARG_BLOCK_ID_OD_RD,
+      IOLINK_ARG_BLOCK_ID_OD_RD,
+      sizeof (arg_block_od_t) + sizeof (data),
+      data);
+   EXPECT_EQ (ODE_STATE_ODblocked, ode_get_state (port));
+
+   ode_read_cnf (port, sizeof (data), data);
+   EXPECT_EQ (ODE_STATE_ODactive, ode_get_state (port));
+   EXPECT_EQ (mock_iolink_smi_cnf_cnt, 3);
+
+   free (arg_block_od);
+   free (arg_block_od2);
+}
+
+TEST_F (ODETest, Ode_cache_invalidate_on_write)
+{
+   uint8_t data[]                   = {'t', 'a', 'g'};
+   arg_block_od_t * arg_block_od    = ode_create_ArgBlock_od (16);
+   arg_block_od_t * arg_block_od_wr = ode_create_ArgBlock_od (sizeof (data));
+
+   ASSERT_TRUE (arg_block_od);
+   ASSERT_TRUE (arg_block_od_wr);
+
+   ode_start (port);
+
+   ode_read_index (portnumber, IOL_DEV_PARAMA_APP_SPEC_TAG, arg_block_od, 16);
+   ode_read_cnf (port, sizeof (data), data);
+   ode_read_index (portnumber, IOL_DEV_PARAMA_APP_SPEC_TAG, arg_block_od, 16);
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 1);
+
+   /* A read queued after a write of the index is not served early */
+   ode_read_index (portnumber, 0x40, arg_block_od, 16);
+   arg_block_od_wr->arg_block.id = IOLINK_ARG_BLOCK_ID_OD_WR;
+   arg_block_od_wr->index        = IOL_DEV_PARAMA_APP_SPEC_TAG;
+   memcpy (arg_block_od_wr->data, data, sizeof (data));
+   SMI_DeviceWrite_req (
+      portnumber,
+      IOLINK_ARG_BLOCK_ID_VOID_BLOCK,
+      sizeof (arg_block_od_t) + sizeof (data),
+      (arg_block_t *)arg_block_od_wr);
+   mock_iolink_job.callback (&mock_iolink_job);
+   ode_read_index (portnumber, IOL_DEV_PARAMA_APP_SPEC_TAG, arg_block_od, 16);
+   EXPECT_EQ (mock_iolink_smi_cnf_cnt, 2);
+
+   ode_read_cnf (port, sizeof (data), data);
+   EXPECT_EQ (mock_iolink_al_write_req_cnt, 1);
+   mock_iolink_al_write_cnf_cb (port, IOLINK_SMI_ERRORTYPE_NONE);
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 3);
+   EXPECT_EQ (mock_iolink_al_data_index, IOL_DEV_PARAMA_APP_SPEC_TAG);
+   ode_read_cnf (port, sizeof (data), data);
+   EXPECT_EQ (mock_iolink_smi_cnf_cnt, 5);
+   EXPECT_EQ (ODE_STATE_ODactive, ode_get_state (port));
+
+   free (arg_block_od);
+   free (arg_block_od_wr);
+}
+
+TEST_F (ODETest, Ode_cache_read_during_batch)
+{
+   uint8_t batch_buf[sizeof (arg_block_devparbat_t) + 2 * sizeof (dev_par_bat_entry_t) + 4];
+   arg_block_devparbat_t * batch = (arg_block_devparbat_t *)batch_buf;
+   dev_par_bat_entry_t * entry1  = (dev_par_bat_entry_t *)batch->entries;
+   dev_par_bat_entry_t * entry2;
+   uint8_t data[]                = {'t', 'a', 'g'};
+   uint8_t name[]                = {'r', 't'};
+   arg_block_od_t * arg_block_od  = ode_create_ArgBlock_od (16);
+   arg_block_od_t * arg_block_od2 = ode_create_ArgBlock_od (16);
+
+   ASSERT_TRUE (arg_block_od);
+   ASSERT_TRUE (arg_block_od2);
+
+   memset (batch_buf, 0, sizeof (batch_buf));
+   batch->arg_block.id = IOLINK_ARG_BLOCK_ID_DEV_PAR_BAT;
+   entry1->index       = 0x40;
+   entry1->len         = 1;
+   entry2              = (dev_par_bat_entry_t *)&entry1->data[entry1->len];
+   entry2->index       = IOL_DEV_PARAMA_APP_SPEC_TAG;
+   entry2->len         = sizeof (data);
+   memcpy (entry2->data, data, sizeof (data));
+
+   ode_start (port);
+
+   ode_read_index (portnumber, IOL_DEV_PARAMA_APP_SPEC_TAG, arg_block_od, 16);
+   ode_read_cnf (port, sizeof (data), data);
+   ode_read_index (portnumber, IOL_DEV_PARAMA_VENDOR_NAME, arg_block_od2, 16);
+   ode_read_cnf (port, sizeof (name), name);
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 2);
+   EXPECT_EQ (mock_iolink_smi_cnf_cnt, 2);
+
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      SMI_ParamWriteBatch_req (
+         portnumber,
+         IOLINK_ARG_BLOCK_ID_VOID_BLOCK,
+         sizeof (batch_buf),
+         &batch->arg_block));
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (mock_iolink_al_write_req_cnt, 1);
+   EXPECT_EQ (mock_iolink_al_data_index, 0x40);
+
+   /* The tag is written later in the batch, the read waits for it */
+   ode_read_index (portnumber, IOL_DEV_PARAMA_APP_SPEC_TAG, arg_block_od, 16);
+   EXPECT_EQ (mock_iolink_smi_cnf_cnt, 2);
+
+   /* Objects not in the batch are still served from the cache */
+   ode_read_index (portnumber, IOL_DEV_PARAMA_VENDOR_NAME, arg_block_od2, 16);
+   EXPECT_EQ (mock_iolink_smi_cnf_cnt, 3);
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 2);
+
+   mock_iolink_al_write_cnf_cb (port, IOLINK_SMI_ERRORTYPE_NONE);
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (mock_iolink_al_write_req_cnt, 2);
+   EXPECT_EQ (mock_iolink_al_data_index, IOL_DEV_PARAMA_APP_SPEC_TAG);
+   mock_iolink_al_write_cnf_cb (port, IOLINK_SMI_ERRORTYPE_NONE);
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (mock_iolink_smi_cnf_cnt, 4);
+
+   /* Read from the device after the batch */
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 3);
+   EXPECT_EQ (mock_iolink_al_data_index, IOL_DEV_PARAMA_APP_SPEC_TAG);
+   ode_read_cnf (port, sizeof (data), data);
+   EXPECT_EQ (mock_iolink_smi_cnf_cnt, 5);
+   EXPECT_EQ (ODE_STATE_ODactive, ode_get_state (port));
+
+   free (arg_block_od);
+   free (arg_block_od2);
+}
+
+TEST_F (ODETest, Ode_cache_ttl)
+{
+   iolink_ode_port_t * ode       = iolink_get_ode_ctx (port);
+   uint8_t data[]                = {0x00};
+   arg_block_od_t * arg_block_od = ode_create_ArgBlock_od (16);
+
+   ASSERT_TRUE (arg_block_od);
+
+   ode_start (port);
+
+   /* Status parameters are not cached by default */
+   ode_read_index (portnumber, IOL_DEV_PARAMA_DEVICE_STATUS, arg_block_od, 16);
+   ode_read_cnf (port, sizeof (data), data);
+   ode_read_index (portnumber, IOL_DEV_PARAMA_DEVICE_STATUS, arg_block_od, 16);
+   ode_read_cnf (port, sizeof (data), data);
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 2);
+
+   ode->cache_ttl_ms = 1;
+   ode_read_index (portnumber, IOL_DEV_PARAMA_DEVICE_STATUS, arg_block_od, 16);
+   ode_read_cnf (port, sizeof (data), data);
+   ode_read_index (portnumber, IOL_DEV_PARAMA_DEVICE_STATUS, arg_block_od, 16);
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 3);
+   EXPECT_EQ (ODE_STATE_ODactive, ode_get_state (port));
+
+   /* Read again from the device when expired */
+   os_usleep (2 * 1000);
+   ode_read_index (portnumber, IOL_DEV_PARAMA_DEVICE_STATUS, arg_block_od, 16);
+   EXPECT_EQ (mock_iolink_al_read_req_cnt, 4);
+   ode_read_cnf (port, sizeof (data), data);
+   EXPECT_EQ (mock_iolink_smi_cnf_cnt, 5);
+
+   free (arg_block_od);
+}
@@ -0,0 +1,194 @@
+/*********************************************************************
+ *        _       _         _
+ *  _ __ | |_  _ | |  __ _ | |__   ___
+ * | '__|| __|(_)| | / _` || '_ \ / __|
+ * | |   | |_  _ | || (_| || |_) |\__ \
+ * |_|    \__|(_)|_| \__,_||_.__/ |___/
+ *
+ * www.rt-labs.com
+ * Copyright 2024 rt-labs AB, Sweden.
+ *
+ * This software is dual-licensed under GPLv3 and a commercial
+ * license. See the file LICENSE.md distributed with this software for
+ * full license information.
+ ********************************************************************/
+
+#include "options.h"
+#include "osal.h"
+#include <gtest/gtest.h>
+
+#include "mocks.h"
+#include "iolink_al.h"
+#include "iolink_pdx.h"
+#include "test_util.h"
+
+#define PDX_VENDORID 0x0136
+#define PDX_DEVICEID 0x000123
+
+/* 4 octets PD input:
+ *   bit 31..16  signed 16-bit value, 0.1 units/LSB
+ *   bit 13..4   unsigned 10-bit value spanning octets 2 and 3
+ *   bit 0       switching signal
+ */
+static const iolink_pd_field_desc_t pdx_fields[] = {
+   {.bit_offset = 16, .bit_len = 16, .is_signed = true, .gradient = 0.1f},
+   {.bit_offset = 4, .bit_len = 10, .is_signed = false},
+   {.bit_offset = 0, .bit_len = 1, .is_signed = false},
+};
+
+static const iolink_pd_desc_t pdx_desc = {
+   .vendorid  = PDX_VENDORID,
+   .deviceid  = PDX_DEVICEID,
+   .pdin_len  = 4,
+   .field_cnt = NELEMENTS (pdx_fields),
+   .fields    = pdx_fields,
+};
+
+// Test fixture
+
+class PDXTest : public TestBase
+{
+ protected:
+   // Override default setup
+   virtual void SetUp()
+   {
+      TestBase::SetUp(); // Re-use default setup
+
+      iolink_port_info_t * port_info = iolink_get_port_info (port);
+
+      port_info->vendorid = PDX_VENDORID;
+      port_info->deviceid = PDX_DEVICEID;
+   };
+};
+
+TEST_F (PDXTest, PDX_Decode)
+{
+   /* -100 (0xFF9C), 0x2A5 at bit 4, switching signal set */
+   uint8_t data[4] = {0xFF, 0x9C, 0x2A, 0x51};
+   float values[4];
+   uint8_t cnt = NELEMENTS (values);
+
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_pd_desc_add (&pdx_desc));
+   DL_PDInputTransport_ind (port, data, sizeof (data));
+
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_pd_decode (portnumber, values, &cnt));
+   EXPECT_EQ (3, cnt);
+   EXPECT_FLOAT_EQ (-10.0f, values[0]);
+   EXPECT_FLOAT_EQ (0x2A5, values[1]);
+   EXPECT_FLOAT_EQ (1, values[2]);
+
+   /* Positive value, switching signal cleared */
+   data[0] = 0x01;
+   data[1] = 0x00;
+   data[3] = 0x50;
+   DL_PDInputTransport_ind (port, data, sizeof (data));
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_pd_decode (portnumber, values, &cnt));
+   EXPECT_FLOAT_EQ (25.6f, values[0]);
+   EXPECT_FLOAT_EQ (0, values[2]);
+
+   /* PD input length does not match the description */
+   DL_PDInputTransport_ind (port, data, 2);
+   EXPECT_EQ (
+      IOLINK_ERROR_PDINLENGTH,
+      iolink_pd_decode (portnumber, values, &cnt));
+
+   /* Too small destination */
+   DL_PDInputTransport_ind (port, data, sizeof (data));
+   cnt = 2;
+   EXPECT_EQ (
+      IOLINK_ERROR_PARAMETER_CONFLICT,
+      iolink_pd_decode (portnumber, values, &cnt));
+}
+
+TEST_F (PDXTest, PDX_NoDescription)
+{
+   float values[4];
+   uint8_t cnt = NELEMENTS (values);
+
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_pd_desc_add (&pdx_desc));
+
+   /* Other device on the port */
+   iolink_get_port_info (port)->deviceid = PDX_DEVICEID + 1;
+   EXPECT_EQ (
+      IOLINK_ERROR_STATE_INVALID,
+      iolink_pd_decode (portnumber, values, &cnt));
+}
+
+TEST_F (PDXTest, PDX_InvalidDescription)
+{
+   iolink_pd_field_desc_t field = {.bit_offset = 25, .bit_len = 8};
+   iolink_pd_desc_t desc        = pdx_desc;
+
+   desc.field_cnt = 1;
+   desc.fields    = &field;
+
+   /* Outside PD input */
+   EXPECT_EQ (IOLINK_ERROR_PARAMETER_CONFLICT, iolink_pd_desc_add (&desc));
+
+   field.bit_offset = 0;
+   field.bit_len    = 33;
+   EXPECT_EQ (IOLINK_ERROR_PARAMETER_CONFLICT, iolink_pd_desc_add (&desc));
+
+   field.bit_len = 0;
+   EXPECT_EQ (IOLINK_ERROR_PARAMETER_CONFLICT, iolink_pd_desc_add (&desc));
+
+   desc.pdin_len = IOLINK_PD_MAX_SIZE + 1;
+   field.bit_len = 8;
+   EXPECT_EQ (IOLINK_ERROR_PARAMETER_CONFLICT, iolink_pd_desc_add (&desc));
+}
+
+TEST_F (PDXTest, PDX_Full)
+{
+   iolink_pd_desc_t desc = pdx_desc;
+   uint8_t i;
+
+   for (i = 0; i < IOLINK_PD_DESC_CNT; i++)
+   {
+      desc.deviceid = i;
+      EXPECT_EQ (IOLINK_ERROR_NONE, iolink_pd_desc_add (&desc));
+   }
+
+   desc.deviceid = IOLINK_PD_DESC_CNT;
+   EXPECT_EQ (IOLINK_ERROR_OUT_OF_MEMORY, iolink_pd_desc_add (&desc));
+
+   /* Replaced */
+   desc.deviceid = 0;
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_pd_desc_add (&desc));
+}
+
+TEST_F (PDXTest, PDX_Run)
+{
+   iolink_pdx_t * pdx = iolink_get_pdx (port);
+   iolink_pd_field_desc_t fields[] = {
+      /* 32-bit unsigned at the start of 32 octets PD input */
+      {.bit_offset = 224, .bit_len = 32, .is_signed = false},
+      /* 32-bit signed at the end */
+      {.bit_offset = 0, .bit_len = 32, .is_signed = true},
+      /* 3-bit signed spanning octets 30 and 31 */
+      {.bit_offset = 7, .bit_len = 3, .is_signed = true, .offset = 0.5f},
+   };
+   iolink_pd_desc_t desc = {
+      .vendorid  = 1,
+      .deviceid  = 2,
+      .pdin_len  = IOLINK_PD_MAX_SIZE,
+      .field_cnt = NELEMENTS (fields),
+      .fields    = fields,
+   };
+   uint8_t pd[IOLINK_PD_MAX_SIZE + 8];
+   float values[3];
+
+   memset (pd, 0, sizeof (pd));
+   pd[0]  = 0x80;
+   pd[3]  = 0x01;
+   pd[28] = 0xFF;
+   pd[29] = 0xFF;
+   pd[30] = 0xFF;
+   pd[31] = 0x80; /* -128 */
+
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_pdx_add (pdx, &desc));
+   iolink_pdx_run (&pdx->prog[0], pd, values);
+   EXPECT_FLOAT_EQ (2147483649.0f, values[0]);
+   EXPECT_FLOAT_EQ (-128.0f, values[1]);
+   /* Bits 9..7 = 0b111 */
+   EXPECT_FLOAT_EQ (-0.5f, values[2]);
+}
@@ -0,0 +1,258 @@
+/*********************************************************************
+ *        _       _         _
+ *  _ __ | |_  _ | |  __ _ | |__   ___
+ * | '__|| __|(_)| | / _` || '_ \ / __|
+ * | |   | |_  _ | || (_| || |_) |\__ \
+ * |_|    \__|(_)|_| \__,_||_.__/ |___/
+ *
+ * www.rt-labs.com
+ * Copyright 2024 rt-labs AB, Sweden.
+ *
+ * This software is dual-licensed under GPLv3 and a commercial
+ * license. See the file LICENSE.md distributed with this software for
+ * full license information.
+ ********************************************************************/
+
+#include "options.h"
+#include "osal.h"
+#include <gtest/gtest.h>
+
+#include "mocks.h"
+#include "iolink_al.h"
+#include "iolink_pde.h"
+#include "iolink_pi.h"
+#include "test_util.h"
+
+#define PI_INPUT_SIZE  40
+#define PI_OUTPUT_SIZE 16
+
+static const iolink_pi_map_t pi_map_port1 = {
+   .pqi_offset    = 0,
+   .status_offset = 1,
+   .pdin_offset   = 2,
+   .pdin_len      = 4,
+   .pdout_offset  = 0,
+   .pdout_len     = 2,
+};
+
+static const iolink_pi_map_t pi_map_port2 = {
+   .pqi_offset    = 32,
+   .status_offset = IOLINK_PI_UNMAPPED,
+   .pdin_offset   = 33,
+   .pdin_len      = 2,
+   .pdout_offset  = IOLINK_PI_UNMAPPED,
+   .pdout_len     = 0,
+};
+
+// Test fixture
+
+class PITest : public TestBase
+{
+ protected:
+   // Override default setup
+   virtual void SetUp()
+   {
+      TestBase::SetUp(); // Re-use default setup
+
+      /* Restart with a process image */
+      iolink_m_deinit (&m);
+      m = init_master (PI_INPUT_SIZE, &pi_map_port2);
+      ASSERT_TRUE (m != NULL);
+      port = iolink_get_port (m, portnumber);
+   };
+
+   iolink_m_t * init_master (uint16_t input_size, const iolink_pi_map_t * map2)
+   {
+      iolink_port_cfg_t port_cfgs[] = {
+         {
+            .name   = "/ioltest1/0",
+            .mode   = NULL,
+            .pi_map = &pi_map_port1,
+         },
+         {
+            .name   = "/ioltest1/1",
+            .mode   = NULL,
+            .pi_map = map2,
+         },
+      };
+      iolink_m_cfg_t m_cfg = {
+         .cb_arg                   = NULL,
+         .cb_smi                   = mock_SMI_cnf,
+         .cb_pd                    = NULL,
+         .port_cnt                 = NELEMENTS (port_cfgs),
+         .port_cfgs                = port_cfgs,
+         .master_thread_prio       = IOLINK_MASTER_THREAD_PRIO,
+         .master_thread_stack_size = IOLINK_MASTER_THREAD_STACK_SIZE,
+         .dl_thread_prio           = IOLINK_DL_THREAD_PRIO,
+         .dl_thread_stack_size     = IOLINK_DL_THREAD_STACK_SIZE,
+         .pi_input_size            = input_size,
+         .pi_output_size           = PI_OUTPUT_SIZE,
+      };
+
+      return iolink_m_init (&m_cfg);
+   }
+};
+
+TEST_F (PITest, PI_Aligned)
+{
+   iolink_pi_t * pi = iolink_get_pi (port);
+
+   EXPECT_EQ (0u, (uintptr_t)pi->input % IOLINK_PI_ALIGN);
+   EXPECT_EQ (0u, (uintptr_t)pi->output % IOLINK_PI_ALIGN);
+}
+
+TEST_F (PITest, PI_InvalidMap)
+{
+   iolink_pi_map_t map = pi_map_port2;
+
+   iolink_m_deinit (&m);
+
+   /* PD input slot outside the input area */
+   map.pdin_offset = PI_INPUT_SIZE - 1;
+   m               = init_master (PI_INPUT_SIZE, &map);
+   EXPECT_TRUE (m == NULL);
+
+   /* Port status outside the input area */
+   map               = pi_map_port2;
+   map.status_offset = PI_INPUT_SIZE;
+   m                 = init_master (PI_INPUT_SIZE, &map);
+   EXPECT_TRUE (m == NULL);
+}
+
+TEST_F (PITest, PI_Input)
+{
+   iolink_port_t * port2 = iolink_get_port (m, 2);
+   uint8_t data[]        = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66};
+   uint8_t image[PI_INPUT_SIZE];
+   uint32_t generation;
+   uint32_t prev_generation;
+
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      iolink_pi_read_input (image, sizeof (image), &prev_generation));
+
+   /* Updated in place by DL_PDInputTransport_ind, truncated to the slot */
+   DL_PDInputTransport_ind (port, data, sizeof (data));
+   DL_PDInputTransport_ind (port2, data, 1);
+
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      iolink_pi_read_input (image, sizeof (image), &generation));
+   EXPECT_EQ (prev_generation + 2, generation);
+   EXPECT_TRUE (ArraysMatchN (data, &image[2], 4));
+   EXPECT_EQ (0, image[6]);
+   EXPECT_EQ (0x11, image[33]);
+   EXPECT_EQ (0x00, image[34]);
+
+   /* Shorter input is zero padded */
+   DL_PDInputTransport_ind (port, data, 2);
+   iolink_pi_read_input (image, sizeof (image), &generation);
+   EXPECT_EQ (0x22, image[3]);
+   EXPECT_EQ (0x00, image[4]);
+   EXPECT_EQ (0x00, image[5]);
+
+   /* Larger than the input area */
+   EXPECT_EQ (
+      IOLINK_ERROR_PARAMETER_CONFLICT,
+      iolink_pi_read_input (image, PI_INPUT_SIZE + 1, NULL));
+}
+
+TEST_F (PITest, PI_PortInfo)
+{
+   iolink_port_info_t * port_info = iolink_get_port_info (port);
+   uint8_t image[PI_INPUT_SIZE];
+   uint32_t generation;
+   uint32_t prev_generation;
+
+   iolink_pi_read_input (image, sizeof (image), &prev_generation);
+
+   port_info->port_status_info  = IOLINK_PORT_STATUS_INFO_OP;
+   port_info->port_quality_info = IOLINK_PORT_QUALITY_INFO_INVALID;
+   iolink_pi_update_port_info (port);
+
+   iolink_pi_read_input (image, sizeof (image), &generation);
+   EXPECT_EQ (prev_generation + 1, generation);
+   EXPECT_EQ (IOLINK_PORT_QUALIFIER_INFO_PQ_INVALID, image[0]);
+   EXPECT_EQ (IOLINK_PORT_STATUS_INFO_OP, image[1]);
+
+   /* Unchanged, the image is not updated */
+   iolink_pi_update_port_info (port);
+   iolink_pi_read_input (image, sizeof (image), &prev_generation);
+   EXPECT_EQ (prev_generation, generation);
+
+   port_info->port_quality_info = IOLINK_PORT_QUALITY_INFO_VALID;
+   iolink_pi_update_port_info (port);
+   iolink_pi_read_input (image, sizeof (image), &generation);
+   EXPECT_EQ (IOLINK_PORT_QUALIFIER_INFO_PQ_VALID, image[0]);
+}
+
+TEST_F (PITest, PI_Output)
+{
+   iolink_pde_port_t * pde       = iolink_get_pde_ctx (port);
+   uint8_t image[PI_OUTPUT_SIZE] = {0xAA, 0xBB};
+   uint8_t exp_setoutput_req_cnt = mock_iolink_al_setoutput_req_cnt;
+
+   /* Not sent unless the port is in operate */
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      iolink_pi_write_output (image, sizeof (image)));
+   EXPECT_EQ (IOLINK_JOB_PI_OUTPUT, mock_iolink_job.type);
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (exp_setoutput_req_cnt, mock_iolink_al_setoutput_req_cnt);
+
+   /* Sent by the job on the master thread */
+   pde->state = PD_STATE_PDactive;
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_pi_write_output (image, 2));
+   EXPECT_EQ (exp_setoutput_req_cnt, mock_iolink_al_setoutput_req_cnt);
+   mock_iolink_job.callback (&mock_iolink_job);
+   exp_setoutput_req_cnt++;
+   EXPECT_EQ (exp_setoutput_req_cnt, mock_iolink_al_setoutput_req_cnt);
+
+   EXPECT_EQ (
+      IOLINK_ERROR_PARAMETER_CONFLICT,
+      iolink_pi_write_output (image, PI_OUTPUT_SIZE + 1));
+   EXPECT_EQ (exp_setoutput_req_cnt, mock_iolink_al_setoutput_req_cnt);
+}
+
+TEST_F (PITest, PI_OutputQueued)
+{
+   iolink_pde_port_t * pde       = iolink_get_pde_ctx (port);
+   uint8_t image[PI_OUTPUT_SIZE] = {0xAA, 0xBB};
+   uint8_t exp_setoutput_req_cnt = mock_iolink_al_setoutput_req_cnt;
+
+   pde->state = PD_STATE_PDactive;
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_pi_write_output (image, 2));
+   EXPECT_EQ (IOLINK_JOB_PI_OUTPUT, mock_iolink_job.type);
+
+   /* No new job while one is queued, it sends the latest output */
+   mock_iolink_job.type = IOLINK_JOB_NONE;
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_pi_write_output (image, 2));
+   EXPECT_EQ (IOLINK_JOB_NONE, mock_iolink_job.type);
+
+   mock_iolink_job.callback (&mock_iolink_job);
+   exp_setoutput_req_cnt++;
+   EXPECT_EQ (exp_setoutput_req_cnt, mock_iolink_al_setoutput_req_cnt);
+
+   /* Sent, the next write queues a new job */
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_pi_write_output (image, 2));
+   EXPECT_EQ (IOLINK_JOB_PI_OUTPUT, mock_iolink_job.type);
+   mock_iolink_job.callback (&mock_iolink_job);
+   exp_setoutput_req_cnt++;
+   EXPECT_EQ (exp_setoutput_req_cnt, mock_iolink_al_setoutput_req_cnt);
+}
+
+TEST_F (PITest, PI_OutputOnPDStart)
+{
+   uint8_t image[PI_OUTPUT_SIZE] = {0xAA, 0xBB};
+   uint8_t exp_setoutput_req_cnt = mock_iolink_al_setoutput_req_cnt;
+
+   /* Written before operate */
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_pi_write_output (image, 2));
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (exp_setoutput_req_cnt, mock_iolink_al_setoutput_req_cnt);
+
+   /* Sent when the PDE starts */
+   PD_Start (port);
+   exp_setoutput_req_cnt++;
+   EXPECT_EQ (exp_setoutput_req_cnt, mock_iolink_al_setoutput_req_cnt);
+}
@@ -0,0 +1,105 @@
+/*********************************************************************
+ *        _       _         _
+ *  _ __ | |_  _ | |  __ _ | |__   ___
+ * | '__|| __|(_)| | / _` || '_ \ / __|
+ * | |   | |_  _ | || (_| || |_) |\__ \
+ * |_|    \__|(_)|_| \__,_||_.__/ |___/
+ *
+ * www.rt-labs.com
+ * Copyright 2024 rt-labs AB, Sweden.
+ *
+ * This software is dual-licensed under GPLv3 and a commercial
+ * license. See the file LICENSE.md distributed with this software for
+ * full license information.
+ ********************************************************************/
+
+#include "options.h"
+#include "osal.h"
+#include <gtest/gtest.h>
+
+#include "iolink_seqlock.h"
+
+// Test fixture
+
+class SeqlockTest : public ::testing::Test
+{
+ protected:
+   virtual void SetUp()
+   {
+      mtx = os_mutex_create();
+      iolink_seqlock_init (&lock, mtx);
+   };
+
+   virtual void TearDown()
+   {
+      os_mutex_destroy (mtx);
+   };
+
+   void write (uint32_t value)
+   {
+      os_mutex_lock (mtx);
+      iolink_seqlock_write_begin (&lock);
+      data = value;
+      iolink_seqlock_write_end (&lock);
+      os_mutex_unlock (mtx);
+   }
+
+   os_mutex_t * mtx;
+   iolink_seqlock_t lock;
+   uint32_t data = 0;
+};
+
+TEST_F (SeqlockTest, Seqlock_Read)
+{
+   iolink_seqlock_read_t read = {0};
+   uint32_t copy;
+
+   write (1);
+   write (2);
+
+   iolink_seqlock_read_begin (&lock, &read);
+   copy = data;
+   EXPECT_FALSE (iolink_seqlock_read_retry (&lock, &read));
+   EXPECT_EQ (2u, copy);
+   EXPECT_EQ (4u, read.seq);
+   EXPECT_FALSE (read.locked);
+}
+
+TEST_F (SeqlockTest, Seqlock_RetryOnUpdate)
+{
+   iolink_seqlock_read_t read = {0};
+   uint32_t copy;
+   int passes = 0;
+
+   do
+   {
+      iolink_seqlock_read_begin (&lock, &read);
+      copy = data;
+      if (passes++ == 0)
+      {
+         /* Updated during the first copy */
+         write (7);
+      }
+   } while (iolink_seqlock_read_retry (&lock, &read));
+
+   EXPECT_EQ (2, passes);
+   EXPECT_EQ (7u, copy);
+   EXPECT_EQ (2u, read.seq);
+}
+
+TEST_F (SeqlockTest, Seqlock_FallbackToMutex)
+{
+   iolink_seqlock_read_t read = {0};
+
+   /* As if a writer never finished its update */
+   __atomic_store_n (&lock.seq, 1, __ATOMIC_RELEASE);
+
+   iolink_seqlock_read_begin (&lock, &read);
+   EXPECT_TRUE (read.locked);
+   EXPECT_EQ (IOLINK_SEQLOCK_MAX_RETRIES, read.tries);
+   EXPECT_FALSE (iolink_seqlock_read_retry (&lock, &read));
+
+   /* The mutex is released again */
+   write (3);
+   EXPECT_EQ (3u, data);
+}
@@ -0,0 +1,313 @@
+/*********************************************************************
+ *        _       _         _
+ *  _ __ | |_  _ | |  __ _ | |__   ___
+ * | '__|| __|(_)| | / _` || '_ \ / __|
+ * | |   | |_  _ | || (_| || |_) |\__ \
+ * |_|    \__|(_)|_| \__,_||_.__/ |___/
+ *
+ * www.rt-labs.com
+ * Copyright 2024 rt-labs AB, Sweden.
+ *
+ * This software is dual-licensed under GPLv3 and a commercial
+ * license. See the file LICENSE.md distributed with this software for
+ * full license information.
+ ********************************************************************/
+
+#include "options.h"
+#include "osal.h"
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include "iolink_dl.h"
+#include "iolink_main.h"
+#include "iolink_pl_hw_drv.h"
+#include "iolink_sim.h"
+
+#define SIM_FLAG BIT (0)
+
+static uint8_t sim_isdu_name[16] = {'r', 't', '-', 'l', 'a', 'b', 's'};
+static uint8_t sim_isdu_tag[8];
+static uint8_t sim_isdu_big[IOLINK_ISDU_MAX_DATA_SIZE + 1];
+
+static iolink_sim_isdu_entry_t sim_isdu[] = {
+   {0x10, 0, true, 7, sizeof (sim_isdu_name), sim_isdu_name},
+   {0x18, 0, false, 0, sizeof (sim_isdu_tag), sim_isdu_tag},
+   {0x20, 0, true, sizeof (sim_isdu_big), sizeof (sim_isdu_big), sim_isdu_big},
+};
+
+class SimTest : public ::testing::Test
+{
+ protected:
+   iolink_hw_drv_t * drv;
+   os_event_t * event;
+
+   virtual void SetUp()
+   {
+      static iolink_sim_device_cfg_t devices[2];
+      iolink_sim_cfg_t cfg;
+
+      memset (devices, 0, sizeof (devices));
+      devices[0].present  = true;
+      devices[0].baudrate = IOLINK_BAUDRATE_COM2;
+      devices[0].page[2]  = 0x17; /* MinCycleTime 2.3 ms */
+      devices[0].page[3]  = 0x02; /* M-seq cap. PREOPERATE TYPE_1_2 */
+      devices[0].page[5]  = 0x81; /* 2 bytes PD in */
+      devices[0].page[6]  = 0x00;
+      devices[0].page[7]  = 0x01;
+      devices[0].page[8]  = 0x02;
+      devices[0].isdu     = sim_isdu;
+      devices[0].isdu_cnt = NELEMENTS (sim_isdu);
+
+      cfg.channel_cnt = NELEMENTS (devices);
+      cfg.devices     = devices;
+      cfg.seed        = 1;
+
+      drv   = iolink_sim_init (&cfg);
+      event = os_event_create();
+      ASSERT_TRUE (drv != NULL);
+
+      drv->ops->configure_event (drv, (void *)0, event, SIM_FLAG);
+      drv->ops->configure_event (drv, (void *)1, event, SIM_FLAG);
+      drv->ops->set_mode (drv, (void *)0, iolink_mode_SDCI);
+   }
+
+   virtual void TearDown()
+   {
+      iolink_sim_deinit (&drv);
+      EXPECT_TRUE (drv == NULL);
+      os_event_destroy (event);
+   }
+
+   /* Collect the PL events reported for a channel */
+   uint32_t pl_events (uintptr_t ch)
+   {
+      uint32_t value = 0;
+
+      if (!os_event_wait (event, SIM_FLAG, &value, 0))
+      {
+         os_event_clr (event, SIM_FLAG);
+         drv->ops->pl_handler (drv, (void *)ch);
+      }
+      os_event_wait (event, 0xFF & ~SIM_FLAG, &value, 0);
+      os_event_clr (event, value);
+
+      return value;
+   }
+
+   /* Send one TYPE_1_2 (2 byte OD) message, return the reply length */
+   uint8_t transfer_od2 (uint8_t mc, const uint8_t * od_out, uint8_t * rx)
+   {
+      uint8_t tx[4] = {mc, 0x40, 0, 0};
+      bool read     = (mc & 0x80) != 0;
+
+      if (!read)
+      {
+         tx[2] = od_out[0];
+         tx[3] = od_out[1];
+      }
+
+      drv->ops->transfer_req (drv, (void *)0, read ? 3 : 1, read ? 2 : 4, tx);
+      if (pl_events (0) != IOLINK_PL_EVENT_RXRDY)
+      {
+         return 0;
+      }
+
+      return drv->ops->get_data (drv, (void *)0, rx, 3) ? (read ? 3 : 1) : 0;
+   }
+};
+
+TEST_F (SimTest, WakeUp)
+{
+   EXPECT_EQ (IOLINK_BAUDRATE_NONE, drv->ops->get_baudrate (drv, (void *)0));
+
+   EXPECT_TRUE (drv->ops->init_sdci (drv, (void *)0));
+   EXPECT_EQ (IOLINK_PL_EVENT_WURQ, pl_events (0));
+   EXPECT_EQ (IOLINK_BAUDRATE_COM2, drv->ops->get_baudrate (drv, (void *)0));
+   EXPECT_EQ (0x17, drv->ops->get_cycletime (drv, (void *)0));
+
+   /* No device on channel 1 */
+   drv->ops->set_mode (drv, (void *)1, iolink_mode_SDCI);
+   EXPECT_TRUE (drv->ops->init_sdci (drv, (void *)1));
+   EXPECT_EQ (IOLINK_PL_EVENT_WURQ, pl_events (1));
+   EXPECT_EQ (IOLINK_BAUDRATE_NONE, drv->ops->get_baudrate (drv, (void *)1));
+}
+
+TEST_F (SimTest, PageRead)
+{
+   uint8_t tx[2] = {0x80 | IOLINK_COMCHANNEL_PAGE | 7, 0x00};
+   uint8_t rx[2] = {0};
+
+   drv->ops->init_sdci (drv, (void *)0);
+   pl_events (0);
+
+   drv->ops->transfer_req (drv, (void *)0, 2, 2, tx);
+   EXPECT_EQ (IOLINK_PL_EVENT_RXRDY, pl_events (0));
+   EXPECT_TRUE (drv->ops->get_data (drv, (void *)0, rx, 2));
+   EXPECT_EQ (0x01, rx[0]);
+   EXPECT_EQ (0x00, rx[1]);
+
+   /* Reply is consumed */
+   EXPECT_FALSE (drv->ops->get_data (drv, (void *)0, rx, 2));
+}
+
+TEST_F (SimTest, OperatePD)
+{
+   uint8_t pdin[2] = {0x12, 0x34};
+   uint8_t tx[2]   = {0x80 | IOLINK_COMCHANNEL_PAGE, 0x80};
+   uint8_t rx[4]   = {0};
+
+   drv->ops->init_sdci (drv, (void *)0);
+   pl_events (0);
+   iolink_sim_set_pdin (drv, 0, pdin, sizeof (pdin), false);
+
+   /* TYPE_2_2: 1 byte OD, 2 bytes PD in */
+   drv->ops->transfer_req (drv, (void *)0, 4, 2, tx);
+   EXPECT_EQ (IOLINK_PL_EVENT_RXRDY, pl_events (0));
+   EXPECT_TRUE (drv->ops->get_data (drv, (void *)0, rx, 4));
+   EXPECT_EQ (0x12, rx[1]);
+   EXPECT_EQ (0x34, rx[2]);
+}
+
+TEST_F (SimTest, IsduRead)
+{
+   uint8_t req[4] = {(IOL_ISERVICE_MASTER_READ_8I << 4) | 3, 0x10, 0, 0};
+   uint8_t rsp[10];
+   uint8_t rx[3];
+   uint8_t chk = 0;
+   uint8_t i;
+
+   req[2] = req[0] ^ req[1];
+
+   drv->ops->init_sdci (drv, (void *)0);
+   pl_events (0);
+
+   ASSERT_EQ (1, transfer_od2 (IOLINK_COMCHANNEL_ISDU | IOLINK_FLOWCTRL_START, &req[0], rx));
+   ASSERT_EQ (1, transfer_od2 (IOLINK_COMCHANNEL_ISDU | 1, &req[2], rx));
+
+   for (i = 0; i < 5; i++)
+   {
+      uint8_t flowctrl = (i == 0) ? IOLINK_FLOWCTRL_START : i;
+
+      ASSERT_EQ (3, transfer_od2 (0x80 | IOLINK_COMCHANNEL_ISDU | flowctrl, NULL, rx));
+      rsp[2 * i]     = rx[0];
+      rsp[2 * i + 1] = rx[1];
+   }
+
+   EXPECT_EQ ((IOL_ISERVICE_DEVICE_READ_RESPONSE_POS << 4) | 9, rsp[0]);
+   EXPECT_EQ (0, memcmp (&rsp[1], "rt-labs", 7));
+   for (i = 0; i < 9; i++)
+   {
+      chk ^= rsp[i];
+   }
+   EXPECT_EQ (0, chk);
+}
+
+TEST_F (SimTest, IsduErrors)
+{
+   uint8_t req[4] = {(IOL_ISERVICE_MASTER_READ_8I << 4) | 3, 0x42, 0, 0};
+   uint8_t rx[3];
+
+   req[2] = req[0] ^ req[1];
+
+   drv->ops->init_sdci (drv, (void *)0);
+   pl_events (0);
+
+   ASSERT_EQ (1, transfer_od2 (IOLINK_COMCHANNEL_ISDU | IOLINK_FLOWCTRL_START, &req[0], rx));
+   ASSERT_EQ (1, transfer_od2 (IOLINK_COMCHANNEL_ISDU | 1, &req[2], rx));
+   ASSERT_EQ (3, transfer_od2 (0x80 | IOLINK_COMCHANNEL_ISDU | IOLINK_FLOWCTRL_START, NULL, rx));
+   EXPECT_EQ ((IOL_ISERVICE_DEVICE_READ_RESPONSE_NEG << 4) | 4, rx[0]);
+   EXPECT_EQ (0x80, rx[1]);
+   ASSERT_EQ (3, transfer_od2 (0x80 | IOLINK_COMCHANNEL_ISDU | 1, NULL, rx));
+   EXPECT_EQ (0x11, rx[0]);
+}
+
+TEST_F (SimTest, IsduReadTooLong)
+{
+   uint8_t req[4] = {(IOL_ISERVICE_MASTER_READ_8I << 4) | 3, 0x20, 0, 0};
+   uint8_t rx[3];
+
+   req[2] = req[0] ^ req[1];
+
+   drv->ops->init_sdci (drv, (void *)0);
+   pl_events (0);
+
+   /* The value does not fit an ISDU */
+   ASSERT_EQ (1, transfer_od2 (IOLINK_COMCHANNEL_ISDU | IOLINK_FLOWCTRL_START, &req[0], rx));
+   ASSERT_EQ (1, transfer_od2 (IOLINK_COMCHANNEL_ISDU | 1, &req[2], rx));
+   ASSERT_EQ (3, transfer_od2 (0x80 | IOLINK_COMCHANNEL_ISDU | IOLINK_FLOWCTRL_START, NULL, rx));
+   EXPECT_EQ ((IOL_ISERVICE_DEVICE_READ_RESPONSE_NEG << 4) | 4, rx[0]);
+   EXPECT_EQ (0x80, rx[1]);
+   ASSERT_EQ (3, transfer_od2 (0x80 | IOLINK_COMCHANNEL_ISDU | 1, NULL, rx));
+   EXPECT_EQ (0x33, rx[0]);
+}
+
+TEST_F (SimTest, IsduBusy)
+{
+   iolink_sim_faults_t faults = {0, 0, 0, 2};
+   uint8_t req[4] = {(IOL_ISERVICE_MASTER_READ_8I << 4) | 3, 0x10, 0, 0};
+   uint8_t rx[3];
+
+   req[2] = req[0] ^ req[1];
+
+   iolink_sim_set_faults (drv, 0, &faults);
+   drv->ops->init_sdci (drv, (void *)0);
+   pl_events (0);
+
+   ASSERT_EQ (1, transfer_od2 (IOLINK_COMCHANNEL_ISDU | IOLINK_FLOWCTRL_START, &req[0], rx));
+   ASSERT_EQ (1, transfer_od2 (IOLINK_COMCHANNEL_ISDU | 1, &req[2], rx));
+
+   ASSERT_EQ (3, transfer_od2 (0x80 | IOLINK_COMCHANNEL_ISDU | IOLINK_FLOWCTRL_START, NULL, rx));
+   EXPECT_EQ (0x01, rx[0]);
+   ASSERT_EQ (3, transfer_od2 (0x80 | IOLINK_COMCHANNEL_ISDU | IOLINK_FLOWCTRL_START, NULL, rx));
+   EXPECT_EQ (0x01, rx[0]);
+   ASSERT_EQ (3, transfer_od2 (0x80 | IOLINK_COMCHANNEL_ISDU | IOLINK_FLOWCTRL_START, NULL, rx));
+   EXPECT_EQ ((IOL_ISERVICE_DEVICE_READ_RESPONSE_POS << 4) | 9, rx[0]);
+}
+
+TEST_F (SimTest, Events)
+{
+   uint8_t confirm[2] = {0, 0};
+   uint8_t rx[3];
+
+   drv->ops->init_sdci (drv, (void *)0);
+   pl_events (0);
+
+   EXPECT_EQ (IOLINK_ERROR_NONE, iolink_sim_event_inject (drv, 0, 0xE4, 0x1801));
+
+   ASSERT_EQ (3, transfer_od2 (0x80 | IOLINK_COMCHANNEL_DIAGNOSIS, NULL, rx));
+   EXPECT_EQ (0x81, rx[0]);
+   EXPECT_EQ (0x80, rx[2] & 0x80);
+
+   ASSERT_EQ (3, transfer_od2 (0x80 | IOLINK_COMCHANNEL_DIAGNOSIS | 1, NULL, rx));
+   EXPECT_EQ (0xE4, rx[0]);
+   EXPECT_EQ (0x18, rx[1]);
+
+   /* Confirm */
+   ASSERT_EQ (1, transfer_od2 (IOLINK_COMCHANNEL_DIAGNOSIS, confirm, rx));
+   EXPECT_EQ (0x00, rx[0] & 0x80);
+}
+
+TEST_F (SimTest, NoResponse)
+{
+   iolink_sim_faults_t faults = {0, 1000, 0, 0};
+   uint8_t tx[2] = {0x80 | IOLINK_COMCHANNEL_PAGE | 7, 0x00};
+   uint8_t cqerr, devdly;
+
+   drv->ops->init_sdci (drv, (void *)0);
+   pl_events (0);
+   iolink_sim_set_faults (drv, 0, &faults);
+
+   drv->ops->transfer_req (drv, (void *)0, 2, 2, tx);
+   EXPECT_EQ (IOLINK_PL_EVENT_RXERR, pl_events (0));
+   drv->ops->get_error (drv, (void *)0, &cqerr, &devdly);
+   EXPECT_EQ (0, cqerr);
+   EXPECT_EQ (BIT (7), devdly);
+
+   /* Disconnected device */
+   faults.no_response_permille = 0;
+   iolink_sim_set_faults (drv, 0, &faults);
+   iolink_sim_set_present (drv, 0, false);
+   drv->ops->transfer_req (drv, (void *)0, 2, 2, tx);
+   EXPECT_EQ (IOLINK_PL_EVENT_RXERR, pl_events (0));
+   EXPECT_EQ (IOLINK_BAUDRATE_NONE, drv->ops->get_baudrate (drv, (void *)0));
+}
@@ -201,35 +201,17 @@ void sm_trans_16 (iolink_port_t * port, bool is_di)
 void sm_verify_readcomparameters (iolink_port_t * port)
 {
    EXPECT_EQ (SM_STATE_ReadComParameter, sm_get_state (port));
-   // IOL_DIR_PARAMA_MIN_CYCL:
-   mock_iolink_job.callback (&mock_iolink_job);
-   // IOL_DIR_PARAMA_MSEQ_CAP:
-   mock_iolink_job.callback (&mock_iolink_job);
-   // IOL_DIR_PARAMA_REV_ID:
-   mock_iolink_job.callback (&mock_iolink_job);
-   // IOL_DIR_PARAMA_PDI:
-   mock_iolink_job.callback (&mock_iolink_job);
-   // IOL_DIR_PARAMA_PDO:
-   EXPECT_EQ (SM_STATE_ReadComParameter, sm_get_state (port));
+   // IOL_DIR_PARAMA_MIN_CYCL to IOL_DIR_PARAMA_PDO, in one DL_ReadPage_cnf
+   EXPECT_EQ (IOLINK_JOB_DL_READPAGE_CNF, mock_iolink_job.type);
+   EXPECT_EQ (IOL_DIR_PARAMA_MIN_CYCL, mock_iolink_job.dl_readpage_cnf.addr);
+   EXPECT_EQ (5, mock_iolink_job.dl_readpage_cnf.len);
    mock_iolink_job.callback (&mock_iolink_job);
    // -> SM_STATE_checkCompatibility
 }
 
 void sm_verify_checkcomp_params (iolink_port_t * port, bool is_v10)
 {
-   // IOL_DIR_PARAMA_VID_1:
-   mock_iolink_job.callback (&mock_iolink_job);
-   // IOL_DIR_PARAMA_VID_2:
-   mock_iolink_job.callback (&mock_iolink_job);
-   // IOL_DIR_PARAMA_DID_1:
-   mock_iolink_job.callback (&mock_iolink_job);
-   // IOL_DIR_PARAMA_DID_2:
-   mock_iolink_job.callback (&mock_iolink_job);
-   // IOL_DIR_PARAMA_DID_3:
-   mock_iolink_job.callback (&mock_iolink_job);
-   // IOL_DIR_PARAMA_FID_1:
-   mock_iolink_job.callback (&mock_iolink_job);
-   // IOL_DIR_PARAMA_FID_2:
+   // IOL_DIR_PARAMA_VID_1 to IOL_DIR_PARAMA_FID_2, in one DL_ReadPage_cnf
    mock_iolink_job.callback (&mock_iolink_job);
    // -> SM_STATE_CheckVxy or SM_STATE_checkCompV10
 }
@@ -514,6 +496,55 @@ TEST_F (SMTest, checkCompatibility_IL_TYPE_COMP)
    EXPECT_EQ (IOLINK_SM_PORTMODE_COMREADY, mock_iolink_sm_portmode);
 }
 
+TEST_F (SMTest, Startup_phases)
+{
+   iolink_smp_parameterlist_t paraml;
+   iolink_startup_timeline_t before;
+   iolink_startup_timeline_t timeline;
+   int phase;
+
+   paraml.inspectionlevel = IOLINK_INSPECTIONLEVEL_TYPE_COMP;
+   paraml.cycletime       = mock_iolink_min_cycletime;
+   paraml.revisionid      = IOL_DIR_PARAM_REV_V11;
+   paraml.mode            = IOLINK_SMTARGET_MODE_AUTOCOM;
+   paraml.vendorid        = mock_iolink_vendorid;
+   paraml.deviceid        = mock_iolink_deviceid;
+   memset (paraml.serialnumber, 0, sizeof (paraml.serialnumber));
+   paraml.serialnumber[0] = 0x11;
+
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      iolink_startup_get_timeline (portnumber, &before));
+
+   sm_checkCompatibility (port, &paraml, SM_STATE_PortInactive, false);
+   DL_Mode_ind (port, IOLINK_MHMODE_PREOPERATE);
+   mock_iolink_job.callback (&mock_iolink_job);
+   mock_iolink_al_read_cnf_cb (
+      port,
+      sizeof (paraml.serialnumber),
+      paraml.serialnumber,
+      IOLINK_SMI_ERRORTYPE_NONE);
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (SM_STATE_wait, sm_get_state (port));
+
+   // Each SM phase was entered once, the CM phases are left to the CM
+   EXPECT_EQ (
+      IOLINK_ERROR_NONE,
+      iolink_startup_get_timeline (portnumber, &timeline));
+   for (phase = IOLINK_STARTUP_PHASE_READ_COM;
+        phase <= IOLINK_STARTUP_PHASE_SERNUM;
+        phase++)
+   {
+      EXPECT_EQ (before.phase[phase].cnt + 1, timeline.phase[phase].cnt);
+      EXPECT_NE (0u, timeline.phase[phase].start_us);
+   }
+   for (phase = IOLINK_STARTUP_PHASE_DS; phase < IOLINK_STARTUP_PHASE_LAST;
+        phase++)
+   {
+      EXPECT_EQ (before.phase[phase].cnt, timeline.phase[phase].cnt);
+   }
+}
+
 TEST_F (SMTest, checkCompatibility_IL_TYPE_COMP_bad_serial)
 {
    iolink_smp_parameterlist_t paraml;
@@ -1112,6 +1143,16 @@ TEST_F (SMTest, Comlost)
    // Verify reported SM_PortMode_ind()
    EXPECT_EQ (IOLINK_SM_PORTMODE_COMLOST, mock_iolink_sm_portmode);
 
+   // Failed page read in ReadComParameter T3
+   sm_set_portconfig_v11_autocom (port);
+   DL_Mode_ind (port, IOLINK_MHMODE_STARTUP);
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (SM_STATE_ReadComParameter, sm_get_state (port));
+   DL_ReadPage_cnf (port, NULL, 0, IOLINK_STATUS_NO_COMM);
+   mock_iolink_job.callback (&mock_iolink_job);
+   EXPECT_EQ (SM_STATE_PortInactive, sm_get_state (port));
+   EXPECT_EQ (IOLINK_SM_PORTMODE_COMLOST, mock_iolink_sm_portmode);
+
    sm_trans_8_10 (port);
    // DL_Mode_COMLOST T3
    DL_Mode_ind (port, IOLINK_MHMODE_COMLOST);
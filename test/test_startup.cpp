@@ -0,0 +1,215 @@
+/*********************************************************************
+ *        _       _         _
+ *  _ __ | |_  _ | |  __ _ | |__   ___
+ * | '__|| __|(_)| | / _` || '_ \ / __|
+ * | |   | |_  _ | || (_| || |_) |\__ \
+ * |_|    \__|(_)|_| \__,_||_.__/ |___/
+ *
+ * www.rt-labs.com
+ * Copyright 2024 rt-labs AB, Sweden.
+ *
+ * This software is dual-licensed under GPLv3 and a commercial
+ * license. See the file LICENSE.md distributed with this software for
+ * full license information.
+ ********************************************************************/
+
+#include "options.h"
+#include "osal.h"
+#include <gtest/gtest.h>
+
+#include "iolink_startup.h"
+
+#define STARTUP_PORT_CNT 4
+
+// Test fixture
+
+class StartupTest : public ::testing::Test
+{
+ protected:
+   virtual void SetUp()
+   {
+      memset (&m_cfg, 0, sizeof (m_cfg));
+      m_cfg.port_cnt = STARTUP_PORT_CNT;
+   };
+
+   virtual void TearDown()
+   {
+      iolink_startup_deinit (&startup);
+   };
+
+   void init (uint8_t max_ports, uint32_t spacing_us)
+   {
+      m_cfg.startup_max_ports       = max_ports;
+      m_cfg.startup_wurq_spacing_us = spacing_us;
+      iolink_startup_init (&startup, &m_cfg);
+   }
+
+   uint32_t wake (uint8_t portnumber, uint32_t now_us)
+   {
+      return iolink_startup_wake_req (&startup, portnumber, now_us, &kick);
+   }
+
+   iolink_m_cfg_t m_cfg;
+   iolink_startup_t startup;
+   uint8_t kick;
+};
+
+TEST_F (StartupTest, Startup_NoLimit)
+{
+   uint8_t portnumber;
+
+   init (0, 0);
+
+   for (portnumber = 1; portnumber <= STARTUP_PORT_CNT; portnumber++)
+   {
+      EXPECT_EQ (0u, wake (portnumber, 100));
+      EXPECT_EQ (0, kick);
+   }
+   EXPECT_EQ (STARTUP_PORT_CNT, startup.active);
+}
+
+TEST_F (StartupTest, Startup_Slots)
+{
+   init (2, 0);
+
+   EXPECT_EQ (0u, wake (1, 0));
+   EXPECT_EQ (0u, wake (2, 0));
+   EXPECT_EQ (IOLINK_STARTUP_WAIT_SLOT, wake (4, 0));
+   EXPECT_EQ (IOLINK_STARTUP_WAIT_SLOT, wake (3, 0));
+
+   /* Slots are given in the order they were asked for */
+   EXPECT_EQ (4, iolink_startup_ready_ind (&startup, 1, 100, false));
+   EXPECT_EQ (IOLINK_STARTUP_WAIT_SLOT, wake (3, 100));
+   EXPECT_EQ (0u, wake (4, 100));
+   EXPECT_EQ (0, kick);
+
+   /* Released on a failed WURQ, or when cancelled */
+   EXPECT_EQ (3, iolink_startup_com_ind (&startup, 2, 200, false));
+   EXPECT_EQ (0u, wake (3, 200));
+   EXPECT_EQ (0, iolink_startup_cancel (&startup, 4, 200));
+   EXPECT_EQ (1, startup.active);
+
+   /* A waiting port that is cancelled gives up its turn */
+   EXPECT_EQ (0u, wake (1, 300));
+   EXPECT_EQ (IOLINK_STARTUP_WAIT_SLOT, wake (2, 300));
+   EXPECT_EQ (IOLINK_STARTUP_WAIT_SLOT, wake (4, 300));
+   EXPECT_EQ (0, iolink_startup_cancel (&startup, 2, 300));
+   EXPECT_EQ (4, iolink_startup_ready_ind (&startup, 3, 400, true));
+   EXPECT_EQ (0u, wake (4, 400));
+}
+
+TEST_F (StartupTest, Startup_Spacing)
+{
+   init (0, 1000);
+
+   EXPECT_EQ (0u, wake (1, 5000));
+   EXPECT_EQ (900u, wake (2, 5100));
+   EXPECT_EQ (IOLINK_STARTUP_WAIT_SLOT, wake (3, 5200));
+
+   /* The next port is kicked to wait for its own spacing */
+   EXPECT_EQ (0u, wake (2, 6000));
+   EXPECT_EQ (3, kick);
+   EXPECT_EQ (1000u, wake (3, 6000));
+   EXPECT_EQ (0u, wake (3, 7000));
+   EXPECT_EQ (0, kick);
+}
+
+TEST_F (StartupTest, Startup_Timeline)
+{
+   iolink_startup_timeline_t timeline;
+
+   init (1, 0);
+
+   EXPECT_EQ (0u, wake (1, 100));
+   EXPECT_EQ (IOLINK_STARTUP_WAIT_SLOT, wake (2, 150));
+
+   /* A retry after a failed WURQ is part of the same startup */
+   EXPECT_EQ (2, iolink_startup_com_ind (&startup, 1, 200, false));
+   EXPECT_EQ (0u, wake (2, 250));
+   EXPECT_EQ (IOLINK_STARTUP_WAIT_SLOT, wake (1, 300));
+   EXPECT_EQ (1, iolink_startup_com_ind (&startup, 2, 350, false));
+   EXPECT_EQ (0u, wake (1, 400));
+   EXPECT_EQ (0, iolink_startup_com_ind (&startup, 1, 500, true));
+   EXPECT_EQ (0, iolink_startup_ready_ind (&startup, 1, 600, false));
+   EXPECT_EQ (0, iolink_startup_ready_ind (&startup, 1, 700, true));
+
+   iolink_startup_read_timeline (&startup, 1, &timeline);
+   EXPECT_EQ (100u, timeline.request_us);
+   EXPECT_EQ (400u, timeline.wurq_us);
+   EXPECT_EQ (500u, timeline.com_us);
+   EXPECT_EQ (600u, timeline.ready_us);
+   EXPECT_EQ (700u, timeline.operate_us);
+   EXPECT_EQ (2, timeline.wurq_cnt);
+
+   /* A new startup */
+   EXPECT_EQ (0, iolink_startup_cancel (&startup, 1, 750));
+   EXPECT_EQ (0u, wake (1, 800));
+   iolink_startup_read_timeline (&startup, 1, &timeline);
+   EXPECT_EQ (800u, timeline.request_us);
+   EXPECT_EQ (800u, timeline.wurq_us);
+   EXPECT_EQ (0u, timeline.ready_us);
+   EXPECT_EQ (1, timeline.wurq_cnt);
+}
+
+TEST_F (StartupTest, Startup_Phases)
+{
+   iolink_startup_timeline_t timeline;
+   iolink_startup_report_t report;
+   const iolink_startup_phase_rec_t * rec = timeline.phase;
+
+   init (1, 0);
+
+   EXPECT_EQ (0u, wake (2, 50));
+   EXPECT_EQ (IOLINK_STARTUP_WAIT_SLOT, wake (1, 100));
+   EXPECT_EQ (0, iolink_startup_com_ind (&startup, 2, 250, true));
+   iolink_startup_phase_ind (&startup, 2, IOLINK_STARTUP_PHASE_READ_COM, 260);
+   EXPECT_EQ (1, iolink_startup_ready_ind (&startup, 2, 300, true));
+   iolink_startup_phase_ind (&startup, 2, IOLINK_STARTUP_PHASE_NONE, 400);
+
+   /* A phase entered again, e.g. after a device restart, adds up */
+   EXPECT_EQ (0u, wake (1, 300));
+   EXPECT_EQ (0, iolink_startup_com_ind (&startup, 1, 450, true));
+   iolink_startup_phase_ind (&startup, 1, IOLINK_STARTUP_PHASE_READ_COM, 500);
+   iolink_startup_phase_ind (&startup, 1, IOLINK_STARTUP_PHASE_CHECK_COMP, 600);
+   iolink_startup_phase_ind (&startup, 1, IOLINK_STARTUP_PHASE_READ_COM, 700);
+   iolink_startup_phase_ind (&startup, 1, IOLINK_STARTUP_PHASE_CHECK_COMP, 750);
+   iolink_startup_phase_ind (&startup, 1, IOLINK_STARTUP_PHASE_PREOPERATE, 800);
+   iolink_startup_phase_ind (&startup, 1, IOLINK_STARTUP_PHASE_SERNUM, 900);
+   iolink_startup_phase_ind (&startup, 1, IOLINK_STARTUP_PHASE_NONE, 950);
+   iolink_startup_phase_ind (&startup, 1, IOLINK_STARTUP_PHASE_DS, 1000);
+   iolink_startup_phase_ind (&startup, 1, IOLINK_STARTUP_PHASE_OPERATE, 1500);
+   EXPECT_EQ (0, iolink_startup_ready_ind (&startup, 1, 1600, true));
+   iolink_startup_phase_ind (&startup, 1, IOLINK_STARTUP_PHASE_NONE, 1700);
+
+   iolink_startup_read_timeline (&startup, 1, &timeline);
+   EXPECT_EQ (100u, rec[IOLINK_STARTUP_PHASE_WAIT].start_us);
+   EXPECT_EQ (200u, rec[IOLINK_STARTUP_PHASE_WAIT].duration_us);
+   EXPECT_EQ (300u, rec[IOLINK_STARTUP_PHASE_WURQ].start_us);
+   EXPECT_EQ (150u, rec[IOLINK_STARTUP_PHASE_WURQ].duration_us);
+   EXPECT_EQ (500u, rec[IOLINK_STARTUP_PHASE_READ_COM].start_us);
+   EXPECT_EQ (150u, rec[IOLINK_STARTUP_PHASE_READ_COM].duration_us);
+   EXPECT_EQ (2, rec[IOLINK_STARTUP_PHASE_READ_COM].cnt);
+   EXPECT_EQ (150u, rec[IOLINK_STARTUP_PHASE_CHECK_COMP].duration_us);
+   EXPECT_EQ (2, rec[IOLINK_STARTUP_PHASE_CHECK_COMP].cnt);
+   EXPECT_EQ (100u, rec[IOLINK_STARTUP_PHASE_PREOPERATE].duration_us);
+   EXPECT_EQ (50u, rec[IOLINK_STARTUP_PHASE_SERNUM].duration_us);
+   EXPECT_EQ (500u, rec[IOLINK_STARTUP_PHASE_DS].duration_us);
+   EXPECT_EQ (1500u, rec[IOLINK_STARTUP_PHASE_OPERATE].start_us);
+   EXPECT_EQ (200u, rec[IOLINK_STARTUP_PHASE_OPERATE].duration_us);
+
+   /* The report covers the ports that went through each phase */
+   iolink_startup_read_report (&startup, &report);
+   EXPECT_EQ (2, report.phase[IOLINK_STARTUP_PHASE_WAIT].port_cnt);
+   EXPECT_EQ (0u, report.phase[IOLINK_STARTUP_PHASE_WAIT].min_us);
+   EXPECT_EQ (200u, report.phase[IOLINK_STARTUP_PHASE_WAIT].max_us);
+   EXPECT_EQ (150u, report.phase[IOLINK_STARTUP_PHASE_WURQ].min_us);
+   EXPECT_EQ (200u, report.phase[IOLINK_STARTUP_PHASE_WURQ].max_us);
+   EXPECT_EQ (350u, report.phase[IOLINK_STARTUP_PHASE_WURQ].total_us);
+   EXPECT_EQ (140u, report.phase[IOLINK_STARTUP_PHASE_READ_COM].min_us);
+   EXPECT_EQ (290u, report.phase[IOLINK_STARTUP_PHASE_READ_COM].total_us);
+   EXPECT_EQ (1, report.phase[IOLINK_STARTUP_PHASE_DS].port_cnt);
+   EXPECT_EQ (2, report.operate.port_cnt);
+   EXPECT_EQ (250u, report.operate.min_us);
+   EXPECT_EQ (1500u, report.operate.max_us);
+   EXPECT_EQ (1750u, report.operate.total_us);
+}
@@ -114,7 +114,9 @@ class TestBase : public ::testing::Test
       mock_iolink_al_getinputoutput_req_cnt = 0;
       mock_iolink_al_newinput_inf_cnt       = 0;
       mock_iolink_ds_delete_cnt             = 0;
+      mock_iolink_ds_release_cnt            = 0;
       mock_iolink_ds_startup_cnt            = 0;
+      mock_iolink_ds_upload_cnt             = 0;
       mock_iolink_ds_ready_cnt              = 0;
       mock_iolink_ds_fault_cnt              = 0;
       mock_iolink_ds_fault                  = IOLINK_DS_FAULT_NONE;